@@ -0,0 +1,161 @@
+// =============================================================================
+// Brutal Engine - Character Batch Benchmark
+// Agents stepped per millisecond versus job system thread count
+// =============================================================================
+
+#include "brutal/core/jobs.h"
+#include "brutal/core/memory.h"
+#include "brutal/core/time.h"
+#include "brutal/world/character.h"
+#include "brutal/world/collision.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+using namespace brutal;
+
+static constexpr f32 FIXED_DT = 1.0f / 60.0f;
+
+struct BenchConfig {
+    u32 agents = 1024;
+    u32 steps = 120;
+    u32 max_threads = 0;
+};
+
+// Floor, outer walls, a grid of pillars and a few low beams to crouch under.
+static void build_world(CollisionWorld* w) {
+    collision_world_add_box(w, { Vec3(-40, -1, -40), Vec3(40, 0, 40) });
+    collision_world_add_box(w, { Vec3(-41, 0, -41), Vec3(-40, 4, 41) });
+    collision_world_add_box(w, { Vec3(40, 0, -41), Vec3(41, 4, 41) });
+    collision_world_add_box(w, { Vec3(-41, 0, -41), Vec3(41, 4, -40) });
+    collision_world_add_box(w, { Vec3(-41, 0, 40), Vec3(41, 4, 41) });
+    for (i32 z = -35; z <= 35; z += 7) {
+        for (i32 x = -35; x <= 35; x += 7) {
+            Vec3 c((f32)x, 0.0f, (f32)z);
+            collision_world_add_box(w, { c + Vec3(-0.5f, 0, -0.5f), c + Vec3(0.5f, 3.0f, 0.5f) });
+        }
+    }
+    for (i32 z = -30; z <= 30; z += 15) {
+        collision_world_add_box(w, { Vec3(-20, 1.3f, (f32)z), Vec3(20, 1.6f, (f32)z + 1.0f) });
+    }
+}
+
+// Deterministic per-agent intent so both paths see the same inputs.
+static void script_input(u32 agent, u32 step, f32* yaw, f32* forward, f32* right, u8* buttons) {
+    u32 phase = (agent * 7u + step) % 240u;
+    *yaw = (f32)(agent % 16) * 0.3926991f + (f32)step * 0.01f;
+    *forward = phase < 200 ? 1.0f : -1.0f;
+    *right = (agent & 1) ? 0.5f : -0.5f;
+    u8 b = 0;
+    if ((step + agent) % 90 == 0) b |= CHARACTER_INPUT_JUMP;
+    if (agent % 5 == 0) b |= CHARACTER_INPUT_SPRINT;
+    if (phase >= 120 && phase < 150) b |= CHARACTER_INPUT_CROUCH;
+    *buttons = b;
+}
+
+static Vec3 spawn_position(u32 agent) {
+    f32 x = -30.0f + (f32)(agent % 64) * 0.95f;
+    f32 z = -30.0f + (f32)(agent / 64 % 64) * 0.95f;
+    return Vec3(x + 0.25f, 1.7f, z + 0.25f);
+}
+
+static void run_reference(CharacterState* states, const CharacterParams* params, const CollisionWorld* w, const BenchConfig& cfg) {
+    for (u32 i = 0; i < cfg.agents; i++) character_state_init(&states[i], params, spawn_position(i));
+    for (u32 step = 0; step < cfg.steps; step++) {
+        for (u32 i = 0; i < cfg.agents; i++) {
+            CharacterInput input = {};
+            u8 buttons = 0;
+            script_input(i, step, &input.yaw, &input.forward, &input.right, &buttons);
+            input.sprint = (buttons & CHARACTER_INPUT_SPRINT) != 0;
+            input.crouch = (buttons & CHARACTER_INPUT_CROUCH) != 0;
+            if (buttons & CHARACTER_INPUT_JUMP) character_request_jump(&states[i]);
+            character_step(&states[i], params, &input, w, FIXED_DT);
+        }
+    }
+}
+
+// Returns seconds spent inside character_batch_update.
+static f64 run_batch(CharacterBatch* b, const CharacterParams* params, const CollisionWorld* w, const BenchConfig& cfg) {
+    character_batch_clear(b);
+    for (u32 i = 0; i < cfg.agents; i++) character_batch_add(b, params, spawn_position(i), 0.0f);
+    f64 total = 0.0;
+    for (u32 step = 0; step < cfg.steps; step++) {
+        for (u32 i = 0; i < cfg.agents; i++) {
+            script_input(i, step, &b->yaw[i], &b->forward[i], &b->right[i], &b->buttons[i]);
+        }
+        f64 t0 = time_now();
+        character_batch_update(b, params, w, FIXED_DT);
+        total += time_now() - t0;
+    }
+    return total;
+}
+
+static bool states_match(const CharacterBatch* b, const CharacterState* reference, u32 count) {
+    for (u32 i = 0; i < count; i++) {
+        CharacterState s;
+        character_batch_get(b, i, &s);
+        const CharacterState& r = reference[i];
+        if (memcmp(&s.eye_position, &r.eye_position, sizeof(Vec3)) != 0 ||
+            memcmp(&s.velocity, &r.velocity, sizeof(Vec3)) != 0 ||
+            s.current_height != r.current_height || s.coyote_time != r.coyote_time ||
+            s.jump_buffer_time != r.jump_buffer_time || s.move_state != r.move_state ||
+            s.grounded != r.grounded || s.is_crouched != r.is_crouched) {
+            fprintf(stderr, "agent %u diverged from single-agent path\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--agents")) cfg.agents = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--steps")) cfg.steps = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--max-threads")) cfg.max_threads = (u32)atoi(argv[i + 1]);
+    }
+    if (cfg.max_threads == 0) {
+        cfg.max_threads = std::thread::hardware_concurrency();
+        if (cfg.max_threads == 0) cfg.max_threads = 1;
+    }
+
+    MemoryArena arena = {};
+    if (!arena_init(&arena, 64 * 1024 * 1024)) return 1;
+
+    CollisionWorld world = {};
+    collision_world_create(&world, &arena, 1024);
+    build_world(&world);
+
+    CharacterParams params;
+    character_params_default(&params);
+
+    CharacterBatch batch = {};
+    CharacterState* reference = arena_alloc_array<CharacterState>(&arena, cfg.agents);
+    if (!character_batch_create(&batch, &arena, cfg.agents) || !reference) return 1;
+
+    run_reference(reference, &params, &world, cfg);
+
+    printf("character batch: %u agents, %u steps, %u boxes\n", cfg.agents, cfg.steps, world.box_count);
+    printf("%8s %12s %12s %10s %10s\n", "threads", "agents/ms", "ms/update", "speedup", "identical");
+
+    bool all_identical = true;
+    f64 baseline = 0.0;
+    for (u32 threads = 1; threads <= cfg.max_threads; threads++) {
+        if (threads > 1) jobs_init(threads - 1);
+        f64 seconds = run_batch(&batch, &params, &world, cfg);
+        if (threads > 1) jobs_shutdown();
+
+        bool identical = states_match(&batch, reference, cfg.agents);
+        all_identical = all_identical && identical;
+
+        f64 ms = seconds * 1000.0;
+        f64 agents_per_ms = ms > 0.0 ? (f64)cfg.agents * cfg.steps / ms : 0.0;
+        if (threads == 1) baseline = agents_per_ms;
+        printf("%8u %12.1f %12.3f %9.2fx %10s\n", threads, agents_per_ms, ms / cfg.steps,
+            baseline > 0.0 ? agents_per_ms / baseline : 0.0, identical ? "yes" : "NO");
+    }
+
+    arena_shutdown(&arena);
+    return all_identical ? 0 : 1;
+}
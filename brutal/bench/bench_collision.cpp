@@ -0,0 +1,337 @@
+// =============================================================================
+// Brutal Engine - Collision Benchmark
+// move_and_slide and player_update against synthetic worlds, JSON output
+// =============================================================================
+
+#include "brutal/core/memory.h"
+#include "brutal/core/platform.h"
+#include "brutal/core/profiler.h"
+#include "brutal/core/time.h"
+#include "brutal/world/collision.h"
+#include "brutal/world/player.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace brutal;
+
+static constexpr f32 FIXED_DT = 1.0f / 60.0f;
+static constexpr u32 MAX_WORLD_BOXES = 16384;
+static constexpr u32 MAX_MOVERS = 64;
+
+struct BenchConfig {
+    u32 movers = 32;
+    u32 steps = 256;
+    const char* out_path = nullptr;
+};
+
+struct BenchWorld {
+    const char* name;
+    CollisionWorld col;
+    Vec3 spawns[MAX_MOVERS];   // Feet positions
+    u32 spawn_count;
+};
+
+struct CaseResult {
+    const char* world;
+    const char* name;
+    u32 boxes;
+    u32 calls;
+    f64 ns_per_call;
+    f64 p50_ns;
+    f64 p99_ns;
+    f64 boxes_tested_per_call;
+    f64 cache_hit_rate;        // < 0 when the case has no cache
+};
+
+// =============================================================================
+// Synthetic Worlds
+// =============================================================================
+static u32 g_rng = 1;
+static f32 rand01() {
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return (f32)(g_rng >> 8) * (1.0f / 16777216.0f);
+}
+
+static void add_box(BenchWorld* w, f32 x0, f32 y0, f32 z0, f32 x1, f32 y1, f32 z1) {
+    collision_world_add_box(&w->col, { Vec3(x0, y0, z0), Vec3(x1, y1, z1) });
+}
+
+static void add_spawn(BenchWorld* w, f32 x, f32 z) {
+    if (w->spawn_count < MAX_MOVERS) w->spawns[w->spawn_count++] = Vec3(x, 0.01f, z);
+}
+
+// Floor with a square grid of pillars and knee-high blocks, 4m apart.
+static void build_grid(BenchWorld* w, u32 n) {
+    f32 half = (f32)n * 2.0f;
+    add_box(w, -half - 1, -1, -half - 1, half + 1, 0, half + 1);
+    for (u32 z = 0; z < n; z++) {
+        for (u32 x = 0; x < n; x++) {
+            f32 cx = -half + 2.0f + (f32)x * 4.0f;
+            f32 cz = -half + 2.0f + (f32)z * 4.0f;
+            f32 h = ((x + z) % 4 == 0) ? 0.4f : 3.0f;
+            add_box(w, cx - 0.4f, 0, cz - 0.4f, cx + 0.4f, h, cz + 0.4f);
+        }
+    }
+    for (u32 i = 0; i < MAX_MOVERS; i++) {
+        add_spawn(w, -half + 4.0f * (f32)(i % n), -half + 4.0f * (f32)((i / n) % n));
+    }
+}
+
+// Floor scattered with random crates, slabs and posts.
+static void build_clutter(BenchWorld* w, u32 count, f32 extent) {
+    g_rng = 12345u;
+    add_box(w, -extent, -1, -extent, extent, 0, extent);
+    for (u32 i = 0; i < count; i++) {
+        f32 sx = 0.3f + rand01() * 2.5f;
+        f32 sz = 0.3f + rand01() * 2.5f;
+        f32 sy = 0.2f + rand01() * 2.8f;
+        f32 x = -extent + rand01() * (2.0f * extent - sx);
+        f32 z = -extent + rand01() * (2.0f * extent - sz);
+        f32 y = rand01() < 0.15f ? 1.2f + rand01() : 0.0f;   // Some overhangs
+        add_box(w, x, y, z, x + sx, y + sy, z + sz);
+    }
+    for (u32 i = 0; i < MAX_MOVERS; i++) {
+        add_spawn(w, -extent * 0.8f + rand01() * extent * 1.6f, -extent * 0.8f + rand01() * extent * 1.6f);
+    }
+}
+
+// Gothic house style: rows of vaulted halls joined by doorways, with wall
+// buttresses, low beams, a ceiling and a staircase per hall.
+static void build_gothic(BenchWorld* w, u32 halls_x, u32 halls_z) {
+    const f32 HALL = 12.0f, WALL = 0.4f, HEIGHT = 6.0f, DOOR = 2.0f;
+    f32 size_x = HALL * (f32)halls_x, size_z = HALL * (f32)halls_z;
+    add_box(w, -1, -1, -1, size_x + 1, 0, size_z + 1);
+    for (u32 hz = 0; hz < halls_z; hz++) {
+        for (u32 hx = 0; hx < halls_x; hx++) {
+            f32 x0 = HALL * (f32)hx, z0 = HALL * (f32)hz;
+            f32 mid_x = x0 + HALL * 0.5f, mid_z = z0 + HALL * 0.5f;
+
+            // West and south walls with a centered doorway and lintel
+            add_box(w, x0, 0, z0, x0 + WALL, HEIGHT, mid_z - DOOR * 0.5f);
+            add_box(w, x0, 0, mid_z + DOOR * 0.5f, x0 + WALL, HEIGHT, z0 + HALL);
+            add_box(w, x0, 2.4f, mid_z - DOOR * 0.5f, x0 + WALL, HEIGHT, mid_z + DOOR * 0.5f);
+            add_box(w, x0, 0, z0, mid_x - DOOR * 0.5f, HEIGHT, z0 + WALL);
+            add_box(w, mid_x + DOOR * 0.5f, 0, z0, x0 + HALL, HEIGHT, z0 + WALL);
+            add_box(w, mid_x - DOOR * 0.5f, 2.4f, z0, mid_x + DOOR * 0.5f, HEIGHT, z0 + WALL);
+
+            // Buttresses along the walls
+            for (u32 b = 1; b < 4; b++) {
+                f32 t = (f32)b * HALL * 0.25f;
+                if (fabsf(t - HALL * 0.5f) < DOOR) continue;
+                add_box(w, x0 + WALL, 0, z0 + t - 0.3f, x0 + WALL + 0.5f, HEIGHT, z0 + t + 0.3f);
+                add_box(w, x0 + t - 0.3f, 0, z0 + WALL, x0 + t + 0.3f, HEIGHT, z0 + WALL + 0.5f);
+            }
+
+            // Crouch beam, ceiling and a six-step staircase
+            add_box(w, x0 + 2.0f, 1.3f, mid_z + 2.0f, x0 + HALL - 2.0f, 1.6f, mid_z + 2.6f);
+            add_box(w, x0, HEIGHT, z0, x0 + HALL, HEIGHT + 0.5f, z0 + HALL);
+            for (u32 s = 0; s < 6; s++) {
+                f32 sx = x0 + HALL - 3.0f;
+                f32 sz = z0 + 1.0f + (f32)s * 0.3f;
+                add_box(w, sx, 0, sz, sx + 2.0f, 0.2f * (f32)(s + 1), sz + 0.3f);
+            }
+            add_spawn(w, mid_x - 1.5f, mid_z - 1.5f);
+        }
+    }
+    // Outer east and north walls
+    add_box(w, size_x, 0, 0, size_x + WALL, HEIGHT, size_z);
+    add_box(w, 0, 0, size_z, size_x, HEIGHT, size_z + WALL);
+}
+
+// =============================================================================
+// Scripted Motion
+// =============================================================================
+// Walk velocity for one mover and step: slow turning, periodic hops, and a
+// constant downward push so the floor is in contact like a grounded player.
+static Vec3 script_velocity(u32 mover, u32 step) {
+    f32 yaw = (f32)mover * 0.7f + (f32)step * 0.02f;
+    f32 speed = (mover % 3 == 0) ? 6.5f : 4.0f;
+    f32 vy = ((step + mover * 11) % 90 < 12) ? 4.0f : -2.0f;
+    return Vec3(sinf(yaw) * speed, vy, cosf(yaw) * speed) * FIXED_DT;
+}
+
+static void script_keys(InputState* input, u32 mover, u32 step) {
+    memset(input, 0, sizeof(*input));
+    u32 phase = (step + mover * 7) % 240;
+    input->keys.down[KEY_W & 0xFF] = phase < 200;
+    input->keys.down[KEY_S & 0xFF] = phase >= 200;
+    input->keys.down[((step / 60) % 2 ? KEY_A : KEY_D) & 0xFF] = true;
+    input->keys.down[KEY_SHIFT & 0xFF] = (mover % 3 == 0);
+    input->keys.down[KEY_LCONTROL & 0xFF] = phase >= 120 && phase < 140;
+    input->keys.pressed[KEY_SPACE & 0xFF] = (step + mover) % 90 == 0;
+    input->keys.down[KEY_SPACE & 0xFF] = input->keys.pressed[KEY_SPACE & 0xFF];
+}
+
+static AABB mover_box(const Vec3& feet) {
+    return { feet + Vec3(-0.3f, 0, -0.3f), feet + Vec3(0.3f, 1.8f, 0.3f) };
+}
+
+// =============================================================================
+// Cases
+// =============================================================================
+static void finish_case(CaseResult* r, f64* samples, u32 calls, u64 boxes_tested) {
+    r->calls = calls;
+    f64 total = 0.0;
+    for (u32 i = 0; i < calls; i++) total += samples[i];
+    std::sort(samples, samples + calls);
+    r->ns_per_call = calls ? total / calls : 0.0;
+    r->p50_ns = calls ? samples[calls / 2] : 0.0;
+    r->p99_ns = calls ? samples[std::min(calls - 1, (u32)((f64)calls * 0.99))] : 0.0;
+    r->boxes_tested_per_call = calls ? (f64)boxes_tested / calls : 0.0;
+}
+
+static CaseResult run_move_and_slide(const BenchWorld* w, const BenchConfig& cfg, f64* samples, bool cached) {
+    CaseResult r = {};
+    r.world = w->name;
+    r.name = cached ? "move_and_slide_cached" : "move_and_slide";
+    r.boxes = w->col.box_count;
+    r.cache_hit_rate = -1.0;
+
+    static Vec3 feet[MAX_MOVERS];
+    static CollisionCache caches[MAX_MOVERS];
+    u32 movers = std::min(cfg.movers, w->spawn_count);
+    for (u32 m = 0; m < movers; m++) {
+        feet[m] = w->spawns[m];
+        collision_cache_init(&caches[m]);
+    }
+
+    u32 calls = 0;
+    u64 tested = 0;
+    for (u32 step = 0; step < cfg.steps; step++) {
+        for (u32 m = 0; m < movers; m++) {
+            AABB box = mover_box(feet[m]);
+            Vec3 vel = script_velocity(m, step);
+            f64 t0 = time_now();
+            MoveResult mr = cached
+                ? collision_move_and_slide_cached(&caches[m], &w->col, box, vel)
+                : collision_move_and_slide(&w->col, box, vel);
+            samples[calls++] = (time_now() - t0) * 1e9;
+            tested += mr.boxes_tested;
+            feet[m] = feet[m] + (mr.position - aabb_center(box));
+        }
+    }
+    finish_case(&r, samples, calls, tested);
+
+    if (cached) {
+        u64 q = 0, h = 0;
+        for (u32 m = 0; m < movers; m++) { q += caches[m].queries; h += caches[m].hits; }
+        r.cache_hit_rate = q ? (f64)h / q : 0.0;
+    }
+    return r;
+}
+
+static CaseResult run_player_update(const BenchWorld* w, const BenchConfig& cfg, f64* samples) {
+    CaseResult r = {};
+    r.world = w->name;
+    r.name = "player_update";
+    r.boxes = w->col.box_count;
+
+    static Player players[MAX_MOVERS];
+    u32 movers = std::min(cfg.movers, w->spawn_count);
+    for (u32 m = 0; m < movers; m++) {
+        player_init(&players[m]);
+        players[m].camera.position = w->spawns[m] + Vec3(0, players[m].stand_height - players[m].eye_offset, 0);
+        players[m].camera.yaw = (f32)m * 0.7f;
+    }
+
+    InputState input;
+    u32 calls = 0;
+    u64 tested = 0;
+    for (u32 step = 0; step < cfg.steps; step++) {
+        for (u32 m = 0; m < movers; m++) {
+            Player* p = &players[m];
+            script_keys(&input, m, step);
+            player_capture_input(p, &input, false);
+            p->camera.yaw += 0.02f;
+            f64 t0 = time_now();
+            player_update(p, &input, &w->col, FIXED_DT);
+            samples[calls++] = (time_now() - t0) * 1e9;
+            tested += p->last_boxes_tested;
+        }
+    }
+    finish_case(&r, samples, calls, tested);
+
+    u64 q = 0, h = 0;
+    for (u32 m = 0; m < movers; m++) { q += players[m].collision_cache.queries; h += players[m].collision_cache.hits; }
+    r.cache_hit_rate = q ? (f64)h / q : 0.0;
+    return r;
+}
+
+// =============================================================================
+// Output
+// =============================================================================
+static void write_json(FILE* f, const BenchConfig& cfg, const CaseResult* results, u32 count) {
+    fprintf(f, "{\n  \"benchmark\": \"collision\",\n  \"movers\": %u,\n  \"steps\": %u,\n  \"results\": [\n",
+        cfg.movers, cfg.steps);
+    for (u32 i = 0; i < count; i++) {
+        const CaseResult& r = results[i];
+        fprintf(f, "    {\"world\": \"%s\", \"case\": \"%s\", \"boxes\": %u, \"calls\": %u, "
+            "\"ns_per_call\": %.1f, \"p50_ns\": %.1f, \"p99_ns\": %.1f, \"boxes_tested_per_call\": %.1f",
+            r.world, r.name, r.boxes, r.calls, r.ns_per_call, r.p50_ns, r.p99_ns, r.boxes_tested_per_call);
+        if (r.cache_hit_rate >= 0.0) fprintf(f, ", \"cache_hit_rate\": %.4f", r.cache_hit_rate);
+        fprintf(f, "}%s\n", i + 1 < count ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--movers")) cfg.movers = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--steps")) cfg.steps = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--out")) cfg.out_path = argv[i + 1];
+    }
+    if (cfg.movers == 0 || cfg.movers > MAX_MOVERS) cfg.movers = MAX_MOVERS;
+    if (cfg.steps == 0) cfg.steps = 1;
+
+    profiler_init();
+
+    MemoryArena arena = {};
+    MemoryArena world_arena = {};
+    if (!arena_init(&arena, 16 * 1024 * 1024) || !arena_init(&world_arena, 4 * 1024 * 1024)) return 1;
+
+    f64* samples = arena_alloc_array<f64>(&arena, (size_t)cfg.movers * cfg.steps);
+    if (!samples) return 1;
+
+    static constexpr u32 WORLD_COUNT = 7;
+    static constexpr u32 MAX_RESULTS = WORLD_COUNT * 3;
+    CaseResult results[MAX_RESULTS];
+    u32 result_count = 0;
+
+    for (u32 i = 0; i < WORLD_COUNT; i++) {
+        arena_reset(&world_arena);
+        BenchWorld* w = arena_alloc_array<BenchWorld>(&world_arena, 1);
+        if (!w || !collision_world_create(&w->col, &world_arena, MAX_WORLD_BOXES)) return 1;
+        switch (i) {
+            case 0: w->name = "grid_8";       build_grid(w, 8); break;
+            case 1: w->name = "grid_32";      build_grid(w, 32); break;
+            case 2: w->name = "grid_96";      build_grid(w, 96); break;
+            case 3: w->name = "clutter_500";  build_clutter(w, 500, 40.0f); break;
+            case 4: w->name = "clutter_5000"; build_clutter(w, 5000, 120.0f); break;
+            case 5: w->name = "gothic_2x2";   build_gothic(w, 2, 2); break;
+            default: w->name = "gothic_8x8";  build_gothic(w, 8, 8); break;
+        }
+
+        results[result_count++] = run_move_and_slide(w, cfg, samples, false);
+        results[result_count++] = run_move_and_slide(w, cfg, samples, true);
+        results[result_count++] = run_player_update(w, cfg, samples);
+    }
+
+    FILE* out = stdout;
+    if (cfg.out_path) {
+        out = fopen(cfg.out_path, "w");
+        if (!out) {
+            fprintf(stderr, "cannot open %s\n", cfg.out_path);
+            return 1;
+        }
+    }
+    write_json(out, cfg, results, result_count);
+    if (out != stdout) fclose(out);
+
+    arena_shutdown(&world_arena);
+    arena_shutdown(&arena);
+    return 0;
+}
@@ -0,0 +1,192 @@
+// =============================================================================
+// Brutal Engine - Light Cluster Benchmark
+// Build cost of the froxel light lists for candle-lit interiors of growing
+// light counts, serial and on the job pool, and a check that every light
+// reaching a point is listed in that point's froxel. Then the cost of picking
+// per-object light lists for a field of props and the lights each gets.
+// =============================================================================
+
+#include "brutal/core/jobs.h"
+#include "brutal/core/memory.h"
+#include "brutal/core/time.h"
+#include "brutal/renderer/light.h"
+#include "brutal/renderer/light_clusters.h"
+#include "brutal/renderer/object_lights.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace brutal;
+
+struct BenchConfig {
+    u32 iterations = 50;
+    u32 samples = 20000;
+    u32 threads = 0;    // 0: hardware threads
+    u32 props = 10000;
+};
+
+static u32 g_rng = 11;
+static f32 rand01() {
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return (f32)(g_rng >> 8) * (1.0f / 16777216.0f);
+}
+
+// Small candles spread through a 60 x 60 m floor, a few spots above them
+static void fill_lights(LightEnvironment* env, u32 count) {
+    light_environment_clear(env);
+    g_rng = 11;
+    for (u32 i = 0; i < count; i++) {
+        Vec3 pos(rand01() * 60.0f - 30.0f, 0.5f + rand01() * 2.0f, -rand01() * 60.0f);
+        Vec3 color(1.0f, 0.6f + rand01() * 0.2f, 0.3f);
+        if (i % 8 == 7) {
+            light_environment_add_spot(env, pos + Vec3(0, 2, 0), Vec3(0, -1, 0), color, 6.0f, 0.95f, 0.85f, 1.0f, 1.0f);
+        } else {
+            light_environment_add_point(env, pos, color, 1.5f + rand01() * 2.5f, 1.0f);
+        }
+    }
+}
+
+static Vec3 view_point(const Mat4& v, const Vec3& p) {
+    return Vec3(v.m[0] * p.x + v.m[4] * p.y + v.m[8] * p.z + v.m[12],
+        v.m[1] * p.x + v.m[5] * p.y + v.m[9] * p.z + v.m[13],
+        v.m[2] * p.x + v.m[6] * p.y + v.m[10] * p.z + v.m[14]);
+}
+
+// Random visible points: each point light whose sphere holds the point must
+// be in the point's froxel unless that froxel is full
+static u32 count_misses(const LightClusters* c, const Mat4& view, u32 samples) {
+    u32 misses = 0;
+    for (u32 s = 0; s < samples; s++) {
+        Vec3 p(rand01() * 60.0f - 30.0f, rand01() * 3.0f, -rand01() * 60.0f);
+        Vec3 vp = view_point(view, p);
+        f32 depth = -vp.z;
+        if (depth < c->near_plane || fabsf(vp.x) > depth * c->tan_half_x || fabsf(vp.y) > depth * c->tan_half_y) continue;
+        u32 cell = c->grid[light_clusters_index(c, vp)];
+        u32 first = cell >> 8, count = cell & 0xFF;
+        if (count == CLUSTER_MAX_LIGHTS) continue;
+        for (u32 i = 0; i < c->light_count; i++) {
+            const f32* d = &c->light_data[i * CLUSTER_LIGHT_FLOATS];
+            if (d[14] != 0.0f) continue;
+            Vec3 to(p.x - d[0], p.y - d[1], p.z - d[2]);
+            if (vec3_length(to) >= d[3]) continue;
+            bool listed = false;
+            for (u32 k = 0; k < count && !listed; k++) listed = c->indices[first + k] == i;
+            if (!listed) misses++;
+        }
+    }
+    return misses;
+}
+
+struct ObjectStats {
+    f64 ms;
+    f32 average;
+    u32 misses;   // Props with a free slot that left out a light touching them
+};
+
+// Unit props on the candle floor; a point light whose sphere touches a prop
+// must be in its list whenever the list has room
+static ObjectStats select_for_props(const LightClusters* c, u32 props) {
+    ObjectStats st = {};
+    u32 refs = 0;
+    g_rng = 23;
+    AABB* boxes = (AABB*)malloc(sizeof(AABB) * props);
+    ObjectLights* lists = (ObjectLights*)malloc(sizeof(ObjectLights) * props);
+    for (u32 p = 0; p < props; p++) {
+        Vec3 pos(rand01() * 60.0f - 30.0f, 0.5f, -rand01() * 60.0f);
+        boxes[p] = aabb_transform({ Vec3(-0.5f, -0.5f, -0.5f), Vec3(0.5f, 0.5f, 0.5f) }, mat4_translation(pos));
+    }
+    f64 t0 = time_now();
+    for (u32 p = 0; p < props; p++) object_lights_select(c, boxes[p], &lists[p]);
+    st.ms = (time_now() - t0) * 1000.0;
+
+    for (u32 p = 0; p < props; p++) {
+        const AABB& box = boxes[p];
+        const ObjectLights& lights = lists[p];
+        refs += lights.count;
+        if (lights.count == OBJECT_MAX_LIGHTS) continue;
+        for (u32 i = 0; i < c->light_count; i++) {
+            const f32* d = &c->light_data[i * CLUSTER_LIGHT_FLOATS];
+            if (d[14] != 0.0f) continue;
+            f32 dx = fmaxf(fmaxf(box.min.x - d[0], d[0] - box.max.x), 0.0f);
+            f32 dy = fmaxf(fmaxf(box.min.y - d[1], d[1] - box.max.y), 0.0f);
+            f32 dz = fmaxf(fmaxf(box.min.z - d[2], d[2] - box.max.z), 0.0f);
+            if (dx * dx + dy * dy + dz * dz >= d[3] * d[3]) continue;
+            bool listed = false;
+            for (u32 k = 0; k < lights.count && !listed; k++) {
+                listed = ((lights.packed[k / 2] >> ((k & 1) * 16)) & 0xFFFF) == i;
+            }
+            if (!listed) {
+                st.misses++;
+                break;
+            }
+        }
+    }
+    free(boxes);
+    free(lists);
+    st.average = props ? (f32)refs / (f32)props : 0.0f;
+    return st;
+}
+
+static f64 time_builds(LightClusters* c, const LightEnvironment* env, const Mat4& view, const Mat4& proj, u32 iterations) {
+    f64 t0 = time_now();
+    for (u32 it = 0; it < iterations; it++) light_clusters_build(c, env, view, proj);
+    return (time_now() - t0) * 1000.0 / iterations;
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--iterations")) cfg.iterations = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--samples")) cfg.samples = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--threads")) cfg.threads = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--props")) cfg.props = (u32)atoi(argv[i + 1]);
+    }
+    if (cfg.iterations == 0) cfg.iterations = 1;
+
+    MemoryArena arena = {};
+    if (!arena_init(&arena, 32 * 1024 * 1024)) return 1;
+    LightEnvironment env = {};
+    LightClusters clusters = {};
+    if (!light_environment_init(&env, &arena) || !light_clusters_create(&clusters, &arena)) return 1;
+
+    Mat4 view = mat4_look_at(Vec3(0.0f, 1.7f, 2.0f), Vec3(0.0f, 1.2f, -20.0f), Vec3(0, 1, 0));
+    Mat4 proj = mat4_perspective(70.0f * 3.14159265f / 180.0f, 16.0f / 9.0f, 0.1f, 200.0f);
+
+    printf("light clusters: %ux%ux%u froxels, %u lights max each\n", CLUSTER_GRID_X, CLUSTER_GRID_Y, CLUSTER_GRID_Z,
+        CLUSTER_MAX_LIGHTS);
+    printf("%8s %10s %10s %10s %10s %8s %8s\n", "lights", "serial ms", "pool ms", "refs", "max/frox", "full", "misses");
+
+    const u32 counts[] = { 16, 64, 256, 1024, 4096 };
+    bool ok = true;
+    for (u32 count : counts) {
+        fill_lights(&env, count);
+        f64 serial = time_builds(&clusters, &env, view, proj, cfg.iterations);
+        jobs_init(cfg.threads);
+        f64 pooled = time_builds(&clusters, &env, view, proj, cfg.iterations);
+        jobs_shutdown();
+
+        u32 max_lights = 0;
+        for (u32 i = 0; i < CLUSTER_COUNT; i++) {
+            u32 n = clusters.grid[i] & 0xFF;
+            if (n > max_lights) max_lights = n;
+        }
+        u32 misses = count_misses(&clusters, view, cfg.samples);
+        ok = ok && misses == 0;
+        printf("%8u %10.3f %10.3f %10u %10u %8u %8u\n", clusters.light_count, serial, pooled, clusters.index_count,
+            max_lights, clusters.full_clusters, misses);
+    }
+
+    printf("\nobject lights: %u props, %u lights max each\n", cfg.props, OBJECT_MAX_LIGHTS);
+    printf("%8s %10s %12s %8s\n", "lights", "select ms", "lights/prop", "misses");
+    for (u32 count : counts) {
+        fill_lights(&env, count);
+        light_clusters_build(&clusters, &env, view, proj);
+        ObjectStats st = select_for_props(&clusters, cfg.props);
+        ok = ok && st.misses == 0;
+        printf("%8u %10.3f %12.2f %8u\n", clusters.light_count, st.ms, st.average, st.misses);
+    }
+
+    arena_shutdown(&arena);
+    return ok ? 0 : 1;
+}
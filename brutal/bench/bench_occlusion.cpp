@@ -0,0 +1,179 @@
+// =============================================================================
+// Brutal Engine - Occlusion Benchmark
+// A grid of walled rooms with props scattered through them, seen from inside
+// one room in four directions. Reports the occluders picked, rasterization
+// time serial and on the job pool, box test time and the props culled, and
+// checks culled props by casting rays from the eye to points on them: a ray
+// that reaches one past every brush is a false cull.
+// =============================================================================
+
+#include "brutal/core/jobs.h"
+#include "brutal/core/memory.h"
+#include "brutal/core/time.h"
+#include "brutal/renderer/occlusion.h"
+#include "brutal/world/scene.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace brutal;
+
+struct BenchConfig {
+    u32 rooms = 16;        // Per side
+    u32 props = 20000;
+    u32 iterations = 20;
+    u32 threads = 0;       // 0: hardware threads
+    u32 checks = 400;      // Culled props ray checked per view
+};
+
+static u32 g_rng = 5;
+static f32 rand01() {
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return (f32)(g_rng >> 8) * (1.0f / 16777216.0f);
+}
+
+constexpr f32 ROOM_SIZE = 10.0f;
+constexpr f32 ROOM_PITCH = 12.0f;
+constexpr f32 WALL = 0.3f;
+
+// Floor, three solid walls and one with a door in the middle of +Z
+static void add_room(Scene* s, f32 ox, f32 oz) {
+    Vec3 grey(0.5f, 0.5f, 0.5f);
+    f32 w = ROOM_SIZE, h = 3.0f;
+    scene_add_brush(s, Vec3(ox, -0.5f, oz), Vec3(ox + w, 0.0f, oz + w), BRUSH_SOLID, grey);
+    scene_add_brush(s, Vec3(ox, 0.0f, oz), Vec3(ox + w, h, oz + WALL), BRUSH_SOLID, grey);
+    scene_add_brush(s, Vec3(ox, 0.0f, oz), Vec3(ox + WALL, h, oz + w), BRUSH_SOLID, grey);
+    scene_add_brush(s, Vec3(ox + w - WALL, 0.0f, oz), Vec3(ox + w, h, oz + w), BRUSH_SOLID, grey);
+    f32 door_lo = ox + w * 0.5f - 0.75f, door_hi = ox + w * 0.5f + 0.75f;
+    scene_add_brush(s, Vec3(ox, 0.0f, oz + w - WALL), Vec3(door_lo, h, oz + w), BRUSH_SOLID, grey);
+    scene_add_brush(s, Vec3(door_hi, 0.0f, oz + w - WALL), Vec3(ox + w, h, oz + w), BRUSH_SOLID, grey);
+    scene_add_brush(s, Vec3(door_lo, 2.2f, oz + w - WALL), Vec3(door_hi, h, oz + w), BRUSH_SOLID, grey);
+}
+
+static void generate(Scene* s, AABB* props, const BenchConfig& cfg) {
+    for (u32 z = 0; z < cfg.rooms; z++) {
+        for (u32 x = 0; x < cfg.rooms; x++) add_room(s, (f32)x * ROOM_PITCH, (f32)z * ROOM_PITCH);
+    }
+    for (u32 i = 0; i < cfg.props; i++) {
+        u32 room = (u32)(rand01() * (f32)(cfg.rooms * cfg.rooms)) % (cfg.rooms * cfg.rooms);
+        f32 ox = (f32)(room % cfg.rooms) * ROOM_PITCH, oz = (f32)(room / cfg.rooms) * ROOM_PITCH;
+        Vec3 min(ox + 0.5f + rand01() * (ROOM_SIZE - 1.5f), 0.0f, oz + 0.5f + rand01() * (ROOM_SIZE - 1.5f));
+        props[i] = { min, min + Vec3(0.5f, 0.5f, 0.5f) };
+    }
+}
+
+// Slab test of the segment from a to a + d over t in [0, 1)
+static bool segment_hits(const Vec3& a, const Vec3& d, const Brush* b) {
+    const f32 o[3] = { a.x, a.y, a.z }, v[3] = { d.x, d.y, d.z };
+    const f32 lo[3] = { b->min.x, b->min.y, b->min.z }, hi[3] = { b->max.x, b->max.y, b->max.z };
+    f32 t0 = 0.0f, t1 = 0.999f;
+    for (u32 k = 0; k < 3; k++) {
+        if (fabsf(v[k]) < 1e-9f) {
+            if (o[k] < lo[k] || o[k] > hi[k]) return false;
+            continue;
+        }
+        f32 ta = (lo[k] - o[k]) / v[k], tb = (hi[k] - o[k]) / v[k];
+        if (ta > tb) { f32 t = ta; ta = tb; tb = t; }
+        t0 = fmaxf(t0, ta);
+        t1 = fminf(t1, tb);
+        if (t0 > t1) return false;
+    }
+    return true;
+}
+
+// A 3x3x3 lattice over the box; any point seen past every brush means the
+// box was visible
+static bool visible_by_rays(const Scene* s, const Vec3& eye, const AABB& box) {
+    for (u32 i = 0; i < 27; i++) {
+        f32 fx = (f32)(i % 3) * 0.5f, fy = (f32)((i / 3) % 3) * 0.5f, fz = (f32)(i / 9) * 0.5f;
+        Vec3 p(box.min.x + (box.max.x - box.min.x) * fx, box.min.y + (box.max.y - box.min.y) * fy,
+            box.min.z + (box.max.z - box.min.z) * fz);
+        Vec3 d = p - eye;
+        bool blocked = false;
+        for (u32 b = 0; b < s->brush_count && !blocked; b++) blocked = segment_hits(eye, d, &s->brushes[b]);
+        if (!blocked) return true;
+    }
+    return false;
+}
+
+static f64 time_build(OcclusionBuffer* o, const Mat4& view, const Mat4& proj, const Vec3& eye, const AABB* occluders,
+    u32 count, u32 iterations) {
+    f64 t0 = time_now();
+    for (u32 it = 0; it < iterations; it++) occlusion_build(o, view, proj, eye, occluders, count);
+    return (time_now() - t0) * 1000.0 / iterations;
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--rooms")) cfg.rooms = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--props")) cfg.props = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--iterations")) cfg.iterations = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--threads")) cfg.threads = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--checks")) cfg.checks = (u32)atoi(argv[i + 1]);
+    }
+    if (cfg.iterations == 0) cfg.iterations = 1;
+    if (cfg.rooms == 0) cfg.rooms = 1;
+
+    MemoryArena arena = {}, temp = {};
+    if (!arena_init(&arena, 64 * 1024 * 1024) || !arena_init(&temp, 16 * 1024 * 1024)) return 1;
+    Scene scene = {};
+    OcclusionBuffer occlusion = {};
+    AABB* props = arena_alloc_array<AABB>(&arena, cfg.props);
+    AABB* occluders = arena_alloc_array<AABB>(&arena, OCCLUSION_MAX_OCCLUDERS);
+    if (!scene_create(&scene, &arena) || !occlusion_create(&occlusion, &arena) || !props || !occluders) return 1;
+    if (!scene_reserve(&scene, &arena, cfg.rooms * cfg.rooms * 7, 0)) return 1;
+    generate(&scene, props, cfg);
+
+    // Standing in the middle room, facing each wall; +Z looks out of the door
+    u32 mid = cfg.rooms / 2;
+    Vec3 eye((f32)mid * ROOM_PITCH + ROOM_SIZE * 0.5f, 1.7f, (f32)mid * ROOM_PITCH + ROOM_SIZE * 0.5f);
+    Mat4 proj = mat4_perspective(70.0f * 3.14159265f / 180.0f, 16.0f / 9.0f, 0.1f, 200.0f);
+    const Vec3 dirs[4] = { Vec3(0, -0.1f, 1), Vec3(1, -0.1f, 0), Vec3(0, -0.1f, -1), Vec3(-1, -0.1f, 0) };
+    const char* names[4] = { "+Z door", "+X", "-Z", "-X" };
+
+    printf("occlusion: %ux%u depth, %u tiles, %u brushes, %u props\n", OCCLUSION_WIDTH, OCCLUSION_HEIGHT,
+        OCCLUSION_TILE_COUNT, scene.brush_count, cfg.props);
+    printf("%8s %6s %6s %9s %9s %9s %9s %8s %8s %6s\n", "view", "occl", "tris", "select", "serial", "pool", "test",
+        "culled", "checked", "false");
+
+    bool ok = true;
+    for (u32 v = 0; v < 4; v++) {
+        Mat4 view = mat4_look_at(eye, eye + dirs[v], Vec3(0, 1, 0));
+
+        arena_reset(&temp);
+        f64 t0 = time_now();
+        u32 count = scene_select_occluders(&scene, eye, mat4_multiply(proj, view), occluders, OCCLUSION_MAX_OCCLUDERS,
+            &temp);
+        f64 select_ms = (time_now() - t0) * 1000.0;
+
+        f64 serial = time_build(&occlusion, view, proj, eye, occluders, count, cfg.iterations);
+        jobs_init(cfg.threads);
+        f64 pooled = time_build(&occlusion, view, proj, eye, occluders, count, cfg.iterations);
+        jobs_shutdown();
+
+        t0 = time_now();
+        u32 culled = 0;
+        for (u32 i = 0; i < cfg.props; i++) culled += occlusion_test_box(&occlusion, props[i]) ? 0 : 1;
+        f64 test_ms = (time_now() - t0) * 1000.0;
+
+        // Ray check an even spread of the culled props
+        u32 checked = 0, false_culls = 0;
+        u32 stride = culled > cfg.checks && cfg.checks ? culled / cfg.checks : 1;
+        u32 seen = 0;
+        for (u32 i = 0; i < cfg.props && checked < cfg.checks; i++) {
+            if (occlusion_test_box(&occlusion, props[i])) continue;
+            if (seen++ % stride) continue;
+            checked++;
+            if (visible_by_rays(&scene, eye, props[i])) false_culls++;
+        }
+        ok = ok && false_culls == 0;
+        printf("%8s %6u %6u %9.3f %9.3f %9.3f %9.3f %8u %8u %6u\n", names[v], occlusion.stats.occluders,
+            occlusion.stats.triangles, select_ms, serial, pooled, test_ms, culled, checked, false_culls);
+    }
+
+    arena_shutdown(&temp);
+    arena_shutdown(&arena);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+// =============================================================================
+// Brutal Engine - Prop Storage Benchmark
+// World matrix pass over props: array-of-structs with an active check per prop
+// versus the packed active prefix of the SoA columns
+// =============================================================================
+
+#include "brutal/core/memory.h"
+#include "brutal/core/time.h"
+#include "brutal/world/entity.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace brutal;
+
+struct BenchConfig {
+    u32 props = 100000;
+    u32 iterations = 20;
+    u32 inactive_every = 11;
+};
+
+// The layout props had before the column storage
+struct LegacyProp {
+    Transform transform;
+    u32 mesh_id;
+    Vec3 color;
+    bool active;
+};
+
+static u32 g_rng = 7;
+static f32 rand01() {
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return (f32)(g_rng >> 8) * (1.0f / 16777216.0f);
+}
+
+static bool matrices_equal(const Mat4& a, const Mat4& b) {
+    for (int i = 0; i < 16; i++) {
+        if (a.m[i] != b.m[i]) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--props")) cfg.props = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--iterations")) cfg.iterations = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--inactive-every")) cfg.inactive_every = (u32)atoi(argv[i + 1]);
+    }
+    if (cfg.iterations == 0) cfg.iterations = 1;
+
+    MemoryArena arena = {};
+    if (!arena_init(&arena, (size_t)cfg.props * 256 + 1024 * 1024)) return 1;
+    PropStorage props = {};
+    if (!prop_storage_reserve(&props, &arena, cfg.props)) return 1;
+
+    std::vector<LegacyProp> legacy(cfg.props);
+    std::vector<PropHandle> handles(cfg.props);
+    for (u32 i = 0; i < cfg.props; i++) {
+        LegacyProp& p = legacy[i];
+        p.transform.position = Vec3(rand01() * 500.0f, rand01() * 3.0f, rand01() * 500.0f);
+        p.transform.rotation = quat_from_euler_radians(Vec3(0, rand01() * 6.2831853f, 0));
+        p.transform.scale = Vec3(0.2f + rand01(), 0.2f + rand01(), 0.2f + rand01());
+        p.mesh_id = MESH_CUBE;
+        p.color = Vec3(rand01(), rand01(), rand01());
+        p.active = cfg.inactive_every == 0 || (i % cfg.inactive_every) != 0;
+        u32 index = prop_storage_add(&props, p.transform, p.mesh_id, p.color, p.active);
+        handles[i] = handle_table_handle<Prop>(&props.handles, index);
+    }
+
+    std::vector<Mat4> legacy_out(cfg.props), soa_out(cfg.props);
+    f64 best_legacy = 0.0, best_soa = 0.0;
+    u32 legacy_count = 0;
+    for (u32 it = 0; it < cfg.iterations; it++) {
+        f64 t0 = time_now();
+        legacy_count = 0;
+        for (u32 i = 0; i < cfg.props; i++) {
+            if (!legacy[i].active) continue;
+            legacy_out[legacy_count++] = transform_to_matrix(&legacy[i].transform);
+        }
+        f64 legacy_ms = (time_now() - t0) * 1000.0;
+
+        t0 = time_now();
+        PropView view = prop_storage_query(&props, PROP_COLUMN_POSITION | PROP_COLUMN_ROTATION | PROP_COLUMN_SCALE);
+        prop_storage_world_matrices(&props, 0, view.count, soa_out.data());
+        f64 soa_ms = (time_now() - t0) * 1000.0;
+
+        if (it == 0 || legacy_ms < best_legacy) best_legacy = legacy_ms;
+        if (it == 0 || soa_ms < best_soa) best_soa = soa_ms;
+    }
+
+    // Packing reorders props, so match them up through their handles
+    bool identical = legacy_count == props.active_count;
+    for (u32 i = 0, j = 0; identical && i < cfg.props; i++) {
+        if (!legacy[i].active) continue;
+        u32 index = handle_table_find(&props.handles, handles[i]);
+        identical = index < props.active_count && matrices_equal(legacy_out[j++], soa_out[index]);
+    }
+
+    printf("props: %u (%u active), best of %u passes\n", cfg.props, props.active_count, cfg.iterations);
+    printf("%14s %14s %10s %10s\n", "aos ms", "soa ms", "speedup", "identical");
+    printf("%14.3f %14.3f %9.2fx %10s\n", best_legacy, best_soa, best_soa > 0.0 ? best_legacy / best_soa : 0.0,
+        identical ? "yes" : "NO");
+
+    arena_shutdown(&arena);
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+// =============================================================================
+// Brutal Engine - Scene Hot Reload Benchmark
+// Edits a saved scene on disk and compares a full reload (parse, world
+// geometry, collision rebuild) against the watched diff-based reload
+// =============================================================================
+
+#include "brutal/core/memory.h"
+#include "brutal/core/time.h"
+#include "brutal/world/scene.h"
+#include "brutal/world/scene_io.h"
+#include "brutal/world/scene_reload.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace brutal;
+
+struct BenchConfig {
+    u32 rooms = 400;
+    u32 edits = 50;
+    const char* path = "bench_reload.scene.json";
+};
+
+// Walled rooms on a grid: neighbouring blocks merge into long collision boxes.
+static bool generate_scene(Scene* s, u32 rooms) {
+    u32 side = 1;
+    while (side * side < rooms) side++;
+    for (u32 r = 0; r < rooms; r++) {
+        f32 ox = (f32)(r % side) * 12.0f, oz = (f32)(r / side) * 12.0f;
+        if (!scene_add_brush(s, Vec3(ox, -0.5f, oz), Vec3(ox + 10.0f, 0.0f, oz + 10.0f), BRUSH_SOLID,
+            Vec3(0.4f, 0.4f, 0.4f))) {
+            return false;
+        }
+        for (u32 i = 0; i < 40; i++) {
+            u32 side_index = i / 10, along = i % 10;
+            f32 x = side_index < 2 ? ox + (f32)along : (side_index == 2 ? ox : ox + 9.0f);
+            f32 z = side_index < 2 ? (side_index == 0 ? oz : oz + 9.0f) : oz + (f32)along;
+            scene_add_brush(s, Vec3(x, 0.0f, z), Vec3(x + 1.0f, 3.0f, z + 1.0f), BRUSH_SOLID, Vec3(0.6f, 0.5f, 0.4f));
+        }
+        Transform t = transform_default();
+        t.position = Vec3(ox + 5.0f, 0.5f, oz + 5.0f);
+        scene_add_prop(s, t, MESH_CUBE, Vec3(0.7f, 0.2f, 0.2f));
+        light_environment_add_point(&s->lights, Vec3(ox + 5.0f, 2.5f, oz + 5.0f), Vec3(1, 0.9f, 0.7f), 8.0f, 1.0f);
+    }
+    return true;
+}
+
+// A level designer's pass: blocks knocked out of walls, a few recolored,
+// some furniture moved, a light retuned and a new room corner at the end.
+static void edit_scene(Scene* s, u32 edits) {
+    for (u32 e = 0; e < edits; e++) {
+        u32 i = 1 + (e * 7919u) % (s->brush_count - 1);
+        if (e % 2) s->brushes[i].faces[3].color = Vec3(0.9f, 0.1f, 0.1f);
+        else s->brushes[i].max.y = 1.0f;
+    }
+    for (u32 e = 0; e < edits / 5 && e < s->props.count; e++) s->props.positions[e].x += 1.0f;
+    if (s->lights.point_light_count) s->lights.point_lights[0].intensity = 2.0f;
+    for (u32 e = 0; e < 10; e++) scene_remove_brush(s, scene_brush_handle(s, s->brush_count - 1));
+    for (u32 e = 0; e < 5; e++) {
+        Vec3 min(-4.0f - (f32)e, 0.0f, -4.0f);
+        scene_add_brush(s, min, min + Vec3(1, 2, 1), BRUSH_SOLID, Vec3(0.3f, 0.3f, 0.3f));
+    }
+}
+
+static bool brushes_match(const Scene* a, const Scene* b) {
+    if (a->brush_count != b->brush_count) return false;
+    for (u32 i = 0; i < a->brush_count; i++) {
+        if (memcmp(&a->brushes[i], &b->brushes[i], sizeof(Brush))) return false;
+    }
+    return true;
+}
+
+static bool props_match(const PropStorage* a, const PropStorage* b) {
+    if (a->count != b->count || a->active_count != b->active_count) return false;
+    return !memcmp(a->positions, b->positions, sizeof(Vec3) * a->count) &&
+        !memcmp(a->rotations, b->rotations, sizeof(Quat) * a->count) &&
+        !memcmp(a->scales, b->scales, sizeof(Vec3) * a->count) &&
+        !memcmp(a->colors, b->colors, sizeof(Vec3) * a->count) &&
+        !memcmp(a->mesh_ids, b->mesh_ids, sizeof(u32) * a->count);
+}
+
+// The patched collision must cover exactly the space a full rebuild covers.
+static u32 collision_mismatches(const CollisionWorld* a, const CollisionWorld* b, f32 extent) {
+    u32 mismatches = 0;
+    for (u32 z = 0; z < 200; z++) {
+        for (u32 x = 0; x < 200; x++) {
+            Vec3 p(-6.0f + (f32)x * (extent + 6.0f) / 200.0f, 0.5f + (f32)((x + z) % 5) * 0.5f,
+                -6.0f + (f32)z * (extent + 6.0f) / 200.0f);
+            AABB probe = aabb_from_center_size(p, Vec3(0.3f, 0.3f, 0.3f));
+            if (collision_overlaps_any(a, probe) != collision_overlaps_any(b, probe)) mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--rooms")) cfg.rooms = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--edits")) cfg.edits = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--path")) cfg.path = argv[i + 1];
+    }
+    if (cfg.rooms == 0) cfg.rooms = 1;
+
+    size_t brushes = (size_t)cfg.rooms * 41 + 64;
+    MemoryArena arena = {};
+    MemoryArena temp = {};
+    if (!arena_init(&arena, brushes * 1024 + 64 * 1024 * 1024) || !arena_init(&temp, brushes * 2048 + 64 * 1024 * 1024)) {
+        return 1;
+    }
+
+    // Original file, and the live scene loaded from it
+    Scene source = {};
+    if (!scene_create(&source, &arena) || !generate_scene(&source, cfg.rooms)) return 1;
+    SceneSpawn spawn = { Vec3(5.0f, 1.7f, 5.0f), 0.0f, 0.0f };
+    if (!scene_save_to_json(&source, &spawn, cfg.path)) return 1;
+
+    Scene live = {};
+    if (!scene_create(&live, &arena) || !scene_load_from_json(&live, &spawn, cfg.path, &arena)) return 1;
+    live.merge_collision = true;
+    scene_rebuild_collision(&live);
+    SceneReloader reloader = {};
+    if (!scene_reloader_open(&reloader, cfg.path, &live)) return 1;
+
+    // The edit lands on disk
+    edit_scene(&source, cfg.edits);
+    if (!scene_save_to_json(&source, &spawn, cfg.path)) return 1;
+
+    // Full path: parse into a fresh scene and rebuild everything derived
+    Scene full = {};
+    if (!scene_create(&full, &arena)) return 1;
+    full.merge_collision = true;
+    f64 t0 = time_now();
+    if (!scene_load_from_json(&full, &spawn, cfg.path, &arena)) return 1;
+    f64 t1 = time_now();
+    Vertex* verts; u32* indices; u32 vc, ic;
+    if (!scene_build_world_geometry(&full, &temp, &verts, &vc, &indices, &ic)) return 1;
+    f64 t2 = time_now();
+    scene_rebuild_collision(&full);
+    f64 t3 = time_now();
+    arena_reset(&temp);
+
+    // Diff path
+    bool noticed = scene_reloader_poll(&reloader);
+    SceneDiffStats diff = {};
+    f64 t4 = time_now();
+    if (!scene_reload(&reloader, &live, &spawn, &temp, &diff)) return 1;
+    f64 t5 = time_now();
+
+    f32 extent = 12.0f * (f32)(u32)(sqrtf((f32)cfg.rooms) + 1.0f);
+    bool same_brushes = brushes_match(&live, &full);
+    bool same_props = props_match(&live.props, &full.props);
+    bool same_lights = live.lights.point_light_count == full.lights.point_light_count &&
+        live.lights.point_lights[0].intensity == full.lights.point_lights[0].intensity;
+    u32 mismatches = collision_mismatches(&live.collision, &full.collision, extent);
+
+    printf("reload: %u brushes, %u edits, watch %s\n", full.brush_count, scene_diff_total(diff),
+        noticed ? "noticed the save" : "MISSED the save");
+    printf("%-30s %10.2f\n", "full: parse ms", (t1 - t0) * 1000.0);
+    printf("%-30s %10.2f\n", "full: world geometry ms", (t2 - t1) * 1000.0);
+    printf("%-30s %10.2f\n", "full: collision ms", (t3 - t2) * 1000.0);
+    printf("%-30s %10.2f\n", "full: total ms", (t3 - t0) * 1000.0);
+    printf("%-30s %10.2f\n", "diff: parse + apply ms", (t5 - t4) * 1000.0);
+    printf("%-30s %10u\n", "diff: brushes touched", diff.brushes_changed + diff.brushes_added + diff.brushes_removed);
+    printf("%-30s %10u / %u\n", "collision boxes (diff/full)", live.collision.box_count, full.collision.box_count);
+    printf("%-30s %10s\n", "scene matches", same_brushes && same_props && same_lights ? "yes" : "NO");
+    printf("%-30s %10s\n", "collision matches", mismatches ? "NO" : "yes");
+
+    scene_reloader_close(&reloader);
+    remove(cfg.path);
+    arena_shutdown(&temp);
+    arena_shutdown(&arena);
+    return noticed && same_brushes && same_props && same_lights && !mismatches ? 0 : 1;
+}
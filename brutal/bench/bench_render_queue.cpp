@@ -0,0 +1,132 @@
+// =============================================================================
+// Brutal Engine - Render Queue Benchmark
+// Sort cost of a frame's draw commands and the state changes left when they
+// run in key order instead of submission order
+// =============================================================================
+
+#include "brutal/core/memory.h"
+#include "brutal/core/time.h"
+#include "brutal/renderer/mesh.h"
+#include "brutal/renderer/render_queue.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace brutal;
+
+struct BenchConfig {
+    u32 draws = 10000;
+    u32 meshes = 8;
+    u32 outlines = 16;
+    u32 iterations = 100;
+};
+
+static u32 g_rng = 7;
+static f32 rand01() {
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return (f32)(g_rng >> 8) * (1.0f / 16777216.0f);
+}
+
+struct StateChanges {
+    u32 programs, meshes, draws;
+};
+
+// Program and mesh switches a run over the items costs, and the draw calls
+// left once opaque runs of one mesh are instanced as renderer_flush does
+static StateChanges count_changes(const RenderQueue* q, const RenderSortItem* items) {
+    StateChanges c = {};
+    u32 program = ~0u;
+    const Mesh* mesh = nullptr;
+    for (u32 i = 0; i < q->count; i++) {
+        const RenderCommand& cmd = q->commands[items[i].command];
+        u32 p = render_key_program(items[i].key);
+        if (p != program) c.programs++;
+        if (cmd.mesh != mesh) c.meshes++;
+        bool batched = i > 0 && render_key_pass(items[i].key) == RENDER_PASS_OPAQUE &&
+            render_key_pass(items[i - 1].key) == RENDER_PASS_OPAQUE && p == program && cmd.mesh == mesh;
+        if (!batched) c.draws++;
+        program = p;
+        mesh = cmd.mesh;
+    }
+    return c;
+}
+
+// Keys ascend, and within a mesh the camera distance never decreases by more
+// than the depth field drops (the low 8 mantissa bits)
+static bool sorted_front_to_back(const RenderQueue* q, const Vec3& cam) {
+    for (u32 i = 1; i < q->count; i++) {
+        const RenderSortItem& a = q->items[i - 1];
+        const RenderSortItem& b = q->items[i];
+        if (a.key > b.key) return false;
+        const RenderCommand& ca = q->commands[a.command];
+        const RenderCommand& cb = q->commands[b.command];
+        if (ca.mesh != cb.mesh || render_key_pass(a.key) != render_key_pass(b.key)) continue;
+        f32 da = vec3_length(Vec3(ca.model.m[12], ca.model.m[13], ca.model.m[14]) - cam);
+        f32 db = vec3_length(Vec3(cb.model.m[12], cb.model.m[13], cb.model.m[14]) - cam);
+        if (da > db * (1.0f + 1.0f / 16384.0f)) return false;
+    }
+    return true;
+}
+
+static void fill(RenderQueue* q, const BenchConfig& cfg, const Mesh* meshes, const Vec3& cam) {
+    render_queue_clear(q);
+    g_rng = 7;
+    for (u32 i = 0; i < cfg.draws + cfg.outlines; i++) {
+        bool outline = i >= cfg.draws;
+        const Mesh* m = &meshes[(u32)(rand01() * cfg.meshes) % cfg.meshes];
+        Vec3 pos(rand01() * 200.0f - 100.0f, rand01() * 10.0f, rand01() * 200.0f - 100.0f);
+        u64 key = render_sort_key(outline ? RENDER_PASS_OUTLINE : RENDER_PASS_OPAQUE,
+            outline ? RENDER_PROGRAM_FLAT : RENDER_PROGRAM_LIT, m->vao, vec3_length(pos - cam));
+        RenderCommand* c = render_queue_push(q, key);
+        c->model = mat4_translation(pos);
+        c->color = Vec3(rand01(), rand01(), rand01());
+        c->mesh = m;
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--draws")) cfg.draws = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--meshes")) cfg.meshes = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--outlines")) cfg.outlines = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--iterations")) cfg.iterations = (u32)atoi(argv[i + 1]);
+    }
+    if (cfg.meshes == 0) cfg.meshes = 1;
+    if (cfg.iterations == 0) cfg.iterations = 1;
+
+    MemoryArena arena = {};
+    u32 capacity = cfg.draws + cfg.outlines;
+    if (!arena_init(&arena, (size_t)capacity * 160 + 1024 * 1024)) return 1;
+    RenderQueue queue = {};
+    if (!render_queue_create(&queue, &arena, capacity)) return 1;
+    Mesh* meshes = arena_alloc_array<Mesh>(&arena, cfg.meshes);
+    for (u32 i = 0; i < cfg.meshes; i++) {
+        meshes[i] = {};
+        meshes[i].vao = i + 1;
+    }
+    Vec3 cam(0.0f, 1.7f, 0.0f);
+
+    fill(&queue, cfg, meshes, cam);
+    StateChanges unsorted = count_changes(&queue, queue.items);
+
+    f64 sort_total = 0.0;
+    for (u32 it = 0; it < cfg.iterations; it++) {
+        fill(&queue, cfg, meshes, cam);
+        f64 t0 = time_now();
+        render_queue_sort(&queue);
+        sort_total += time_now() - t0;
+    }
+    StateChanges sorted = count_changes(&queue, queue.items);
+    bool ordered = sorted_front_to_back(&queue, cam);
+
+    printf("render queue: %u draws, %u meshes, %u outlines\n", cfg.draws, cfg.meshes, cfg.outlines);
+    printf("%-30s %10.3f\n", "sort ms", sort_total * 1000.0 / cfg.iterations);
+    printf("%-30s %10u -> %u\n", "program changes", unsorted.programs, sorted.programs);
+    printf("%-30s %10u -> %u\n", "mesh (VAO) changes", unsorted.meshes, sorted.meshes);
+    printf("%-30s %10u -> %u\n", "draw calls (instanced)", unsorted.draws, sorted.draws);
+    printf("%-30s %10s\n", "front to back per mesh", ordered ? "yes" : "NO");
+
+    arena_shutdown(&arena);
+    return ordered ? 0 : 1;
+}
@@ -0,0 +1,216 @@
+// =============================================================================
+// Brutal Engine - Renderer Submission Benchmark
+// CPU cost of the renderer on the null backend: a playground-like frame of
+// the scene plus synthetic props on several meshes, outlines and the grid,
+// recorded and flushed with everything but the GL calls. Reports the time to
+// record and to flush and what the frame would have submitted, checks the
+// counts repeat frame to frame, and fails past --budget-ms per frame.
+// =============================================================================
+
+#include "brutal/core/memory.h"
+#include "brutal/core/time.h"
+#include "brutal/renderer/camera.h"
+#include "brutal/renderer/render_backend.h"
+#include "brutal/renderer/renderer.h"
+#include "brutal/world/entity.h"
+#include "brutal/world/scene.h"
+#include "brutal/world/scene_io.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace brutal;
+
+// Set by the build so the default scene loads from any working directory
+#ifndef BRUTAL_SOURCE_DIR
+#define BRUTAL_SOURCE_DIR "."
+#endif
+
+struct BenchConfig {
+    const char* scene = BRUTAL_SOURCE_DIR "/playground/data/gothic_house.scene.json";
+    u32 props = 8000;         // Synthetic props on top of the scene's
+    u32 meshes = 8;           // Meshes the synthetic props are spread over
+    u32 outlines = 16;
+    u32 iterations = 200;
+    f64 budget_ms = 0.0;      // 0: no budget
+};
+
+struct SyntheticProps {
+    Mesh* meshes;
+    u32 mesh_count;
+    Mat4* models;
+    Vec3* colors;
+    u32 count;
+};
+
+static u32 g_rng = 7;
+static f32 rand01() {
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return (f32)(g_rng >> 8) * (1.0f / 16777216.0f);
+}
+
+// What the renderer counted for one frame
+struct SubmitCounts {
+    u64 vertex_bytes, upload_bytes;
+    u32 draw_calls, triangles, vertices;
+    u32 program_binds, vao_binds, uniform_uploads, light_uploads;
+    u32 object_light_draws;
+    u32 occlusion_culled;
+};
+
+static SubmitCounts read_counts(const RendererState* r) {
+    SubmitCounts c = {};
+    c.draw_calls = renderer_draw_calls(r);
+    c.triangles = renderer_triangles(r);
+    c.vertices = renderer_vertices(r);
+    c.vertex_bytes = renderer_vertex_bytes(r);
+    c.upload_bytes = renderer_upload_bytes(r);
+    c.program_binds = renderer_program_binds(r);
+    c.vao_binds = renderer_vao_binds(r);
+    c.uniform_uploads = renderer_uniform_uploads(r);
+    c.light_uploads = renderer_light_uploads(r);
+    c.object_light_draws = renderer_object_light_draws(r);
+    c.occlusion_culled = renderer_occlusion_stats(r)->culled;
+    return c;
+}
+
+// Records the frame the playground would and returns the time spent
+// recording; the flush time goes to *flush_ms
+static f64 render_frame(RendererState* r, Scene* scene, const SyntheticProps* synth, const Camera* camera,
+    const BenchConfig& cfg, MemoryArena* temp, f64* flush_ms) {
+    arena_reset(temp);
+    f64 t0 = time_now();
+    renderer_begin_frame(r, 1280, 720);
+    renderer_set_lights(r, &scene->lights);
+    renderer_set_camera(r, camera);
+    AABB* occluders = arena_alloc_array<AABB>(temp, OCCLUSION_MAX_OCCLUDERS);
+    if (occluders) {
+        u32 count = scene_select_occluders(scene, camera->position, renderer_get_view_projection(r), occluders,
+            OCCLUSION_MAX_OCCLUDERS, temp);
+        renderer_build_occlusion(r, occluders, count);
+    }
+    renderer_draw_grid(r);
+    if (scene->world_mesh.vao) renderer_draw_mesh(r, &scene->world_mesh, Mat4::identity(), Vec3(1, 1, 1));
+    PropView props = prop_storage_query(&scene->props, PROP_COLUMN_COLOR);
+    Mat4* models = arena_alloc_array<Mat4>(temp, props.count);
+    if (models) {
+        prop_storage_world_matrices(&scene->props, 0, props.count, models);
+        for (u32 i = 0; i < props.count; i++) {
+            renderer_draw_mesh(r, renderer_get_cube_mesh(r), models[i], props.colors[i]);
+        }
+    }
+    for (u32 i = 0; i < synth->count; i++) {
+        renderer_draw_mesh(r, &synth->meshes[i % synth->mesh_count], synth->models[i], synth->colors[i]);
+    }
+    u32 outlines = cfg.outlines < synth->count ? cfg.outlines : synth->count;
+    for (u32 i = 0; i < outlines; i++) {
+        renderer_draw_mesh_outline(r, &synth->meshes[i % synth->mesh_count], synth->models[i], Vec3(1.0f, 0.6f, 0.1f),
+            1.05f);
+    }
+    f64 t1 = time_now();
+    renderer_flush(r);
+    renderer_end_frame();
+    *flush_ms = (time_now() - t1) * 1000.0;
+    return (t1 - t0) * 1000.0;
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--scene")) cfg.scene = argv[i + 1];
+        else if (!strcmp(argv[i], "--props")) cfg.props = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--meshes")) cfg.meshes = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--outlines")) cfg.outlines = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--iterations")) cfg.iterations = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--budget-ms")) cfg.budget_ms = atof(argv[i + 1]);
+    }
+    if (cfg.iterations == 0) cfg.iterations = 1;
+    if (cfg.meshes == 0) cfg.meshes = 1;
+
+    render_backend_select(RENDER_BACKEND_NULL);
+    MemoryArena arena = {}, temp = {};
+    if (!arena_init(&arena, 128 * 1024 * 1024) || !arena_init(&temp, 32 * 1024 * 1024)) return 1;
+    Scene scene = {};
+    SceneSpawn spawn = { Vec3(0.0f, 1.7f, 8.0f), 3.14159f, 0.0f };
+    // A missing file loads as an empty scene, which would time nothing
+    FILE* probe = fopen(cfg.scene, "rb");
+    if (probe) fclose(probe);
+    if (!probe || !scene_create(&scene, &arena) || !scene_load_from_json(&scene, &spawn, cfg.scene, &arena) ||
+        scene.brush_count == 0) {
+        fprintf(stderr, "failed to load %s\n", cfg.scene);
+        return 1;
+    }
+    scene.cull_hidden_faces = true;
+    scene_rebuild_world_mesh(&scene, &temp);
+
+    RendererState renderer = {};
+    if (!renderer_init(&renderer, &arena)) return 1;
+
+    // Small props scattered around the spawn, a few metres up to a metre across
+    SyntheticProps synth = {};
+    synth.mesh_count = cfg.meshes;
+    synth.count = cfg.props;
+    synth.meshes = arena_alloc_array<Mesh>(&arena, synth.mesh_count);
+    synth.models = arena_alloc_array<Mat4>(&arena, synth.count ? synth.count : 1);
+    synth.colors = arena_alloc_array<Vec3>(&arena, synth.count ? synth.count : 1);
+    if (!synth.meshes || !synth.models || !synth.colors) return 1;
+    for (u32 i = 0; i < synth.mesh_count; i++) synth.meshes[i] = mesh_create_cube();
+    for (u32 i = 0; i < synth.count; i++) {
+        Transform t = transform_default();
+        t.position = spawn.position + Vec3(rand01() * 80.0f - 40.0f, rand01() * 3.0f - 1.2f, rand01() * 80.0f - 40.0f);
+        t.rotation = quat_from_euler_radians(Vec3(0, rand01() * 6.2831853f, 0));
+        t.scale = Vec3(0.2f + rand01() * 0.8f, 0.2f + rand01() * 0.8f, 0.2f + rand01() * 0.8f);
+        synth.models[i] = transform_to_matrix(&t);
+        synth.colors[i] = Vec3(rand01(), rand01(), rand01());
+    }
+
+    printf("renderer submit (%s backend): %s, %u scene props, %u synthetic props on %u meshes, %u outlines\n",
+        render_backend_name(render_backend()), cfg.scene, scene.props.count, synth.count, synth.mesh_count,
+        cfg.outlines);
+    printf("%6s %9s %9s %9s %6s %9s %7s %6s %6s %8s %10s %7s\n", "yaw", "record", "flush", "frame", "draws", "tris",
+        "culled", "progs", "vaos", "uniforms", "upload KB", "stable");
+
+    bool ok = true;
+    f64 worst = 0.0;
+    for (u32 v = 0; v < 4; v++) {
+        Camera camera;
+        camera_init(&camera);
+        camera.position = spawn.position;
+        camera.yaw = spawn.yaw + (f32)v * 1.5707963f;
+        camera.pitch = spawn.pitch;
+
+        // The first frame of a view may upload the Lights block the later
+        // ones find unchanged, so it only warms up
+        f64 record = 0.0, flush = 0.0;
+        render_frame(&renderer, &scene, &synth, &camera, cfg, &temp, &flush);
+        flush = 0.0;
+        SubmitCounts first = {};
+        bool stable = true;
+        for (u32 it = 0; it < cfg.iterations; it++) {
+            f64 flush_ms = 0.0;
+            record += render_frame(&renderer, &scene, &synth, &camera, cfg, &temp, &flush_ms);
+            flush += flush_ms;
+            SubmitCounts counts = read_counts(&renderer);
+            if (it == 0) first = counts;
+            else if (memcmp(&first, &counts, sizeof(counts))) stable = false;
+        }
+        record /= cfg.iterations;
+        flush /= cfg.iterations;
+        f64 frame = record + flush;
+        if (frame > worst) worst = frame;
+        ok = ok && stable;
+        printf("%6.2f %9.3f %9.3f %9.3f %6u %9u %7u %6u %6u %8u %10.1f %7s\n", camera.yaw, record, flush, frame,
+            first.draw_calls, first.triangles, first.occlusion_culled, first.program_binds, first.vao_binds,
+            first.uniform_uploads, first.upload_bytes / 1024.0, stable ? "yes" : "NO");
+    }
+    if (cfg.budget_ms > 0.0 && worst > cfg.budget_ms) {
+        printf("over budget: %.3f ms per frame > %.3f ms\n", worst, cfg.budget_ms);
+        ok = false;
+    }
+
+    for (u32 i = 0; i < synth.mesh_count; i++) mesh_destroy(&synth.meshes[i]);
+    renderer_shutdown(&renderer);
+    arena_shutdown(&temp);
+    arena_shutdown(&arena);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+// =============================================================================
+// Brutal Engine - Scene I/O Benchmark
+// JSON save/load and baked .bscene load times for generated scenes with many
+// entities, against rebuilding mesh and collision from brushes
+// =============================================================================
+
+#include "brutal/core/memory.h"
+#include "brutal/core/time.h"
+#include "brutal/world/scene.h"
+#include "brutal/world/scene_io.h"
+#include "brutal/world/scene_binary.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace brutal;
+
+struct BenchConfig {
+    u32 entities = 100000;
+    u32 iterations = 5;
+    const char* path = "bench_scene.scene.json";
+    const char* baked_path = "bench_scene.bscene";
+};
+
+static u32 g_rng = 7;
+static f32 rand01() {
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return (f32)(g_rng >> 8) * (1.0f / 16777216.0f);
+}
+
+static Vec3 rand_color() { return Vec3(rand01(), rand01(), rand01()); }
+
+// 70% brushes, 30% props, plus a light per thousand entities.
+static bool generate_scene(Scene* s, MemoryArena* arena, u32 entities) {
+    u32 brushes = entities * 7 / 10;
+    u32 props = entities - brushes;
+    if (!scene_reserve(s, arena, brushes, props)) return false;
+
+    u32 side = 1;
+    while (side * side < brushes) side++;
+    for (u32 i = 0; i < brushes; i++) {
+        f32 x = (f32)(i % side) * 2.0f, z = (f32)(i / side) * 2.0f;
+        Vec3 min(x, 0.0f, z);
+        Vec3 max(x + 0.5f + rand01() * 1.5f, 0.2f + rand01() * 4.0f, z + 0.5f + rand01() * 1.5f);
+        u32 flags = (i % 13 == 0) ? BRUSH_INVISIBLE : BRUSH_SOLID;
+        Brush* b = scene_add_brush(s, min, max, flags, rand_color());
+        if (i % 7 == 0) {
+            for (int f = 0; f < 6; f++) b->faces[f].color = rand_color();
+        }
+    }
+    for (u32 i = 0; i < props; i++) {
+        Transform t;
+        t.position = Vec3(rand01() * 500.0f, rand01() * 3.0f, rand01() * 500.0f);
+        t.scale = Vec3(0.2f + rand01(), 0.2f + rand01(), 0.2f + rand01());
+        Vec3 color = rand_color();
+        t.rotation = quat_from_euler_radians(Vec3(0, rand01() * 6.2831853f, 0));
+        scene_add_prop(s, t, MESH_CUBE, color, (i % 11) != 0);
+    }
+    for (u32 i = 0; i < entities / 1000 + 16; i++) {
+        light_environment_add_point(&s->lights, Vec3(rand01() * 100.0f, 3.0f, rand01() * 100.0f),
+            rand_color(), 5.0f + rand01() * 10.0f, 0.5f + rand01());
+    }
+    for (u32 i = 0; i < entities / 1000 + 8; i++) {
+        light_environment_add_spot(&s->lights, Vec3(rand01() * 100.0f, 4.0f, rand01() * 100.0f),
+            Vec3(0, -1, 0), rand_color(), 12.0f, 0.95f, 0.85f, 1.5f, 1.0f);
+    }
+    return true;
+}
+
+static bool vec3_equal(const Vec3& a, const Vec3& b) { return a.x == b.x && a.y == b.y && a.z == b.z; }
+
+static bool scenes_match(const Scene* a, const Scene* b) {
+    if (a->brush_count != b->brush_count || a->props.count != b->props.count ||
+        a->props.active_count != b->props.active_count ||
+        a->lights.point_light_count != b->lights.point_light_count ||
+        a->lights.spot_light_count != b->lights.spot_light_count) {
+        return false;
+    }
+    for (u32 i = 0; i < a->brush_count; i++) {
+        const Brush& x = a->brushes[i];
+        const Brush& y = b->brushes[i];
+        if (!vec3_equal(x.min, y.min) || !vec3_equal(x.max, y.max) || x.flags != y.flags) return false;
+        for (int f = 0; f < 6; f++) {
+            if (!vec3_equal(x.faces[f].color, y.faces[f].color)) return false;
+        }
+    }
+    const PropStorage& pa = a->props;
+    const PropStorage& pb = b->props;
+    for (u32 i = 0; i < pa.count; i++) {
+        const Quat& qx = pa.rotations[i];
+        const Quat& qy = pb.rotations[i];
+        if (!vec3_equal(pa.positions[i], pb.positions[i]) || !vec3_equal(pa.scales[i], pb.scales[i]) ||
+            !vec3_equal(pa.colors[i], pb.colors[i]) ||
+            qx.x != qy.x || qx.y != qy.y || qx.z != qy.z || qx.w != qy.w || pa.mesh_ids[i] != pb.mesh_ids[i]) {
+            return false;
+        }
+    }
+    for (u32 i = 0; i < a->lights.point_light_count; i++) {
+        const PointLight& x = a->lights.point_lights[i];
+        const PointLight& y = b->lights.point_lights[i];
+        if (!vec3_equal(x.position, y.position) || !vec3_equal(x.color, y.color) ||
+            x.radius != y.radius || x.intensity != y.intensity) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static long file_size(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return 0;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    return size;
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--entities")) cfg.entities = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--iterations")) cfg.iterations = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--path")) cfg.path = argv[i + 1];
+        else if (!strcmp(argv[i], "--baked-path")) cfg.baked_path = argv[i + 1];
+    }
+    if (cfg.iterations == 0) cfg.iterations = 1;
+
+    MemoryArena source_arena = {};
+    MemoryArena load_arena = {};
+    // Room for the world mesh of every brush (24 verts + 36 indices each)
+    size_t arena_size = (size_t)cfg.entities * 2048 + 16 * 1024 * 1024;
+    if (!arena_init(&source_arena, arena_size) || !arena_init(&load_arena, arena_size)) return 1;
+
+    Scene source = {};
+    if (!scene_create(&source, &source_arena) || !generate_scene(&source, &source_arena, cfg.entities)) return 1;
+    SceneSpawn spawn = { Vec3(1.0f, 1.7f, 2.0f), 0.5f, -0.1f };
+
+    f64 t0 = time_now();
+    if (!scene_save_to_json(&source, &spawn, cfg.path)) return 1;
+    f64 save_ms = (time_now() - t0) * 1000.0;
+    f64 megabytes = (f64)file_size(cfg.path) / (1024.0 * 1024.0);
+
+    f64 best_ms = 0.0, total_ms = 0.0;
+    bool identical = true;
+    for (u32 it = 0; it < cfg.iterations; it++) {
+        arena_reset(&load_arena);
+        Scene loaded = {};
+        SceneSpawn loaded_spawn = {};
+        if (!scene_create(&loaded, &load_arena)) return 1;
+
+        f64 start = time_now();
+        bool ok = scene_load_from_json(&loaded, &loaded_spawn, cfg.path, &load_arena);
+        f64 ms = (time_now() - start) * 1000.0;
+        if (!ok) return 1;
+
+        total_ms += ms;
+        if (it == 0 || ms < best_ms) best_ms = ms;
+        identical = identical && scenes_match(&source, &loaded) &&
+            vec3_equal(loaded_spawn.position, spawn.position) && loaded_spawn.yaw == spawn.yaw;
+    }
+
+    u32 entities = source.brush_count + source.props.count;
+    printf("scene json: %u brushes, %u props, %.1f MB\n", source.brush_count, source.props.count, megabytes);
+    printf("%12s %12s %12s %14s %10s\n", "save ms", "load ms", "avg ms", "MB/s (load)", "identical");
+    printf("%12.2f %12.2f %12.2f %14.1f %10s\n", save_ms, best_ms, total_ms / cfg.iterations,
+        best_ms > 0.0 ? megabytes / (best_ms / 1000.0) : 0.0, identical ? "yes" : "NO");
+    printf("%.1f entities/ms\n", best_ms > 0.0 ? entities / best_ms : 0.0);
+
+    // What startup did before baking: mesh and collision from brushes. Kept in
+    // source_arena as the reference for the baked data.
+    f64 rebuild_start = time_now();
+    Vertex* verts; u32* indices;
+    u32 vc, ic;
+    CollisionWorld rebuilt = {};
+    if (!scene_build_world_geometry(&source, &source_arena, &verts, &vc, &indices, &ic) ||
+        !collision_world_create(&rebuilt, &source_arena, source.brush_count)) {
+        return 1;
+    }
+    scene_build_collision(&source, &rebuilt);
+    f64 rebuild_ms = (time_now() - rebuild_start) * 1000.0;
+
+    arena_reset(&load_arena);
+    t0 = time_now();
+    if (!scene_bake_binary(&source, &spawn, cfg.baked_path, &load_arena)) return 1;
+    f64 bake_ms = (time_now() - t0) * 1000.0;
+    f64 baked_megabytes = (f64)file_size(cfg.baked_path) / (1024.0 * 1024.0);
+
+    // load = map + validate + fix-ups; touch = first pass over every page,
+    // which is where the page faults of a zero-copy load are actually paid.
+    f64 best_load_ms = 0.0, best_touch_ms = 0.0;
+    bool baked_identical = true;
+    for (u32 it = 0; it < cfg.iterations; it++) {
+        arena_reset(&load_arena);
+        Scene loaded = {};
+        SceneSpawn loaded_spawn = {};
+        SceneBinary bin = {};
+        if (!scene_create(&loaded, &load_arena)) return 1;
+
+        f64 start = time_now();
+        if (!scene_load_binary(&loaded, &loaded_spawn, cfg.baked_path, &load_arena, &bin)) return 1;
+        f64 load_ms = (time_now() - start) * 1000.0;
+
+        start = time_now();
+        u64 checksum = 0;
+        const u8* bytes = bin.mapping.data;
+        for (size_t i = 0; i < bin.mapping.size; i += 4096) checksum += bytes[i];
+        f64 touch_ms = (time_now() - start) * 1000.0;
+
+        if (it == 0 || load_ms < best_load_ms) best_load_ms = load_ms;
+        if (it == 0 || touch_ms < best_touch_ms) best_touch_ms = touch_ms;
+        baked_identical = baked_identical && checksum != ~0ull && scenes_match(&source, &loaded) &&
+            vec3_equal(loaded_spawn.position, spawn.position) && loaded_spawn.yaw == spawn.yaw &&
+            bin.vertex_count == vc && bin.index_count == ic &&
+            loaded.collision.box_count == rebuilt.box_count &&
+            !memcmp(bin.vertices, verts, sizeof(Vertex) * vc) &&
+            !memcmp(loaded.collision.boxes, rebuilt.boxes, sizeof(AABB) * rebuilt.box_count);
+        scene_binary_close(&bin);
+    }
+
+    printf("\nscene bscene: %.1f MB, %u verts, %u collision boxes\n", baked_megabytes, vc, rebuilt.box_count);
+    printf("%12s %12s %12s %12s %10s\n", "bake ms", "rebuild ms", "load ms", "touch ms", "identical");
+    printf("%12.2f %12.2f %12.3f %12.2f %10s\n", bake_ms, rebuild_ms, best_load_ms, best_touch_ms,
+        baked_identical ? "yes" : "NO");
+
+    remove(cfg.path);
+    remove(cfg.baked_path);
+    arena_shutdown(&load_arena);
+    arena_shutdown(&source_arena);
+    return identical && baked_identical ? 0 : 1;
+}
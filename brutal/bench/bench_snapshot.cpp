@@ -0,0 +1,180 @@
+// =============================================================================
+// Brutal Engine - Snapshot Benchmark
+// Capture and restore cost of a full scene + player snapshot, compressed
+// sizes with and without a base snapshot, and round-trip checks in memory
+// and through a quick-save file
+// =============================================================================
+
+#include "brutal/core/memory.h"
+#include "brutal/core/time.h"
+#include "brutal/world/scene.h"
+#include "brutal/world/player.h"
+#include "brutal/world/snapshot.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace brutal;
+
+struct BenchConfig {
+    u32 rooms = 400;
+    u32 iterations = 50;
+    u32 edits = 50;
+    const char* path = "bench_snapshot.bsnap";
+};
+
+// Walled rooms on a grid with a prop and a light each
+static bool generate_scene(Scene* s, u32 rooms) {
+    u32 side = 1;
+    while (side * side < rooms) side++;
+    for (u32 r = 0; r < rooms; r++) {
+        f32 ox = (f32)(r % side) * 12.0f, oz = (f32)(r / side) * 12.0f;
+        if (!scene_add_brush(s, Vec3(ox, -0.5f, oz), Vec3(ox + 10.0f, 0.0f, oz + 10.0f), BRUSH_SOLID,
+            Vec3(0.4f, 0.4f, 0.4f))) {
+            return false;
+        }
+        for (u32 i = 0; i < 40; i++) {
+            u32 side_index = i / 10, along = i % 10;
+            f32 x = side_index < 2 ? ox + (f32)along : (side_index == 2 ? ox : ox + 9.0f);
+            f32 z = side_index < 2 ? (side_index == 0 ? oz : oz + 9.0f) : oz + (f32)along;
+            scene_add_brush(s, Vec3(x, 0.0f, z), Vec3(x + 1.0f, 3.0f, z + 1.0f), BRUSH_SOLID, Vec3(0.6f, 0.5f, 0.4f));
+        }
+        Transform t = transform_default();
+        t.position = Vec3(ox + 5.0f, 0.5f, oz + 5.0f);
+        scene_add_prop(s, t, MESH_CUBE, Vec3(0.7f, 0.2f, 0.2f));
+        light_environment_add_point(&s->lights, Vec3(ox + 5.0f, 2.5f, oz + 5.0f), Vec3(1, 0.9f, 0.7f), 8.0f, 1.0f);
+    }
+    return true;
+}
+
+// A short stretch of play: blocks moved, furniture pushed, lights flickered,
+// a brush and a prop destroyed and the player somewhere else
+static void perturb(Scene* s, Player* p, u32 edits) {
+    for (u32 e = 0; e < edits; e++) {
+        u32 i = 1 + (e * 7919u) % (s->brush_count - 1);
+        s->brushes[i].max.y += 0.5f;
+        scene_mark_brush_dirty(s, i);
+    }
+    for (u32 e = 0; e < edits && e < s->props.count; e++) s->props.positions[e].y += 0.25f;
+    for (u32 e = 0; e < edits && e < s->lights.point_light_count; e++) s->lights.point_lights[e].intensity *= 0.5f;
+    scene_remove_brush(s, scene_brush_handle(s, s->brush_count / 2));
+    scene_remove_prop(s, scene_prop_handle(s, 0));
+    p->camera.position = p->camera.position + Vec3(3.0f, 0.0f, -2.0f);
+    p->velocity = Vec3(0.0f, -4.0f, 1.0f);
+    p->grounded = false;
+}
+
+// Restore rewrites what cannot survive a process boundary: the collision
+// revision moves on and the player's debug strings and cache are dropped.
+// Put those back so the recapture can be compared byte for byte.
+static void match_volatile(Scene* s, Player* p, u32 revision, const char* grounded_reason) {
+    s->collision.revision = revision;
+    p->grounded_reason = grounded_reason;
+}
+
+static void clear_volatile(Player* p) {
+    for (u32 i = 0; i < Player::kJumpDebugRingSize; i++) p->jump_debug_ring[i].grounded_reason = nullptr;
+    p->collision_cache.world = nullptr;
+    collision_cache_invalidate(&p->collision_cache);
+}
+
+static bool snapshots_equal(const Snapshot* a, const Snapshot* b) {
+    return a->size == b->size && !memcmp(a->data, b->data, a->size);
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--rooms")) cfg.rooms = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--iterations")) cfg.iterations = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--edits")) cfg.edits = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--path")) cfg.path = argv[i + 1];
+    }
+    if (cfg.rooms == 0) cfg.rooms = 1;
+    if (cfg.iterations == 0) cfg.iterations = 1;
+
+    size_t brushes = (size_t)cfg.rooms * 41 + 64;
+    MemoryArena arena = {};
+    MemoryArena temp = {};
+    if (!arena_init(&arena, brushes * 1024 + 64 * 1024 * 1024) || !arena_init(&temp, brushes * 2048 + 64 * 1024 * 1024)) {
+        return 1;
+    }
+
+    Scene scene = {};
+    if (!scene_create(&scene, &arena) || !generate_scene(&scene, cfg.rooms)) return 1;
+    scene.merge_collision = true;
+    scene_rebuild_collision(&scene);
+    Player player = {};
+    player_init(&player);
+    player.camera.position = Vec3(5.0f, 1.7f, 5.0f);
+    clear_volatile(&player);
+    u32 revision = scene.collision.revision;
+    const char* grounded_reason = player.grounded_reason;
+
+    // Capture
+    Snapshot base = {};
+    if (!snapshot_capture(&base, &scene, &player)) return 1;
+    f64 t0 = time_now();
+    for (u32 i = 0; i < cfg.iterations; i++) snapshot_capture(&base, &scene, &player);
+    f64 capture_ms = (time_now() - t0) * 1000.0 / cfg.iterations;
+
+    // Restore over a perturbed state, once per iteration
+    f64 restore_total = 0.0;
+    bool restored = true;
+    for (u32 i = 0; i < cfg.iterations; i++) {
+        perturb(&scene, &player, cfg.edits);
+        f64 t1 = time_now();
+        restored = snapshot_restore(&base, &scene, &player) && restored;
+        restore_total += time_now() - t1;
+    }
+    f64 restore_ms = restore_total * 1000.0 / cfg.iterations;
+    match_volatile(&scene, &player, revision, grounded_reason);
+    Snapshot check = {};
+    bool round_trip = restored && snapshot_capture(&check, &scene, &player) && snapshots_equal(&base, &check);
+
+    // Compression: alone, and against the base after the same edits (the
+    // brush count is kept so the snapshots line up)
+    u8* packed = (u8*)malloc(snapshot_compress_bound(base.size));
+    u8* unpacked = (u8*)malloc(base.size);
+    if (!packed || !unpacked) return 1;
+    f64 t2 = time_now();
+    size_t packed_size = snapshot_compress(base.data, base.size, nullptr, packed);
+    f64 compress_ms = (time_now() - t2) * 1000.0;
+    bool unpack_ok = snapshot_decompress(packed, packed_size, nullptr, unpacked, base.size) &&
+        !memcmp(unpacked, base.data, base.size);
+
+    for (u32 e = 0; e < cfg.edits; e++) scene.brushes[1 + (e * 7919u) % (scene.brush_count - 1)].max.y += 0.5f;
+    for (u32 e = 0; e < cfg.edits && e < scene.props.count; e++) scene.props.positions[e].y += 0.25f;
+    player.camera.position = player.camera.position + Vec3(3.0f, 0.0f, -2.0f);
+    if (!snapshot_capture(&check, &scene, &player) || check.size != base.size) return 1;
+    size_t delta_size = snapshot_compress(check.data, check.size, base.data, packed);
+    unpack_ok = unpack_ok && snapshot_decompress(packed, delta_size, base.data, unpacked, check.size) &&
+        !memcmp(unpacked, check.data, check.size);
+
+    // Quick-save file round trip
+    Snapshot loaded = {};
+    bool file_ok = snapshot_save(&base, cfg.path, true) && snapshot_load(&loaded, cfg.path) &&
+        snapshots_equal(&base, &loaded);
+
+    printf("snapshot: %u brushes, %u props, %u lights, %u collision boxes\n", scene.brush_count, scene.props.count,
+        scene.lights.point_light_count, scene.collision.box_count);
+    printf("%-30s %10.1f\n", "snapshot KB", base.size / 1024.0);
+    printf("%-30s %10.3f\n", "capture ms", capture_ms);
+    printf("%-30s %10.3f\n", "restore ms", restore_ms);
+    printf("%-30s %10.3f\n", "compress ms", compress_ms);
+    printf("%-30s %10.1f\n", "compressed KB", packed_size / 1024.0);
+    printf("%-30s %10.1f\n", "compressed vs base KB", delta_size / 1024.0);
+    printf("%-30s %10s\n", "restore round trip", round_trip ? "yes" : "NO");
+    printf("%-30s %10s\n", "compression round trip", unpack_ok ? "yes" : "NO");
+    printf("%-30s %10s\n", "file round trip", file_ok ? "yes" : "NO");
+
+    remove(cfg.path);
+    free(packed);
+    free(unpacked);
+    snapshot_free(&loaded);
+    snapshot_free(&check);
+    snapshot_free(&base);
+    arena_shutdown(&temp);
+    arena_shutdown(&arena);
+    return round_trip && unpack_ok && file_ok ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+// =============================================================================
+// Brutal Engine - Software Render Benchmark
+// Renders a scene through the renderer on the software backend the way the
+// playground draws a frame: occluders, world mesh, then every prop. Reports
+// frame time serial and on the job pool for views turning around the spawn,
+// checks the pooled frame matches the serial one pixel for pixel, and can
+// save each view as a TGA.
+// =============================================================================
+
+#include "brutal/core/jobs.h"
+#include "brutal/core/memory.h"
+#include "brutal/core/time.h"
+#include "brutal/renderer/camera.h"
+#include "brutal/renderer/render_backend.h"
+#include "brutal/renderer/renderer.h"
+#include "brutal/world/entity.h"
+#include "brutal/world/scene.h"
+#include "brutal/world/scene_io.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace brutal;
+
+// Set by the build so the default scene loads from any working directory
+#ifndef BRUTAL_SOURCE_DIR
+#define BRUTAL_SOURCE_DIR "."
+#endif
+
+struct BenchConfig {
+    const char* scene = BRUTAL_SOURCE_DIR "/playground/data/gothic_house.scene.json";
+    const char* out = nullptr;    // Views saved as <out>_<view>.tga
+    u32 width = 1280;
+    u32 height = 720;
+    u32 iterations = 10;
+    u32 threads = 0;              // 0: hardware threads
+};
+
+static void render_frame(RendererState* r, Scene* scene, const Camera* camera, u32 width, u32 height,
+    MemoryArena* temp) {
+    arena_reset(temp);
+    renderer_begin_frame(r, (i32)width, (i32)height);
+    renderer_set_lights(r, &scene->lights);
+    renderer_set_camera(r, camera);
+    AABB* occluders = arena_alloc_array<AABB>(temp, OCCLUSION_MAX_OCCLUDERS);
+    if (occluders) {
+        u32 count = scene_select_occluders(scene, camera->position, renderer_get_view_projection(r), occluders,
+            OCCLUSION_MAX_OCCLUDERS, temp);
+        renderer_build_occlusion(r, occluders, count);
+    }
+    if (scene->world_mesh.vao) renderer_draw_mesh(r, &scene->world_mesh, Mat4::identity(), Vec3(1, 1, 1));
+    PropView props = prop_storage_query(&scene->props, PROP_COLUMN_COLOR);
+    Mat4* models = arena_alloc_array<Mat4>(temp, props.count);
+    if (models) {
+        prop_storage_world_matrices(&scene->props, 0, props.count, models);
+        for (u32 i = 0; i < props.count; i++) {
+            renderer_draw_mesh(r, renderer_get_cube_mesh(r), models[i], props.colors[i]);
+        }
+    }
+    renderer_flush(r);
+    renderer_end_frame();
+}
+
+static f64 time_frames(RendererState* r, Scene* scene, const Camera* camera, const BenchConfig& cfg, MemoryArena* temp) {
+    f64 t0 = time_now();
+    for (u32 it = 0; it < cfg.iterations; it++) render_frame(r, scene, camera, cfg.width, cfg.height, temp);
+    return (time_now() - t0) * 1000.0 / cfg.iterations;
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--scene")) cfg.scene = argv[i + 1];
+        else if (!strcmp(argv[i], "--out")) cfg.out = argv[i + 1];
+        else if (!strcmp(argv[i], "--width")) cfg.width = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--height")) cfg.height = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--iterations")) cfg.iterations = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--threads")) cfg.threads = (u32)atoi(argv[i + 1]);
+    }
+    if (cfg.iterations == 0) cfg.iterations = 1;
+    if (cfg.width == 0 || cfg.height == 0) return 1;
+
+    render_backend_select(RENDER_BACKEND_SOFTWARE);
+    MemoryArena arena = {}, temp = {};
+    if (!arena_init(&arena, 128 * 1024 * 1024) || !arena_init(&temp, 32 * 1024 * 1024)) return 1;
+    Scene scene = {};
+    SceneSpawn spawn = { Vec3(0.0f, 1.7f, 8.0f), 3.14159f, 0.0f };
+    // A missing file loads as an empty scene, which would time nothing
+    FILE* probe = fopen(cfg.scene, "rb");
+    if (probe) fclose(probe);
+    if (!probe || !scene_create(&scene, &arena) || !scene_load_from_json(&scene, &spawn, cfg.scene, &arena) ||
+        scene.brush_count == 0) {
+        fprintf(stderr, "failed to load %s\n", cfg.scene);
+        return 1;
+    }
+    scene.cull_hidden_faces = true;
+    scene_rebuild_world_mesh(&scene, &temp);
+
+    RendererState renderer = {};
+    if (!renderer_init(&renderer, &arena)) return 1;
+    u32 pixels = cfg.width * cfg.height;
+    u32* reference = (u32*)malloc(sizeof(u32) * pixels);
+    if (!reference) return 1;
+
+    printf("software render: %s, %ux%u, %u brushes, %u props, %u lights\n", cfg.scene, cfg.width, cfg.height,
+        scene.brush_count, scene.props.count, scene.lights.point_light_count + scene.lights.spot_light_count);
+    printf("%6s %6s %9s %9s %9s %8s %8s %9s %6s\n", "yaw", "draws", "tris", "serial", "pool", "fps", "covered",
+        "shaded", "match");
+
+    bool ok = true;
+    for (u32 v = 0; v < 4; v++) {
+        Camera camera;
+        camera_init(&camera);
+        camera.position = spawn.position;
+        camera.yaw = spawn.yaw + (f32)v * 1.5707963f;
+        camera.pitch = spawn.pitch;
+
+        f64 serial = time_frames(&renderer, &scene, &camera, cfg, &temp);
+        const SoftwareFramebuffer* fb = renderer_framebuffer(&renderer);
+        memcpy(reference, fb->color, sizeof(u32) * pixels);
+        jobs_init(cfg.threads);
+        f64 pooled = time_frames(&renderer, &scene, &camera, cfg, &temp);
+        jobs_shutdown();
+
+        // Tiles own their pixels, so the pool must not change a single one
+        bool match = !memcmp(reference, fb->color, sizeof(u32) * pixels);
+        ok = ok && match;
+        u32 covered = 0;
+        for (u32 i = 0; i < pixels; i++) covered += fb->depth[i] < 1.0f ? 1 : 0;
+        printf("%6.2f %6u %9u %9.3f %9.3f %8.1f %7.1f%% %9u %6s\n", camera.yaw, renderer_draw_calls(&renderer),
+            renderer_triangles(&renderer), serial, pooled, 1000.0 / pooled, 100.0 * covered / pixels,
+            renderer.software.pixels_shaded, match ? "yes" : "NO");
+
+        if (cfg.out) {
+            char path[512];
+            snprintf(path, sizeof(path), "%s_%u.tga", cfg.out, v);
+            if (!software_framebuffer_save_tga(fb, path)) ok = false;
+        }
+    }
+
+    free(reference);
+    renderer_shutdown(&renderer);
+    arena_shutdown(&temp);
+    arena_shutdown(&arena);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+// =============================================================================
+// Brutal Engine - Sector Streaming Benchmark
+// Walks a viewer across a large sectored world: per-frame update cost, peak
+// resident memory versus the whole level, and collision checked against the
+// unsectored scene
+// =============================================================================
+
+#include "brutal/core/memory.h"
+#include "brutal/core/time.h"
+#include "brutal/world/scene.h"
+#include "brutal/world/sector.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+using namespace brutal;
+
+struct BenchConfig {
+    u32 rooms = 48;          // Per side
+    u32 steps = 400;
+    f32 sector_size = 48.0f;
+    f32 load_radius = 64.0f;
+    const char* path = nullptr;  // Default: in a directory under the system temp directory
+};
+
+// A grid of walled rooms, each with a few props and a light.
+static bool generate_scene(Scene* s, MemoryArena* arena, u32 rooms) {
+    u32 room_count = rooms * rooms;
+    if (!scene_reserve(s, arena, room_count * 41, room_count * 4)) return false;
+    for (u32 r = 0; r < room_count; r++) {
+        f32 ox = (f32)(r % rooms) * 12.0f, oz = (f32)(r / rooms) * 12.0f;
+        scene_add_brush(s, Vec3(ox, -0.5f, oz), Vec3(ox + 10.0f, 0.0f, oz + 10.0f), BRUSH_SOLID, Vec3(0.4f, 0.4f, 0.4f));
+        for (u32 i = 0; i < 40; i++) {
+            u32 side = i / 10, along = i % 10;
+            f32 x = side < 2 ? ox + (f32)along : (side == 2 ? ox : ox + 9.0f);
+            f32 z = side < 2 ? (side == 0 ? oz : oz + 9.0f) : oz + (f32)along;
+            scene_add_brush(s, Vec3(x, 0.0f, z), Vec3(x + 1.0f, 3.0f, z + 1.0f), BRUSH_SOLID, Vec3(0.6f, 0.5f, 0.4f));
+        }
+        for (u32 i = 0; i < 4; i++) {
+            Transform t;
+            t.position = Vec3(ox + 3.0f + (f32)(i % 2) * 4.0f, 0.5f, oz + 3.0f + (f32)(i / 2) * 4.0f);
+            t.rotation = quat_identity();
+            t.scale = Vec3(1, 1, 1);
+            scene_add_prop(s, t, 0, Vec3(0.7f, 0.2f, 0.2f));
+        }
+        if (!light_environment_add_point(&s->lights, Vec3(ox + 5.0f, 2.5f, oz + 5.0f), Vec3(1, 0.9f, 0.7f), 8.0f, 1.0f)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Probes around the viewer, all closer than the load radius, must hit the
+// same brushes in the streamed world as in the full one.
+static u32 check_collision(const CollisionWorld* full, const CollisionWorld* streamed, const Vec3& viewer, f32 radius) {
+    u32 mismatches = 0;
+    for (i32 z = -8; z <= 8; z++) {
+        for (i32 x = -8; x <= 8; x++) {
+            if (x * x + z * z > 64) continue;
+            Vec3 p = viewer + Vec3((f32)x, 0.0f, (f32)z) * (radius / 8.0f);
+            AABB probe = aabb_from_center_size(Vec3(p.x, 1.0f, p.z), Vec3(0.6f, 1.8f, 0.6f));
+            if (collision_overlaps_any(full, probe) != collision_overlaps_any(streamed, probe)) mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+// Sector files are numbered from 0 without gaps, so the first one missing
+// ends them; also covers a bake that failed partway. The temp directory goes
+// with them when the bench made it.
+static void remove_baked(const char* path, const std::filesystem::path& temp_dir) {
+    char name[1024];
+    for (u32 i = 0;; i++) {
+        snprintf(name, sizeof(name), "%s.%u", path, i);
+        if (remove(name) != 0) break;
+    }
+    remove(path);
+    std::error_code ec;
+    if (!temp_dir.empty()) std::filesystem::remove(temp_dir, ec);
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--rooms")) cfg.rooms = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--steps")) cfg.steps = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--sector-size")) cfg.sector_size = (f32)atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--load-radius")) cfg.load_radius = (f32)atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--path")) cfg.path = argv[i + 1];
+    }
+    if (cfg.rooms == 0) cfg.rooms = 1;
+    if (cfg.steps == 0) cfg.steps = 1;
+
+    std::filesystem::path temp_dir;
+    std::string temp_path;
+    if (!cfg.path) {
+        std::error_code ec;
+        temp_dir = std::filesystem::temp_directory_path(ec) / "brutal_bench_streaming";
+        if (!ec) std::filesystem::create_directories(temp_dir, ec);
+        if (ec) {
+            fprintf(stderr, "no temp directory for the baked sectors: %s\n", ec.message().c_str());
+            return 1;
+        }
+        temp_path = (temp_dir / "bench_streaming.bsectors").string();
+        cfg.path = temp_path.c_str();
+    }
+
+    u32 room_count = cfg.rooms * cfg.rooms;
+    MemoryArena arena = {};
+    MemoryArena temp = {};
+    if (!arena_init(&arena, (size_t)room_count * 41 * 256 + 16 * 1024 * 1024) ||
+        !arena_init(&temp, (size_t)room_count * 41 * 64 + 16 * 1024 * 1024)) {
+        return 1;
+    }
+
+    Scene scene = {};
+    if (!scene_create(&scene, &arena) || !generate_scene(&scene, &arena, cfg.rooms)) return 1;
+    scene_rebuild_collision(&scene);
+    SceneSpawn spawn = { Vec3(5.0f, 1.0f, 5.0f), 0.0f, 0.0f };
+
+    f64 t0 = time_now();
+    if (!scene_bake_sectors(&scene, &spawn, cfg.path, cfg.sector_size, &temp)) {
+        remove_baked(cfg.path, temp_dir);
+        return 1;
+    }
+    f64 bake_ms = (time_now() - t0) * 1000.0;
+
+    SectorStreamConfig sc = sector_stream_config_default();
+    sc.load_radius = cfg.load_radius;
+    sc.unload_radius = cfg.load_radius + cfg.sector_size * 0.5f;
+    sc.upload_meshes = false;
+    SectorStreamer st = {};
+    if (!sector_streamer_open(&st, cfg.path, sc, &arena)) {
+        remove_baked(cfg.path, temp_dir);
+        return 1;
+    }
+    u32 sector_count = st.stats.sector_count;
+
+    // Total cost of the level if every sector were resident
+    size_t total_bytes = 0;
+    {
+        SectorStreamer all = {};
+        SectorStreamConfig ac = sc;
+        ac.load_radius = ac.unload_radius = 1e9f;
+        MemoryArena all_arena = {};
+        if (!arena_init(&all_arena, (size_t)room_count * 256 + 1024 * 1024) || !sector_streamer_open(&all, cfg.path, ac, &all_arena)) {
+            sector_streamer_close(&st);
+            remove_baked(cfg.path, temp_dir);
+            return 1;
+        }
+        sector_streamer_flush(&all, spawn.position);
+        total_bytes = all.stats.resident_bytes;
+        sector_streamer_close(&all);
+        arena_shutdown(&all_arena);
+    }
+
+    printf("streaming: %u rooms, %u brushes, %u sectors of %.0f units, baked in %.1f ms\n", room_count,
+        scene.brush_count, sector_count, cfg.sector_size, bake_ms);
+
+    // Diagonal walk corner to corner, flushing and checking every 25 steps
+    f32 extent = (f32)cfg.rooms * 12.0f;
+    f64 update_total = 0.0, update_max = 0.0;
+    size_t peak_bytes = 0;
+    u32 mismatches = 0, checks = 0;
+    for (u32 i = 0; i <= cfg.steps; i++) {
+        f32 t = (f32)i / (f32)cfg.steps;
+        Vec3 viewer(5.0f + t * (extent - 10.0f), 1.0f, 5.0f + t * (extent - 10.0f));
+        f64 u0 = time_now();
+        sector_streamer_update(&st, viewer);
+        f64 ms = (time_now() - u0) * 1000.0;
+        update_total += ms;
+        if (ms > update_max) update_max = ms;
+        if (i % 25 == 0 || i == cfg.steps) {
+            sector_streamer_flush(&st, viewer);
+            mismatches += check_collision(&scene.collision, &st.collision, viewer, cfg.load_radius - 2.0f);
+            checks++;
+        }
+        if (st.stats.resident_bytes > peak_bytes) peak_bytes = st.stats.resident_bytes;
+    }
+
+    printf("%-28s %10.3f\n", "update ms (avg)", update_total / (cfg.steps + 1));
+    printf("%-28s %10.3f\n", "update ms (max)", update_max);
+    printf("%-28s %10.2f\n", "peak resident MB", peak_bytes / (1024.0 * 1024.0));
+    printf("%-28s %10.2f\n", "whole level MB", total_bytes / (1024.0 * 1024.0));
+    printf("%-28s %10u\n", "sector loads", st.stats.loads);
+    printf("%-28s %10u\n", "sector unloads", st.stats.unloads);
+    printf("%-28s %10s\n", "collision matches", mismatches ? "NO" : "yes");
+    printf("(%u checkpoints, %u probe mismatches)\n", checks, mismatches);
+
+    sector_streamer_close(&st);
+    remove_baked(cfg.path, temp_dir);
+    arena_shutdown(&temp);
+    arena_shutdown(&arena);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,217 @@
+// =============================================================================
+// Brutal Engine - World Mesh Benchmark
+// Full world mesh generation time versus job system thread count, then the
+// size of the result as float and packed vertices and the packing error
+// =============================================================================
+
+#include "brutal/core/jobs.h"
+#include "brutal/core/memory.h"
+#include "brutal/core/time.h"
+#include "brutal/renderer/mesh.h"
+#include "brutal/world/scene.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+using namespace brutal;
+
+struct BenchConfig {
+    u32 brushes = 100000;
+    u32 iterations = 5;
+    u32 max_threads = 0;
+};
+
+// Rooms of stacked wall blocks on a grid, so hidden face removal has real
+// work: neighbouring blocks share faces and every room has a floor slab.
+static bool generate_scene(Scene* s, MemoryArena* arena, u32 count) {
+    if (!scene_reserve(s, arena, count, 0)) return false;
+    u32 room = 0;
+    while (s->brush_count < count) {
+        f32 ox = (f32)(room % 64) * 12.0f, oz = (f32)(room / 64) * 12.0f;
+        scene_add_brush(s, Vec3(ox, -0.5f, oz), Vec3(ox + 10.0f, 0.0f, oz + 10.0f), BRUSH_SOLID, Vec3(0.4f, 0.4f, 0.4f));
+        for (u32 i = 0; i < 40 && s->brush_count < count; i++) {
+            // Walls of 1x1x1 blocks around the room edge, three high
+            u32 side = i / 10, along = i % 10;
+            f32 x = side < 2 ? ox + (f32)along : (side == 2 ? ox : ox + 9.0f);
+            f32 z = side < 2 ? (side == 0 ? oz : oz + 9.0f) : oz + (f32)along;
+            for (u32 h = 0; h < 3 && s->brush_count < count; h++) {
+                Vec3 min(x, (f32)h, z);
+                scene_add_brush(s, min, min + Vec3(1, 1, 1), BRUSH_SOLID, Vec3(0.6f, 0.5f, 0.4f));
+            }
+        }
+        room++;
+    }
+    return true;
+}
+
+struct MeshOutput {
+    Vertex* verts;
+    u32* indices;
+    u32 vertex_count, index_count;
+};
+
+// Returns the best build time in ms; out receives the last build's geometry.
+static f64 run_build(const Scene* s, MemoryArena* temp, u32 iterations, MeshOutput* out) {
+    f64 best = 0.0;
+    for (u32 it = 0; it < iterations; it++) {
+        arena_reset(temp);
+        f64 t0 = time_now();
+        if (!scene_build_world_geometry(s, temp, &out->verts, &out->vertex_count, &out->indices, &out->index_count)) {
+            return -1.0;
+        }
+        f64 ms = (time_now() - t0) * 1000.0;
+        if (it == 0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+struct PackStats {
+    u32 vertex_count;
+    bool packed;
+    f32 step;
+    f64 ms;
+    f32 position_error;   // Metres
+    f32 normal_error;     // Degrees
+    f32 color_error;      // In 1/255 steps
+};
+
+// Packs a build's vertices on their own grid and decodes them back the way
+// the vertex fetch does
+static PackStats measure_packing(const Vertex* verts, u32 count) {
+    PackStats st = {};
+    st.vertex_count = count;
+    if (!count) return st;
+    AABB range = { verts[0].position, verts[0].position };
+    for (u32 i = 1; i < count; i++) {
+        const Vec3& p = verts[i].position;
+        range.min = Vec3(fminf(range.min.x, p.x), fminf(range.min.y, p.y), fminf(range.min.z, p.z));
+        range.max = Vec3(fmaxf(range.max.x, p.x), fmaxf(range.max.y, p.y), fmaxf(range.max.z, p.z));
+    }
+    Vec3 origin;
+    if (!vertex_pack_grid(range, &origin, &st.step)) return st;
+    st.packed = true;
+
+    PackedVertex* packed = (PackedVertex*)malloc(sizeof(PackedVertex) * count);
+    if (!packed) return st;
+    f64 t0 = time_now();
+    vertex_pack(verts, count, origin, st.step, packed);
+    st.ms = (time_now() - t0) * 1000.0;
+
+    for (u32 i = 0; i < count; i++) {
+        const Vertex& v = verts[i];
+        const PackedVertex& p = packed[i];
+        Vec3 pos(origin.x + p.position[0] * st.step, origin.y + p.position[1] * st.step,
+            origin.z + p.position[2] * st.step);
+        Vec3 d = pos - v.position;
+        st.position_error = fmaxf(st.position_error, fmaxf(fabsf(d.x), fmaxf(fabsf(d.y), fabsf(d.z))));
+
+        f32 n[3];
+        for (u32 c = 0; c < 3; c++) {
+            i32 q = (i32)(p.normal << (22 - c * 10)) >> 22;
+            n[c] = fmaxf((f32)q / 511.0f, -1.0f);
+        }
+        Vec3 normal = vec3_normalize(Vec3(n[0], n[1], n[2]));
+        f32 cos_angle = fminf(vec3_dot(normal, vec3_normalize(v.normal)), 1.0f);
+        st.normal_error = fmaxf(st.normal_error, acosf(cos_angle) * 57.2957795f);
+
+        const f32 col[3] = { v.color.x, v.color.y, v.color.z };
+        for (u32 c = 0; c < 3; c++) {
+            f32 back = (f32)((p.color >> (c * 8)) & 0xFF) / 255.0f;
+            st.color_error = fmaxf(st.color_error, fabsf(back - col[c]) * 255.0f);
+        }
+    }
+    free(packed);
+    return st;
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--brushes")) cfg.brushes = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--iterations")) cfg.iterations = (u32)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--max-threads")) cfg.max_threads = (u32)atoi(argv[i + 1]);
+    }
+    if (cfg.iterations == 0) cfg.iterations = 1;
+    if (cfg.max_threads == 0) {
+        cfg.max_threads = std::thread::hardware_concurrency();
+        if (cfg.max_threads == 0) cfg.max_threads = 1;
+    }
+
+    MemoryArena arena = {};
+    MemoryArena temp = {};
+    size_t temp_size = (size_t)cfg.brushes * 2048 + 16 * 1024 * 1024;
+    if (!arena_init(&arena, (size_t)cfg.brushes * 256 + 1024 * 1024) || !arena_init(&temp, temp_size)) return 1;
+
+    Scene scene = {};
+    if (!scene_create(&scene, &arena) || !generate_scene(&scene, &arena, cfg.brushes)) return 1;
+
+    // Serial reference output per mode, copied out of the temp arena
+    size_t max_verts = (size_t)cfg.brushes * 24, max_indices = (size_t)cfg.brushes * 36;
+    Vertex* ref_verts = (Vertex*)malloc(sizeof(Vertex) * max_verts);
+    u32* ref_indices = (u32*)malloc(sizeof(u32) * max_indices);
+    if (!ref_verts || !ref_indices) return 1;
+
+    printf("world mesh: %u brushes, best of %u builds\n", scene.brush_count, cfg.iterations);
+    printf("%8s %8s %12s %12s %10s %10s\n", "culled", "threads", "triangles", "ms/build", "speedup", "identical");
+
+    bool all_identical = true;
+    PackStats pack_stats[2] = {};
+    for (u32 mode = 0; mode < 2; mode++) {
+        scene.cull_hidden_faces = mode == 1;
+        u32 ref_vc = 0, ref_ic = 0;
+        f64 baseline = 0.0;
+        for (u32 threads = 1; threads <= cfg.max_threads; threads++) {
+            if (threads > 1) jobs_init(threads - 1);
+            MeshOutput out = {};
+            f64 ms = run_build(&scene, &temp, cfg.iterations, &out);
+            if (threads > 1) jobs_shutdown();
+            if (ms < 0.0) return 1;
+
+            bool identical = true;
+            if (threads == 1) {
+                baseline = ms;
+                ref_vc = out.vertex_count;
+                ref_ic = out.index_count;
+                memcpy(ref_verts, out.verts, sizeof(Vertex) * ref_vc);
+                memcpy(ref_indices, out.indices, sizeof(u32) * ref_ic);
+            } else {
+                identical = out.vertex_count == ref_vc && out.index_count == ref_ic &&
+                    !memcmp(out.verts, ref_verts, sizeof(Vertex) * ref_vc) &&
+                    !memcmp(out.indices, ref_indices, sizeof(u32) * ref_ic);
+            }
+            all_identical = all_identical && identical;
+            printf("%8s %8u %12u %12.2f %9.2fx %10s\n", mode ? "yes" : "no", threads, out.index_count / 3, ms,
+                ms > 0.0 ? baseline / ms : 0.0, identical ? "yes" : "NO");
+        }
+        pack_stats[mode] = measure_packing(ref_verts, ref_vc);
+    }
+
+    // Bytes are what one full draw of the world mesh fetches
+    printf("\nvertex format: %zu bytes float, %zu bytes packed\n", sizeof(Vertex), sizeof(PackedVertex));
+    printf("%8s %10s %10s %10s %8s %10s %10s %10s %10s\n", "culled", "vertices", "float MB", "packed MB", "saved",
+        "pack ms", "pos err", "nrm deg", "col /255");
+    bool packing_ok = true;
+    for (u32 mode = 0; mode < 2; mode++) {
+        const PackStats& st = pack_stats[mode];
+        if (!st.packed) {
+            printf("%8s %10u  level too wide to pack\n", mode ? "yes" : "no", st.vertex_count);
+            continue;
+        }
+        f64 float_mb = (f64)st.vertex_count * sizeof(Vertex) / (1024.0 * 1024.0);
+        f64 packed_mb = (f64)st.vertex_count * sizeof(PackedVertex) / (1024.0 * 1024.0);
+        // Within half a grid step, a tenth of a degree and half a color step
+        bool ok = st.position_error <= st.step * 0.5f && st.normal_error <= 0.1f && st.color_error <= 0.5001f;
+        packing_ok = packing_ok && ok;
+        printf("%8s %10u %10.2f %10.2f %7.0f%% %10.2f %10.5f %10.3f %10.3f%s\n", mode ? "yes" : "no",
+            st.vertex_count, float_mb, packed_mb, 100.0 * (1.0 - packed_mb / float_mb), st.ms, st.position_error,
+            st.normal_error, st.color_error, ok ? "" : "  OUT OF TOLERANCE");
+    }
+
+    free(ref_verts);
+    free(ref_indices);
+    arena_shutdown(&temp);
+    arena_shutdown(&arena);
+    return all_identical && packing_ok ? 0 : 1;
+}
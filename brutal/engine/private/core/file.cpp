@@ -0,0 +1,178 @@
+#include "brutal/core/file.h"
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace brutal {
+
+#if defined(_WIN32)
+
+static bool map_file(const char* path, FileMapping* out, bool copy_on_write) {
+    *out = {};
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) return false;
+
+    void* view = MapViewOfFile(mapping, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    out->data = static_cast<const u8*>(view);
+    out->size = static_cast<size_t>(size.QuadPart);
+    out->handle = mapping;
+    return true;
+}
+
+void file_unmap(FileMapping* m) {
+    if (m->data) UnmapViewOfFile(m->data);
+    if (m->handle) CloseHandle(static_cast<HANDLE>(m->handle));
+    *m = {};
+}
+
+bool file_modified_time(const char* path, u64* out) {
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &info)) return false;
+    *out = (static_cast<u64>(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime;
+    return true;
+}
+
+#else
+
+static bool map_file(const char* path, FileMapping* out, bool copy_on_write) {
+    *out = {};
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    int prot = copy_on_write ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), prot, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) return false;
+    madvise(view, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+    out->data = static_cast<const u8*>(view);
+    out->size = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void file_unmap(FileMapping* m) {
+    if (m->data) munmap(const_cast<u8*>(m->data), m->size);
+    *m = {};
+}
+
+bool file_modified_time(const char* path, u64* out) {
+    struct stat st;
+    if (stat(path, &st) != 0) return false;
+#if defined(__linux__)
+    *out = static_cast<u64>(st.st_mtim.tv_sec) * 1000000000ull + static_cast<u64>(st.st_mtim.tv_nsec);
+#else
+    *out = static_cast<u64>(st.st_mtime) * 1000000000ull;
+#endif
+    return true;
+}
+
+#endif
+
+bool file_map_read(const char* path, FileMapping* out) { return map_file(path, out, false); }
+bool file_map_private(const char* path, FileMapping* out) { return map_file(path, out, true); }
+
+bool file_watch_open(FileWatch* w, const char* path) {
+    *w = {};
+    w->fd = w->wd = -1;
+    size_t len = strlen(path);
+    if (len >= sizeof(w->path)) return false;
+    memcpy(w->path, path, len + 1);
+    const char* slash = strrchr(w->path, '/');
+#if defined(_WIN32)
+    const char* backslash = strrchr(w->path, '\\');
+    if (backslash > slash) slash = backslash;
+#endif
+    w->name_offset = slash ? static_cast<u32>(slash + 1 - w->path) : 0;
+    file_modified_time(path, &w->modified);
+
+#if defined(__linux__)
+    char dir[sizeof(w->path)];
+    size_t dir_len = slash ? static_cast<size_t>(slash - w->path) : 0;
+    if (slash) memcpy(dir, w->path, dir_len);
+    else dir[dir_len++] = '.';
+    if (dir_len == 0) dir[dir_len++] = '/';
+    dir[dir_len] = 0;
+    w->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (w->fd >= 0) w->wd = inotify_add_watch(w->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (w->wd < 0 && w->fd >= 0) {
+        close(w->fd);
+        w->fd = -1;
+    }
+#endif
+    return true;
+}
+
+void file_watch_close(FileWatch* w) {
+#if defined(__linux__)
+    if (w->fd >= 0) close(w->fd);
+#endif
+    w->fd = w->wd = -1;
+}
+
+bool file_watch_poll(FileWatch* w) {
+    bool changed = false;
+#if defined(__linux__)
+    if (w->fd >= 0) {
+        alignas(inotify_event) char buffer[4096];
+        for (;;) {
+            ssize_t n = read(w->fd, buffer, sizeof(buffer));
+            if (n <= 0) break;
+            for (ssize_t at = 0; at < n;) {
+                const inotify_event* e = reinterpret_cast<const inotify_event*>(buffer + at);
+                if (e->len && !strcmp(e->name, w->path + w->name_offset)) changed = true;
+                at += sizeof(inotify_event) + e->len;
+            }
+        }
+        if (changed) file_modified_time(w->path, &w->modified);
+        return changed;
+    }
+#endif
+    u64 modified;
+    if (file_modified_time(w->path, &modified) && modified != w->modified) {
+        w->modified = modified;
+        changed = true;
+    }
+    return changed;
+}
+
+}
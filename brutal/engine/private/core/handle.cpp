@@ -0,0 +1,83 @@
+#include "brutal/core/handle.h"
+#include "brutal/core/memory.h"
+#include <cstring>
+
+namespace brutal {
+
+bool handle_table_reserve(HandleTable* t, MemoryArena* arena, u32 capacity) {
+    if (capacity <= t->capacity) return true;
+    u32* slot_dense = arena_alloc_array<u32>(arena, capacity);
+    u32* slot_generation = arena_alloc_array<u32>(arena, capacity);
+    u32* dense_slot = arena_alloc_array<u32>(arena, capacity);
+    if (!slot_dense || !slot_generation || !dense_slot) return false;
+    if (t->capacity) {
+        memcpy(slot_dense, t->slot_dense, sizeof(u32) * t->slot_count);
+        memcpy(slot_generation, t->slot_generation, sizeof(u32) * t->slot_count);
+        memcpy(dense_slot, t->dense_slot, sizeof(u32) * t->capacity);
+    } else {
+        t->free_head = HANDLE_NONE;
+    }
+    t->slot_dense = slot_dense;
+    t->slot_generation = slot_generation;
+    t->dense_slot = dense_slot;
+    t->capacity = capacity;
+    return true;
+}
+
+static u32 next_generation(u32 generation) {
+    return generation + 1 ? generation + 1 : 1;
+}
+
+void handle_table_clear(HandleTable* t) {
+    // Free slots get bumped again, which only skips a generation
+    for (u32 i = 0; i < t->slot_count; i++) {
+        t->slot_generation[i] = next_generation(t->slot_generation[i]);
+        t->slot_dense[i] = i + 1 < t->slot_count ? i + 1 : HANDLE_NONE;
+    }
+    t->free_head = t->slot_count ? 0 : HANDLE_NONE;
+}
+
+u32 handle_table_insert(HandleTable* t, u32 dense, u32* generation) {
+    if (dense >= t->capacity) return HANDLE_NONE;
+    u32 slot;
+    if (t->free_head != HANDLE_NONE) {
+        slot = t->free_head;
+        t->free_head = t->slot_dense[slot];
+    } else {
+        if (t->slot_count >= t->capacity) return HANDLE_NONE;
+        slot = t->slot_count++;
+        t->slot_generation[slot] = 1;
+    }
+    t->slot_dense[slot] = dense;
+    t->dense_slot[dense] = slot;
+    *generation = t->slot_generation[slot];
+    return slot;
+}
+
+u32 handle_table_lookup(const HandleTable* t, u32 slot, u32 generation) {
+    if (slot >= t->slot_count || generation == 0 || t->slot_generation[slot] != generation) return HANDLE_NONE;
+    return t->slot_dense[slot];
+}
+
+void handle_table_remove(HandleTable* t, u32 dense, u32 count) {
+    u32 slot = t->dense_slot[dense];
+    u32 last = count - 1;
+    if (dense != last) {
+        u32 moved = t->dense_slot[last];
+        t->dense_slot[dense] = moved;
+        t->slot_dense[moved] = dense;
+    }
+    t->slot_generation[slot] = next_generation(t->slot_generation[slot]);
+    t->slot_dense[slot] = t->free_head;
+    t->free_head = slot;
+}
+
+void handle_table_swap(HandleTable* t, u32 a, u32 b) {
+    u32 slot_a = t->dense_slot[a], slot_b = t->dense_slot[b];
+    t->dense_slot[a] = slot_b;
+    t->dense_slot[b] = slot_a;
+    t->slot_dense[slot_a] = b;
+    t->slot_dense[slot_b] = a;
+}
+
+}
@@ -0,0 +1,151 @@
+#include "brutal/core/jobs.h"
+#include "brutal/core/logging.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace brutal {
+
+static constexpr u32 MAX_JOB_WORKERS = 63;
+
+struct ParallelForTask {
+    ParallelForFn fn;
+    void* user;
+    u32 count;
+    u32 batch_size;
+    std::atomic<u32> next;
+    std::atomic<u32> remaining;
+};
+
+struct JobSystemState {
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::mutex submit_mutex;
+    ParallelForTask* task;
+    u32 busy_workers;
+    u64 generation;
+    bool quit;
+    bool initialized;
+};
+
+static JobSystemState g_jobs;
+static thread_local bool g_inside_job = false;
+
+// Pulls batches until the range is exhausted.
+static void run_batches(ParallelForTask* task) {
+    for (;;) {
+        u32 begin = task->next.fetch_add(task->batch_size, std::memory_order_relaxed);
+        if (begin >= task->count) break;
+        u32 end = begin + task->batch_size;
+        if (end > task->count) end = task->count;
+        task->fn(task->user, begin, end);
+        task->remaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+static void worker_main() {
+    g_inside_job = true;
+    u64 seen_generation = 0;
+    for (;;) {
+        ParallelForTask* task = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(g_jobs.mutex);
+            g_jobs.wake.wait(lock, [&] { return g_jobs.quit || g_jobs.generation != seen_generation; });
+            if (g_jobs.quit) return;
+            seen_generation = g_jobs.generation;
+            task = g_jobs.task;
+            if (task) g_jobs.busy_workers++;
+        }
+        if (!task) continue;
+        run_batches(task);
+        {
+            std::lock_guard<std::mutex> lock(g_jobs.mutex);
+            g_jobs.busy_workers--;
+        }
+        g_jobs.done.notify_all();
+    }
+}
+
+bool jobs_init(u32 worker_count) {
+    if (g_jobs.initialized) return true;
+    if (worker_count == 0) {
+        u32 hw = std::thread::hardware_concurrency();
+        worker_count = hw > 1 ? hw - 1 : 0;
+    }
+    if (worker_count > MAX_JOB_WORKERS) worker_count = MAX_JOB_WORKERS;
+
+    g_jobs.task = nullptr;
+    g_jobs.busy_workers = 0;
+    g_jobs.generation = 0;
+    g_jobs.quit = false;
+    g_jobs.workers.reserve(worker_count);
+    for (u32 i = 0; i < worker_count; i++) {
+        g_jobs.workers.emplace_back(worker_main);
+    }
+    g_jobs.initialized = true;
+    LOG_INFO("Job system: %u workers", worker_count);
+    return true;
+}
+
+void jobs_shutdown() {
+    if (!g_jobs.initialized) return;
+    {
+        std::lock_guard<std::mutex> lock(g_jobs.mutex);
+        g_jobs.quit = true;
+    }
+    g_jobs.wake.notify_all();
+    for (std::thread& t : g_jobs.workers) t.join();
+    g_jobs.workers.clear();
+    g_jobs.task = nullptr;
+    g_jobs.initialized = false;
+}
+
+u32 jobs_worker_count() {
+    return static_cast<u32>(g_jobs.workers.size());
+}
+
+void parallel_for(u32 count, u32 batch_size, ParallelForFn fn, void* user) {
+    if (count == 0 || !fn) return;
+    if (batch_size == 0) batch_size = 1;
+
+    // Nested or single-batch ranges gain nothing from a handoff.
+    if (!g_jobs.initialized || g_jobs.workers.empty() || g_inside_job || count <= batch_size) {
+        fn(user, 0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> submit(g_jobs.submit_mutex);
+
+    ParallelForTask task;
+    task.fn = fn;
+    task.user = user;
+    task.count = count;
+    task.batch_size = batch_size;
+    task.next.store(0, std::memory_order_relaxed);
+    task.remaining.store((count + batch_size - 1) / batch_size, std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> lock(g_jobs.mutex);
+        g_jobs.task = &task;
+        g_jobs.generation++;
+    }
+    g_jobs.wake.notify_all();
+
+    g_inside_job = true;
+    run_batches(&task);
+    g_inside_job = false;
+
+    // The task lives on this stack frame, so also wait for every worker that
+    // picked it up to let go before returning.
+    std::unique_lock<std::mutex> lock(g_jobs.mutex);
+    g_jobs.done.wait(lock, [&] {
+        return task.remaining.load(std::memory_order_acquire) == 0 && g_jobs.busy_workers == 0;
+    });
+    g_jobs.task = nullptr;
+}
+
+}
@@ -0,0 +1,331 @@
+#include "brutal/core/json.h"
+#include <cmath>
+#include <cstring>
+
+namespace brutal {
+
+// =============================================================================
+// Reader
+// =============================================================================
+static const f64 POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static JsonToken fail(JsonReader* r, const char* message) {
+    if (!r->error) r->error = message;
+    return JsonToken::ERROR;
+}
+
+static inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+static void skip_whitespace(JsonReader* r) {
+    const char* p = r->cur;
+    while (p < r->end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+    r->cur = p;
+}
+
+static JsonToken push_container(JsonReader* r, bool object) {
+    if (r->depth == JSON_MAX_DEPTH) return fail(r, "nesting too deep");
+    r->in_object[r->depth++] = object;
+    r->need_comma = false;
+    r->cur++;
+    return object ? JsonToken::OBJECT_BEGIN : JsonToken::ARRAY_BEGIN;
+}
+
+static JsonToken pop_container(JsonReader* r, JsonToken token) {
+    r->depth--;
+    r->need_comma = true;
+    r->root_done = r->depth == 0;
+    r->cur++;
+    return token;
+}
+
+static JsonToken finish_value(JsonReader* r, JsonToken token) {
+    r->need_comma = true;
+    r->root_done = r->depth == 0;
+    return token;
+}
+
+static bool scan_string(JsonReader* r) {
+    const char* p = r->cur + 1;
+    const char* start = p;
+    while (p < r->end) {
+        char c = *p;
+        if (c == '"') {
+            r->text = start;
+            r->text_length = static_cast<u32>(p - start);
+            r->cur = p + 1;
+            return true;
+        }
+        if (c == '\\') { p += 2; continue; }
+        if (static_cast<u8>(c) < 0x20) {
+            fail(r, "control character in string");
+            return false;
+        }
+        p++;
+    }
+    fail(r, "unterminated string");
+    return false;
+}
+
+static JsonToken scan_number(JsonReader* r) {
+    const char* p = r->cur;
+    const char* end = r->end;
+    bool negative = false;
+    if (*p == '-') { negative = true; p++; }
+    if (p == end || !is_digit(*p)) return fail(r, "malformed number");
+
+    u64 mantissa = 0;
+    i32 digits = 0;
+    i32 exp10 = 0;
+    if (*p == '0') {
+        p++;
+    } else {
+        while (p < end && is_digit(*p)) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + static_cast<u64>(*p - '0');
+                if (mantissa) digits++;
+            } else {
+                exp10++;
+            }
+            p++;
+        }
+    }
+    if (p < end && *p == '.') {
+        p++;
+        if (p == end || !is_digit(*p)) return fail(r, "malformed number");
+        while (p < end && is_digit(*p)) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + static_cast<u64>(*p - '0');
+                if (mantissa) digits++;
+                exp10--;
+            }
+            p++;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        i32 sign = 1;
+        if (p < end && (*p == '+' || *p == '-')) { sign = (*p == '-') ? -1 : 1; p++; }
+        if (p == end || !is_digit(*p)) return fail(r, "malformed number");
+        i32 e = 0;
+        while (p < end && is_digit(*p)) {
+            if (e < 10000) e = e * 10 + (*p - '0');
+            p++;
+        }
+        exp10 += sign * e;
+    }
+
+    f64 value = static_cast<f64>(mantissa);
+    if (mantissa != 0 && exp10 != 0) {
+        if (exp10 > 0 && exp10 <= 22) value *= POW10[exp10];
+        else if (exp10 < 0 && exp10 >= -22) value /= POW10[-exp10];
+        else value *= pow(10.0, static_cast<f64>(exp10));
+    }
+    r->number = negative ? -value : value;
+    r->text = r->cur;
+    r->text_length = static_cast<u32>(p - r->cur);
+    r->cur = p;
+    return finish_value(r, JsonToken::NUMBER);
+}
+
+static JsonToken scan_literal(JsonReader* r, const char* word, JsonToken token) {
+    size_t len = strlen(word);
+    if (static_cast<size_t>(r->end - r->cur) < len || memcmp(r->cur, word, len) != 0) {
+        return fail(r, "unexpected character");
+    }
+    r->cur += len;
+    return finish_value(r, token);
+}
+
+void json_reader_init(JsonReader* r, const char* data, size_t size) {
+    *r = {};
+    r->begin = data;
+    r->cur = data;
+    r->end = data + size;
+}
+
+JsonToken json_next(JsonReader* r) {
+    if (r->error) return JsonToken::ERROR;
+    skip_whitespace(r);
+    if (r->root_done) {
+        if (r->cur == r->end) return JsonToken::END;
+        return fail(r, "trailing data after root value");
+    }
+    if (r->cur == r->end) return fail(r, "unexpected end of input");
+
+    char c = *r->cur;
+    bool after_comma = false;
+    if (r->depth > 0 && !r->after_key) {
+        bool object = r->in_object[r->depth - 1];
+        char close = object ? '}' : ']';
+        if (c == close) return pop_container(r, object ? JsonToken::OBJECT_END : JsonToken::ARRAY_END);
+        if (r->need_comma) {
+            if (c != ',') return fail(r, object ? "expected ',' or '}'" : "expected ',' or ']'");
+            r->cur++;
+            skip_whitespace(r);
+            if (r->cur == r->end) return fail(r, "unexpected end of input");
+            c = *r->cur;
+            after_comma = true;
+        }
+        if (object) {
+            if (c != '"') return fail(r, after_comma && c == '}' ? "trailing comma" : "expected key");
+            if (!scan_string(r)) return JsonToken::ERROR;
+            skip_whitespace(r);
+            if (r->cur == r->end || *r->cur != ':') return fail(r, "expected ':'");
+            r->cur++;
+            r->after_key = true;
+            return JsonToken::KEY;
+        }
+        if (after_comma && c == ']') return fail(r, "trailing comma");
+    }
+
+    r->after_key = false;
+    switch (c) {
+        case '{': return push_container(r, true);
+        case '[': return push_container(r, false);
+        case '"':
+            if (!scan_string(r)) return JsonToken::ERROR;
+            return finish_value(r, JsonToken::STRING);
+        case 't': return scan_literal(r, "true", JsonToken::TRUE_VALUE);
+        case 'f': return scan_literal(r, "false", JsonToken::FALSE_VALUE);
+        case 'n': return scan_literal(r, "null", JsonToken::NULL_VALUE);
+        default:
+            if (c == '-' || is_digit(c)) return scan_number(r);
+            return fail(r, "unexpected character");
+    }
+}
+
+bool json_skip_value(JsonReader* r, JsonToken first) {
+    if (first == JsonToken::OBJECT_BEGIN || first == JsonToken::ARRAY_BEGIN) {
+        u32 target = r->depth - 1;
+        for (;;) {
+            JsonToken t = json_next(r);
+            if (t == JsonToken::ERROR || t == JsonToken::END) return false;
+            if ((t == JsonToken::OBJECT_END || t == JsonToken::ARRAY_END) && r->depth == target) return true;
+        }
+    }
+    return first != JsonToken::ERROR && first != JsonToken::END &&
+           first != JsonToken::KEY && first != JsonToken::OBJECT_END && first != JsonToken::ARRAY_END;
+}
+
+bool json_text_equals(const JsonReader* r, const char* s) {
+    size_t len = strlen(s);
+    return r->text_length == len && memcmp(r->text, s, len) == 0;
+}
+
+void json_error_location(const JsonReader* r, u32* line, u32* column) {
+    u32 l = 1, col = 1;
+    for (const char* p = r->begin; p < r->cur; p++) {
+        if (*p == '\n') { l++; col = 1; }
+        else col++;
+    }
+    *line = l;
+    *column = col;
+}
+
+// =============================================================================
+// Writer
+// =============================================================================
+static void write_newline(JsonWriter* w) {
+    fputc('\n', w->file);
+    for (u32 i = 0; i < w->depth; i++) fputs("  ", w->file);
+}
+
+static void write_separator(JsonWriter* w) {
+    if (w->after_key) {
+        w->after_key = false;
+        return;
+    }
+    if (w->need_comma) fputc(',', w->file);
+    if (w->depth == 0) return;
+    if (w->single_line_depth) {
+        if (w->need_comma) fputc(' ', w->file);
+    } else {
+        write_newline(w);
+    }
+}
+
+static void begin_container(JsonWriter* w, char open, bool single_line) {
+    write_separator(w);
+    fputc(open, w->file);
+    w->depth++;
+    if (single_line && !w->single_line_depth) w->single_line_depth = w->depth;
+    w->need_comma = false;
+}
+
+static void end_container(JsonWriter* w, char close) {
+    bool had_items = w->need_comma;
+    w->depth--;
+    if (!w->single_line_depth && had_items) write_newline(w);
+    fputc(close, w->file);
+    if (w->single_line_depth > w->depth) w->single_line_depth = 0;
+    w->need_comma = true;
+    if (w->depth == 0) fputc('\n', w->file);
+}
+
+void json_writer_init(JsonWriter* w, FILE* file) {
+    *w = {};
+    w->file = file;
+}
+
+void json_begin_object(JsonWriter* w, bool single_line) { begin_container(w, '{', single_line); }
+void json_end_object(JsonWriter* w) { end_container(w, '}'); }
+void json_begin_array(JsonWriter* w, bool single_line) { begin_container(w, '[', single_line); }
+void json_end_array(JsonWriter* w) { end_container(w, ']'); }
+
+void json_key(JsonWriter* w, const char* key) {
+    write_separator(w);
+    fputc('"', w->file);
+    fputs(key, w->file);
+    fputs("\": ", w->file);
+    w->after_key = true;
+    w->need_comma = true;
+}
+
+void json_write_number(JsonWriter* w, f64 value) {
+    write_separator(w);
+    if (!std::isfinite(value)) value = 0.0;
+    fprintf(w->file, "%.17g", value);
+    w->need_comma = true;
+}
+
+void json_write_float(JsonWriter* w, f32 value) {
+    write_separator(w);
+    if (!std::isfinite(value)) value = 0.0f;
+    fprintf(w->file, "%.9g", static_cast<f64>(value));
+    w->need_comma = true;
+}
+
+void json_write_uint(JsonWriter* w, u64 value) {
+    write_separator(w);
+    fprintf(w->file, "%llu", static_cast<unsigned long long>(value));
+    w->need_comma = true;
+}
+
+void json_write_bool(JsonWriter* w, bool value) {
+    write_separator(w);
+    fputs(value ? "true" : "false", w->file);
+    w->need_comma = true;
+}
+
+void json_write_string(JsonWriter* w, const char* value) {
+    write_separator(w);
+    fputc('"', w->file);
+    for (const char* p = value; *p; p++) {
+        char c = *p;
+        if (c == '"' || c == '\\') {
+            fputc('\\', w->file);
+            fputc(c, w->file);
+        } else if (static_cast<u8>(c) < 0x20) {
+            fprintf(w->file, "\\u%04x", static_cast<unsigned>(c));
+        } else {
+            fputc(c, w->file);
+        }
+    }
+    fputc('"', w->file);
+    w->need_comma = true;
+}
+
+}
@@ -2,8 +2,12 @@
 
 #if defined(BRUTAL_ENABLE_PROFILER) && BRUTAL_ENABLE_PROFILER
 
+#if defined(_WIN32)
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#else
+#include <time.h>
+#endif
 
 namespace brutal {
 
@@ -18,14 +22,30 @@ namespace brutal {
 
     static ProfilerState g_profiler = {};
 
+    static i64 profiler_ticks() {
+#if defined(_WIN32)
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        return now.QuadPart;
+#else
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<i64>(ts.tv_sec) * 1000000000ll + ts.tv_nsec;
+#endif
+    }
+
     static f64 ticks_to_ms(i64 ticks) {
         return (static_cast<f64>(ticks) / static_cast<f64>(g_profiler.frequency)) * 1000.0;
     }
 
     void profiler_init() {
+#if defined(_WIN32)
         LARGE_INTEGER freq;
         QueryPerformanceFrequency(&freq);
         g_profiler.frequency = freq.QuadPart;
+#else
+        g_profiler.frequency = 1000000000ll;
+#endif
         g_profiler.frame = {};
         g_profiler.stack_count = 0;
     }
@@ -35,9 +55,7 @@ namespace brutal {
     }
 
     void profiler_begin_frame() {
-        LARGE_INTEGER now;
-        QueryPerformanceCounter(&now);
-        g_profiler.frame_start = now.QuadPart;
+        g_profiler.frame_start = profiler_ticks();
         g_profiler.frame.count = 0;
         g_profiler.frame.frame_ms = 0.0;
         g_profiler.stack_count = 0;
@@ -45,17 +63,14 @@ namespace brutal {
 
     static void profiler_push(const char* name) {
         if (g_profiler.stack_count >= 64) return;
-        LARGE_INTEGER now;
-        QueryPerformanceCounter(&now);
-        g_profiler.stack_start[g_profiler.stack_count] = now.QuadPart;
+        g_profiler.stack_start[g_profiler.stack_count] = profiler_ticks();
         g_profiler.stack_name[g_profiler.stack_count] = name;
         g_profiler.stack_count++;
     }
 
     static void profiler_pop() {
         if (g_profiler.stack_count == 0) return;
-        LARGE_INTEGER now;
-        QueryPerformanceCounter(&now);
+        i64 now = profiler_ticks();
 
         g_profiler.stack_count--;
         i64 start = g_profiler.stack_start[g_profiler.stack_count];
@@ -64,14 +79,12 @@ namespace brutal {
         if (g_profiler.frame.count >= 64) return;
         ProfileEntry& entry = g_profiler.frame.entries[g_profiler.frame.count++];
         entry.name = name;
-        entry.ms = ticks_to_ms(now.QuadPart - start);
+        entry.ms = ticks_to_ms(now - start);
         entry.depth = g_profiler.stack_count;
     }
 
     void profiler_end_frame() {
-        LARGE_INTEGER now;
-        QueryPerformanceCounter(&now);
-        g_profiler.frame.frame_ms = ticks_to_ms(now.QuadPart - g_profiler.frame_start);
+        g_profiler.frame.frame_ms = ticks_to_ms(profiler_ticks() - g_profiler.frame_start);
 
         if (g_profiler.frame.count < 64) {
             ProfileEntry& entry = g_profiler.frame.entries[g_profiler.frame.count++];
@@ -1,11 +1,17 @@
 #include "brutal/core/time.h"
 
+#if defined(_WIN32)
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #include <timeapi.h>
+#else
+#include <time.h>
+#endif
 
 namespace brutal {
 
+#if defined(_WIN32)
+
 void time_init(TimeState* state) {
     timeBeginPeriod(1);
     LARGE_INTEGER freq, now;
@@ -44,4 +50,40 @@ f64 time_now() {
     return static_cast<f64>(now.QuadPart) / freq.QuadPart;
 }
 
+#else
+
+static i64 monotonic_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<i64>(ts.tv_sec) * 1000000000ll + ts.tv_nsec;
+}
+
+void time_init(TimeState* state) {
+    i64 now = monotonic_ns();
+    state->frequency = 1000000000ll;
+    state->start_time = now;
+    state->last_time = now;
+    state->total_time = 0;
+    state->timing = {};
+}
+
+void time_update(TimeState* state) {
+    i64 now = monotonic_ns();
+
+    f64 dt = static_cast<f64>(now - state->last_time) / state->frequency;
+    state->last_time = now;
+    state->total_time += dt;
+
+    state->timing.delta_time = dt;
+    state->timing.total_time = state->total_time;
+    state->timing.frame_time_ms = dt * 1000.0;
+    state->timing.fps = (dt > 0) ? 1.0 / dt : 0;
+}
+
+f64 time_now() {
+    return static_cast<f64>(monotonic_ns()) * 1e-9;
+}
+
+#endif
+
 }
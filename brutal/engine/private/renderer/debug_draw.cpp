@@ -1,6 +1,8 @@
 #include "brutal/renderer/debug_draw.h"
 #include "brutal/renderer/shader.h"
 #include "brutal/renderer/camera.h"
+#include "brutal/renderer/stream_buffer.h"
+#include "brutal/renderer/render_backend.h"
 #include "brutal/core/logging.h"
 #include <glad/glad.h>
 #include <cstdio>
@@ -183,26 +185,78 @@ struct TextVert { f32 x, y, u, v, r, g, b; };
 struct LineVert { f32 x, y, z, r, g, b; };
 struct Line2DVert { f32 x, y, r, g, b; };
 
+// Vertices one flush can draw of each kind
+static constexpr u32 TEXT_MAX_VERTS = 4096;
+static constexpr u32 LINE_MAX_VERTS = 8192;
+static constexpr u32 LINE2D_MAX_VERTS = 4096;
+// Flushes of a full batch each stream segment holds before it moves on
+static constexpr u32 BATCHES_PER_SEGMENT = 2;
+
+// Vertices are written straight into the stream's open write and drawn from
+// where they landed. The arrays stage them when the buffer cannot stay mapped.
+struct DebugBatch {
+    StreamBuffer stream;
+    u8* write;
+    u32 stride;
+    u32 max_verts;
+    u32 count;
+    u32 capacity;
+};
+
 static Shader g_text_shader;
 static u32 g_font_texture;
-static u32 g_text_vao, g_text_vbo;
-static TextVert g_text_verts[4096];
-static u32 g_text_count;
+static u32 g_text_vao;
+static TextVert g_text_verts[TEXT_MAX_VERTS];
+static DebugBatch g_text;
 static i32 g_text_loc_screen, g_text_loc_texture;
 
 static Shader g_line_shader;
-static u32 g_line_vao, g_line_vbo;
-static LineVert g_line_verts[8192];
-static u32 g_line_count;
+static u32 g_line_vao;
+static LineVert g_line_verts[LINE_MAX_VERTS];
+static DebugBatch g_line;
 static i32 g_line_loc_viewproj;
 
 static Shader g_line2d_shader;
-static u32 g_line2d_vao, g_line2d_vbo;
-static Line2DVert g_line2d_verts[4096];
-static u32 g_line2d_count;
+static u32 g_line2d_vao;
+static Line2DVert g_line2d_verts[LINE2D_MAX_VERTS];
+static DebugBatch g_line2d;
 static i32 g_line2d_loc_screen;
 
+static bool batch_create(DebugBatch* b, void* staging, u32 stride, u32 max_verts) {
+    *b = {};
+    b->stride = stride;
+    b->max_verts = max_verts;
+    return stream_buffer_create(&b->stream, GL_ARRAY_BUFFER, stride * max_verts * BATCHES_PER_SEGMENT, staging,
+        stride * max_verts);
+}
+
+// Room for n more vertices in the open write, opening one if needed. A batch
+// never created (no GL) takes nothing, so nothing reaches its flush.
+static void* batch_reserve(DebugBatch* b, u32 n) {
+    if (!b->max_verts) return nullptr;
+    if (!b->write) {
+        b->write = static_cast<u8*>(stream_buffer_begin(&b->stream, b->stride, b->max_verts, &b->capacity));
+        if (b->capacity > b->max_verts) b->capacity = b->max_verts;
+        b->count = 0;
+        if (!b->write) return nullptr;
+    }
+    if (b->count + n > b->capacity) return nullptr;
+    void* v = b->write + b->count * b->stride;
+    b->count += n;
+    return v;
+}
+
+// Closes the open write; returns the first vertex to draw
+static u32 batch_commit(DebugBatch* b) {
+    u32 offset = stream_buffer_commit(&b->stream, b->count);
+    b->write = nullptr;
+    b->count = 0;
+    return offset / b->stride;
+}
+
+// Debug text and lines are drawn with GL only; other backends drop them
 bool debug_draw_init() {
+    if (!render_backend_uses_gl()) return true;
     if (!shader_create(&g_text_shader, text_vert, text_frag)) return false;
     g_text_loc_screen = glGetUniformLocation(g_text_shader.program, "u_Screen");
     g_text_loc_texture = glGetUniformLocation(g_text_shader.program, "u_Texture");
@@ -225,9 +279,8 @@ bool debug_draw_init() {
 
     glGenVertexArrays(1, &g_text_vao);
     glBindVertexArray(g_text_vao);
-    glGenBuffers(1, &g_text_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, g_text_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(g_text_verts), nullptr, GL_DYNAMIC_DRAW);
+    if (!batch_create(&g_text, g_text_verts, sizeof(TextVert), TEXT_MAX_VERTS)) return false;
+    glBindBuffer(GL_ARRAY_BUFFER, g_text.stream.buffer);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(TextVert), (void*)0);
     glEnableVertexAttribArray(1);
@@ -235,67 +288,63 @@ bool debug_draw_init() {
     glEnableVertexAttribArray(2);
     glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(TextVert), (void*)16);
     glBindVertexArray(0);
-    g_text_count = 0;
 
     if (!shader_create(&g_line_shader, line_vert, line_frag)) return false;
     g_line_loc_viewproj = glGetUniformLocation(g_line_shader.program, "u_ViewProj");
 
     glGenVertexArrays(1, &g_line_vao);
     glBindVertexArray(g_line_vao);
-    glGenBuffers(1, &g_line_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, g_line_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(g_line_verts), nullptr, GL_DYNAMIC_DRAW);
+    if (!batch_create(&g_line, g_line_verts, sizeof(LineVert), LINE_MAX_VERTS)) return false;
+    glBindBuffer(GL_ARRAY_BUFFER, g_line.stream.buffer);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(LineVert), (void*)0);
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(LineVert), (void*)12);
     glBindVertexArray(0);
-    g_line_count = 0;
 
     if (!shader_create(&g_line2d_shader, line2d_vert, line2d_frag)) return false;
     g_line2d_loc_screen = glGetUniformLocation(g_line2d_shader.program, "u_Screen");
     glGenVertexArrays(1, &g_line2d_vao);
     glBindVertexArray(g_line2d_vao);
-    glGenBuffers(1, &g_line2d_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, g_line2d_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(g_line2d_verts), nullptr, GL_DYNAMIC_DRAW);
+    if (!batch_create(&g_line2d, g_line2d_verts, sizeof(Line2DVert), LINE2D_MAX_VERTS)) return false;
+    glBindBuffer(GL_ARRAY_BUFFER, g_line2d.stream.buffer);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Line2DVert), (void*)0);
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Line2DVert), (void*)(2 * sizeof(f32)));
     glBindVertexArray(0);
-    g_line2d_count = 0;
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     return true;
 }
 
 void debug_draw_shutdown() {
+    if (!render_backend_uses_gl()) return;
     glDeleteTextures(1, &g_font_texture);
-    glDeleteBuffers(1, &g_text_vbo);
+    stream_buffer_destroy(&g_text.stream);
     glDeleteVertexArrays(1, &g_text_vao);
     shader_destroy(&g_text_shader);
-    glDeleteBuffers(1, &g_line_vbo);
+    stream_buffer_destroy(&g_line.stream);
     glDeleteVertexArrays(1, &g_line_vao);
     shader_destroy(&g_line_shader);
-    glDeleteBuffers(1, &g_line2d_vbo);
+    stream_buffer_destroy(&g_line2d.stream);
     glDeleteVertexArrays(1, &g_line2d_vao);
     shader_destroy(&g_line2d_shader);
 }
 
 static void add_char(f32 x, f32 y, char c, const Vec3& col) {
-    if (g_text_count + 6 > 4096) return;
+    TextVert* v = static_cast<TextVert*>(batch_reserve(&g_text, 6));
+    if (!v) return;
     int ci = c - 32;
     if (ci < 0 || ci >= 95) ci = 0;
     f32 u0 = (ci % 16) * 8.0f / 128.0f, v0 = (ci / 16) * 8.0f / 128.0f;
     f32 u1 = u0 + 8.0f / 128.0f, v1 = v0 + 8.0f / 128.0f;
-    TextVert* v = &g_text_verts[g_text_count];
     v[0] = {x, y, u0, v0, col.x, col.y, col.z};
     v[1] = {x+8, y, u1, v0, col.x, col.y, col.z};
     v[2] = {x+8, y+8, u1, v1, col.x, col.y, col.z};
     v[3] = {x, y, u0, v0, col.x, col.y, col.z};
     v[4] = {x+8, y+8, u1, v1, col.x, col.y, col.z};
     v[5] = {x, y+8, u0, v1, col.x, col.y, col.z};
-    g_text_count += 6;
 }
 
 void debug_text_printf(i32 x, i32 y, const Vec3& col, const char* fmt, ...) {
@@ -309,54 +358,50 @@ void debug_text_printf(i32 x, i32 y, const Vec3& col, const char* fmt, ...) {
 }
 
 void debug_text_flush(i32 sw, i32 sh) {
-    if (g_text_count == 0) return;
+    if (g_text.count == 0) return;
+    u32 count = g_text.count;
+    u32 first = batch_commit(&g_text);
     glDisable(GL_DEPTH_TEST);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glBindBuffer(GL_ARRAY_BUFFER, g_text_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, g_text_count * sizeof(TextVert), g_text_verts);
     shader_bind(&g_text_shader);
     if (g_text_loc_screen >= 0) glUniform2f(g_text_loc_screen, (f32)sw, (f32)sh);
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, g_font_texture);
     if (g_text_loc_texture >= 0) glUniform1i(g_text_loc_texture, 0);
     glBindVertexArray(g_text_vao);
-    glDrawArrays(GL_TRIANGLES, 0, g_text_count);
+    glDrawArrays(GL_TRIANGLES, first, count);
     glBindVertexArray(0);
     glDisable(GL_BLEND);
     glEnable(GL_DEPTH_TEST);
-    g_text_count = 0;
 }
 
 void debug_line_2d(const Vec2& a, const Vec2& b, const Vec3& color) {
-    if (g_line2d_count + 2 > 4096) return;
-    Line2DVert* v = &g_line2d_verts[g_line2d_count];
+    Line2DVert* v = static_cast<Line2DVert*>(batch_reserve(&g_line2d, 2));
+    if (!v) return;
     v[0] = { a.x, a.y, color.x, color.y, color.z };
     v[1] = { b.x, b.y, color.x, color.y, color.z };
-    g_line2d_count += 2;
 }
 
 void debug_lines_flush_2d(i32 screen_w, i32 screen_h) {
-    if (g_line2d_count == 0) return;
+    if (g_line2d.count == 0) return;
+    u32 count = g_line2d.count;
+    u32 first = batch_commit(&g_line2d);
     glDisable(GL_DEPTH_TEST);
     glLineWidth(1.0f);
-    glBindBuffer(GL_ARRAY_BUFFER, g_line2d_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, g_line2d_count * sizeof(Line2DVert), g_line2d_verts);
     shader_bind(&g_line2d_shader);
     if (g_line2d_loc_screen >= 0) glUniform2f(g_line2d_loc_screen, (f32)screen_w, (f32)screen_h);
     glBindVertexArray(g_line2d_vao);
-    glDrawArrays(GL_LINES, 0, g_line2d_count);
+    glDrawArrays(GL_LINES, first, count);
     glBindVertexArray(0);
     glEnable(GL_DEPTH_TEST);
-    g_line2d_count = 0;
 }
 
 void debug_line(const Vec3& a, const Vec3& b, const Vec3& color) {
-    if (g_line_count + 2 > 8192) return;
-    LineVert* v = &g_line_verts[g_line_count];
+    LineVert* v = static_cast<LineVert*>(batch_reserve(&g_line, 2));
+    if (!v) return;
     v[0] = {a.x, a.y, a.z, color.x, color.y, color.z};
     v[1] = {b.x, b.y, b.z, color.x, color.y, color.z};
-    g_line_count += 2;
 }
 
 void debug_box(const AABB& box, const Vec3& color) {
@@ -381,36 +426,34 @@ void debug_wire_box(const Vec3& center, const Vec3& size, const Vec3& color) {
 }
 
 void debug_lines_flush(const Camera* camera, i32 screen_w, i32 screen_h) {
-    if (g_line_count == 0) return;
+    if (g_line.count == 0) return;
+    u32 count = g_line.count;
+    u32 first = batch_commit(&g_line);
     glDisable(GL_DEPTH_TEST);
     glLineWidth(1.0f);
-    glBindBuffer(GL_ARRAY_BUFFER, g_line_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, g_line_count * sizeof(LineVert), g_line_verts);
     shader_bind(&g_line_shader);
     Mat4 view = camera_view_matrix(camera);
     Mat4 proj = camera_projection_matrix(camera, (f32)screen_w / (f32)screen_h);
     Mat4 vp = mat4_multiply(proj, view);
     if (g_line_loc_viewproj >= 0) glUniformMatrix4fv(g_line_loc_viewproj, 1, GL_FALSE, vp.m);
     glBindVertexArray(g_line_vao);
-    glDrawArrays(GL_LINES, 0, g_line_count);
+    glDrawArrays(GL_LINES, first, count);
     glBindVertexArray(0);
     glEnable(GL_DEPTH_TEST);
-    g_line_count = 0;
 }
 void debug_lines_flush_matrix(const Mat4& view, const Mat4& projection) {
-    if (g_line_count == 0) return;
+    if (g_line.count == 0) return;
+    u32 count = g_line.count;
+    u32 first = batch_commit(&g_line);
     glDisable(GL_DEPTH_TEST);
     glLineWidth(1.0f);
-    glBindBuffer(GL_ARRAY_BUFFER, g_line_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, g_line_count * sizeof(LineVert), g_line_verts);
     shader_bind(&g_line_shader);
     Mat4 vp = mat4_multiply(projection, view);
     if (g_line_loc_viewproj >= 0) glUniformMatrix4fv(g_line_loc_viewproj, 1, GL_FALSE, vp.m);
     glBindVertexArray(g_line_vao);
-    glDrawArrays(GL_LINES, 0, g_line_count);
+    glDrawArrays(GL_LINES, first, count);
     glBindVertexArray(0);
     glEnable(GL_DEPTH_TEST);
-    g_line_count = 0;
 }
 
 }
@@ -1,9 +1,23 @@
 #include "brutal/renderer/gl_context.h"
 #include "brutal/core/logging.h"
 #include <glad/glad.h>
+#include <cstring>
 
 namespace brutal {
 
+static bool g_buffer_storage = false;
+
+static bool has_extension(const char* name) {
+    if (!glGetStringi) return false;
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+        const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (ext && !strcmp(ext, name)) return true;
+    }
+    return false;
+}
+
 bool gl_init() {
     if (!gladLoadGL()) {
         LOG_ERROR("Failed to load OpenGL");
@@ -11,7 +25,18 @@ bool gl_init() {
     }
     LOG_INFO("OpenGL: %s", glGetString(GL_VERSION));
     LOG_INFO("Renderer: %s", glGetString(GL_RENDERER));
+
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    bool core_storage = major > 4 || (major == 4 && minor >= 4);
+    g_buffer_storage = glBufferStorage && (core_storage || has_extension("GL_ARB_buffer_storage"));
+    LOG_INFO("Streaming: %s", g_buffer_storage ? "persistent mapped buffers" : "fenced buffer updates");
     return true;
 }
 
+bool gl_has_buffer_storage() {
+    return g_buffer_storage;
+}
+
 }
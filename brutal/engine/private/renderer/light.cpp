@@ -1,32 +1,52 @@
 #include "brutal/renderer/light.h"
+#include "brutal/core/memory.h"
+#include <cstring>
 
 namespace brutal {
 
-void light_environment_init(LightEnvironment* env) {
+static constexpr u32 INITIAL_POINT_LIGHTS = 16;
+static constexpr u32 INITIAL_SPOT_LIGHTS = 8;
+
+bool light_environment_init(LightEnvironment* env, MemoryArena* arena) {
+    *env = {};
     env->ambient_color = Vec3(0.1f, 0.1f, 0.15f);
     env->ambient_intensity = 1.0f;
-    env->point_light_count = 0;
-    for (u32 i = 0; i < MAX_POINT_LIGHTS; i++) {
-        env->point_lights[i].active = false;
-        env->point_lights[i].rotation = Vec3(0.0f, 0.0f, 0.0f);
-        env->point_lights[i].scale = Vec3(1.0f, 1.0f, 1.0f);
-    }
-    env->spot_light_count = 0;
-    for (u32 i = 0; i < MAX_SPOT_LIGHTS; i++) env->spot_lights[i].active = false;
+    env->arena = arena;
+    return light_environment_reserve(env, INITIAL_POINT_LIGHTS, INITIAL_SPOT_LIGHTS);
 }
 
 void light_environment_clear(LightEnvironment* env) {
     env->point_light_count = 0;
-    for (u32 i = 0; i < MAX_POINT_LIGHTS; i++) {
-        env->point_lights[i].active = false;
-        env->point_lights[i].rotation = Vec3(0.0f, 0.0f, 0.0f);
-        env->point_lights[i].scale = Vec3(1.0f, 1.0f, 1.0f);
-    }    env->spot_light_count = 0;
-    for (u32 i = 0; i < MAX_SPOT_LIGHTS; i++) env->spot_lights[i].active = false;
+    env->spot_light_count = 0;
+    handle_table_clear(&env->point_handles);
+    handle_table_clear(&env->spot_handles);
+}
+
+bool light_environment_reserve(LightEnvironment* env, u32 point_capacity, u32 spot_capacity) {
+    if (!env->arena) return false;
+    if (point_capacity > env->point_light_capacity) {
+        PointLight* lights = arena_alloc_array<PointLight>(env->arena, point_capacity);
+        if (!lights || !handle_table_reserve(&env->point_handles, env->arena, point_capacity)) return false;
+        if (env->point_light_count) memcpy(lights, env->point_lights, sizeof(PointLight) * env->point_light_count);
+        env->point_lights = lights;
+        env->point_light_capacity = point_capacity;
+    }
+    if (spot_capacity > env->spot_light_capacity) {
+        SpotLight* lights = arena_alloc_array<SpotLight>(env->arena, spot_capacity);
+        if (!lights || !handle_table_reserve(&env->spot_handles, env->arena, spot_capacity)) return false;
+        if (env->spot_light_count) memcpy(lights, env->spot_lights, sizeof(SpotLight) * env->spot_light_count);
+        env->spot_lights = lights;
+        env->spot_light_capacity = spot_capacity;
+    }
+    return true;
 }
 
 PointLight* light_environment_add_point(LightEnvironment* env, const Vec3& pos, const Vec3& color, f32 radius, f32 intensity) {
-    if (env->point_light_count >= MAX_POINT_LIGHTS) return nullptr;
+    if (env->point_light_count >= env->point_light_capacity &&
+        !light_environment_reserve(env, env->point_light_capacity ? env->point_light_capacity * 2 : INITIAL_POINT_LIGHTS, 0)) {
+        return nullptr;
+    }
+    handle_table_add<PointLight>(&env->point_handles, env->point_light_count);
     PointLight* l = &env->point_lights[env->point_light_count++];
     l->position = pos;
     l->rotation = Vec3(0.0f, 0.0f, 0.0f);
@@ -47,7 +67,11 @@ SpotLight* light_environment_add_spot(LightEnvironment* env,
     f32 outer_cos,
     f32 intensity,
     f32 falloff) {
-    if (env->spot_light_count >= MAX_SPOT_LIGHTS) return nullptr;
+    if (env->spot_light_count >= env->spot_light_capacity &&
+        !light_environment_reserve(env, 0, env->spot_light_capacity ? env->spot_light_capacity * 2 : INITIAL_SPOT_LIGHTS)) {
+        return nullptr;
+    }
+    handle_table_add<SpotLight>(&env->spot_handles, env->spot_light_count);
     SpotLight* l = &env->spot_lights[env->spot_light_count++];
     l->position = pos;
     l->direction = direction;
@@ -61,4 +85,48 @@ SpotLight* light_environment_add_spot(LightEnvironment* env,
     return l;
 }
 
+PointLightHandle light_environment_point_handle(const LightEnvironment* env, u32 index) {
+    if (index >= env->point_light_count) return PointLightHandle{};
+    return handle_table_handle<PointLight>(&env->point_handles, index);
+}
+
+SpotLightHandle light_environment_spot_handle(const LightEnvironment* env, u32 index) {
+    if (index >= env->spot_light_count) return SpotLightHandle{};
+    return handle_table_handle<SpotLight>(&env->spot_handles, index);
+}
+
+u32 light_environment_point_index(const LightEnvironment* env, PointLightHandle h) {
+    return handle_table_find(&env->point_handles, h);
+}
+
+u32 light_environment_spot_index(const LightEnvironment* env, SpotLightHandle h) {
+    return handle_table_find(&env->spot_handles, h);
+}
+
+PointLight* light_environment_get_point(LightEnvironment* env, PointLightHandle h) {
+    u32 index = handle_table_find(&env->point_handles, h);
+    return index == HANDLE_NONE ? nullptr : &env->point_lights[index];
+}
+
+SpotLight* light_environment_get_spot(LightEnvironment* env, SpotLightHandle h) {
+    u32 index = handle_table_find(&env->spot_handles, h);
+    return index == HANDLE_NONE ? nullptr : &env->spot_lights[index];
+}
+
+bool light_environment_remove_point(LightEnvironment* env, PointLightHandle h) {
+    u32 index = handle_table_find(&env->point_handles, h);
+    if (index == HANDLE_NONE) return false;
+    handle_table_remove(&env->point_handles, index, env->point_light_count);
+    env->point_lights[index] = env->point_lights[--env->point_light_count];
+    return true;
+}
+
+bool light_environment_remove_spot(LightEnvironment* env, SpotLightHandle h) {
+    u32 index = handle_table_find(&env->spot_handles, h);
+    if (index == HANDLE_NONE) return false;
+    handle_table_remove(&env->spot_handles, index, env->spot_light_count);
+    env->spot_lights[index] = env->spot_lights[--env->spot_light_count];
+    return true;
+}
+
 }
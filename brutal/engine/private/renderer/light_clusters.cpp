@@ -0,0 +1,223 @@
+#include "brutal/renderer/light_clusters.h"
+#include "brutal/renderer/light.h"
+#include "brutal/core/jobs.h"
+#include "brutal/core/memory.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace brutal {
+
+// Below this many lights a serial build beats waking the workers
+static constexpr u32 CLUSTER_PARALLEL_LIGHTS = 64;
+
+bool light_clusters_create(LightClusters* c, MemoryArena* arena) {
+    *c = {};
+    c->light_data = arena_alloc_array<f32>(arena, CLUSTER_LIGHT_CAPACITY * CLUSTER_LIGHT_FLOATS);
+    c->sphere_x = arena_alloc_array<f32>(arena, CLUSTER_LIGHT_CAPACITY);
+    c->sphere_y = arena_alloc_array<f32>(arena, CLUSTER_LIGHT_CAPACITY);
+    c->sphere_z = arena_alloc_array<f32>(arena, CLUSTER_LIGHT_CAPACITY);
+    c->sphere_r = arena_alloc_array<f32>(arena, CLUSTER_LIGHT_CAPACITY);
+    c->bound_x = arena_alloc_array<f32>(arena, CLUSTER_LIGHT_CAPACITY);
+    c->bound_y = arena_alloc_array<f32>(arena, CLUSTER_LIGHT_CAPACITY);
+    c->bound_z = arena_alloc_array<f32>(arena, CLUSTER_LIGHT_CAPACITY);
+    c->bound_r = arena_alloc_array<f32>(arena, CLUSTER_LIGHT_CAPACITY);
+    c->staging = arena_alloc_array<f32>(arena, CLUSTER_LIGHT_CAPACITY * CLUSTER_LIGHT_FLOATS);
+    c->order = arena_alloc_array<u16>(arena, CLUSTER_LIGHT_CAPACITY);
+    c->grid = arena_alloc_array<u32>(arena, CLUSTER_COUNT);
+    c->indices = arena_alloc_array<u16>(arena, CLUSTER_COUNT * CLUSTER_MAX_LIGHTS);
+    c->scratch = arena_alloc_array<u16>(arena, CLUSTER_COUNT * CLUSTER_MAX_LIGHTS);
+    c->scratch_counts = arena_alloc_array<u8>(arena, CLUSTER_COUNT);
+    if (!c->light_data || !c->sphere_x || !c->sphere_y || !c->sphere_z || !c->sphere_r || !c->bound_x || !c->bound_y || !c->bound_z || !c->bound_r || !c->staging || !c->order || !c->grid ||
+        !c->indices || !c->scratch || !c->scratch_counts) {
+        *c = {};
+        return false;
+    }
+    memset(c->grid, 0, sizeof(u32) * CLUSTER_COUNT);
+    return true;
+}
+
+static f32* pack_light(LightClusters* c, const Vec3& pos, f32 range, const Vec3& color, f32 intensity) {
+    f32* d = &c->staging[c->light_count * CLUSTER_LIGHT_FLOATS];
+    memset(d, 0, sizeof(f32) * CLUSTER_LIGHT_FLOATS);
+    d[0] = pos.x;
+    d[1] = pos.y;
+    d[2] = pos.z;
+    d[3] = range;
+    d[4] = color.x;
+    d[5] = color.y;
+    d[6] = color.z;
+    d[7] = intensity;
+    return d;
+}
+
+// Packing writes the staging arrays; the view-space arrays hold the spheres
+// until sort_lights moves everything into place
+static void set_bound(LightClusters* c, const Vec3& center, f32 radius) {
+    u32 i = c->light_count++;
+    c->bound_x[i] = center.x;
+    c->bound_y[i] = center.y;
+    c->bound_z[i] = center.z;
+    c->bound_r[i] = radius;
+}
+
+// Orders the packed lights and their spheres by world x
+static void sort_lights(LightClusters* c) {
+    for (u32 i = 0; i < c->light_count; i++) c->order[i] = (u16)i;
+    const f32* key = c->bound_x;
+    std::sort(c->order, c->order + c->light_count, [key](u16 a, u16 b) { return key[a] < key[b]; });
+    c->max_radius = 0.0f;
+    for (u32 i = 0; i < c->light_count; i++) {
+        u32 src = c->order[i];
+        memcpy(&c->light_data[i * CLUSTER_LIGHT_FLOATS], &c->staging[src * CLUSTER_LIGHT_FLOATS],
+            sizeof(f32) * CLUSTER_LIGHT_FLOATS);
+        c->sphere_x[i] = c->bound_x[src];
+        c->sphere_y[i] = c->bound_y[src];
+        c->sphere_z[i] = c->bound_z[src];
+        c->sphere_r[i] = c->bound_r[src];
+        if (c->sphere_r[i] > c->max_radius) c->max_radius = c->sphere_r[i];
+    }
+}
+
+// Tightest sphere around a cone of the given length and half angle
+static void cone_bound(const SpotLight& l, Vec3* center, f32* radius) {
+    f32 cos_half = l.outer_cos > 0.0f ? l.outer_cos : 0.0f;
+    if (cos_half < 0.70710678f) {
+        f32 sin_half = sqrtf(1.0f - cos_half * cos_half);
+        *center = l.position + l.direction * (cos_half * l.range);
+        *radius = sin_half * l.range;
+    } else {
+        f32 r = l.range / (2.0f * cos_half);
+        *center = l.position + l.direction * r;
+        *radius = r;
+    }
+}
+
+// World spheres to view space; depth is -z so it grows away from the eye
+static void transform_bounds(LightClusters* c, const Mat4& v) {
+    const f32* sx = c->sphere_x;
+    const f32* sy = c->sphere_y;
+    const f32* sz = c->sphere_z;
+    f32* bx = c->bound_x;
+    f32* by = c->bound_y;
+    f32* bz = c->bound_z;
+    for (u32 i = 0; i < c->light_count; i++) {
+        bx[i] = v.m[0] * sx[i] + v.m[4] * sy[i] + v.m[8] * sz[i] + v.m[12];
+        by[i] = v.m[1] * sx[i] + v.m[5] * sy[i] + v.m[9] * sz[i] + v.m[13];
+        bz[i] = -(v.m[2] * sx[i] + v.m[6] * sy[i] + v.m[10] * sz[i] + v.m[14]);
+    }
+    memcpy(c->bound_r, c->sphere_r, sizeof(f32) * c->light_count);
+}
+
+// Tile range [lo, hi] a slab of a sphere covers along one screen axis, false
+// when it falls outside the frustum
+static bool tile_range(f32 center, f32 radius, f32 near_depth, f32 far_depth, f32 tan_half, u32 tiles, u32* lo,
+    u32* hi) {
+    f32 a = center - radius, b = center + radius;
+    // x / depth is monotonic in both, so the extremes sit on the slab faces
+    f32 min_ndc = fminf(a / near_depth, a / far_depth) / tan_half;
+    f32 max_ndc = fmaxf(b / near_depth, b / far_depth) / tan_half;
+    if (max_ndc < -1.0f || min_ndc > 1.0f) return false;
+    f32 t0 = (min_ndc * 0.5f + 0.5f) * (f32)tiles;
+    f32 t1 = (max_ndc * 0.5f + 0.5f) * (f32)tiles;
+    *lo = t0 <= 0.0f ? 0 : (u32)t0;
+    *hi = t1 >= (f32)(tiles - 1) ? tiles - 1 : (u32)t1;
+    return true;
+}
+
+static void assign_slices(void* user, u32 begin, u32 end) {
+    LightClusters* c = static_cast<LightClusters*>(user);
+    const f32* bx = c->bound_x;
+    const f32* by = c->bound_y;
+    const f32* bz = c->bound_z;
+    const f32* br = c->bound_r;
+    for (u32 slice = begin; slice < end; slice++) {
+        f32 slice_near = slice == 0 ? c->near_plane : expf(((f32)slice - c->depth_bias) / c->depth_scale);
+        f32 slice_far = slice == CLUSTER_GRID_Z - 1 ? INFINITY : expf(((f32)slice + 1.0f - c->depth_bias) / c->depth_scale);
+        u32 base = slice * CLUSTER_GRID_X * CLUSTER_GRID_Y;
+        for (u32 i = 0; i < c->light_count; i++) {
+            if (bz[i] + br[i] < slice_near || bz[i] - br[i] > slice_far) continue;
+            f32 d0 = fmaxf(bz[i] - br[i], slice_near);
+            f32 d1 = fminf(bz[i] + br[i], slice_far);
+            u32 x0, x1, y0, y1;
+            if (!tile_range(bx[i], br[i], d0, d1, c->tan_half_x, CLUSTER_GRID_X, &x0, &x1)) continue;
+            if (!tile_range(by[i], br[i], d0, d1, c->tan_half_y, CLUSTER_GRID_Y, &y0, &y1)) continue;
+            for (u32 y = y0; y <= y1; y++) {
+                for (u32 x = x0; x <= x1; x++) {
+                    u32 cell = base + y * CLUSTER_GRID_X + x;
+                    u8& n = c->scratch_counts[cell];
+                    if (n == CLUSTER_MAX_LIGHTS) continue;
+                    c->scratch[cell * CLUSTER_MAX_LIGHTS + n++] = (u16)i;
+                }
+            }
+        }
+    }
+}
+
+void light_clusters_build(LightClusters* c, const LightEnvironment* l, const Mat4& view, const Mat4& projection) {
+    c->tan_half_x = 1.0f / projection.m[0];
+    c->tan_half_y = 1.0f / projection.m[5];
+    c->near_plane = projection.m[14] / (projection.m[10] - 1.0f);
+    c->far_plane = projection.m[14] / (projection.m[10] + 1.0f);
+    c->depth_scale = (f32)CLUSTER_GRID_Z / logf(c->far_plane / c->near_plane);
+    c->depth_bias = -logf(c->near_plane) * c->depth_scale;
+
+    c->light_count = 0;
+    c->index_count = 0;
+    c->full_clusters = 0;
+    memset(c->scratch_counts, 0, CLUSTER_COUNT);
+    if (l) {
+        for (u32 i = 0; i < l->point_light_count && c->light_count < CLUSTER_LIGHT_CAPACITY; i++) {
+            const PointLight& p = l->point_lights[i];
+            if (!p.active || p.intensity <= 0.0f || p.radius <= 0.0f) continue;
+            pack_light(c, p.position, p.radius, p.color, p.intensity);
+            set_bound(c, p.position, p.radius);
+        }
+        for (u32 i = 0; i < l->spot_light_count && c->light_count < CLUSTER_LIGHT_CAPACITY; i++) {
+            const SpotLight& s = l->spot_lights[i];
+            if (!s.active || s.intensity <= 0.0f || s.range <= 0.0f) continue;
+            f32* d = pack_light(c, s.position, s.range, s.color, s.intensity);
+            d[8] = s.direction.x;
+            d[9] = s.direction.y;
+            d[10] = s.direction.z;
+            d[11] = s.inner_cos;
+            d[12] = s.outer_cos;
+            d[13] = s.falloff;
+            d[14] = 1.0f;
+            Vec3 center;
+            f32 radius;
+            cone_bound(s, &center, &radius);
+            set_bound(c, center, radius);
+        }
+    }
+    sort_lights(c);
+    transform_bounds(c, view);
+
+    // Each slice owns its froxels, so slices build independently
+    if (c->light_count >= CLUSTER_PARALLEL_LIGHTS) parallel_for(CLUSTER_GRID_Z, 1, assign_slices, c);
+    else assign_slices(c, 0, CLUSTER_GRID_Z);
+
+    for (u32 cell = 0; cell < CLUSTER_COUNT; cell++) {
+        u32 n = c->scratch_counts[cell];
+        c->grid[cell] = (c->index_count << 8) | n;
+        if (n == CLUSTER_MAX_LIGHTS) c->full_clusters++;
+        if (n) {
+            memcpy(&c->indices[c->index_count], &c->scratch[cell * CLUSTER_MAX_LIGHTS], sizeof(u16) * n);
+            c->index_count += n;
+        }
+    }
+}
+
+u32 light_clusters_index(const LightClusters* c, const Vec3& view_pos) {
+    f32 depth = -view_pos.z;
+    if (depth < c->near_plane) depth = c->near_plane;
+    f32 fx = (view_pos.x / (depth * c->tan_half_x) * 0.5f + 0.5f) * (f32)CLUSTER_GRID_X;
+    f32 fy = (view_pos.y / (depth * c->tan_half_y) * 0.5f + 0.5f) * (f32)CLUSTER_GRID_Y;
+    f32 fz = logf(depth) * c->depth_scale + c->depth_bias;
+    u32 x = fx <= 0.0f ? 0 : fx >= (f32)(CLUSTER_GRID_X - 1) ? CLUSTER_GRID_X - 1 : (u32)fx;
+    u32 y = fy <= 0.0f ? 0 : fy >= (f32)(CLUSTER_GRID_Y - 1) ? CLUSTER_GRID_Y - 1 : (u32)fy;
+    u32 z = fz <= 0.0f ? 0 : fz >= (f32)(CLUSTER_GRID_Z - 1) ? CLUSTER_GRID_Z - 1 : (u32)fz;
+    return (z * CLUSTER_GRID_Y + y) * CLUSTER_GRID_X + x;
+}
+
+}
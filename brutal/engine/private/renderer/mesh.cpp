@@ -1,26 +1,122 @@
 #include "brutal/renderer/mesh.h"
+#include "brutal/renderer/render_backend.h"
 #include <glad/glad.h>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
 
 namespace brutal {
 
-bool mesh_create(Mesh* m, const Vertex* verts, u32 vc, const u32* idx, u32 ic) {
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex must stay 16 bytes");
+
+// Vertices packed per upload call, staged on the stack
+static constexpr u32 PACK_CHUNK = 256;
+
+static AABB vertex_bounds(const Vertex* verts, u32 vc) {
+    AABB b = { verts[0].position, verts[0].position };
+    for (u32 i = 1; i < vc; i++) {
+        const Vec3& p = verts[i].position;
+        b.min = Vec3(fminf(b.min.x, p.x), fminf(b.min.y, p.y), fminf(b.min.z, p.z));
+        b.max = Vec3(fmaxf(b.max.x, p.x), fmaxf(b.max.y, p.y), fmaxf(b.max.z, p.z));
+    }
+    return b;
+}
+
+static u32 vertex_size(VertexFormat format) {
+    return format == VERTEX_FORMAT_PACKED ? sizeof(PackedVertex) : sizeof(Vertex);
+}
+
+// Attribute pointers of the bound vertex buffer into the bound VAO
+static void set_vertex_layout(VertexFormat format) {
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    if (format == VERTEX_FORMAT_PACKED) {
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_FALSE, sizeof(PackedVertex), (void*)0);
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex), (void*)8);
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PackedVertex), (void*)12);
+        return;
+    }
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)12);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)24);
+}
+
+// Uploads vertices to the bound buffer in the mesh's format
+static void upload_vertices(const Mesh* m, u32 first, const Vertex* verts, u32 count) {
+    if (m->format != VERTEX_FORMAT_PACKED) {
+        glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(Vertex), count * sizeof(Vertex), verts);
+        return;
+    }
+    PackedVertex packed[PACK_CHUNK];
+    for (u32 done = 0; done < count; done += PACK_CHUNK) {
+        u32 n = count - done < PACK_CHUNK ? count - done : PACK_CHUNK;
+        vertex_pack(verts + done, n, m->origin, m->step, packed);
+        glBufferSubData(GL_ARRAY_BUFFER, (first + done) * sizeof(PackedVertex), n * sizeof(PackedVertex), packed);
+    }
+}
+
+// Stands in for the vao of meshes without GL objects. Ids count up from 1 so
+// a valid mesh never has vao 0.
+static u32 g_mesh_id = 0;
+
+static u32 next_mesh_id() {
+    if (++g_mesh_id == 0) g_mesh_id = 1;
+    return g_mesh_id;
+}
+
+// Memory for a mesh of the software backend
+static bool create_cpu(Mesh* m, u32 vertex_capacity, u32 index_capacity) {
+    m->vao = next_mesh_id();
+    m->cpu_vertices = (Vertex*)malloc(sizeof(Vertex) * (vertex_capacity ? vertex_capacity : 1));
+    m->cpu_indices = (u32*)malloc(sizeof(u32) * (index_capacity ? index_capacity : 1));
+    m->vertex_capacity = vertex_capacity;
+    m->index_capacity = index_capacity;
+    if (m->cpu_vertices && m->cpu_indices) return true;
+    free(m->cpu_vertices);
+    free(m->cpu_indices);
+    *m = {};
+    return false;
+}
+
+static bool create_static(Mesh* m, const Vertex* verts, u32 vc, const u32* idx, u32 ic, bool pack) {
+    *m = {};
     m->vertex_count = vc;
     m->index_count = ic;
+    RenderBackend backend = render_backend();
+    // The null backend takes the GL layout so vertex_bytes counts match
+    if (vc > 0) {
+        m->bounds = vertex_bounds(verts, vc);
+        m->has_bounds = true;
+        if (backend != RENDER_BACKEND_SOFTWARE && pack && vertex_pack_grid(m->bounds, &m->origin, &m->step)) {
+            m->format = VERTEX_FORMAT_PACKED;
+        }
+    }
+    if (backend == RENDER_BACKEND_NULL) {
+        m->vao = next_mesh_id();
+        return true;
+    }
+    if (backend == RENDER_BACKEND_SOFTWARE) {
+        if (!idx) ic = 0;
+        if (!create_cpu(m, vc, ic)) return false;
+        m->index_count = ic;
+        if (vc) memcpy(m->cpu_vertices, verts, sizeof(Vertex) * vc);
+        if (ic) memcpy(m->cpu_indices, idx, sizeof(u32) * ic);
+        return true;
+    }
     
     glGenVertexArrays(1, &m->vao);
     glBindVertexArray(m->vao);
     
     glGenBuffers(1, &m->vbo);
     glBindBuffer(GL_ARRAY_BUFFER, m->vbo);
-    glBufferData(GL_ARRAY_BUFFER, vc * sizeof(Vertex), verts, GL_STATIC_DRAW);
-    
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)12);
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)24);
+    if (m->format == VERTEX_FORMAT_PACKED) {
+        glBufferData(GL_ARRAY_BUFFER, vc * sizeof(PackedVertex), nullptr, GL_STATIC_DRAW);
+        upload_vertices(m, 0, verts, vc);
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, vc * sizeof(Vertex), verts, GL_STATIC_DRAW);
+    }
+    set_vertex_layout(m->format);
     
     if (idx && ic > 0) {
         glGenBuffers(1, &m->ibo);
@@ -32,14 +128,154 @@ bool mesh_create(Mesh* m, const Vertex* verts, u32 vc, const u32* idx, u32 ic) {
     return true;
 }
 
+bool mesh_create(Mesh* m, const Vertex* verts, u32 vc, const u32* idx, u32 ic) {
+    return create_static(m, verts, vc, idx, ic, false);
+}
+
+bool mesh_create_packed(Mesh* m, const Vertex* verts, u32 vc, const u32* idx, u32 ic) {
+    return create_static(m, verts, vc, idx, ic, true);
+}
+
+static bool create_dynamic(Mesh* m, u32 vertex_capacity, u32 index_capacity, const AABB* range) {
+    *m = {};
+    RenderBackend backend = render_backend();
+    if (backend == RENDER_BACKEND_SOFTWARE) return create_cpu(m, vertex_capacity, index_capacity);
+    if (range && vertex_pack_grid(*range, &m->origin, &m->step)) m->format = VERTEX_FORMAT_PACKED;
+    if (backend == RENDER_BACKEND_NULL) {
+        m->vao = next_mesh_id();
+        return true;
+    }
+
+    glGenVertexArrays(1, &m->vao);
+    glBindVertexArray(m->vao);
+
+    glGenBuffers(1, &m->vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, m->vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertex_capacity * vertex_size(m->format), nullptr, GL_DYNAMIC_DRAW);
+    set_vertex_layout(m->format);
+
+    glGenBuffers(1, &m->ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m->ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_capacity * sizeof(u32), nullptr, GL_DYNAMIC_DRAW);
+
+    glBindVertexArray(0);
+    return true;
+}
+
+bool mesh_create_dynamic(Mesh* m, u32 vertex_capacity, u32 index_capacity) {
+    return create_dynamic(m, vertex_capacity, index_capacity, nullptr);
+}
+
+bool mesh_create_dynamic_packed(Mesh* m, u32 vertex_capacity, u32 index_capacity, const AABB& range) {
+    return create_dynamic(m, vertex_capacity, index_capacity, &range);
+}
+
+void mesh_update_vertices(Mesh* m, u32 first, const Vertex* verts, u32 count) {
+    if (!count) return;
+    if (!m->vbo) {
+        if (m->cpu_vertices && first + count <= m->vertex_capacity) {
+            memcpy(m->cpu_vertices + first, verts, sizeof(Vertex) * count);
+        }
+        return;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, m->vbo);
+    upload_vertices(m, first, verts, count);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void mesh_update_indices(Mesh* m, u32 first, const u32* idx, u32 count) {
+    if (!count) return;
+    if (!m->vbo) {
+        if (m->cpu_indices && first + count <= m->index_capacity) memcpy(m->cpu_indices + first, idx, sizeof(u32) * count);
+        return;
+    }
+    // Bound through the VAO so the element binding it records is not disturbed
+    glBindVertexArray(m->vao);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, first * sizeof(u32), count * sizeof(u32), idx);
+    glBindVertexArray(0);
+}
+
 void mesh_destroy(Mesh* m) {
+    if (!m->vbo) {
+        free(m->cpu_vertices);
+        free(m->cpu_indices);
+        *m = {};
+        return;
+    }
     if (m->ibo) glDeleteBuffers(1, &m->ibo);
     if (m->vbo) glDeleteBuffers(1, &m->vbo);
     if (m->vao) glDeleteVertexArrays(1, &m->vao);
     *m = {};
 }
 
+bool mesh_contains(const Mesh* m, const AABB& box) {
+    if (m->format != VERTEX_FORMAT_PACKED) return true;
+    f32 span = 65535.0f * m->step;
+    return box.min.x >= m->origin.x && box.min.y >= m->origin.y && box.min.z >= m->origin.z &&
+        box.max.x <= m->origin.x + span && box.max.y <= m->origin.y + span && box.max.z <= m->origin.z + span;
+}
+
+Mat4 mesh_draw_matrix(const Mesh* m, const Mat4& model) {
+    if (m->format != VERTEX_FORMAT_PACKED) return model;
+    // model * translation(origin) * scale(step)
+    Mat4 r = model;
+    for (u32 i = 0; i < 4; i++) {
+        r.m[12 + i] = model.m[i] * m->origin.x + model.m[4 + i] * m->origin.y + model.m[8 + i] * m->origin.z + model.m[12 + i];
+    }
+    for (u32 i = 0; i < 12; i++) r.m[i] *= m->step;
+    return r;
+}
+
+u32 mesh_vertex_size(const Mesh* m) {
+    return vertex_size(m->format);
+}
+
+// =============================================================================
+// Vertex packing
+// =============================================================================
+bool vertex_pack_grid(const AABB& range, Vec3* origin, f32* step) {
+    for (f32 s = 1.0f / 65536.0f; s <= PACKED_MAX_STEP; s *= 2.0f) {
+        Vec3 o(floorf(range.min.x / s) * s, floorf(range.min.y / s) * s, floorf(range.min.z / s) * s);
+        Vec3 extent = range.max - o;
+        if (fmaxf(extent.x, fmaxf(extent.y, extent.z)) <= 65535.0f * s) {
+            *origin = o;
+            *step = s;
+            return true;
+        }
+    }
+    return false;
+}
+
+static u16 pack_position(f32 v, f32 origin, f32 inv_step) {
+    f32 q = floorf((v - origin) * inv_step + 0.5f);
+    return (u16)(q < 0.0f ? 0.0f : (q > 65535.0f ? 65535.0f : q));
+}
+
+static u32 pack_snorm10(f32 v) {
+    f32 q = floorf((v < -1.0f ? -1.0f : (v > 1.0f ? 1.0f : v)) * 511.0f + 0.5f);
+    return (u32)(i32)q & 0x3FF;
+}
+
+static u32 pack_unorm8(f32 v) {
+    return (u32)floorf((v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v)) * 255.0f + 0.5f);
+}
+
+void vertex_pack(const Vertex* in, u32 count, const Vec3& origin, f32 step, PackedVertex* out) {
+    f32 inv = 1.0f / step;
+    for (u32 i = 0; i < count; i++) {
+        const Vertex& v = in[i];
+        PackedVertex& p = out[i];
+        p.position[0] = pack_position(v.position.x, origin.x, inv);
+        p.position[1] = pack_position(v.position.y, origin.y, inv);
+        p.position[2] = pack_position(v.position.z, origin.z, inv);
+        p.pad = 0;
+        p.normal = pack_snorm10(v.normal.x) | (pack_snorm10(v.normal.y) << 10) | (pack_snorm10(v.normal.z) << 20);
+        p.color = pack_unorm8(v.color.x) | (pack_unorm8(v.color.y) << 8) | (pack_unorm8(v.color.z) << 16) | (255u << 24);
+    }
+}
+
 void mesh_draw(const Mesh* m) {
+    if (!m->vbo) return;
     glBindVertexArray(m->vao);
     if (m->index_count > 0) {
         glDrawElements(GL_TRIANGLES, m->index_count, GL_UNSIGNED_INT, 0);
@@ -70,7 +306,7 @@ Mesh mesh_create_cube() {
         12,13,14,14,15,12, 16,17,18,18,19,16, 20,22,21,22,20,23
     };
     Mesh m;
-    mesh_create(&m, v, 24, idx, 36);
+    mesh_create_packed(&m, v, 24, idx, 36);
     return m;
 }
 
@@ -89,7 +325,7 @@ Mesh mesh_create_grid(f32 size, i32 divs) {
         verts[idx++] = {{half, 0, p}, {0,1,0}, c};
     }
     Mesh m;
-    mesh_create(&m, verts, lines, nullptr, 0);
+    mesh_create_packed(&m, verts, lines, nullptr, 0);
     free(verts);
     return m;
 }
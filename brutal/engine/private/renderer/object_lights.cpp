@@ -0,0 +1,96 @@
+#include "brutal/renderer/object_lights.h"
+#include "brutal/renderer/light_clusters.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace brutal {
+
+// Lights tested per pass over the component arrays
+static constexpr u32 CULL_BLOCK = 256;
+
+AABB aabb_transform(const AABB& b, const Mat4& m) {
+    Vec3 c = (b.min + b.max) * 0.5f;
+    Vec3 e = (b.max - b.min) * 0.5f;
+    Vec3 wc(m.m[0] * c.x + m.m[4] * c.y + m.m[8] * c.z + m.m[12],
+        m.m[1] * c.x + m.m[5] * c.y + m.m[9] * c.z + m.m[13],
+        m.m[2] * c.x + m.m[6] * c.y + m.m[10] * c.z + m.m[14]);
+    Vec3 we(fabsf(m.m[0]) * e.x + fabsf(m.m[4]) * e.y + fabsf(m.m[8]) * e.z,
+        fabsf(m.m[1]) * e.x + fabsf(m.m[5]) * e.y + fabsf(m.m[9]) * e.z,
+        fabsf(m.m[2]) * e.x + fabsf(m.m[6]) * e.y + fabsf(m.m[10]) * e.z);
+    return { wc - we, wc + we };
+}
+
+// Sphere against the cone of a packed spot light
+static bool cone_reaches(const f32* d, const Vec3& center, f32 radius) {
+    f32 cos_half = d[12];
+    if (cos_half <= 0.0f) return true;
+    Vec3 v(center.x - d[0], center.y - d[1], center.z - d[2]);
+    f32 along = v.x * d[8] + v.y * d[9] + v.z * d[10];
+    if (along > radius + d[3] || along < -radius) return false;
+    f32 across = sqrtf(fmaxf(vec3_dot(v, v) - along * along, 0.0f));
+    f32 sin_half = sqrtf(1.0f - cos_half * cos_half);
+    return cos_half * across - along * sin_half <= radius;
+}
+
+void object_lights_select(const LightClusters* c, const AABB& bounds, ObjectLights* out) {
+    memset(out, 0, sizeof(*out));
+    f32 score[OBJECT_MAX_LIGHTS];
+    u32 chosen[OBJECT_MAX_LIGHTS];
+    u32 n = 0;
+    Vec3 center = aabb_center(bounds);
+    f32 box_radius = vec3_length(aabb_half_size(bounds));
+
+    // Lights are sorted by sphere x, so only those centred within the widest
+    // radius of the box's x extent can touch it
+    f32 lo_x = bounds.min.x - c->max_radius;
+    f32 hi_x = bounds.max.x + c->max_radius;
+    u32 first = (u32)(std::lower_bound(c->sphere_x, c->sphere_x + c->light_count, lo_x) - c->sphere_x);
+    u32 last = (u32)(std::upper_bound(c->sphere_x + first, c->sphere_x + c->light_count, hi_x) - c->sphere_x);
+
+    f32 gap[CULL_BLOCK];
+    for (u32 base = first; base < last; base += CULL_BLOCK) {
+        u32 count = last - base < CULL_BLOCK ? last - base : CULL_BLOCK;
+        const f32* sx = c->sphere_x + base;
+        const f32* sy = c->sphere_y + base;
+        const f32* sz = c->sphere_z + base;
+        const f32* sr = c->sphere_r + base;
+        // Squared distance from each sphere to the box less its squared
+        // radius: branch-free over contiguous floats, negative when they touch
+        for (u32 i = 0; i < count; i++) {
+            f32 dx = fmaxf(fmaxf(bounds.min.x - sx[i], sx[i] - bounds.max.x), 0.0f);
+            f32 dy = fmaxf(fmaxf(bounds.min.y - sy[i], sy[i] - bounds.max.y), 0.0f);
+            f32 dz = fmaxf(fmaxf(bounds.min.z - sz[i], sz[i] - bounds.max.z), 0.0f);
+            gap[i] = dx * dx + dy * dy + dz * dz - sr[i] * sr[i];
+        }
+        for (u32 i = 0; i < count; i++) {
+            if (gap[i] >= 0.0f) continue;
+            u32 light = base + i;
+            const f32* d = &c->light_data[light * CLUSTER_LIGHT_FLOATS];
+            if (d[14] != 0.0f && !cone_reaches(d, center, box_radius)) continue;
+
+            // Contribution at the box point nearest the light, with the
+            // shader's range falloff
+            f32 dx = fmaxf(fmaxf(bounds.min.x - d[0], d[0] - bounds.max.x), 0.0f);
+            f32 dy = fmaxf(fmaxf(bounds.min.y - d[1], d[1] - bounds.max.y), 0.0f);
+            f32 dz = fmaxf(fmaxf(bounds.min.z - d[2], d[2] - bounds.max.z), 0.0f);
+            f32 t = 1.0f - sqrtf(dx * dx + dy * dy + dz * dz) / d[3];
+            if (t < 0.0f) t = 0.0f;
+            f32 s = d[7] * fmaxf(d[4], fmaxf(d[5], d[6])) * t * t;
+
+            if (n == OBJECT_MAX_LIGHTS && s <= score[n - 1]) continue;
+            u32 j = n < OBJECT_MAX_LIGHTS ? n++ : n - 1;
+            for (; j > 0 && score[j - 1] < s; j--) {
+                score[j] = score[j - 1];
+                chosen[j] = chosen[j - 1];
+            }
+            score[j] = s;
+            chosen[j] = light;
+        }
+    }
+
+    for (u32 i = 0; i < n; i++) out->packed[i / 2] |= chosen[i] << ((i & 1) * 16);
+    out->count = n;
+}
+
+}
@@ -0,0 +1,308 @@
+#include "brutal/renderer/occlusion.h"
+#include "brutal/core/jobs.h"
+#include "brutal/core/memory.h"
+#include "brutal/core/time.h"
+#include <cmath>
+#include <cstring>
+
+namespace brutal {
+
+// Tile references the bins can hold; triangles past it are dropped, which
+// only lets more through
+static constexpr u32 TILE_REF_CAPACITY = 1 << 18;
+// Faces are clipped to the near plane and to a guard band twice the screen,
+// which keeps pixel coordinates small enough for float edge functions
+static constexpr f32 GUARD_BAND = 2.0f;
+static constexpr u32 CLIP_PLANES = 5;
+static constexpr u32 CLIP_MAX_VERTS = 4 + CLIP_PLANES;
+
+struct ClipVertex { f32 x, y, w; };
+
+bool occlusion_create(OcclusionBuffer* o, MemoryArena* arena) {
+    memset(o, 0, sizeof(*o));
+    u32 w = OCCLUSION_WIDTH, h = OCCLUSION_HEIGHT;
+    for (u32 l = 0; l < OCCLUSION_MAX_LEVELS; l++) {
+        o->levels[l] = arena_alloc_array<f32>(arena, w * h);
+        if (!o->levels[l]) return false;
+        o->level_width[l] = w;
+        o->level_height[l] = h;
+        o->level_count = l + 1;
+        if (w == 1 && h == 1) break;
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+    }
+    o->triangles = arena_alloc_array<OccluderTriangle>(arena, OCCLUSION_MAX_TRIANGLES);
+    o->tile_first = arena_alloc_array<u32>(arena, OCCLUSION_TILE_COUNT + 1);
+    o->tile_triangles = arena_alloc_array<u16>(arena, TILE_REF_CAPACITY);
+    o->tile_capacity = TILE_REF_CAPACITY;
+    return o->triangles && o->tile_first && o->tile_triangles;
+}
+
+// =============================================================================
+// Setup
+// =============================================================================
+static ClipVertex to_clip(const Mat4& m, f32 x, f32 y, f32 z) {
+    return { m.m[0] * x + m.m[4] * y + m.m[8] * z + m.m[12],
+        m.m[1] * x + m.m[5] * y + m.m[9] * z + m.m[13],
+        m.m[3] * x + m.m[7] * y + m.m[11] * z + m.m[15] };
+}
+
+static f32 clip_distance(const ClipVertex& v, u32 plane, f32 near_plane) {
+    switch (plane) {
+    case 0: return v.w - near_plane;
+    case 1: return GUARD_BAND * v.w - v.x;
+    case 2: return GUARD_BAND * v.w + v.x;
+    case 3: return GUARD_BAND * v.w - v.y;
+    default: return GUARD_BAND * v.w + v.y;
+    }
+}
+
+// Sutherland-Hodgman in clip space; returns the vertices left in poly
+static u32 clip_polygon(ClipVertex* poly, u32 count, f32 near_plane) {
+    ClipVertex out[CLIP_MAX_VERTS];
+    for (u32 plane = 0; plane < CLIP_PLANES; plane++) {
+        u32 n = 0;
+        for (u32 i = 0; i < count; i++) {
+            const ClipVertex& a = poly[i];
+            const ClipVertex& b = poly[(i + 1) % count];
+            f32 da = clip_distance(a, plane, near_plane);
+            f32 db = clip_distance(b, plane, near_plane);
+            if (da >= 0.0f) out[n++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f)) {
+                f32 t = da / (da - db);
+                out[n++] = { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.w + (b.w - a.w) * t };
+            }
+        }
+        if (n < 3) return 0;
+        memcpy(poly, out, sizeof(ClipVertex) * n);
+        count = n;
+    }
+    return count;
+}
+
+static bool setup_triangle(OccluderTriangle* t, const f32* px, const f32* py, const f32* pd, u32 a, u32 b, u32 c) {
+    f32 area = (px[b] - px[a]) * (py[c] - py[a]) - (px[c] - px[a]) * (py[b] - py[a]);
+    if (fabsf(area) < 1e-6f) return false;
+    if (area < 0.0f) {
+        u32 swap = b; b = c; c = swap;
+        area = -area;
+    }
+    const u32 v[3] = { a, b, c };
+    for (u32 e = 0; e < 3; e++) {
+        u32 i = v[e], j = v[(e + 1) % 3];
+        t->edge[e][0] = py[i] - py[j];
+        t->edge[e][1] = px[j] - px[i];
+        t->edge[e][2] = px[i] * py[j] - px[j] * py[i];
+    }
+    f32 dx1 = px[b] - px[a], dy1 = py[b] - py[a], dd1 = pd[b] - pd[a];
+    f32 dx2 = px[c] - px[a], dy2 = py[c] - py[a], dd2 = pd[c] - pd[a];
+    t->depth[0] = (dd1 * dy2 - dd2 * dy1) / area;
+    t->depth[1] = (dd2 * dx1 - dd1 * dx2) / area;
+    t->depth[2] = pd[a] - t->depth[0] * px[a] - t->depth[1] * py[a];
+
+    f32 lo_x = fminf(px[a], fminf(px[b], px[c])), hi_x = fmaxf(px[a], fmaxf(px[b], px[c]));
+    f32 lo_y = fminf(py[a], fminf(py[b], py[c])), hi_y = fmaxf(py[a], fmaxf(py[b], py[c]));
+    t->min_x = lo_x > 0.0f ? (i32)lo_x : 0;
+    t->min_y = lo_y > 0.0f ? (i32)lo_y : 0;
+    t->max_x = hi_x < (f32)(OCCLUSION_WIDTH - 1) ? (i32)hi_x : (i32)OCCLUSION_WIDTH - 1;
+    t->max_y = hi_y < (f32)(OCCLUSION_HEIGHT - 1) ? (i32)hi_y : (i32)OCCLUSION_HEIGHT - 1;
+    return t->min_x <= t->max_x && t->min_y <= t->max_y;
+}
+
+// Faces of the box turned towards the eye, clipped, projected and fanned into
+// triangles. A box around the eye has none.
+static u32 add_box(OcclusionBuffer* o, const AABB& box, const Vec3& eye) {
+    const f32 lo[3] = { box.min.x, box.min.y, box.min.z };
+    const f32 hi[3] = { box.max.x, box.max.y, box.max.z };
+    const f32 e[3] = { eye.x, eye.y, eye.z };
+    u32 added = 0;
+    for (u32 axis = 0; axis < 3; axis++) {
+        f32 plane;
+        if (e[axis] < lo[axis]) plane = lo[axis];
+        else if (e[axis] > hi[axis]) plane = hi[axis];
+        else continue;
+        u32 u = (axis + 1) % 3, v = (axis + 2) % 3;
+        const f32 corner_u[4] = { lo[u], hi[u], hi[u], lo[u] };
+        const f32 corner_v[4] = { lo[v], lo[v], hi[v], hi[v] };
+        ClipVertex poly[CLIP_MAX_VERTS];
+        for (u32 k = 0; k < 4; k++) {
+            f32 p[3];
+            p[axis] = plane;
+            p[u] = corner_u[k];
+            p[v] = corner_v[k];
+            poly[k] = to_clip(o->view_projection, p[0], p[1], p[2]);
+        }
+        u32 n = clip_polygon(poly, 4, o->near_plane);
+
+        f32 px[CLIP_MAX_VERTS], py[CLIP_MAX_VERTS], pd[CLIP_MAX_VERTS];
+        for (u32 k = 0; k < n; k++) {
+            f32 inv = 1.0f / poly[k].w;
+            px[k] = (poly[k].x * inv * 0.5f + 0.5f) * (f32)OCCLUSION_WIDTH;
+            py[k] = (poly[k].y * inv * 0.5f + 0.5f) * (f32)OCCLUSION_HEIGHT;
+            pd[k] = inv;
+        }
+        for (u32 k = 1; k + 1 < n && o->triangle_count < OCCLUSION_MAX_TRIANGLES; k++) {
+            if (setup_triangle(&o->triangles[o->triangle_count], px, py, pd, 0, k, k + 1)) {
+                o->triangle_count++;
+                added++;
+            }
+        }
+    }
+    return added;
+}
+
+// Counting sort of triangle references into the tiles their bounds overlap
+static void bin_triangles(OcclusionBuffer* o) {
+    u32* first = o->tile_first;
+    memset(first, 0, sizeof(u32) * (OCCLUSION_TILE_COUNT + 1));
+    u32 total = 0;
+    for (u32 i = 0; i < o->triangle_count; i++) {
+        OccluderTriangle& t = o->triangles[i];
+        u32 tx0 = (u32)t.min_x / OCCLUSION_TILE_WIDTH, tx1 = (u32)t.max_x / OCCLUSION_TILE_WIDTH;
+        u32 ty0 = (u32)t.min_y / OCCLUSION_TILE_HEIGHT, ty1 = (u32)t.max_y / OCCLUSION_TILE_HEIGHT;
+        u32 n = (tx1 - tx0 + 1) * (ty1 - ty0 + 1);
+        if (total + n > o->tile_capacity) {
+            t.max_x = -1;
+            continue;
+        }
+        total += n;
+        for (u32 ty = ty0; ty <= ty1; ty++) {
+            for (u32 tx = tx0; tx <= tx1; tx++) first[ty * OCCLUSION_TILES_X + tx + 1]++;
+        }
+    }
+    for (u32 i = 1; i <= OCCLUSION_TILE_COUNT; i++) first[i] += first[i - 1];
+
+    u32 cursor[OCCLUSION_TILE_COUNT];
+    memcpy(cursor, first, sizeof(cursor));
+    for (u32 i = 0; i < o->triangle_count; i++) {
+        const OccluderTriangle& t = o->triangles[i];
+        if (t.max_x < t.min_x) continue;
+        u32 tx0 = (u32)t.min_x / OCCLUSION_TILE_WIDTH, tx1 = (u32)t.max_x / OCCLUSION_TILE_WIDTH;
+        u32 ty0 = (u32)t.min_y / OCCLUSION_TILE_HEIGHT, ty1 = (u32)t.max_y / OCCLUSION_TILE_HEIGHT;
+        for (u32 ty = ty0; ty <= ty1; ty++) {
+            for (u32 tx = tx0; tx <= tx1; tx++) o->tile_triangles[cursor[ty * OCCLUSION_TILES_X + tx]++] = (u16)i;
+        }
+    }
+}
+
+// =============================================================================
+// Rasterization
+// =============================================================================
+// Each tile owns its pixels, so tiles run independently. Pixels are sampled
+// at their centres with branch-free spans the compiler can vectorise.
+static void raster_tiles(void* user, u32 begin, u32 end) {
+    OcclusionBuffer* o = static_cast<OcclusionBuffer*>(user);
+    f32* depth = o->levels[0];
+    for (u32 tile = begin; tile < end; tile++) {
+        i32 x0 = (i32)((tile % OCCLUSION_TILES_X) * OCCLUSION_TILE_WIDTH);
+        i32 y0 = (i32)((tile / OCCLUSION_TILES_X) * OCCLUSION_TILE_HEIGHT);
+        i32 x1 = x0 + (i32)OCCLUSION_TILE_WIDTH - 1;
+        i32 y1 = y0 + (i32)OCCLUSION_TILE_HEIGHT - 1;
+        for (i32 y = y0; y <= y1; y++) memset(depth + y * OCCLUSION_WIDTH + x0, 0, sizeof(f32) * OCCLUSION_TILE_WIDTH);
+
+        for (u32 r = o->tile_first[tile]; r < o->tile_first[tile + 1]; r++) {
+            const OccluderTriangle& t = o->triangles[o->tile_triangles[r]];
+            i32 ax = t.min_x > x0 ? t.min_x : x0, bx = t.max_x < x1 ? t.max_x : x1;
+            i32 ay = t.min_y > y0 ? t.min_y : y0, by = t.max_y < y1 ? t.max_y : y1;
+            for (i32 y = ay; y <= by; y++) {
+                f32 fy = (f32)y + 0.5f;
+                f32 r0 = t.edge[0][1] * fy + t.edge[0][2];
+                f32 r1 = t.edge[1][1] * fy + t.edge[1][2];
+                f32 r2 = t.edge[2][1] * fy + t.edge[2][2];
+                f32 rd = t.depth[1] * fy + t.depth[2];
+                f32* row = depth + y * OCCLUSION_WIDTH;
+                for (i32 x = ax; x <= bx; x++) {
+                    f32 fx = (f32)x + 0.5f;
+                    f32 e0 = t.edge[0][0] * fx + r0;
+                    f32 e1 = t.edge[1][0] * fx + r1;
+                    f32 e2 = t.edge[2][0] * fx + r2;
+                    f32 d = t.depth[0] * fx + rd;
+                    bool inside = (e0 >= 0.0f) & (e1 >= 0.0f) & (e2 >= 0.0f) & (d > row[x]);
+                    row[x] = inside ? d : row[x];
+                }
+            }
+        }
+    }
+}
+
+// Each level keeps the farthest depth of the texels below it
+static void build_pyramid(OcclusionBuffer* o) {
+    for (u32 l = 1; l < o->level_count; l++) {
+        const f32* src = o->levels[l - 1];
+        f32* dst = o->levels[l];
+        u32 sw = o->level_width[l - 1], sh = o->level_height[l - 1];
+        u32 w = o->level_width[l], h = o->level_height[l];
+        for (u32 y = 0; y < h; y++) {
+            const f32* row0 = src + (2 * y) * sw;
+            const f32* row1 = src + (2 * y + 1 < sh ? 2 * y + 1 : 2 * y) * sw;
+            for (u32 x = 0; x < w; x++) {
+                u32 xa = 2 * x, xb = 2 * x + 1 < sw ? 2 * x + 1 : 2 * x;
+                dst[y * w + x] = fminf(fminf(row0[xa], row0[xb]), fminf(row1[xa], row1[xb]));
+            }
+        }
+    }
+}
+
+void occlusion_build(OcclusionBuffer* o, const Mat4& view, const Mat4& projection, const Vec3& eye,
+    const AABB* boxes, u32 count) {
+    f64 t0 = time_now();
+    o->view_projection = mat4_multiply(projection, view);
+    o->near_plane = projection.m[14] / (projection.m[10] - 1.0f);
+    o->stats = {};
+    o->triangle_count = 0;
+    if (count > OCCLUSION_MAX_OCCLUDERS) count = OCCLUSION_MAX_OCCLUDERS;
+    for (u32 i = 0; i < count; i++) {
+        if (add_box(o, boxes[i], eye)) o->stats.occluders++;
+    }
+    bin_triangles(o);
+    parallel_for(OCCLUSION_TILE_COUNT, 1, raster_tiles, o);
+    build_pyramid(o);
+    o->stats.triangles = o->triangle_count;
+    o->stats.raster_ms = (f32)((time_now() - t0) * 1000.0);
+    o->ready = true;
+}
+
+// =============================================================================
+// Tests
+// =============================================================================
+bool occlusion_test_box(OcclusionBuffer* o, const AABB& box) {
+    if (!o->ready) return true;
+    o->stats.tested++;
+
+    // Screen rectangle and nearest depth of the corners; the nearest point of
+    // a box in front of the eye is one of them
+    f32 lo_x = 1e30f, lo_y = 1e30f, hi_x = -1e30f, hi_y = -1e30f, nearest = 0.0f;
+    for (u32 i = 0; i < 8; i++) {
+        ClipVertex c = to_clip(o->view_projection, (i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y,
+            (i & 4) ? box.max.z : box.min.z);
+        if (c.w < o->near_plane) return true;
+        f32 inv = 1.0f / c.w;
+        f32 x = (c.x * inv * 0.5f + 0.5f) * (f32)OCCLUSION_WIDTH;
+        f32 y = (c.y * inv * 0.5f + 0.5f) * (f32)OCCLUSION_HEIGHT;
+        lo_x = fminf(lo_x, x); hi_x = fmaxf(hi_x, x);
+        lo_y = fminf(lo_y, y); hi_y = fmaxf(hi_y, y);
+        nearest = fmaxf(nearest, inv);
+    }
+    if (hi_x < 0.0f || hi_y < 0.0f || lo_x >= (f32)OCCLUSION_WIDTH || lo_y >= (f32)OCCLUSION_HEIGHT) return true;
+
+    // One texel of slack around the rectangle covers occluder edges that were
+    // only sampled at pixel centres
+    i32 x0 = (i32)fmaxf(lo_x - 1.0f, 0.0f), y0 = (i32)fmaxf(lo_y - 1.0f, 0.0f);
+    i32 x1 = (i32)fminf(hi_x + 1.0f, (f32)(OCCLUSION_WIDTH - 1));
+    i32 y1 = (i32)fminf(hi_y + 1.0f, (f32)(OCCLUSION_HEIGHT - 1));
+
+    // Coarsest level where the rectangle spans at most 4 x 4 texels
+    u32 l = 0;
+    while (l + 1 < o->level_count && ((x1 >> l) - (x0 >> l) > 3 || (y1 >> l) - (y0 >> l) > 3)) l++;
+    const f32* level = o->levels[l];
+    u32 w = o->level_width[l];
+    for (i32 y = y0 >> l; y <= (y1 >> l); y++) {
+        for (i32 x = x0 >> l; x <= (x1 >> l); x++) {
+            if (level[y * w + x] <= nearest) return true;
+        }
+    }
+    o->stats.culled++;
+    return false;
+}
+
+}
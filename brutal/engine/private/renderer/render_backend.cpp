@@ -0,0 +1,24 @@
+#include "brutal/renderer/render_backend.h"
+
+namespace brutal {
+
+static RenderBackend g_backend = RENDER_BACKEND_GL;
+
+void render_backend_select(RenderBackend backend) {
+    g_backend = backend;
+}
+
+RenderBackend render_backend() {
+    return g_backend;
+}
+
+const char* render_backend_name(RenderBackend backend) {
+    switch (backend) {
+    case RENDER_BACKEND_GL: return "OpenGL";
+    case RENDER_BACKEND_SOFTWARE: return "software";
+    case RENDER_BACKEND_NULL: return "null";
+    }
+    return "unknown";
+}
+
+}
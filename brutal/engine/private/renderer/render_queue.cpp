@@ -0,0 +1,66 @@
+#include "brutal/renderer/render_queue.h"
+#include "brutal/core/memory.h"
+#include <cstring>
+
+namespace brutal {
+
+bool render_queue_create(RenderQueue* q, MemoryArena* arena, u32 capacity) {
+    *q = {};
+    q->commands = arena_alloc_array<RenderCommand>(arena, capacity);
+    q->items = arena_alloc_array<RenderSortItem>(arena, capacity);
+    q->scratch = arena_alloc_array<RenderSortItem>(arena, capacity);
+    if (!q->commands || !q->items || !q->scratch) {
+        *q = {};
+        return false;
+    }
+    q->capacity = capacity;
+    return true;
+}
+
+RenderCommand* render_queue_push(RenderQueue* q, u64 key) {
+    if (q->count == q->capacity) return nullptr;
+    u32 i = q->count++;
+    q->items[i] = { key, i };
+    return &q->commands[i];
+}
+
+u64 render_sort_key(RenderPass pass, RenderProgram program, u32 mesh_id, f32 depth) {
+    u32 depth_bits = 0;
+    if (depth > 0.0f) memcpy(&depth_bits, &depth, sizeof(depth_bits));
+    return (static_cast<u64>(pass & 0xF) << 60) | (static_cast<u64>(program & 0xF) << 56) |
+        (static_cast<u64>(mesh_id & 0xFFFF) << 40) | (static_cast<u64>(depth_bits >> 8) << 16);
+}
+
+// 11-bit digits keep the histogram on the stack; digits every key shares
+// (the unused low bits, usually pass and program) are skipped
+void render_queue_sort(RenderQueue* q) {
+    if (q->count < 2) return;
+    constexpr u32 kDigitBits = 11;
+    constexpr u32 kDigits = 1u << kDigitBits;
+    u64 all_or = 0, all_and = ~0ull;
+    for (u32 i = 0; i < q->count; i++) {
+        all_or |= q->items[i].key;
+        all_and &= q->items[i].key;
+    }
+    u32 offsets[kDigits];
+    RenderSortItem* src = q->items;
+    RenderSortItem* dst = q->scratch;
+    for (u32 shift = 0; shift < 64; shift += kDigitBits) {
+        if ((((all_or ^ all_and) >> shift) & (kDigits - 1)) == 0) continue;
+        memset(offsets, 0, sizeof(offsets));
+        for (u32 i = 0; i < q->count; i++) offsets[(src[i].key >> shift) & (kDigits - 1)]++;
+        u32 sum = 0;
+        for (u32 d = 0; d < kDigits; d++) {
+            u32 n = offsets[d];
+            offsets[d] = sum;
+            sum += n;
+        }
+        for (u32 i = 0; i < q->count; i++) dst[offsets[(src[i].key >> shift) & (kDigits - 1)]++] = src[i];
+        RenderSortItem* t = src;
+        src = dst;
+        dst = t;
+    }
+    if (src != q->items) memcpy(q->items, src, sizeof(RenderSortItem) * q->count);
+}
+
+}
@@ -1,9 +1,13 @@
 #include "brutal/renderer/renderer.h"
 #include "brutal/renderer/camera.h"
 #include "brutal/renderer/light.h"
+#include "brutal/renderer/object_lights.h"
+#include "brutal/renderer/render_backend.h"
 #include "brutal/core/logging.h"
+#include "brutal/core/memory.h"
 #include <glad/glad.h>
-#include <cstdio>
+#include <cstddef>
+#include <cstring>
 
 namespace brutal {
 
@@ -14,84 +18,128 @@ layout(location = 1) in vec3 a_Normal;
 layout(location = 2) in vec3 a_Color;
 uniform mat4 u_MVP;
 uniform mat4 u_Model;
+uniform ivec4 u_ObjectLights;
+uniform int u_ObjectLightCount;
 out vec3 v_Normal;
 out vec3 v_Color;
 out vec3 v_WorldPos;
+out vec4 v_ClipPos;
+flat out ivec4 v_Lights;
+flat out int v_LightCount;
 void main() {
     vec4 world = u_Model * vec4(a_Position, 1.0);
     v_WorldPos = world.xyz;
     v_Normal = mat3(u_Model) * a_Normal;
     v_Color = a_Color;
     gl_Position = u_MVP * vec4(a_Position, 1.0);
+    v_ClipPos = gl_Position;
+    v_Lights = u_ObjectLights;
+    v_LightCount = u_ObjectLightCount;
 }
 )";
 
+// Model, color and light list come per instance; u_Color stays white so
+// lit_frag is shared with the single-draw program
+static const char* lit_instanced_vert = R"(
+#version 330 core
+layout(location = 0) in vec3 a_Position;
+layout(location = 1) in vec3 a_Normal;
+layout(location = 2) in vec3 a_Color;
+layout(location = 3) in mat4 a_Model;
+layout(location = 7) in vec4 a_InstanceColor;
+layout(location = 8) in ivec4 a_Lights;
+uniform mat4 u_ViewProj;
+out vec3 v_Normal;
+out vec3 v_Color;
+out vec3 v_WorldPos;
+out vec4 v_ClipPos;
+flat out ivec4 v_Lights;
+flat out int v_LightCount;
+void main() {
+    vec4 world = a_Model * vec4(a_Position, 1.0);
+    v_WorldPos = world.xyz;
+    v_Normal = mat3(a_Model) * a_Normal;
+    v_Color = a_Color * a_InstanceColor.rgb;
+    gl_Position = u_ViewProj * world;
+    v_ClipPos = gl_Position;
+    v_Lights = a_Lights;
+    v_LightCount = int(a_InstanceColor.a);
+}
+)";
+
+// Shades with the object's own light list when it has one (count >= 0),
+// otherwise with the lights of the fragment's froxel. The froxel comes from
+// the clip position: xy / w picks the screen tile, w is the view depth.
 static const char* lit_frag = R"(
 #version 330 core
-#define MAX_LIGHTS 16
-#define MAX_SPOT_LIGHTS 8
 in vec3 v_Normal;
 in vec3 v_Color;
 in vec3 v_WorldPos;
+in vec4 v_ClipPos;
+flat in ivec4 v_Lights;
+flat in int v_LightCount;
 uniform vec4 u_Color;
-uniform vec3 u_CameraPos;
-uniform vec4 u_Ambient;
-uniform vec4 u_LightPos[MAX_LIGHTS];
-uniform vec4 u_LightColor[MAX_LIGHTS];
-uniform int u_LightCount;
-uniform vec4 u_SpotLightPos[MAX_SPOT_LIGHTS];
-uniform vec4 u_SpotLightDir[MAX_SPOT_LIGHTS];
-uniform vec4 u_SpotLightColor[MAX_SPOT_LIGHTS];
-uniform vec4 u_SpotLightParams[MAX_SPOT_LIGHTS];
-uniform int u_SpotLightCount;
+uniform samplerBuffer u_LightData;
+uniform usamplerBuffer u_ClusterGrid;
+uniform usamplerBuffer u_ClusterLights;
+layout(std140) uniform Lights {
+    vec4 u_CameraPos;
+    vec4 u_Ambient;
+    vec4 u_ClusterDepth;
+    ivec4 u_ClusterDims;
+};
 out vec4 FragColor;
+vec3 N;
+vec3 V;
+vec3 diffuse = vec3(0.0);
+vec3 specular = vec3(0.0);
+void add_light(int light) {
+    int l = light * 4;
+    vec4 pos = texelFetch(u_LightData, l);
+    vec4 col = texelFetch(u_LightData, l + 1);
+    vec3 lpos = pos.xyz;
+    float lrange = pos.w;
+    vec3 lcol = col.rgb;
+    float lint = col.w;
+    vec3 L = lpos - v_WorldPos;
+    float dist = length(L);
+    L = normalize(L);
+    float att = 1.0 / (1.0 + (dist*dist) / (lrange*lrange*0.1));
+    att *= clamp(1.0 - dist/lrange, 0.0, 1.0);
+    att = att * att;
+    vec4 params = texelFetch(u_LightData, l + 3);
+    if (params.z > 0.5) {
+        vec4 dir = texelFetch(u_LightData, l + 2);
+        float spot_cos = dot(-L, normalize(dir.xyz));
+        float cone = smoothstep(params.x, dir.w, spot_cos);
+        att *= pow(cone, max(params.y, 0.001));
+    }
+    float NdL = max(dot(N, L), 0.0);
+    diffuse += lcol * lint * NdL * att;
+    vec3 H = normalize(L + V);
+    float NdH = max(dot(N, H), 0.0);
+    specular += lcol * lint * pow(NdH, 32.0) * att * 0.2;
+}
 void main() {
-    vec3 N = normalize(v_Normal);
-    vec3 V = normalize(u_CameraPos - v_WorldPos);
+    N = normalize(v_Normal);
+    V = normalize(u_CameraPos.xyz - v_WorldPos);
     vec3 ambient = u_Ambient.rgb * u_Ambient.w;
-    vec3 diffuse = vec3(0.0);
-    vec3 specular = vec3(0.0);
-    for (int i = 0; i < u_LightCount && i < MAX_LIGHTS; i++) {
-        vec3 lpos = u_LightPos[i].xyz;
-        float lrad = u_LightPos[i].w;
-        vec3 lcol = u_LightColor[i].rgb;
-        float lint = u_LightColor[i].w;
-        vec3 L = lpos - v_WorldPos;
-        float dist = length(L);
-        L = normalize(L);
-        float att = 1.0 / (1.0 + (dist*dist) / (lrad*lrad*0.1));
-        att *= clamp(1.0 - dist/lrad, 0.0, 1.0);
-        att = att * att;
-        float NdL = max(dot(N, L), 0.0);
-        diffuse += lcol * lint * NdL * att;
-        vec3 H = normalize(L + V);
-        float NdH = max(dot(N, H), 0.0);
-        specular += lcol * lint * pow(NdH, 32.0) * att * 0.2;
-    }
-for (int i = 0; i < u_SpotLightCount && i < MAX_SPOT_LIGHTS; i++) {
-        vec3 lpos = u_SpotLightPos[i].xyz;
-        float lrange = u_SpotLightPos[i].w;
-        vec3 ldir = normalize(u_SpotLightDir[i].xyz);
-        float inner_cos = u_SpotLightDir[i].w;
-        vec3 lcol = u_SpotLightColor[i].rgb;
-        float lint = u_SpotLightColor[i].w;
-        float outer_cos = u_SpotLightParams[i].x;
-        float falloff = u_SpotLightParams[i].y;
-        vec3 to_frag = normalize(v_WorldPos - lpos);
-        float spot_cos = dot(to_frag, ldir);
-        float cone = smoothstep(outer_cos, inner_cos, spot_cos);
-        cone = pow(cone, max(falloff, 0.001));
-        vec3 L = lpos - v_WorldPos;
-        float dist = length(L);
-        L = normalize(L);
-        float att = 1.0 / (1.0 + (dist*dist) / (lrange*lrange*0.1));
-        att *= clamp(1.0 - dist/lrange, 0.0, 1.0);
-        att = att * att * cone;
-        float NdL = max(dot(N, L), 0.0);
-        diffuse += lcol * lint * NdL * att;
-        vec3 H = normalize(L + V);
-        float NdH = max(dot(N, H), 0.0);
-        specular += lcol * lint * pow(NdH, 32.0) * att * 0.2;
+
+    if (v_LightCount >= 0) {
+        for (int k = 0; k < v_LightCount; k++) {
+            int pair = v_Lights[k >> 1];
+            add_light((k & 1) == 0 ? (pair & 0xFFFF) : (pair >> 16));
+        }
+    } else {
+        vec2 ndc = v_ClipPos.xy / v_ClipPos.w;
+        ivec2 tile = clamp(ivec2((ndc * 0.5 + 0.5) * vec2(u_ClusterDims.xy)), ivec2(0), u_ClusterDims.xy - 1);
+        int slice = clamp(int(log(v_ClipPos.w) * u_ClusterDepth.x + u_ClusterDepth.y), 0, u_ClusterDims.z - 1);
+        uint cell = texelFetch(u_ClusterGrid, (slice * u_ClusterDims.y + tile.y) * u_ClusterDims.x + tile.x).r;
+        int first = int(cell >> 8u);
+        int count = int(cell & 255u);
+        for (int k = 0; k < count; k++) {
+            add_light(int(texelFetch(u_ClusterLights, first + k).r));
+        }
     }
     vec3 base = v_Color * u_Color.rgb;
     vec3 final = base * (ambient + diffuse) + specular;
@@ -119,7 +167,91 @@ void main() {
 }
 )";
 
-bool renderer_init(RendererState* s, MemoryArena*) {
+// Commands a frame can queue before a flush is forced
+constexpr u32 RENDER_QUEUE_CAPACITY = 16384;
+// Uniform buffer binding point of the Lights block
+constexpr u32 LIGHT_BLOCK_BINDING = 0;
+// Shortest run of one mesh drawn instanced; single draws skip the upload
+constexpr u32 INSTANCING_MIN_RUN = 2;
+constexpr u32 INSTANCE_ATTRIB_MODEL = 3;
+constexpr u32 INSTANCE_ATTRIB_COLOR = 7;
+constexpr u32 INSTANCE_ATTRIB_LIGHTS = 8;
+// Objects whose world bounds reach further from their center keep the froxel
+// lists; a short list per object only pays off for small things
+constexpr f32 OBJECT_LIGHTS_MAX_RADIUS = 4.0f;
+
+// Texture units of the clustered light buffers
+constexpr u32 LIGHT_DATA_UNIT = 1;
+constexpr u32 CLUSTER_GRID_UNIT = 2;
+constexpr u32 CLUSTER_LIGHTS_UNIT = 3;
+
+static_assert(sizeof(ShaderLightBlock) == 16 * 4, "ShaderLightBlock must match the std140 Lights block");
+
+static bool bind_light_block(const Shader* shader) {
+    u32 block = glGetUniformBlockIndex(shader->program, "Lights");
+    if (block == GL_INVALID_INDEX) return false;
+    glUniformBlockBinding(shader->program, block, LIGHT_BLOCK_BINDING);
+    shader_bind(shader);
+    glUniform1i(glGetUniformLocation(shader->program, "u_LightData"), LIGHT_DATA_UNIT);
+    glUniform1i(glGetUniformLocation(shader->program, "u_ClusterGrid"), CLUSTER_GRID_UNIT);
+    glUniform1i(glGetUniformLocation(shader->program, "u_ClusterLights"), CLUSTER_LIGHTS_UNIT);
+    glUseProgram(0);
+    return true;
+}
+
+// A buffer sized for its worst case, read by the shader as a buffer texture
+static void create_texture_buffer(u32* buffer, u32* texture, u32 format, size_t size) {
+    glGenBuffers(1, buffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, *buffer);
+    glBufferData(GL_TEXTURE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    glGenTextures(1, texture);
+    glBindTexture(GL_TEXTURE_BUFFER, *texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, *buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+static void destroy_texture_buffer(u32* buffer, u32* texture) {
+    if (*texture) glDeleteTextures(1, texture);
+    if (*buffer) glDeleteBuffers(1, buffer);
+    *texture = 0;
+    *buffer = 0;
+}
+
+bool renderer_init(RendererState* s, MemoryArena* arena) {
+    if (!render_queue_create(&s->queue, arena, RENDER_QUEUE_CAPACITY)) {
+        LOG_ERROR("Failed to allocate render queue");
+        return false;
+    }
+    s->instances = arena_alloc_array<RenderInstance>(arena, RENDER_QUEUE_CAPACITY);
+    if (!s->instances) {
+        LOG_ERROR("Failed to allocate instance staging");
+        return false;
+    }
+    s->instance_capacity = RENDER_QUEUE_CAPACITY;
+    if (!occlusion_create(&s->occlusion, arena)) {
+        LOG_ERROR("Failed to allocate occlusion buffer");
+        return false;
+    }
+    if (!light_clusters_create(&s->clusters, arena)) {
+        LOG_ERROR("Failed to allocate light clusters");
+        return false;
+    }
+    s->lights = nullptr;
+    s->lights_dirty = true;
+    s->draw_calls = 0;
+    s->triangles = 0;
+    s->vertices = 0;
+    if (!render_backend_uses_gl()) {
+        if (render_backend() == RENDER_BACKEND_SOFTWARE) software_raster_create(&s->software);
+        // The null backend's flush checks the same locations GL would have
+        s->lit_shader.loc_model = 0;
+        s->flat_shader.loc_model = -1;
+        s->cube_mesh = mesh_create_cube();
+        s->grid_mesh = mesh_create_grid(50.0f, 25);
+        LOG_INFO("Renderer initialized (%s)", render_backend_name(render_backend()));
+        return true;
+    }
     if (!shader_create(&s->lit_shader, lit_vert, lit_frag)) {
         LOG_ERROR("Failed to create shader");
         return false;
@@ -129,36 +261,42 @@ bool renderer_init(RendererState* s, MemoryArena*) {
         shader_destroy(&s->lit_shader);
         return false;
     }
+    if (!shader_create(&s->lit_instanced_shader, lit_instanced_vert, lit_frag)) {
+        LOG_ERROR("Failed to create instanced shader");
+        shader_destroy(&s->lit_shader);
+        shader_destroy(&s->flat_shader);
+        return false;
+    }
+    s->loc_instanced_view_proj = glGetUniformLocation(s->lit_instanced_shader.program, "u_ViewProj");
+    s->loc_object_lights = glGetUniformLocation(s->lit_shader.program, "u_ObjectLights");
+    s->loc_object_light_count = glGetUniformLocation(s->lit_shader.program, "u_ObjectLightCount");
 
-    s->loc_camera_pos = glGetUniformLocation(s->lit_shader.program, "u_CameraPos");
-    s->loc_ambient = glGetUniformLocation(s->lit_shader.program, "u_Ambient");
-    s->loc_light_count = glGetUniformLocation(s->lit_shader.program, "u_LightCount");
-    s->loc_spot_light_count = glGetUniformLocation(s->lit_shader.program, "u_SpotLightCount");
-    for (u32 i = 0; i < MAX_POINT_LIGHTS; i++) {
-        char buf[64];
-        snprintf(buf, sizeof(buf), "u_LightPos[%u]", i);
-        s->loc_light_pos[i] = glGetUniformLocation(s->lit_shader.program, buf);
-        snprintf(buf, sizeof(buf), "u_LightColor[%u]", i);
-        s->loc_light_color[i] = glGetUniformLocation(s->lit_shader.program, buf);
+    if (!bind_light_block(&s->lit_shader) || !bind_light_block(&s->lit_instanced_shader)) {
+        LOG_ERROR("Lit shader has no Lights block");
+        shader_destroy(&s->lit_shader);
+        shader_destroy(&s->flat_shader);
+        shader_destroy(&s->lit_instanced_shader);
+        return false;
     }
-    for (u32 i = 0; i < MAX_SPOT_LIGHTS; i++) {
-        char buf[64];
-        snprintf(buf, sizeof(buf), "u_SpotLightPos[%u]", i);
-        s->loc_spot_light_pos[i] = glGetUniformLocation(s->lit_shader.program, buf);
-        snprintf(buf, sizeof(buf), "u_SpotLightDir[%u]", i);
-        s->loc_spot_light_dir[i] = glGetUniformLocation(s->lit_shader.program, buf);
-        snprintf(buf, sizeof(buf), "u_SpotLightColor[%u]", i);
-        s->loc_spot_light_color[i] = glGetUniformLocation(s->lit_shader.program, buf);
-        snprintf(buf, sizeof(buf), "u_SpotLightParams[%u]", i);
-        s->loc_spot_light_params[i] = glGetUniformLocation(s->lit_shader.program, buf);
+    glGenBuffers(1, &s->light_buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, s->light_buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(ShaderLightBlock), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_BLOCK_BINDING, s->light_buffer);
+    s->light_block_valid = false;
+    create_texture_buffer(&s->light_data_buffer, &s->light_data_texture, GL_RGBA32F,
+        sizeof(f32) * CLUSTER_LIGHT_CAPACITY * CLUSTER_LIGHT_FLOATS);
+    create_texture_buffer(&s->cluster_grid_buffer, &s->cluster_grid_texture, GL_R32UI, sizeof(u32) * CLUSTER_COUNT);
+    create_texture_buffer(&s->cluster_lights_buffer, &s->cluster_lights_texture, GL_R16UI,
+        sizeof(u16) * CLUSTER_COUNT * CLUSTER_MAX_LIGHTS);
+    u32 instance_bytes = sizeof(RenderInstance) * s->instance_capacity;
+    if (!stream_buffer_create(&s->instance_stream, GL_ARRAY_BUFFER, instance_bytes, s->instances, instance_bytes)) {
+        LOG_ERROR("Failed to create instance stream");
+        return false;
     }
 
     s->cube_mesh = mesh_create_cube();
     s->grid_mesh = mesh_create_grid(50.0f, 25);
-    s->lights = nullptr;
-    s->draw_calls = 0;
-    s->triangles = 0;
-    s->vertices = 0;
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_CULL_FACE);
     glCullFace(GL_BACK);
@@ -170,8 +308,19 @@ bool renderer_init(RendererState* s, MemoryArena*) {
 void renderer_shutdown(RendererState* s) {
     mesh_destroy(&s->cube_mesh);
     mesh_destroy(&s->grid_mesh);
+    if (!render_backend_uses_gl()) {
+        if (render_backend() == RENDER_BACKEND_SOFTWARE) software_raster_destroy(&s->software);
+        return;
+    }
     shader_destroy(&s->lit_shader);
     shader_destroy(&s->flat_shader);
+    shader_destroy(&s->lit_instanced_shader);
+    if (s->light_buffer) glDeleteBuffers(1, &s->light_buffer);
+    s->light_buffer = 0;
+    destroy_texture_buffer(&s->light_data_buffer, &s->light_data_texture);
+    destroy_texture_buffer(&s->cluster_grid_buffer, &s->cluster_grid_texture);
+    destroy_texture_buffer(&s->cluster_lights_buffer, &s->cluster_lights_texture);
+    stream_buffer_destroy(&s->instance_stream);
 }
 
 void renderer_begin_frame(RendererState* s, i32 w, i32 h) {
@@ -180,124 +329,455 @@ void renderer_begin_frame(RendererState* s, i32 w, i32 h) {
     s->draw_calls = 0;
     s->triangles = 0;
     s->vertices = 0;
+    s->vertex_bytes = 0;
+    s->upload_bytes = 0;
+    s->program_binds = 0;
+    s->vao_binds = 0;
+    s->uniform_uploads = 0;
+    s->light_uploads = 0;
+    s->object_light_draws = 0;
+    s->object_light_refs = 0;
+    occlusion_reset(&s->occlusion);
+    s->occlusion.stats = {};
+    render_queue_clear(&s->queue);
+    if (!render_backend_uses_gl()) {
+        if (render_backend() == RENDER_BACKEND_SOFTWARE) {
+            software_raster_begin_frame(&s->software, (u32)w, (u32)h, Vec3(0.02f, 0.02f, 0.03f));
+        }
+        return;
+    }
     glViewport(0, 0, w, h);
     glClearColor(0.02f, 0.02f, 0.03f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
 void renderer_end_frame() {
-    glFlush();
+    stream_buffers_end_frame();
+    if (render_backend_uses_gl()) glFlush();
 }
 
 void renderer_set_camera(RendererState* s, const Camera* c) {
+    renderer_flush(s);
     f32 aspect = (f32)s->viewport_width / (f32)s->viewport_height;
     s->view = camera_view_matrix(c);
     s->projection = camera_projection_matrix(c, aspect);
     s->view_projection = mat4_multiply(s->projection, s->view);
     s->camera_pos = c->position;
+    s->lights_dirty = true;
+    occlusion_reset(&s->occlusion);
 }
 
 void renderer_set_camera_matrices(RendererState* s, const Mat4& view, const Mat4& projection, const Vec3& camera_pos) {
+    renderer_flush(s);
     s->view = view;
     s->projection = projection;
     s->view_projection = mat4_multiply(s->projection, s->view);
     s->camera_pos = camera_pos;
+    s->lights_dirty = true;
+    occlusion_reset(&s->occlusion);
 }
 
 void renderer_set_lights(RendererState* s, const LightEnvironment* l) {
+    if (s->lights != l) renderer_flush(s);
     s->lights = l;
+    s->lights_dirty = true;
+}
+
+static void set4(f32* out, f32 x, f32 y, f32 z, f32 w) {
+    out[0] = x;
+    out[1] = y;
+    out[2] = z;
+    out[3] = w;
+}
+
+static void pack_light_block(ShaderLightBlock* b, const LightEnvironment* l, const LightClusters* c, const Vec3& cam) {
+    set4(b->camera_pos, cam.x, cam.y, cam.z, 1.0f);
+    if (l) set4(b->ambient, l->ambient_color.x, l->ambient_color.y, l->ambient_color.z, l->ambient_intensity);
+    else set4(b->ambient, 0.3f, 0.3f, 0.3f, 1.0f);
+    set4(b->cluster_depth, c->depth_scale, c->depth_bias, 0.0f, 0.0f);
+    b->cluster_dims[0] = (i32)CLUSTER_GRID_X;
+    b->cluster_dims[1] = (i32)CLUSTER_GRID_Y;
+    b->cluster_dims[2] = (i32)CLUSTER_GRID_Z;
+    b->cluster_dims[3] = (i32)CLUSTER_MAX_LIGHTS;
 }
 
-static void upload_lights(RendererState* s, const LightEnvironment* l, const Vec3& cam) {
-    if (s->loc_camera_pos >= 0) {
-        glUniform3f(s->loc_camera_pos, cam.x, cam.y, cam.z);
+// Orphans the buffer so the upload does not wait on draws still reading it
+static void upload_texture_buffer(u32 buffer, size_t capacity, const void* data, size_t size) {
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBufferData(GL_TEXTURE_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+    if (size) glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+// Rebuilds the clusters for the current camera and lights, then refreshes
+// the Lights block when its bytes changed. Without `submit` only counts the
+// uploads.
+static void update_lights(RendererState* s, bool submit) {
+    if (!s->lights_dirty) return;
+    s->lights_dirty = false;
+    LightClusters* c = &s->clusters;
+    light_clusters_build(c, s->lights, s->view, s->projection);
+    size_t data_bytes = sizeof(f32) * CLUSTER_LIGHT_FLOATS * c->light_count;
+    size_t grid_bytes = sizeof(u32) * CLUSTER_COUNT;
+    size_t index_bytes = sizeof(u16) * c->index_count;
+    if (submit) {
+        upload_texture_buffer(s->light_data_buffer, sizeof(f32) * CLUSTER_LIGHT_CAPACITY * CLUSTER_LIGHT_FLOATS,
+            c->light_data, data_bytes);
+        upload_texture_buffer(s->cluster_grid_buffer, grid_bytes, c->grid, grid_bytes);
+        upload_texture_buffer(s->cluster_lights_buffer, sizeof(u16) * CLUSTER_COUNT * CLUSTER_MAX_LIGHTS, c->indices,
+            index_bytes);
     }
-    if (!l) {
-        if (s->loc_ambient >= 0) {
-            glUniform4f(s->loc_ambient, 0.3f, 0.3f, 0.3f, 1.0f);
-        }
-        if (s->loc_light_count >= 0) {
-            glUniform1i(s->loc_light_count, 0);
+    s->light_uploads++;
+    s->upload_bytes += data_bytes + grid_bytes + index_bytes;
+
+    ShaderLightBlock block;
+    pack_light_block(&block, s->lights, c, s->camera_pos);
+    if (s->light_block_valid && !memcmp(&block, &s->light_block, sizeof(block))) return;
+    s->light_block = block;
+    s->light_block_valid = true;
+    s->upload_bytes += sizeof(block);
+    if (!submit) return;
+    glBindBuffer(GL_UNIFORM_BUFFER, s->light_buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(block), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+static void bind_light_textures(const RendererState* s) {
+    glActiveTexture(GL_TEXTURE0 + LIGHT_DATA_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, s->light_data_texture);
+    glActiveTexture(GL_TEXTURE0 + CLUSTER_GRID_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, s->cluster_grid_texture);
+    glActiveTexture(GL_TEXTURE0 + CLUSTER_LIGHTS_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, s->cluster_lights_texture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+// =============================================================================
+// Queue
+// =============================================================================
+static void queue_draw(RendererState* s, RenderPass pass, RenderProgram program, const Mesh* m, const Mat4& model,
+    const Vec3& color) {
+    if (pass != RENDER_PASS_LINES && m->has_bounds && s->occlusion.ready &&
+        !occlusion_test_box(&s->occlusion, aabb_transform(m->bounds, model))) {
+        return;
+    }
+    Vec3 offset = Vec3(model.m[12], model.m[13], model.m[14]) - s->camera_pos;
+    u64 key = render_sort_key(pass, program, m->vao, vec3_length(offset));
+    RenderCommand* c = render_queue_push(&s->queue, key);
+    if (!c) {
+        renderer_flush(s);
+        c = render_queue_push(&s->queue, key);
+    }
+    c->model = model;
+    c->color = color;
+    c->mesh = m;
+}
+
+struct BoundProgram {
+    Mat4 model;
+    Vec3 color;
+    ObjectLights lights;
+    bool model_set, color_set, lights_set;
+};
+
+// `submit` is false on the null backend: the flush does all of its work and
+// counts every bind, upload and draw, but makes no GL call
+struct FlushState {
+    const Shader* program;
+    u32 vao;
+    bool instanced_ready;
+    bool lights_ready;
+    bool submit;
+};
+
+static void prepare_lights(RendererState* s, FlushState* f) {
+    if (f->lights_ready) return;
+    update_lights(s, f->submit);
+    if (f->submit) bind_light_textures(s);
+    f->lights_ready = true;
+}
+
+static void bind_program(RendererState* s, FlushState* f, const Shader* shader) {
+    if (shader == f->program) return;
+    if (f->submit) shader_bind(shader);
+    f->program = shader;
+    s->program_binds++;
+}
+
+static void bind_vao(RendererState* s, FlushState* f, u32 vao) {
+    if (vao == f->vao) return;
+    if (f->submit) glBindVertexArray(vao);
+    f->vao = vao;
+    s->vao_binds++;
+}
+
+// The draw's own light list; false for boundless or large geometry, which
+// shades with the froxel lists. Needs the clusters built for this flush.
+static bool select_object_lights(RendererState* s, const RenderCommand& c, ObjectLights* out) {
+    if (!c.mesh->has_bounds) return false;
+    AABB world = aabb_transform(c.mesh->bounds, c.model);
+    if (vec3_length(aabb_half_size(world)) > OBJECT_LIGHTS_MAX_RADIUS) return false;
+    object_lights_select(&s->clusters, world, out);
+    s->object_light_draws++;
+    s->object_light_refs += out->count;
+    return true;
+}
+
+// Finds how many items from first on can share one instanced draw
+static u32 instanced_run(const RendererState* s, const RenderQueue* q, u32 first) {
+    const RenderSortItem& item = q->items[first];
+    const Mesh* m = q->commands[item.command].mesh;
+    if (render_key_pass(item.key) != RENDER_PASS_OPAQUE || render_key_program(item.key) != RENDER_PROGRAM_LIT ||
+        m->index_count == 0) {
+        return 1;
+    }
+    u32 run = 1;
+    while (first + run < q->count && run < s->instance_capacity) {
+        const RenderSortItem& next = q->items[first + run];
+        if (render_key_pass(next.key) != RENDER_PASS_OPAQUE || render_key_program(next.key) != RENDER_PROGRAM_LIT ||
+            q->commands[next.command].mesh != m) {
+            break;
         }
-        if (s->loc_spot_light_count >= 0) {
-            glUniform1i(s->loc_spot_light_count, 0);
+        run++;
+    }
+    return run;
+}
+
+// Streams the run's models and colors and draws it in one call. The instance
+// attributes are VAO state, so they are pointed at the buffer on every run
+// rather than trusting a VAO id that may have been recycled.
+static void fill_instances(RendererState* s, const RenderQueue* q, u32 first, u32 count, RenderInstance* out) {
+    for (u32 i = 0; i < count; i++) {
+        const RenderCommand& c = q->commands[q->items[first + i].command];
+        RenderInstance& inst = out[i];
+        Mat4 model = mesh_draw_matrix(c.mesh, c.model);
+        memcpy(inst.model, model.m, sizeof(inst.model));
+        inst.color[0] = c.color.x;
+        inst.color[1] = c.color.y;
+        inst.color[2] = c.color.z;
+        ObjectLights lights;
+        if (select_object_lights(s, c, &lights)) {
+            memcpy(inst.lights, lights.packed, sizeof(inst.lights));
+            inst.color[3] = (f32)lights.count;
+        } else {
+            memset(inst.lights, 0, sizeof(inst.lights));
+            inst.color[3] = -1.0f;
         }
-        return;
     }
-    if (s->loc_ambient >= 0) {
-        glUniform4f(s->loc_ambient, l->ambient_color.x, l->ambient_color.y, l->ambient_color.z, l->ambient_intensity);
+}
+
+// Points the instance attributes at a run written at byte offset `base`
+static void bind_instances(RendererState* s, u32 base) {
+    glBindBuffer(GL_ARRAY_BUFFER, s->instance_stream.buffer);
+    for (u32 col = 0; col < 4; col++) {
+        u32 loc = INSTANCE_ATTRIB_MODEL + col;
+        glEnableVertexAttribArray(loc);
+        glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, sizeof(RenderInstance), (void*)(base + sizeof(f32) * 4 * col));
+        glVertexAttribDivisor(loc, 1);
     }
-    if (s->loc_light_count >= 0) {
-        glUniform1i(s->loc_light_count, (i32)l->point_light_count);
+    glEnableVertexAttribArray(INSTANCE_ATTRIB_COLOR);
+    glVertexAttribPointer(INSTANCE_ATTRIB_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(RenderInstance),
+        (void*)(base + offsetof(RenderInstance, color)));
+    glVertexAttribDivisor(INSTANCE_ATTRIB_COLOR, 1);
+    glEnableVertexAttribArray(INSTANCE_ATTRIB_LIGHTS);
+    glVertexAttribIPointer(INSTANCE_ATTRIB_LIGHTS, 4, GL_INT, sizeof(RenderInstance),
+        (void*)(base + offsetof(RenderInstance, lights)));
+    glVertexAttribDivisor(INSTANCE_ATTRIB_LIGHTS, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+static void draw_instanced(RendererState* s, FlushState* f, const RenderQueue* q, u32 first, u32 count) {
+    prepare_lights(s, f);
+    const Mesh* m = q->commands[q->items[first].command].mesh;
+
+    const Shader* shader = &s->lit_instanced_shader;
+    bind_program(s, f, shader);
+    if (!f->instanced_ready) {
+        if (f->submit) {
+            if (s->loc_instanced_view_proj >= 0) glUniformMatrix4fv(s->loc_instanced_view_proj, 1, GL_FALSE, s->view_projection.m);
+            shader_set_color(shader, 1.0f, 1.0f, 1.0f, 1.0f);
+        }
+        s->uniform_uploads += 2;
+        f->instanced_ready = true;
     }
-    for (u32 i = 0; i < l->point_light_count && i < MAX_POINT_LIGHTS; i++) {
-        const PointLight& p = l->point_lights[i];
-        if (s->loc_light_pos[i] >= 0) {
-            glUniform4f(s->loc_light_pos[i], p.position.x, p.position.y, p.position.z, p.radius);
+    bind_vao(s, f, m->vao);
+
+    // A run the stream's segment cannot take whole is drawn in pieces. The
+    // null backend fills the staging array, which holds any run.
+    for (u32 done = 0; done < count;) {
+        u32 capacity = s->instance_capacity;
+        RenderInstance* dst = s->instances;
+        if (f->submit) {
+            dst = static_cast<RenderInstance*>(
+                stream_buffer_begin(&s->instance_stream, sizeof(RenderInstance), count - done, &capacity));
         }
-        if (s->loc_light_color[i] >= 0) {
-            glUniform4f(s->loc_light_color[i], p.color.x, p.color.y, p.color.z, p.intensity);
+        if (!dst || capacity == 0) break;
+        u32 n = count - done < capacity ? count - done : capacity;
+        fill_instances(s, q, first + done, n, dst);
+        if (f->submit) {
+            bind_instances(s, stream_buffer_commit(&s->instance_stream, n));
+            glDrawElementsInstanced(GL_TRIANGLES, m->index_count, GL_UNSIGNED_INT, 0, n);
         }
+        s->draw_calls += 1;
+        s->upload_bytes += sizeof(RenderInstance) * n;
+        s->triangles += m->index_count / 3 * n;
+        s->vertices += m->vertex_count * n;
+        s->vertex_bytes += m->vertex_count * mesh_vertex_size(m) * n;
+        done += n;
     }
+}
 
-    if (s->loc_spot_light_count >= 0) {
-        glUniform1i(s->loc_spot_light_count, (i32)l->spot_light_count);
+// The queue in the same order, rasterized on the CPU. Every command is its
+// own draw; lit draws carry the light list the GL path would give them.
+static void flush_software(RendererState* s) {
+    RenderQueue* q = &s->queue;
+    if (s->lights_dirty) {
+        s->lights_dirty = false;
+        light_clusters_build(&s->clusters, s->lights, s->view, s->projection);
+    }
+    SoftwareRaster* r = &s->software;
+    for (u32 i = 0; i < q->count; i++) {
+        const RenderSortItem& item = q->items[i];
+        const RenderCommand& c = q->commands[item.command];
+        RenderPass p = render_key_pass(item.key);
+        const Mesh* m = c.mesh;
+
+        SoftwareDraw d = {};
+        d.color = c.color;
+        d.light_count = -1;
+        d.lit = render_key_program(item.key) == RENDER_PROGRAM_LIT;
+        if (d.lit && select_object_lights(s, c, &d.lights)) d.light_count = (i32)d.lights.count;
+        u32 draw = software_raster_add_draw(r, d);
+        Mat4 model = mesh_draw_matrix(m, c.model);
+        if (p == RENDER_PASS_LINES) {
+            software_raster_draw_lines(r, m, model, s->view_projection, draw);
+        } else {
+            software_raster_draw_triangles(r, m, model, s->view_projection, draw,
+                p == RENDER_PASS_OUTLINE ? SOFTWARE_CULL_FRONT : SOFTWARE_CULL_BACK);
+            s->triangles += (m->index_count ? m->index_count : m->vertex_count) / 3;
+        }
+        s->draw_calls += 1;
+        s->vertices += m->vertex_count;
+        s->vertex_bytes += m->vertex_count * mesh_vertex_size(m);
+    }
+
+    SoftwareShading shading = {};
+    shading.clusters = &s->clusters;
+    shading.camera_pos = s->camera_pos;
+    const LightEnvironment* l = s->lights;
+    shading.ambient = l ? l->ambient_color * l->ambient_intensity : Vec3(0.3f, 0.3f, 0.3f);
+    software_raster_resolve(r, shading);
+    render_queue_clear(q);
+}
+
+void renderer_flush(RendererState* s) {
+    RenderQueue* q = &s->queue;
+    if (q->count == 0) return;
+    render_queue_sort(q);
+    if (render_backend() == RENDER_BACKEND_SOFTWARE) {
+        flush_software(s);
+        return;
     }
-    for (u32 i = 0; i < l->spot_light_count && i < MAX_SPOT_LIGHTS; i++) {
-        const SpotLight& spt = l->spot_lights[i];
-        if (s->loc_spot_light_pos[i] >= 0) {
-            glUniform4f(s->loc_spot_light_pos[i], spt.position.x, spt.position.y, spt.position.z, spt.range);
+
+    // Uniforms stay with their program, so values are tracked per program
+    BoundProgram bound[2] = {};
+    const Shader* shaders[2] = { &s->lit_shader, &s->flat_shader };
+    FlushState f = {};
+    f.submit = render_backend_uses_gl();
+    u32 pass = RENDER_PASS_OPAQUE;
+    for (u32 i = 0; i < q->count;) {
+        const RenderSortItem& item = q->items[i];
+        const RenderCommand& c = q->commands[item.command];
+        RenderPass p = render_key_pass(item.key);
+        RenderProgram prog = render_key_program(item.key);
+
+        if (p != pass) {
+            if (f.submit) glCullFace(p == RENDER_PASS_OUTLINE ? GL_FRONT : GL_BACK);
+            pass = p;
+        }
+        u32 run = instanced_run(s, q, i);
+        if (run >= INSTANCING_MIN_RUN) {
+            draw_instanced(s, &f, q, i, run);
+            i += run;
+            continue;
+        }
+
+        const Shader* shader = shaders[prog];
+        BoundProgram& b = bound[prog];
+        bind_program(s, &f, shader);
+        if (prog == RENDER_PROGRAM_LIT) {
+            prepare_lights(s, &f);
+            ObjectLights lights;
+            if (!select_object_lights(s, c, &lights)) {
+                memset(&lights, 0, sizeof(lights));
+                lights.count = ~0u;
+            }
+            if (!b.lights_set || memcmp(&b.lights, &lights, sizeof(lights))) {
+                if (f.submit) {
+                    glUniform4i(s->loc_object_lights, (i32)lights.packed[0], (i32)lights.packed[1],
+                        (i32)lights.packed[2], (i32)lights.packed[3]);
+                    glUniform1i(s->loc_object_light_count, (i32)lights.count);
+                }
+                b.lights = lights;
+                b.lights_set = true;
+                s->uniform_uploads += 2;
+            }
         }
-        if (s->loc_spot_light_dir[i] >= 0) {
-            glUniform4f(s->loc_spot_light_dir[i], spt.direction.x, spt.direction.y, spt.direction.z, spt.inner_cos);
+        bind_vao(s, &f, c.mesh->vao);
+
+        Mat4 model = mesh_draw_matrix(c.mesh, c.model);
+        Mat4 mvp = mat4_multiply(s->view_projection, model);
+        if (f.submit) shader_set_mvp(shader, mvp);
+        s->uniform_uploads++;
+        if (shader->loc_model >= 0 && (!b.model_set || memcmp(&b.model, &model, sizeof(Mat4)))) {
+            if (f.submit) shader_set_model(shader, model);
+            b.model = model;
+            b.model_set = true;
+            s->uniform_uploads++;
         }
-        if (s->loc_spot_light_color[i] >= 0) {
-            glUniform4f(s->loc_spot_light_color[i], spt.color.x, spt.color.y, spt.color.z, spt.intensity);
+        if (!b.color_set || memcmp(&b.color, &c.color, sizeof(Vec3))) {
+            if (f.submit) shader_set_color(shader, c.color.x, c.color.y, c.color.z, 1.0f);
+            b.color = c.color;
+            b.color_set = true;
+            s->uniform_uploads++;
         }
-        if (s->loc_spot_light_params[i] >= 0) {
-            glUniform4f(s->loc_spot_light_params[i], spt.outer_cos, spt.falloff, 0.0f, 0.0f);
+
+        const Mesh* m = c.mesh;
+        if (p == RENDER_PASS_LINES) {
+            if (f.submit) glDrawArrays(GL_LINES, 0, m->vertex_count);
+        } else if (m->index_count > 0) {
+            if (f.submit) glDrawElements(GL_TRIANGLES, m->index_count, GL_UNSIGNED_INT, 0);
+            s->triangles += m->index_count / 3;
+        } else {
+            if (f.submit) glDrawArrays(GL_TRIANGLES, 0, m->vertex_count);
+            s->triangles += m->vertex_count / 3;
         }
+        s->draw_calls += 1;
+        s->vertices += m->vertex_count;
+        s->vertex_bytes += m->vertex_count * mesh_vertex_size(m);
+        i++;
+    }
+    if (f.submit) {
+        glBindVertexArray(0);
+        if (pass != RENDER_PASS_OPAQUE) glCullFace(GL_BACK);
     }
+    render_queue_clear(q);
+}
+
+void renderer_build_occlusion(RendererState* s, const AABB* occluders, u32 count) {
+    occlusion_build(&s->occlusion, s->view, s->projection, s->camera_pos, occluders, count);
 }
 
 void renderer_draw_mesh(RendererState* s, const Mesh* m, const Mat4& model, const Vec3& color) {
     if (!m || !m->vao) return;
-    Mat4 mvp = mat4_multiply(s->view_projection, model);
-    shader_bind(&s->lit_shader);
-    shader_set_mvp(&s->lit_shader, mvp);
-    shader_set_model(&s->lit_shader, model);
-    shader_set_color(&s->lit_shader, color.x, color.y, color.z, 1.0f);
-    upload_lights(s, s->lights, s->camera_pos);
-    mesh_draw(m);
-    s->draw_calls += 1;
-    s->vertices += m->vertex_count;
-    if (m->index_count > 0) {
-        s->triangles += m->index_count / 3;
-    }
-    else {
-        s->triangles += m->vertex_count / 3;
-    }
+    queue_draw(s, RENDER_PASS_OPAQUE, RENDER_PROGRAM_LIT, m, model, color);
 }
 
 void renderer_draw_mesh_outline(RendererState* s, const Mesh* m, const Mat4& model, const Vec3& color, f32 scale) {
     if (!m || !m->vao) return;
     f32 safe_scale = (scale > 0.0f) ? scale : 1.0f;
     Mat4 outline_model = mat4_multiply(model, mat4_scale(Vec3(safe_scale, safe_scale, safe_scale)));
-    Mat4 mvp = mat4_multiply(s->view_projection, outline_model);
-    shader_bind(&s->flat_shader);
-    shader_set_mvp(&s->flat_shader, mvp);
-    shader_set_color(&s->flat_shader, color.x, color.y, color.z, 1.0f);
-    glCullFace(GL_FRONT);
-    mesh_draw(m);
-    glCullFace(GL_BACK);
-    s->draw_calls += 1;
-    s->vertices += m->vertex_count;
-    if (m->index_count > 0) {
-        s->triangles += m->index_count / 3;
-    }
-    else {
-        s->triangles += m->vertex_count / 3;
-    }
+    queue_draw(s, RENDER_PASS_OUTLINE, RENDER_PROGRAM_FLAT, m, outline_model, color);
 }
 
 void renderer_draw_cube(RendererState* s, const Vec3& pos, const Vec3& scale, const Vec3& color) {
@@ -306,17 +786,7 @@ void renderer_draw_cube(RendererState* s, const Vec3& pos, const Vec3& scale, co
 }
 
 void renderer_draw_grid(RendererState* s) {
-    Mat4 model = Mat4::identity();
-    Mat4 mvp = mat4_multiply(s->view_projection, model);
-    shader_bind(&s->lit_shader);
-    shader_set_mvp(&s->lit_shader, mvp);
-    shader_set_model(&s->lit_shader, model);
-    shader_set_color(&s->lit_shader, 1.0f, 1.0f, 1.0f, 1.0f);
-    glBindVertexArray(s->grid_mesh.vao);
-    glDrawArrays(GL_LINES, 0, s->grid_mesh.vertex_count);
-    glBindVertexArray(0);
-    s->draw_calls += 1;
-    s->vertices += s->grid_mesh.vertex_count;
+    queue_draw(s, RENDER_PASS_LINES, RENDER_PROGRAM_LIT, &s->grid_mesh, Mat4::identity(), Vec3(1, 1, 1));
 }
 
 Mat4 renderer_get_view_projection(const RendererState* s) { return s->view_projection; }
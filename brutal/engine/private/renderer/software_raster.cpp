@@ -0,0 +1,779 @@
+#include "brutal/renderer/software_raster.h"
+#include "brutal/renderer/light_clusters.h"
+#include "brutal/renderer/mesh.h"
+#include "brutal/core/jobs.h"
+#include "brutal/core/logging.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace brutal {
+
+// Steps per pixel vertices are snapped to
+static constexpr f32 SUBPIXEL = 16.0f;
+// Triangles are clipped to the near plane and to a guard band this many
+// times the viewport, which keeps snapped coordinates and edge values small
+static constexpr f32 GUARD_BAND = 1.5f;
+static constexpr u32 CLIP_PLANES = 5;
+static constexpr u32 CLIP_MAX_VERTS = 3 + CLIP_PLANES;
+// Meshes with more vertices are transformed on the job pool
+static constexpr u32 PARALLEL_VERTICES = 4096;
+static constexpr u32 VERTEX_BATCH = 1024;
+static constexpr u32 GAMMA_LUT_SIZE = 4096;
+
+// Clip-space outcodes: outside the viewport on one side (trivially rejected
+// when all three vertices share it), and needing the clipper
+static constexpr u32 OUT_VIEW = 0x3F;
+static constexpr u32 OUT_NEAR = 0x10;
+static constexpr u32 OUT_GUARD = 0x40;
+static constexpr u32 OUT_CLIP = OUT_NEAR | OUT_GUARD;
+
+static u8 g_gamma[GAMMA_LUT_SIZE];
+
+template <typename T>
+static bool reserve(T** p, u32* capacity, u32 needed) {
+    if (needed <= *capacity) return true;
+    u32 cap = *capacity ? *capacity : 1024;
+    while (cap < needed) cap *= 2;
+    T* grown = (T*)realloc(*p, sizeof(T) * cap);
+    if (!grown) return false;
+    *p = grown;
+    *capacity = cap;
+    return true;
+}
+
+static u32 pack_rgba(f32 r, f32 g, f32 b) {
+    auto unorm = [](f32 v) { return (u32)(fminf(fmaxf(v, 0.0f), 1.0f) * 255.0f + 0.5f); };
+    return unorm(r) | (unorm(g) << 8) | (unorm(b) << 16) | 0xFF000000u;
+}
+
+bool software_raster_create(SoftwareRaster* r) {
+    *r = {};
+    for (u32 i = 0; i < GAMMA_LUT_SIZE; i++) {
+        g_gamma[i] = (u8)(powf((f32)i / (f32)(GAMMA_LUT_SIZE - 1), 1.0f / 2.2f) * 255.0f + 0.5f);
+    }
+    return true;
+}
+
+void software_raster_destroy(SoftwareRaster* r) {
+    free(r->framebuffer.color);
+    free(r->framebuffer.depth);
+    free(r->vertices);
+    free(r->clip);
+    free(r->triangles);
+    free(r->lines);
+    free(r->draws);
+    free(r->tile_first);
+    free(r->tile_pixels);
+    free(r->tile_triangles);
+    *r = {};
+}
+
+bool software_raster_begin_frame(SoftwareRaster* r, u32 width, u32 height, const Vec3& clear_color) {
+    SoftwareFramebuffer* fb = &r->framebuffer;
+    u32 pixels = width * height;
+    if (pixels > r->framebuffer_capacity) {
+        free(fb->color);
+        free(fb->depth);
+        fb->color = (u32*)malloc(sizeof(u32) * pixels);
+        fb->depth = (f32*)malloc(sizeof(f32) * pixels);
+        r->framebuffer_capacity = fb->color && fb->depth ? pixels : 0;
+        if (!r->framebuffer_capacity) {
+            LOG_ERROR("Software framebuffer: out of memory for %ux%u", width, height);
+            fb->width = fb->height = 0;
+            return false;
+        }
+    }
+    fb->width = width;
+    fb->height = height;
+    r->tiles_x = (width + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+    r->tiles_y = (height + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+    u32 tiles = r->tiles_x * r->tiles_y;
+    if (tiles > r->tile_capacity) {
+        free(r->tile_first);
+        free(r->tile_pixels);
+        r->tile_first = (u32*)malloc(sizeof(u32) * (tiles + 1));
+        r->tile_pixels = (u32*)malloc(sizeof(u32) * tiles);
+        r->tile_capacity = r->tile_first && r->tile_pixels ? tiles : 0;
+        if (!r->tile_capacity) return false;
+    }
+
+    r->clear_color = pack_rgba(clear_color.x, clear_color.y, clear_color.z);
+    for (u32 i = 0; i < pixels; i++) fb->color[i] = r->clear_color;
+    for (u32 i = 0; i < pixels; i++) fb->depth[i] = 1.0f;
+    r->vertex_count = r->triangle_count = r->line_count = r->draw_count = 0;
+    r->triangles_binned = 0;
+    r->pixels_shaded = 0;
+    return true;
+}
+
+u32 software_raster_add_draw(SoftwareRaster* r, const SoftwareDraw& draw) {
+    if (!reserve(&r->draws, &r->draw_capacity, r->draw_count + 1)) return 0;
+    r->draws[r->draw_count] = draw;
+    return r->draw_count++;
+}
+
+// =============================================================================
+// Vertices
+// =============================================================================
+static f32 snap(f32 p) {
+    return floorf(p * SUBPIXEL + 0.5f) * (1.0f / SUBPIXEL);
+}
+
+static u32 outcode(const Vec4& c) {
+    u32 code = 0;
+    if (c.x > c.w) code |= 0x01;
+    if (c.x < -c.w) code |= 0x02;
+    if (c.y > c.w) code |= 0x04;
+    if (c.y < -c.w) code |= 0x08;
+    if (c.z < -c.w) code |= OUT_NEAR;
+    if (c.z > c.w) code |= 0x20;
+    f32 g = GUARD_BAND * c.w;
+    if (c.x > g || c.x < -g || c.y > g || c.y < -g) code |= OUT_GUARD;
+    return code;
+}
+
+static void project(SoftwareVertex* v, const Vec4& c, f32 width, f32 height) {
+    f32 inv = 1.0f / c.w;
+    v->x = snap((c.x * inv * 0.5f + 0.5f) * width);
+    v->y = snap((0.5f - c.y * inv * 0.5f) * height);
+    v->z = c.z * inv;
+    v->inv_w = inv;
+}
+
+struct VertexJob {
+    SoftwareRaster* r;
+    const Vertex* in;
+    u32 base;
+    Mat4 model, mvp;
+};
+
+static void transform_vertices(void* user, u32 begin, u32 end) {
+    const VertexJob* job = static_cast<const VertexJob*>(user);
+    const f32* m = job->model.m;
+    const f32* p = job->mvp.m;
+    f32 width = (f32)job->r->framebuffer.width, height = (f32)job->r->framebuffer.height;
+    for (u32 i = begin; i < end; i++) {
+        const Vertex& v = job->in[i];
+        const Vec3& a = v.position;
+        Vec4 c(p[0] * a.x + p[4] * a.y + p[8] * a.z + p[12], p[1] * a.x + p[5] * a.y + p[9] * a.z + p[13],
+            p[2] * a.x + p[6] * a.y + p[10] * a.z + p[14], p[3] * a.x + p[7] * a.y + p[11] * a.z + p[15]);
+        SoftwareVertex& o = job->r->vertices[job->base + i];
+        o.world = Vec3(m[0] * a.x + m[4] * a.y + m[8] * a.z + m[12], m[1] * a.x + m[5] * a.y + m[9] * a.z + m[13],
+            m[2] * a.x + m[6] * a.y + m[10] * a.z + m[14]);
+        const Vec3& n = v.normal;
+        o.normal = Vec3(m[0] * n.x + m[4] * n.y + m[8] * n.z, m[1] * n.x + m[5] * n.y + m[9] * n.z,
+            m[2] * n.x + m[6] * n.y + m[10] * n.z);
+        o.color = v.color;
+        job->r->clip[job->base + i] = c;
+        // Vertices the clipper will replace are never read projected
+        if (!(outcode(c) & OUT_CLIP)) project(&o, c, width, height);
+    }
+}
+
+// Transforms the mesh's vertices into the recording; returns the first index
+static bool add_vertices(SoftwareRaster* r, const Mesh* m, const Mat4& model, const Mat4& view_projection, u32* base) {
+    u32 count = m->vertex_count;
+    if (!reserve(&r->vertices, &r->vertex_capacity, r->vertex_count + count) ||
+        !reserve(&r->clip, &r->clip_capacity, r->vertex_count + count)) {
+        return false;
+    }
+    VertexJob job = { r, m->cpu_vertices, r->vertex_count, model, mat4_multiply(view_projection, model) };
+    if (count >= PARALLEL_VERTICES) parallel_for(count, VERTEX_BATCH, transform_vertices, &job);
+    else transform_vertices(&job, 0, count);
+    *base = r->vertex_count;
+    r->vertex_count += count;
+    return true;
+}
+
+// =============================================================================
+// Triangle setup
+// =============================================================================
+static void add_triangle(SoftwareRaster* r, u32 i0, u32 i1, u32 i2, u32 draw, SoftwareCull cull) {
+    const SoftwareVertex* v = r->vertices;
+    f64 area = ((f64)v[i1].x - v[i0].x) * ((f64)v[i2].y - v[i0].y) - ((f64)v[i2].x - v[i0].x) * ((f64)v[i1].y - v[i0].y);
+    if (area == 0.0) return;
+    // y runs down the screen, so GL's counter-clockwise front faces come out
+    // clockwise here
+    bool front = area < 0.0;
+    if ((cull == SOFTWARE_CULL_BACK && !front) || (cull == SOFTWARE_CULL_FRONT && front)) return;
+    if (area < 0.0) {
+        u32 swap = i1; i1 = i2; i2 = swap;
+        area = -area;
+    }
+
+    const SoftwareFramebuffer& fb = r->framebuffer;
+    f32 lo_x = fminf(v[i0].x, fminf(v[i1].x, v[i2].x)), hi_x = fmaxf(v[i0].x, fmaxf(v[i1].x, v[i2].x));
+    f32 lo_y = fminf(v[i0].y, fminf(v[i1].y, v[i2].y)), hi_y = fmaxf(v[i0].y, fmaxf(v[i1].y, v[i2].y));
+    // Pixels whose centre can be inside
+    i32 min_x = (i32)ceilf(lo_x - 0.5f), max_x = (i32)floorf(hi_x - 0.5f);
+    i32 min_y = (i32)ceilf(lo_y - 0.5f), max_y = (i32)floorf(hi_y - 0.5f);
+    if (min_x < 0) min_x = 0;
+    if (min_y < 0) min_y = 0;
+    if (max_x > (i32)fb.width - 1) max_x = (i32)fb.width - 1;
+    if (max_y > (i32)fb.height - 1) max_y = (i32)fb.height - 1;
+    if (min_x > max_x || min_y > max_y) return;
+    if (!reserve(&r->triangles, &r->triangle_capacity, r->triangle_count + 1)) return;
+
+    SoftwareTriangle& t = r->triangles[r->triangle_count++];
+    t.v[0] = i0;
+    t.v[1] = i1;
+    t.v[2] = i2;
+    t.draw = draw;
+    for (u32 e = 0; e < 3; e++) {
+        const SoftwareVertex& a = v[t.v[e]];
+        const SoftwareVertex& b = v[t.v[(e + 1) % 3]];
+        t.a[e] = a.y - b.y;
+        t.b[e] = b.x - a.x;
+    }
+    t.inv_area = (f32)(1.0 / area);
+    // Depth is a plane through v[0]; it moves with the weights of v[1] and
+    // v[2], which are edges 2 and 0 over the area
+    f32 dz1 = v[i1].z - v[i0].z, dz2 = v[i2].z - v[i0].z;
+    t.z_dx = (t.a[2] * dz1 + t.a[0] * dz2) * t.inv_area;
+    t.z_dy = (t.b[2] * dz1 + t.b[0] * dz2) * t.inv_area;
+    t.min_x = min_x;
+    t.min_y = min_y;
+    t.max_x = max_x;
+    t.max_y = max_y;
+}
+
+struct ClipVertex {
+    Vec4 c;
+    Vec3 world, normal, color;
+};
+
+static f32 clip_distance(const Vec4& c, u32 plane) {
+    switch (plane) {
+    case 0: return c.z + c.w;
+    case 1: return GUARD_BAND * c.w - c.x;
+    case 2: return GUARD_BAND * c.w + c.x;
+    case 3: return GUARD_BAND * c.w - c.y;
+    default: return GUARD_BAND * c.w + c.y;
+    }
+}
+
+static ClipVertex clip_lerp(const ClipVertex& a, const ClipVertex& b, f32 t) {
+    ClipVertex o;
+    o.c = Vec4(a.c.x + (b.c.x - a.c.x) * t, a.c.y + (b.c.y - a.c.y) * t, a.c.z + (b.c.z - a.c.z) * t,
+        a.c.w + (b.c.w - a.c.w) * t);
+    o.world = a.world + (b.world - a.world) * t;
+    o.normal = a.normal + (b.normal - a.normal) * t;
+    o.color = a.color + (b.color - a.color) * t;
+    return o;
+}
+
+static ClipVertex clip_vertex(const SoftwareRaster* r, u32 i) {
+    const SoftwareVertex& v = r->vertices[i];
+    return { r->clip[i], v.world, v.normal, v.color };
+}
+
+// Appends a clipped vertex, projected
+static u32 push_vertex(SoftwareRaster* r, const ClipVertex& c) {
+    if (!reserve(&r->vertices, &r->vertex_capacity, r->vertex_count + 1) ||
+        !reserve(&r->clip, &r->clip_capacity, r->vertex_count + 1)) {
+        return ~0u;
+    }
+    u32 i = r->vertex_count++;
+    SoftwareVertex& v = r->vertices[i];
+    v.world = c.world;
+    v.normal = c.normal;
+    v.color = c.color;
+    r->clip[i] = c.c;
+    project(&v, c.c, (f32)r->framebuffer.width, (f32)r->framebuffer.height);
+    return i;
+}
+
+// Sutherland-Hodgman against the near plane and the guard band, then a fan
+static void clip_triangle(SoftwareRaster* r, u32 i0, u32 i1, u32 i2, u32 draw, SoftwareCull cull) {
+    ClipVertex poly[CLIP_MAX_VERTS], out[CLIP_MAX_VERTS];
+    poly[0] = clip_vertex(r, i0);
+    poly[1] = clip_vertex(r, i1);
+    poly[2] = clip_vertex(r, i2);
+    u32 count = 3;
+    for (u32 plane = 0; plane < CLIP_PLANES; plane++) {
+        u32 n = 0;
+        for (u32 i = 0; i < count; i++) {
+            const ClipVertex& a = poly[i];
+            const ClipVertex& b = poly[(i + 1) % count];
+            f32 da = clip_distance(a.c, plane), db = clip_distance(b.c, plane);
+            if (da >= 0.0f) out[n++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f)) out[n++] = clip_lerp(a, b, da / (da - db));
+        }
+        if (n < 3) return;
+        memcpy(poly, out, sizeof(ClipVertex) * n);
+        count = n;
+    }
+    u32 first = push_vertex(r, poly[0]);
+    u32 prev = push_vertex(r, poly[1]);
+    for (u32 k = 2; k < count; k++) {
+        u32 next = push_vertex(r, poly[k]);
+        if (first == ~0u || prev == ~0u || next == ~0u) return;
+        add_triangle(r, first, prev, next, draw, cull);
+        prev = next;
+    }
+}
+
+void software_raster_draw_triangles(SoftwareRaster* r, const Mesh* m, const Mat4& model, const Mat4& view_projection,
+    u32 draw, SoftwareCull cull) {
+    if (!m->cpu_vertices || !m->vertex_count || !r->framebuffer.width) return;
+    u32 base;
+    if (!add_vertices(r, m, model, view_projection, &base)) return;
+    u32 count = m->index_count ? m->index_count : m->vertex_count;
+    for (u32 k = 0; k + 2 < count; k += 3) {
+        u32 i0 = base + (m->index_count ? m->cpu_indices[k] : k);
+        u32 i1 = base + (m->index_count ? m->cpu_indices[k + 1] : k + 1);
+        u32 i2 = base + (m->index_count ? m->cpu_indices[k + 2] : k + 2);
+        u32 c0 = outcode(r->clip[i0]), c1 = outcode(r->clip[i1]), c2 = outcode(r->clip[i2]);
+        if (c0 & c1 & c2 & OUT_VIEW) continue;
+        if ((c0 | c1 | c2) & OUT_CLIP) clip_triangle(r, i0, i1, i2, draw, cull);
+        else add_triangle(r, i0, i1, i2, draw, cull);
+    }
+}
+
+void software_raster_draw_lines(SoftwareRaster* r, const Mesh* m, const Mat4& model, const Mat4& view_projection,
+    u32 draw) {
+    if (!m->cpu_vertices || !m->vertex_count || !r->framebuffer.width) return;
+    u32 base;
+    if (!add_vertices(r, m, model, view_projection, &base)) return;
+    for (u32 k = 0; k + 1 < m->vertex_count; k += 2) {
+        ClipVertex a = clip_vertex(r, base + k), b = clip_vertex(r, base + k + 1);
+        if (outcode(a.c) & outcode(b.c) & OUT_VIEW) continue;
+        // Parametric clip of the segment to the same planes as triangles
+        f32 t0 = 0.0f, t1 = 1.0f;
+        for (u32 plane = 0; plane < CLIP_PLANES && t0 <= t1; plane++) {
+            f32 da = clip_distance(a.c, plane), db = clip_distance(b.c, plane);
+            if (da < 0.0f && db < 0.0f) t0 = 2.0f;
+            else if (da < 0.0f) t0 = fmaxf(t0, da / (da - db));
+            else if (db < 0.0f) t1 = fminf(t1, da / (da - db));
+        }
+        if (t0 > t1) continue;
+        if (!reserve(&r->lines, &r->line_capacity, r->line_count + 1)) return;
+        u32 i0 = push_vertex(r, clip_lerp(a, b, t0));
+        u32 i1 = push_vertex(r, clip_lerp(a, b, t1));
+        if (i0 == ~0u || i1 == ~0u) return;
+        r->lines[r->line_count++] = { { i0, i1 }, draw };
+    }
+}
+
+// =============================================================================
+// Shading
+// =============================================================================
+// lit_frag on the CPU, for a row of pixels at a time. Visible pixels are
+// gathered with their attributes in one array each; consecutive pixels with
+// the same light list (a froxel's, or an object's own) are then lit one
+// light at a time over the whole run, in branch-free loops the compiler
+// turns into SIMD, before the same tone map and gamma.
+static constexpr u32 OBJECT_LIST = 0x80000000u;   // Low bits: the draw
+static constexpr u32 NO_LIGHTS = 0xFFFFFFFFu;
+
+struct LitSpan {
+    u32 count;
+    u32 x[SOFTWARE_TILE_SIZE];
+    u32 list[SOFTWARE_TILE_SIZE];
+    f32 wx[SOFTWARE_TILE_SIZE], wy[SOFTWARE_TILE_SIZE], wz[SOFTWARE_TILE_SIZE];
+    f32 nx[SOFTWARE_TILE_SIZE], ny[SOFTWARE_TILE_SIZE], nz[SOFTWARE_TILE_SIZE];
+    f32 vx[SOFTWARE_TILE_SIZE], vy[SOFTWARE_TILE_SIZE], vz[SOFTWARE_TILE_SIZE];
+    f32 base_r[SOFTWARE_TILE_SIZE], base_g[SOFTWARE_TILE_SIZE], base_b[SOFTWARE_TILE_SIZE];
+    f32 diffuse_r[SOFTWARE_TILE_SIZE], diffuse_g[SOFTWARE_TILE_SIZE], diffuse_b[SOFTWARE_TILE_SIZE];
+    f32 specular_r[SOFTWARE_TILE_SIZE], specular_g[SOFTWARE_TILE_SIZE], specular_b[SOFTWARE_TILE_SIZE];
+    // Per light, reused
+    f32 lx[SOFTWARE_TILE_SIZE], ly[SOFTWARE_TILE_SIZE], lz[SOFTWARE_TILE_SIZE], att[SOFTWARE_TILE_SIZE];
+};
+
+static f32 smoothstep(f32 e0, f32 e1, f32 x) {
+    f32 t = (x - e0) / (e1 - e0);
+    t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+static i32 clamp_cell(i32 v, u32 n) {
+    return v < 0 ? 0 : (v >= (i32)n ? (i32)n - 1 : v);
+}
+
+// Adds a lit pixel at x; world, normal and color already interpolated
+static void span_push(LitSpan* span, const SoftwareRaster* r, u32 draw, u32 x, const Vec3& world, const Vec3& normal,
+    const Vec3& color, f32 ndc_x, f32 ndc_y, f32 view_w) {
+    const SoftwareShading& sh = r->shading;
+    const SoftwareDraw& d = r->draws[draw];
+    const LightClusters* c = sh.clusters;
+    u32 k = span->count++;
+    span->x[k] = x;
+    if (c && d.light_count >= 0) {
+        span->list[k] = OBJECT_LIST | draw;
+    } else if (c && c->light_count) {
+        i32 tx = clamp_cell((i32)((ndc_x * 0.5f + 0.5f) * (f32)CLUSTER_GRID_X), CLUSTER_GRID_X);
+        i32 ty = clamp_cell((i32)((ndc_y * 0.5f + 0.5f) * (f32)CLUSTER_GRID_Y), CLUSTER_GRID_Y);
+        i32 slice = clamp_cell((i32)(logf(view_w) * c->depth_scale + c->depth_bias), CLUSTER_GRID_Z);
+        span->list[k] = ((u32)slice * CLUSTER_GRID_Y + (u32)ty) * CLUSTER_GRID_X + (u32)tx;
+    } else {
+        span->list[k] = NO_LIGHTS;
+    }
+    f32 nl = vec3_length(normal);
+    Vec3 n = nl > 0.0f ? normal * (1.0f / nl) : normal;
+    Vec3 v = sh.camera_pos - world;
+    f32 vl = vec3_length(v);
+    if (vl > 0.0f) v = v * (1.0f / vl);
+    span->wx[k] = world.x;
+    span->wy[k] = world.y;
+    span->wz[k] = world.z;
+    span->nx[k] = n.x;
+    span->ny[k] = n.y;
+    span->nz[k] = n.z;
+    span->vx[k] = v.x;
+    span->vy[k] = v.y;
+    span->vz[k] = v.z;
+    span->base_r[k] = color.x * d.color.x;
+    span->base_g[k] = color.y * d.color.y;
+    span->base_b[k] = color.z * d.color.z;
+    span->diffuse_r[k] = span->diffuse_g[k] = span->diffuse_b[k] = 0.0f;
+    span->specular_r[k] = span->specular_g[k] = span->specular_b[k] = 0.0f;
+}
+
+// One light over span pixels [begin, end)
+static void span_add_light(LitSpan* s, const LightClusters* c, u32 light, u32 begin, u32 end) {
+    const f32* d = &c->light_data[light * CLUSTER_LIGHT_FLOATS];
+    f32 px = d[0], py = d[1], pz = d[2];
+    f32 inv_range = 1.0f / d[3];
+    f32 inv_soft = 1.0f / (d[3] * d[3] * 0.1f);
+    for (u32 k = begin; k < end; k++) {
+        f32 lx = px - s->wx[k], ly = py - s->wy[k], lz = pz - s->wz[k];
+        f32 dist2 = lx * lx + ly * ly + lz * lz;
+        // Clamped rather than branched on, so the loop stays straight-line;
+        // a light exactly on the pixel leaves L zero
+        f32 dist = sqrtf(dist2);
+        f32 inv = 1.0f / (dist > 1e-20f ? dist : 1e-20f);
+        f32 fade = 1.0f - dist * inv_range;
+        fade = fade > 0.0f ? fade : 0.0f;
+        f32 att = fade / (1.0f + dist2 * inv_soft);
+        s->lx[k] = lx * inv;
+        s->ly[k] = ly * inv;
+        s->lz[k] = lz * inv;
+        s->att[k] = att * att;
+    }
+    if (d[14] > 0.5f) {
+        f32 dl = sqrtf(d[8] * d[8] + d[9] * d[9] + d[10] * d[10]);
+        f32 dx = d[8] / dl, dy = d[9] / dl, dz = d[10] / dl;
+        f32 falloff = d[13] > 0.001f ? d[13] : 0.001f;
+        for (u32 k = begin; k < end; k++) {
+            if (s->att[k] <= 0.0f) continue;
+            f32 cone = smoothstep(d[12], d[11], -(s->lx[k] * dx + s->ly[k] * dy + s->lz[k] * dz));
+            s->att[k] *= powf(cone, falloff);
+        }
+    }
+    f32 cr = d[4] * d[7], cg = d[5] * d[7], cb = d[6] * d[7];
+    for (u32 k = begin; k < end; k++) {
+        f32 ndl = s->nx[k] * s->lx[k] + s->ny[k] * s->ly[k] + s->nz[k] * s->lz[k];
+        ndl = ndl > 0.0f ? ndl : 0.0f;
+        f32 hx = s->lx[k] + s->vx[k], hy = s->ly[k] + s->vy[k], hz = s->lz[k] + s->vz[k];
+        f32 h2 = hx * hx + hy * hy + hz * hz;
+        f32 ndh = s->nx[k] * hx + s->ny[k] * hy + s->nz[k] * hz;
+        ndh *= 1.0f / sqrtf(h2 > 1e-20f ? h2 : 1e-20f);
+        ndh = ndh > 0.0f ? ndh : 0.0f;
+        // pow(ndh, 32)
+        f32 p = ndh * ndh;
+        p *= p;
+        p *= p;
+        p *= p;
+        p *= p;
+        f32 diffuse = ndl * s->att[k];
+        f32 specular = p * s->att[k] * 0.2f;
+        s->diffuse_r[k] += cr * diffuse;
+        s->diffuse_g[k] += cg * diffuse;
+        s->diffuse_b[k] += cb * diffuse;
+        s->specular_r[k] += cr * specular;
+        s->specular_g[k] += cg * specular;
+        s->specular_b[k] += cb * specular;
+    }
+}
+
+static u32 tone(f32 x) {
+    x = x > 0.0f ? x / (x + 1.0f) : 0.0f;
+    return (u32)g_gamma[(u32)(x * (f32)(GAMMA_LUT_SIZE - 1) + 0.5f)];
+}
+
+// Lights the gathered pixels and writes them to the row; empties the span
+static void span_resolve(LitSpan* s, const SoftwareRaster* r, u32* row) {
+    const LightClusters* c = r->shading.clusters;
+    for (u32 i = 0; i < s->count;) {
+        u32 list = s->list[i];
+        u32 j = i + 1;
+        while (j < s->count && s->list[j] == list) j++;
+        if (list == NO_LIGHTS) {
+            i = j;
+            continue;
+        }
+        if (list & OBJECT_LIST) {
+            const SoftwareDraw& d = r->draws[list & ~OBJECT_LIST];
+            for (i32 k = 0; k < d.light_count; k++) {
+                span_add_light(s, c, (d.lights.packed[k >> 1] >> ((k & 1) * 16)) & 0xFFFF, i, j);
+            }
+        } else {
+            u32 cell = c->grid[list];
+            u32 first = cell >> 8, count = cell & 0xFF;
+            for (u32 k = 0; k < count; k++) span_add_light(s, c, c->indices[first + k], i, j);
+        }
+        i = j;
+    }
+    Vec3 a = r->shading.ambient;
+    for (u32 k = 0; k < s->count; k++) {
+        f32 lr = s->base_r[k] * (a.x + s->diffuse_r[k]) + s->specular_r[k];
+        f32 lg = s->base_g[k] * (a.y + s->diffuse_g[k]) + s->specular_g[k];
+        f32 lb = s->base_b[k] * (a.z + s->diffuse_b[k]) + s->specular_b[k];
+        row[s->x[k]] = tone(lr) | (tone(lg) << 8) | (tone(lb) << 16) | 0xFF000000u;
+    }
+    s->count = 0;
+}
+
+// =============================================================================
+// Tiles
+// =============================================================================
+static void bin_triangles(SoftwareRaster* r) {
+    u32 tiles = r->tiles_x * r->tiles_y;
+    u32* first = r->tile_first;
+    memset(first, 0, sizeof(u32) * (tiles + 1));
+    for (u32 i = 0; i < r->triangle_count; i++) {
+        const SoftwareTriangle& t = r->triangles[i];
+        for (u32 ty = (u32)t.min_y / SOFTWARE_TILE_SIZE; ty <= (u32)t.max_y / SOFTWARE_TILE_SIZE; ty++) {
+            for (u32 tx = (u32)t.min_x / SOFTWARE_TILE_SIZE; tx <= (u32)t.max_x / SOFTWARE_TILE_SIZE; tx++) {
+                first[ty * r->tiles_x + tx + 1]++;
+            }
+        }
+    }
+    for (u32 i = 1; i <= tiles; i++) first[i] += first[i - 1];
+    if (!reserve(&r->tile_triangles, &r->tile_ref_capacity, first[tiles])) {
+        memset(first, 0, sizeof(u32) * (tiles + 1));
+        return;
+    }
+    // Filled in recording order so each tile draws in submission order;
+    // tile_pixels doubles as the fill cursor until the tiles run
+    u32* cursor = r->tile_pixels;
+    memcpy(cursor, first, sizeof(u32) * tiles);
+    for (u32 i = 0; i < r->triangle_count; i++) {
+        const SoftwareTriangle& t = r->triangles[i];
+        for (u32 ty = (u32)t.min_y / SOFTWARE_TILE_SIZE; ty <= (u32)t.max_y / SOFTWARE_TILE_SIZE; ty++) {
+            for (u32 tx = (u32)t.min_x / SOFTWARE_TILE_SIZE; tx <= (u32)t.max_x / SOFTWARE_TILE_SIZE; tx++) {
+                r->tile_triangles[cursor[ty * r->tiles_x + tx]++] = i;
+            }
+        }
+    }
+}
+
+// Pixel span of one row of a tile the triangle may cover. Computed in double
+// with slack for the float rounding of the per-pixel test, which has the
+// final say.
+static bool row_span(const f64* c, const f32* a, i32* lo, i32* hi) {
+    for (u32 e = 0; e < 3; e++) {
+        if (a[e] == 0.0f) {
+            if (c[e] < 0.0) return false;
+            continue;
+        }
+        f64 cross = -c[e] / a[e];
+        f64 slack = 2.0 + fabs(c[e]) * (1.0 / 8388608.0) / fabs(a[e]);
+        if (a[e] > 0.0f) {
+            f64 first = floor(cross - slack);
+            if (first > *lo) *lo = first > *hi ? *hi + 1 : (i32)first;
+        } else {
+            f64 last = ceil(cross + slack);
+            if (last < *hi) *hi = last < *lo ? *lo - 1 : (i32)last;
+        }
+    }
+    return *lo <= *hi;
+}
+
+// Depth-tests the triangle over its pixels in the tile, leaving its index + 1
+// in ids where it is nearest. Edge values of a row start from the tile's
+// left pixel, rounded once from double, and step by whole pixels: a shared
+// edge gives its two triangles exactly opposite values, and pixels exactly
+// on it go to the one whose edge points one fixed way, so each is drawn once.
+static void cover_triangle(const SoftwareRaster* r, u32 index, i32 x0, i32 y0, u32* ids) {
+    const SoftwareFramebuffer& fb = r->framebuffer;
+    const SoftwareTriangle& t = r->triangles[index];
+    const SoftwareVertex* v[3] = { &r->vertices[t.v[0]], &r->vertices[t.v[1]], &r->vertices[t.v[2]] };
+    i32 ay = t.min_y > y0 ? t.min_y : y0;
+    i32 by = t.max_y < y0 + (i32)SOFTWARE_TILE_SIZE - 1 ? t.max_y : y0 + (i32)SOFTWARE_TILE_SIZE - 1;
+    i32 kx0 = (t.min_x > x0 ? t.min_x : x0) - x0;
+    i32 kx1 = (t.max_x < x0 + (i32)SOFTWARE_TILE_SIZE - 1 ? t.max_x : x0 + (i32)SOFTWARE_TILE_SIZE - 1) - x0;
+    f32 a0 = t.a[0], a1 = t.a[1], a2 = t.a[2];
+    bool o0 = t.a[0] > 0.0f || (t.a[0] == 0.0f && t.b[0] > 0.0f);
+    bool o1 = t.a[1] > 0.0f || (t.a[1] == 0.0f && t.b[1] > 0.0f);
+    bool o2 = t.a[2] > 0.0f || (t.a[2] == 0.0f && t.b[2] > 0.0f);
+    f32 z_dx = t.z_dx;
+    u32 id = index + 1;
+    f64 px = (f64)x0 + 0.5;
+
+    for (i32 y = ay; y <= by; y++) {
+        f64 py = (f64)y + 0.5;
+        f64 c[3];
+        for (u32 e = 0; e < 3; e++) c[e] = (f64)t.a[e] * (px - v[e]->x) + (f64)t.b[e] * (py - v[e]->y);
+        i32 lo = kx0, hi = kx1;
+        if (!row_span(c, t.a, &lo, &hi)) continue;
+        f32 c0 = (f32)c[0], c1 = (f32)c[1], c2 = (f32)c[2];
+        f32 zr = (f32)(v[0]->z + t.z_dx * (px - v[0]->x) + t.z_dy * (py - v[0]->y));
+        f32* depth = fb.depth + (u32)y * fb.width + (u32)x0;
+        u32* row = ids + (u32)(y - y0) * SOFTWARE_TILE_SIZE;
+        for (i32 k = lo; k <= hi; k++) {
+            f32 dx = (f32)k;
+            f32 e0 = c0 + a0 * dx, e1 = c1 + a1 * dx, e2 = c2 + a2 * dx;
+            bool inside = ((e0 > 0.0f) | ((e0 == 0.0f) & o0)) & ((e1 > 0.0f) | ((e1 == 0.0f) & o1)) &
+                ((e2 > 0.0f) | ((e2 == 0.0f) & o2));
+            f32 z = zr + z_dx * dx;
+            bool pass = inside & (z < depth[k]);
+            depth[k] = pass ? z : depth[k];
+            row[k] = pass ? id : row[k];
+        }
+    }
+}
+
+
+// A visible triangle's pixel: flat draws are written, lit ones gathered with
+// barycentrics from the edges and attributes weighted perspective-correct
+static void shade_pixel(const SoftwareRaster* r, u32 index, i32 x, i32 y, u32* row, LitSpan* span) {
+    const SoftwareTriangle& t = r->triangles[index];
+    const SoftwareDraw& d = r->draws[t.draw];
+    if (!d.lit) {
+        row[x] = pack_rgba(d.color.x, d.color.y, d.color.z);
+        return;
+    }
+    const SoftwareFramebuffer& fb = r->framebuffer;
+    const SoftwareVertex& v0 = r->vertices[t.v[0]];
+    const SoftwareVertex& v1 = r->vertices[t.v[1]];
+    const SoftwareVertex& v2 = r->vertices[t.v[2]];
+    f32 px = (f32)x + 0.5f, py = (f32)y + 0.5f;
+    // Each vertex weighs by the edge opposite it
+    f32 l0 = (t.a[1] * (px - v1.x) + t.b[1] * (py - v1.y)) * t.inv_area;
+    f32 l1 = (t.a[2] * (px - v2.x) + t.b[2] * (py - v2.y)) * t.inv_area;
+    f32 l2 = (t.a[0] * (px - v0.x) + t.b[0] * (py - v0.y)) * t.inv_area;
+    f32 p0 = l0 * v0.inv_w, p1 = l1 * v1.inv_w, p2 = l2 * v2.inv_w;
+    f32 w = 1.0f / (p0 + p1 + p2);
+    p0 *= w;
+    p1 *= w;
+    p2 *= w;
+    span_push(span, r, t.draw, (u32)x, v0.world * p0 + v1.world * p1 + v2.world * p2,
+        v0.normal * p0 + v1.normal * p1 + v2.normal * p2, v0.color * p0 + v1.color * p1 + v2.color * p2,
+        px / (f32)fb.width * 2.0f - 1.0f, 1.0f - py / (f32)fb.height * 2.0f, w);
+}
+
+// Each tile owns its pixels, so tiles run independently. All of a tile's
+// triangles are depth tested first, then each pixel is shaded once, by the
+// triangle left nearest.
+static void raster_tiles(void* user, u32 begin, u32 end) {
+    SoftwareRaster* r = static_cast<SoftwareRaster*>(user);
+    const SoftwareFramebuffer& fb = r->framebuffer;
+    u32 ids[SOFTWARE_TILE_SIZE * SOFTWARE_TILE_SIZE];
+    LitSpan span;
+    span.count = 0;
+    for (u32 tile = begin; tile < end; tile++) {
+        i32 x0 = (i32)((tile % r->tiles_x) * SOFTWARE_TILE_SIZE);
+        i32 y0 = (i32)((tile / r->tiles_x) * SOFTWARE_TILE_SIZE);
+        u32 first = r->tile_first[tile], last = r->tile_first[tile + 1];
+        r->tile_pixels[tile] = 0;
+        if (first == last) continue;
+        memset(ids, 0, sizeof(ids));
+        for (u32 ref = first; ref < last; ref++) cover_triangle(r, r->tile_triangles[ref], x0, y0, ids);
+
+        i32 w = fb.width - (u32)x0 < SOFTWARE_TILE_SIZE ? (i32)(fb.width - (u32)x0) : (i32)SOFTWARE_TILE_SIZE;
+        i32 h = fb.height - (u32)y0 < SOFTWARE_TILE_SIZE ? (i32)(fb.height - (u32)y0) : (i32)SOFTWARE_TILE_SIZE;
+        u32 shaded = 0;
+        for (i32 y = y0; y < y0 + h; y++) {
+            const u32* id = ids + (u32)(y - y0) * SOFTWARE_TILE_SIZE - x0;
+            u32* row = fb.color + (u32)y * fb.width;
+            for (i32 x = x0; x < x0 + w; x++) {
+                if (!id[x]) continue;
+                shade_pixel(r, id[x] - 1, x, y, row, &span);
+                shaded++;
+            }
+            span_resolve(&span, r, row);
+        }
+        r->tile_pixels[tile] = shaded;
+    }
+}
+
+// Lines step along their major axis, one pixel per step, depth tested
+static void raster_lines(SoftwareRaster* r) {
+    const SoftwareFramebuffer& fb = r->framebuffer;
+    LitSpan span;
+    span.count = 0;
+    for (u32 i = 0; i < r->line_count; i++) {
+        const SoftwareLine& line = r->lines[i];
+        const SoftwareVertex& a = r->vertices[line.v[0]];
+        const SoftwareVertex& b = r->vertices[line.v[1]];
+        const SoftwareDraw& d = r->draws[line.draw];
+        f32 dx = b.x - a.x, dy = b.y - a.y;
+        u32 steps = (u32)fmaxf(fabsf(dx), fabsf(dy)) + 1;
+        for (u32 s = 0; s <= steps; s++) {
+            f32 t = (f32)s / (f32)steps;
+            i32 x = (i32)floorf(a.x + dx * t), y = (i32)floorf(a.y + dy * t);
+            if (x < 0 || y < 0 || x >= (i32)fb.width || y >= (i32)fb.height) continue;
+            f32 z = a.z + (b.z - a.z) * t;
+            u32 p = (u32)y * fb.width + (u32)x;
+            if (!(z < fb.depth[p])) continue;
+            fb.depth[p] = z;
+            r->pixels_shaded++;
+            u32* row = fb.color + (u32)y * fb.width;
+            if (!d.lit) {
+                row[x] = pack_rgba(d.color.x, d.color.y, d.color.z);
+                continue;
+            }
+            // Perspective-correct along the line
+            f32 wa = (1.0f - t) * a.inv_w, wb = t * b.inv_w;
+            f32 w = 1.0f / (wa + wb);
+            wa *= w;
+            wb *= w;
+            span_push(&span, r, line.draw, (u32)x, a.world * wa + b.world * wb, a.normal * wa + b.normal * wb,
+                a.color * wa + b.color * wb, ((f32)x + 0.5f) / (f32)fb.width * 2.0f - 1.0f,
+                1.0f - ((f32)y + 0.5f) / (f32)fb.height * 2.0f, w);
+            span_resolve(&span, r, row);
+        }
+    }
+}
+
+void software_raster_resolve(SoftwareRaster* r, const SoftwareShading& shading) {
+    r->shading = shading;
+    if (r->triangle_count && r->framebuffer.width) {
+        u32 tiles = r->tiles_x * r->tiles_y;
+        bin_triangles(r);
+        parallel_for(tiles, 1, raster_tiles, r);
+        for (u32 t = 0; t < tiles; t++) r->pixels_shaded += r->tile_pixels[t];
+    }
+    raster_lines(r);
+    r->triangles_binned += r->triangle_count;
+    r->vertex_count = r->triangle_count = r->line_count = r->draw_count = 0;
+}
+
+bool software_framebuffer_save_tga(const SoftwareFramebuffer* fb, const char* path) {
+    if (!fb->color || !fb->width || !fb->height) return false;
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        LOG_ERROR("Failed to open %s for writing", path);
+        return false;
+    }
+    u8 header[18] = {};
+    header[2] = 2;   // Uncompressed true color
+    header[12] = (u8)(fb->width & 0xFF);
+    header[13] = (u8)(fb->width >> 8);
+    header[14] = (u8)(fb->height & 0xFF);
+    header[15] = (u8)(fb->height >> 8);
+    header[16] = 32;
+    header[17] = 0x28;   // Top-left origin, 8 alpha bits
+    bool ok = fwrite(header, sizeof(header), 1, f) == 1;
+    u8* row = (u8*)malloc(fb->width * 4);
+    for (u32 y = 0; ok && row && y < fb->height; y++) {
+        const u32* src = fb->color + y * fb->width;
+        for (u32 x = 0; x < fb->width; x++) {
+            row[x * 4 + 0] = (u8)(src[x] >> 16);
+            row[x * 4 + 1] = (u8)(src[x] >> 8);
+            row[x * 4 + 2] = (u8)src[x];
+            row[x * 4 + 3] = (u8)(src[x] >> 24);
+        }
+        ok = fwrite(row, fb->width * 4, 1, f) == 1;
+    }
+    ok = ok && row;
+    free(row);
+    fclose(f);
+    if (!ok) LOG_ERROR("Failed to write %s", path);
+    return ok;
+}
+
+}
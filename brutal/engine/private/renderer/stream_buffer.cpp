@@ -0,0 +1,159 @@
+#include "brutal/renderer/stream_buffer.h"
+#include "brutal/renderer/gl_context.h"
+#include "brutal/core/logging.h"
+#include <glad/glad.h>
+#include <cstring>
+
+namespace brutal {
+
+static u32 g_stream_frame = 1;
+static StreamStats g_frame_stats;
+static StreamStats g_last_stats;
+
+bool stream_buffer_create(StreamBuffer* sb, u32 target, u32 segment_size, void* staging, u32 staging_size) {
+    *sb = {};
+    sb->target = target;
+    sb->segment_size = segment_size;
+    sb->staging = static_cast<u8*>(staging);
+    sb->staging_size = staging ? staging_size : 0;
+    sb->frame = g_stream_frame;
+    GLsizeiptr total = (GLsizeiptr)segment_size * STREAM_SEGMENTS;
+
+    glGenBuffers(1, &sb->buffer);
+    glBindBuffer(target, sb->buffer);
+    if (gl_has_buffer_storage()) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(target, total, nullptr, flags);
+        sb->mapped = static_cast<u8*>(glMapBufferRange(target, 0, total, flags));
+        if (sb->mapped) {
+            sb->mode = STREAM_PERSISTENT;
+            glBindBuffer(target, 0);
+            return true;
+        }
+        // Storage is immutable, so start over with a mutable buffer
+        LOG_WARN("Persistent map failed, streaming through staging");
+        glDeleteBuffers(1, &sb->buffer);
+        glGenBuffers(1, &sb->buffer);
+        glBindBuffer(target, sb->buffer);
+    }
+    if (!sb->staging) {
+        LOG_ERROR("Stream buffer needs staging without persistent mapping");
+        glBindBuffer(target, 0);
+        glDeleteBuffers(1, &sb->buffer);
+        *sb = {};
+        return false;
+    }
+    glBufferData(target, total, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(target, 0);
+    sb->mode = glFenceSync && glClientWaitSync && glMapBufferRange ? STREAM_FENCED : STREAM_ORPHAN;
+    return true;
+}
+
+void stream_buffer_destroy(StreamBuffer* sb) {
+    if (!sb->buffer) return;
+    if (sb->mapped) {
+        glBindBuffer(sb->target, sb->buffer);
+        glUnmapBuffer(sb->target);
+        glBindBuffer(sb->target, 0);
+    }
+    for (u32 i = 0; i < STREAM_SEGMENTS; i++) {
+        if (sb->fences[i]) glDeleteSync(static_cast<GLsync>(sb->fences[i]));
+    }
+    glDeleteBuffers(1, &sb->buffer);
+    *sb = {};
+}
+
+static void wait_segment(StreamBuffer* sb, u32 segment) {
+    GLsync fence = static_cast<GLsync>(sb->fences[segment]);
+    if (!fence) return;
+    if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+        g_frame_stats.stalls++;
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull) == GL_TIMEOUT_EXPIRED) {}
+    }
+    glDeleteSync(fence);
+    sb->fences[segment] = nullptr;
+}
+
+// Fences the draws issued from the current segment and claims the next one
+static void next_segment(StreamBuffer* sb) {
+    if (sb->mode == STREAM_ORPHAN) {
+        sb->head = 0;
+        return;
+    }
+    sb->fences[sb->segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    sb->segment = (sb->segment + 1) % STREAM_SEGMENTS;
+    wait_segment(sb, sb->segment);
+    sb->head = sb->segment * sb->segment_size;
+}
+
+static u32 align_up(u32 offset, u32 stride) {
+    return (offset + stride - 1) / stride * stride;
+}
+
+void* stream_buffer_begin(StreamBuffer* sb, u32 stride, u32 count, u32* capacity) {
+    *capacity = 0;
+    if (!sb->buffer || stride == 0 || stride > sb->segment_size) return nullptr;
+    u32 start = sb->segment * sb->segment_size;
+    if (sb->frame != g_stream_frame) {
+        sb->frame = g_stream_frame;
+        if (sb->head > start) next_segment(sb);
+    }
+
+    // Aligned to the stride so the offset is a whole element index
+    u32 head = align_up(sb->head, stride);
+    u32 end = sb->segment * sb->segment_size + sb->segment_size;
+    if (head + count * stride > end && sb->head > sb->segment * sb->segment_size) {
+        next_segment(sb);
+        head = align_up(sb->head, stride);
+        end = sb->head + sb->segment_size;
+    }
+    if (head >= end) return nullptr;
+    sb->head = head;
+    sb->write_stride = stride;
+
+    u32 room = end - head;
+    if (sb->mode == STREAM_PERSISTENT) {
+        *capacity = room / stride;
+        return sb->mapped + head;
+    }
+    if (room > sb->staging_size) room = sb->staging_size;
+    *capacity = room / stride;
+    return sb->staging;
+}
+
+u32 stream_buffer_commit(StreamBuffer* sb, u32 count) {
+    u32 bytes = count * sb->write_stride;
+    u32 offset = sb->head;
+    sb->write_stride = 0;
+    glBindBuffer(sb->target, sb->buffer);
+    if (bytes == 0) return offset;
+
+    if (sb->mode == STREAM_FENCED) {
+        // The fences already keep the GPU off this range
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        void* dst = glMapBufferRange(sb->target, offset, bytes, flags);
+        if (dst) {
+            memcpy(dst, sb->staging, bytes);
+            glUnmapBuffer(sb->target);
+        }
+    } else if (sb->mode == STREAM_ORPHAN) {
+        glBufferData(sb->target, (GLsizeiptr)sb->segment_size * STREAM_SEGMENTS, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(sb->target, 0, bytes, sb->staging);
+        offset = 0;
+    }
+    if (sb->mode != STREAM_ORPHAN) sb->head += bytes;
+    g_frame_stats.bytes += bytes;
+    return offset;
+}
+
+void stream_buffers_end_frame() {
+    g_stream_frame++;
+    g_last_stats = g_frame_stats;
+    g_frame_stats = {};
+}
+
+StreamStats stream_buffers_last_frame() {
+    return g_last_stats;
+}
+
+}
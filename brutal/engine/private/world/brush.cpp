@@ -1,5 +1,8 @@
 #include "brutal/world/brush.h"
 #include "brutal/renderer/mesh.h"
+#include "brutal/core/memory.h"
+#include "brutal/core/jobs.h"
+#include <cstring>
 
 namespace brutal {
 
@@ -36,4 +39,277 @@ u32 brush_generate_indices(u32 base, u32* idx) {
     return 36;
 }
 
+// =============================================================================
+// Hidden face removal
+// =============================================================================
+static f32 axis_of(const Vec3& v, u32 a) { return a == 0 ? v.x : (a == 1 ? v.y : v.z); }
+static void set_axis(Vec3* v, u32 a, f32 value) { if (a == 0) v->x = value; else if (a == 1) v->y = value; else v->z = value; }
+static u32 tangent_u(u32 axis) { return axis == 0 ? 1 : 0; }
+static u32 tangent_v(u32 axis) { return axis == 2 ? 1 : 2; }
+
+BrushFaceRect brush_face_rect(const Brush* b, u32 face) {
+    u32 axis = face / 2, u = tangent_u(axis), v = tangent_v(axis);
+    return { axis_of(b->min, u), axis_of(b->min, v), axis_of(b->max, u), axis_of(b->max, v) };
+}
+
+u32 brush_generate_clipped(const Brush* b, const BrushFaceRect* rects, u32 base, Vertex* verts, u32* idx, u32* index_count) {
+    u32 vc = 0, ic = 0;
+    for (u32 f = 0; f < BRUSH_FACE_COUNT; f++) {
+        const BrushFaceRect& r = rects[f];
+        if (brush_face_rect_empty(r)) continue;
+        // Generate a brush shrunk to the rect and keep this face's quad, which
+        // preserves the winding and normal of the full face.
+        u32 axis = f / 2, u = tangent_u(axis), v = tangent_v(axis);
+        Brush clipped = *b;
+        set_axis(&clipped.min, u, r.min_u); set_axis(&clipped.max, u, r.max_u);
+        set_axis(&clipped.min, v, r.min_v); set_axis(&clipped.max, v, r.max_v);
+        Vertex quad[24];
+        brush_generate_vertices(&clipped, quad);
+        for (u32 k = 0; k < 4; k++) verts[vc + k] = quad[f * 4 + k];
+
+        u32 q = base + vc;
+        idx[ic] = q; idx[ic + 1] = q + 1; idx[ic + 2] = q + 2;
+        idx[ic + 3] = q + 2; idx[ic + 4] = q + 3; idx[ic + 5] = q;
+        vc += 4; ic += 6;
+    }
+    *index_count = ic;
+    return vc;
+}
+
+static bool boxes_touch(const Brush* a, const Brush* b) {
+    return a->min.x <= b->max.x && a->max.x >= b->min.x &&
+           a->min.y <= b->max.y && a->max.y >= b->min.y &&
+           a->min.z <= b->max.z && a->max.z >= b->min.z;
+}
+
+// Uniform grid over the visible brushes for finding touching pairs. Brushes
+// spanning more than GRID_MAX_SPAN cells are kept aside and tested against
+// everything instead.
+constexpr u32 GRID_MAX_SPAN = 64;
+
+struct BrushGrid {
+    Vec3 origin;
+    f32 inv_cell;
+    i32 dim[3];
+    u32* cell_start;       // dim[0]*dim[1]*dim[2] + 1 offsets into items
+    u32* items;
+    u32* large;
+    u32 large_count;
+};
+
+static i32 grid_coord(const BrushGrid* g, f32 value, u32 axis) {
+    i32 c = static_cast<i32>((value - axis_of(g->origin, axis)) * g->inv_cell);
+    return c < 0 ? 0 : (c >= g->dim[axis] ? g->dim[axis] - 1 : c);
+}
+
+static void grid_range(const BrushGrid* g, const Brush* b, i32 lo[3], i32 hi[3]) {
+    for (u32 a = 0; a < 3; a++) {
+        lo[a] = grid_coord(g, axis_of(b->min, a), a);
+        hi[a] = grid_coord(g, axis_of(b->max, a), a);
+    }
+}
+
+static u32 grid_span(const i32 lo[3], const i32 hi[3]) {
+    return static_cast<u32>(hi[0] - lo[0] + 1) * static_cast<u32>(hi[1] - lo[1] + 1) * static_cast<u32>(hi[2] - lo[2] + 1);
+}
+
+static bool grid_build(BrushGrid* g, const Brush* brushes, const u32* visible, u32 count, MemoryArena* temp) {
+    *g = {};
+    AABB bounds = brush_to_aabb(&brushes[visible[0]]);
+    f32 extent = 0.0f;
+    for (u32 i = 0; i < count; i++) {
+        const Brush* b = &brushes[visible[i]];
+        bounds = aabb_merge(bounds, brush_to_aabb(b));
+        Vec3 size = b->max - b->min;
+        extent += (size.x + size.y + size.z) * (1.0f / 3.0f);
+    }
+    // Cell about the mean brush size, grown until the grid stays near the brush count
+    f32 cell = extent / static_cast<f32>(count);
+    if (cell <= 0.0f) cell = 1.0f;
+    Vec3 size = bounds.max - bounds.min;
+    for (;;) {
+        f64 cells = (f64)(size.x / cell + 1.0f) * (f64)(size.y / cell + 1.0f) * (f64)(size.z / cell + 1.0f);
+        if (cells <= 4.0 * count + 64.0) break;
+        cell *= 1.5f;
+    }
+    g->origin = bounds.min;
+    g->inv_cell = 1.0f / cell;
+    g->dim[0] = static_cast<i32>(size.x / cell) + 1;
+    g->dim[1] = static_cast<i32>(size.y / cell) + 1;
+    g->dim[2] = static_cast<i32>(size.z / cell) + 1;
+    u32 cells = static_cast<u32>(g->dim[0] * g->dim[1] * g->dim[2]);
+
+    g->cell_start = arena_alloc_array<u32>(temp, cells + 1);
+    g->large = arena_alloc_array<u32>(temp, count);
+    if (!g->cell_start || !g->large) return false;
+    memset(g->cell_start, 0, sizeof(u32) * (cells + 1));
+
+    // Count, prefix sum, fill
+    u32 total = 0;
+    for (u32 pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            for (u32 c = 0; c < cells; c++) g->cell_start[c + 1] += g->cell_start[c];
+            total = g->cell_start[cells];
+            g->items = arena_alloc_array<u32>(temp, total ? total : 1);
+            if (!g->items) return false;
+        }
+        g->large_count = 0;
+        for (u32 i = 0; i < count; i++) {
+            i32 lo[3], hi[3];
+            grid_range(g, &brushes[visible[i]], lo, hi);
+            if (grid_span(lo, hi) > GRID_MAX_SPAN) {
+                g->large[g->large_count++] = visible[i];
+                continue;
+            }
+            for (i32 z = lo[2]; z <= hi[2]; z++)
+                for (i32 y = lo[1]; y <= hi[1]; y++)
+                    for (i32 x = lo[0]; x <= hi[0]; x++) {
+                        u32 c = static_cast<u32>((z * g->dim[1] + y) * g->dim[0] + x);
+                        if (pass == 0) g->cell_start[c + 1]++;
+                        else g->items[--g->cell_start[c + 1]] = visible[i];
+                    }
+        }
+    }
+    // The fill walked each cell's end offset back to its start; shift back
+    memmove(g->cell_start, g->cell_start + 1, sizeof(u32) * cells);
+    g->cell_start[cells] = total;
+    return true;
+}
+
+// Calls fn(a, b) once for every touching pair of visible brushes. A pair
+// sharing several cells is reported only from the cell holding the low
+// corner of their overlap.
+template<typename Fn>
+static void grid_for_each_pair(const BrushGrid* g, const Brush* brushes, const u32* visible, u32 count, Fn fn) {
+    u32 cells = static_cast<u32>(g->dim[0] * g->dim[1] * g->dim[2]);
+    for (u32 c = 0; c < cells; c++) {
+        i32 cx = static_cast<i32>(c % static_cast<u32>(g->dim[0]));
+        i32 cy = static_cast<i32>((c / static_cast<u32>(g->dim[0])) % static_cast<u32>(g->dim[1]));
+        i32 cz = static_cast<i32>(c / static_cast<u32>(g->dim[0] * g->dim[1]));
+        for (u32 i = g->cell_start[c]; i < g->cell_start[c + 1]; i++) {
+            const Brush* a = &brushes[g->items[i]];
+            for (u32 j = i + 1; j < g->cell_start[c + 1]; j++) {
+                const Brush* b = &brushes[g->items[j]];
+                if (!boxes_touch(a, b)) continue;
+                if (grid_coord(g, a->min.x > b->min.x ? a->min.x : b->min.x, 0) != cx ||
+                    grid_coord(g, a->min.y > b->min.y ? a->min.y : b->min.y, 1) != cy ||
+                    grid_coord(g, a->min.z > b->min.z ? a->min.z : b->min.z, 2) != cz) {
+                    continue;
+                }
+                fn(g->items[i], g->items[j]);
+            }
+        }
+    }
+    for (u32 l = 0; l < g->large_count; l++) {
+        u32 a = g->large[l];
+        for (u32 i = 0; i < count; i++) {
+            u32 b = visible[i];
+            if (b == a || !boxes_touch(&brushes[a], &brushes[b])) continue;
+            // Large-large pairs would otherwise be seen from both sides
+            bool b_large = false;
+            for (u32 k = 0; k < g->large_count && !b_large; k++) b_large = g->large[k] == b;
+            if (b_large && b < a) continue;
+            fn(a, b);
+        }
+    }
+}
+
+// Cuts the part of r covered by c from r when that part is a strip across
+// the whole rect. Returns true if r changed.
+static bool trim_rect(BrushFaceRect* r, const BrushFaceRect& c) {
+    if (c.min_u <= r->min_u && c.max_u >= r->max_u) {
+        if (c.min_v <= r->min_v && c.max_v > r->min_v) { r->min_v = c.max_v; return true; }
+        if (c.max_v >= r->max_v && c.min_v < r->max_v) { r->max_v = c.min_v; return true; }
+    }
+    if (c.min_v <= r->min_v && c.max_v >= r->max_v) {
+        if (c.min_u <= r->min_u && c.max_u > r->min_u) { r->min_u = c.max_u; return true; }
+        if (c.max_u >= r->max_u && c.min_u < r->max_u) { r->max_u = c.min_u; return true; }
+    }
+    return false;
+}
+
+// True when c lies on the outer side of face f of b, starting at or behind
+// the face plane, so it hides whatever part of the face it overlaps.
+static bool covers_face(const Brush* b, u32 f, const Brush* c) {
+    u32 axis = f / 2;
+    if (f & 1) {
+        f32 p = axis_of(b->max, axis);
+        return axis_of(c->min, axis) <= p && axis_of(c->max, axis) > p;
+    }
+    f32 p = axis_of(b->min, axis);
+    return axis_of(c->max, axis) >= p && axis_of(c->min, axis) < p;
+}
+
+struct TrimJob {
+    const Brush* brushes;
+    BrushFaceRect* rects;
+    const u32* start;          // Neighbour list offsets per brush
+    const u32* neighbours;
+};
+
+static void trim_brush_faces(void* user, u32 begin, u32 end) {
+    const TrimJob* job = static_cast<const TrimJob*>(user);
+    for (u32 i = begin; i < end; i++) {
+        const Brush* b = &job->brushes[i];
+        if (b->flags & BRUSH_INVISIBLE) continue;
+        for (u32 f = 0; f < BRUSH_FACE_COUNT; f++) {
+            BrushFaceRect* r = &job->rects[i * BRUSH_FACE_COUNT + f];
+            // Repeat while trims happen: one cut can make another cover span the rect
+            bool changed = true;
+            while (changed && !brush_face_rect_empty(*r)) {
+                changed = false;
+                for (u32 n = job->start[i]; n < job->start[i + 1] && !brush_face_rect_empty(*r); n++) {
+                    const Brush* c = &job->brushes[job->neighbours[n]];
+                    if (covers_face(b, f, c) && trim_rect(r, brush_face_rect(c, f))) changed = true;
+                }
+            }
+        }
+    }
+}
+
+u32 brush_cull_hidden_faces(const Brush* brushes, u32 count, BrushFaceRect* rects, MemoryArena* temp) {
+    for (u32 i = 0; i < count; i++) {
+        for (u32 f = 0; f < BRUSH_FACE_COUNT; f++) rects[i * BRUSH_FACE_COUNT + f] = brush_face_rect(&brushes[i], f);
+    }
+
+    u32 visible = 0;
+    u32* order = arena_alloc_array<u32>(temp, count ? count : 1);
+    u32* start = arena_alloc_array<u32>(temp, count + 1);
+    if (!order || !start) return 0;
+    for (u32 i = 0; i < count; i++)
+        if (!(brushes[i].flags & BRUSH_INVISIBLE)) order[visible++] = i;
+    if (!visible) return 0;
+
+    // Touching pairs become per-brush neighbour lists (counted, then filled)
+    BrushGrid grid;
+    if (!grid_build(&grid, brushes, order, visible, temp)) return 0;
+    memset(start, 0, sizeof(u32) * (count + 1));
+    grid_for_each_pair(&grid, brushes, order, visible, [start](u32 a, u32 b) {
+        start[a + 1]++;
+        start[b + 1]++;
+    });
+    for (u32 i = 0; i < count; i++) start[i + 1] += start[i];
+    u32* neighbours = arena_alloc_array<u32>(temp, start[count] ? start[count] : 1);
+    u32* fill = arena_alloc_array<u32>(temp, count);
+    if (!neighbours || !fill) return 0;
+    memcpy(fill, start, sizeof(u32) * count);
+    grid_for_each_pair(&grid, brushes, order, visible, [neighbours, fill](u32 a, u32 b) {
+        neighbours[fill[a]++] = b;
+        neighbours[fill[b]++] = a;
+    });
+
+    // Each brush only writes its own rects, so trimming runs in parallel
+    TrimJob job = { brushes, rects, start, neighbours };
+    parallel_for(count, 256, trim_brush_faces, &job);
+
+    u32 removed = 0;
+    for (u32 i = 0; i < count; i++) {
+        if (brushes[i].flags & BRUSH_INVISIBLE) continue;
+        for (u32 f = 0; f < BRUSH_FACE_COUNT; f++) {
+            if (brush_face_rect_empty(rects[i * BRUSH_FACE_COUNT + f])) removed++;
+        }
+    }
+    return removed;
+}
+
 }
@@ -0,0 +1,397 @@
+#include "brutal/world/character.h"
+#include "brutal/world/collision.h"
+#include "brutal/renderer/camera.h"
+#include "brutal/core/memory.h"
+#include "brutal/core/jobs.h"
+#include <cmath>
+#include <algorithm>
+
+namespace brutal {
+
+// =============================================================================
+// Physics Constants - tuned for realistic FPS feel
+// =============================================================================
+static const f32 GRAVITY = 20.0f;              // Gravity acceleration (m/s^2)
+static const f32 JUMP_VELOCITY = 6.5f;         // Initial upward velocity when jumping
+static const f32 TERMINAL_VELOCITY = 50.0f;    // Max fall speed
+static const f32 AIR_CONTROL = 0.3f;           // Air control multiplier (0-1)
+static const f32 CROUCH_TRANSITION_SPEED = 8.0f; // Height units per second
+static const f32 COYOTE_TIME_MAX = 0.1f;       // Grace period for jumping after leaving ground
+static const f32 GROUND_ACCEL = 35.0f;         // Ground acceleration (m/s^2)
+static const f32 AIR_ACCEL = 12.0f;            // Air acceleration (m/s^2)
+static const f32 GROUND_FRICTION = 8.0f;       // Ground friction (1/s)
+static const f32 MAX_TIMER_DT = 0.05f;         // Clamp timer dt to avoid spikes
+static const f32 MAX_STEP_DT = 0.1f;           // Clamp dt to prevent physics explosion on lag spikes
+
+static const u32 BATCH_JOB_SIZE = 64;          // Agents per parallel_for batch
+
+static void apply_ground_friction(Vec3* velocity, f32 dt) {
+    f32 speed = sqrtf(velocity->x * velocity->x + velocity->z * velocity->z);
+    if (speed < 0.0001f) {
+        velocity->x = 0.0f;
+        velocity->z = 0.0f;
+        return;
+    }
+
+    f32 drop = speed * GROUND_FRICTION * dt;
+    f32 new_speed = speed - drop;
+    if (new_speed < 0.0f) new_speed = 0.0f;
+    f32 scale = new_speed / speed;
+    velocity->x *= scale;
+    velocity->z *= scale;
+}
+
+static void accelerate(Vec3* velocity, const Vec3& wish_dir, f32 wish_speed, f32 accel, f32 dt) {
+    if (wish_speed <= 0.0f) return;
+
+    f32 current_speed = vec3_dot(*velocity, wish_dir);
+    f32 add_speed = wish_speed - current_speed;
+    if (add_speed <= 0.0f) return;
+
+    f32 accel_speed = accel * dt * wish_speed;
+    if (accel_speed > add_speed) accel_speed = add_speed;
+
+    *velocity = *velocity + wish_dir * accel_speed;
+}
+
+void character_params_default(CharacterParams* params) {
+    // Movement speeds (meters per second)
+    params->walk_speed = 4.5f;
+    params->sprint_speed = 7.5f;
+    params->crouch_speed = 2.5f;
+
+    params->gravity = GRAVITY;
+    params->jump_velocity = JUMP_VELOCITY;
+    params->terminal_velocity = TERMINAL_VELOCITY;
+    params->air_control = AIR_CONTROL;
+
+    params->stand_height = 1.8f;
+    params->crouch_height = 1.0f;
+    params->eye_offset = 0.1f;  // Eyes 10cm below top of head
+    params->radius = 0.3f;
+}
+
+void character_state_init(CharacterState* s, const CharacterParams* params, const Vec3& eye_position) {
+    s->eye_position = eye_position;
+    s->velocity = Vec3(0, 0, 0);
+    s->current_height = params->stand_height;
+    s->coyote_time = 0.0f;
+    s->jump_buffer_time = 0.0f;
+    s->move_state = MoveState::STANDING;
+    s->grounded = false;
+    s->is_crouched = false;
+}
+
+// =============================================================================
+// Bounds and Position Helpers
+// =============================================================================
+f32 character_feet_y(const CharacterState* s, const CharacterParams* params) {
+    // Eye is at eye_position, eye_offset below the top of the box
+    return s->eye_position.y - (s->current_height - params->eye_offset);
+}
+
+AABB character_bounds_at_height(const CharacterState* s, const CharacterParams* params, f32 height) {
+    f32 feet_y = character_feet_y(s, params);
+    Vec3 center(s->eye_position.x, feet_y + height * 0.5f, s->eye_position.z);
+    Vec3 half(params->radius, height * 0.5f, params->radius);
+    return {center - half, center + half};
+}
+
+AABB character_bounds(const CharacterState* s, const CharacterParams* params) {
+    return character_bounds_at_height(s, params, s->current_height);
+}
+
+bool character_can_stand(const CharacterState* s, const CharacterParams* params, const CollisionWorld* col,
+    CollisionCache* cache) {
+    if (!col || col->box_count == 0) return true;
+
+    // Check if standing height would collide with anything
+    AABB stand_bounds = character_bounds_at_height(s, params, params->stand_height);
+    if (cache) return !collision_overlaps_any_cached(cache, col, stand_bounds);
+    return !collision_overlaps_any(col, stand_bounds);
+}
+
+// =============================================================================
+// Fixed Step
+// =============================================================================
+CharacterStepResult character_step(CharacterState* s,
+    const CharacterParams* params,
+    const CharacterInput* input,
+    const CollisionWorld* col,
+    f32 dt,
+    CollisionCache* cache) {
+    CharacterStepResult result = {};
+    if (dt > MAX_STEP_DT) dt = MAX_STEP_DT;
+
+    // =========================================================================
+    // Crouch State (hold to crouch)
+    // =========================================================================
+    f32 old_height = s->current_height;
+    f32 target_height;
+    if (input->crouch) {
+        target_height = params->crouch_height;
+        s->is_crouched = true;
+    } else {
+        // Only stand up if there's room
+        if (s->is_crouched && !character_can_stand(s, params, col, cache)) {
+            target_height = params->crouch_height;
+            // Stay crouched - can't stand up yet
+        } else {
+            target_height = params->stand_height;
+            s->is_crouched = false;
+        }
+    }
+
+    // Smoothly interpolate height
+    f32 height_diff = target_height - s->current_height;
+    f32 max_change = CROUCH_TRANSITION_SPEED * dt;
+    if (fabsf(height_diff) > max_change) {
+        s->current_height += (height_diff > 0) ? max_change : -max_change;
+    } else {
+        s->current_height = target_height;
+    }
+
+    // Adjust eye position to maintain feet position during crouch
+    // When crouching: feet stay on ground, eye comes down
+    if (fabsf(s->current_height - old_height) > 0.0001f) {
+        s->eye_position.y += (s->current_height - old_height);
+    }
+
+    // =========================================================================
+    // Determine Move State
+    // =========================================================================
+    f32 fwd = input->forward, right = input->right;
+    bool is_moving = (fabsf(fwd) > 0.001f || fabsf(right) > 0.001f);
+
+    if (!is_moving) {
+        s->move_state = s->is_crouched ? MoveState::CROUCHING : MoveState::STANDING;
+    } else if (s->is_crouched) {
+        s->move_state = MoveState::CROUCHING;
+    } else if (input->sprint && fwd > 0 && s->grounded) {
+        // Can only sprint forward while grounded
+        s->move_state = MoveState::SPRINTING;
+    } else {
+        s->move_state = MoveState::WALKING;
+    }
+
+    f32 speed;
+    switch (s->move_state) {
+        case MoveState::SPRINTING: speed = params->sprint_speed; break;
+        case MoveState::CROUCHING: speed = params->crouch_speed; break;
+        case MoveState::WALKING:   speed = params->walk_speed; break;
+        default:                   speed = 0; break;
+    }
+
+    // =========================================================================
+    // Calculate Movement Direction (horizontal only)
+    // =========================================================================
+    Camera view = {};
+    view.yaw = input->yaw;
+    view.pitch = input->pitch;
+    Vec3 f = camera_forward(&view);
+    Vec3 r = camera_right(&view);
+    f.y = 0;
+    f = vec3_normalize(f);
+
+    Vec3 move_dir = f * fwd + r * right;
+    f32 len = vec3_length(move_dir);
+    if (len > 0.001f) {
+        move_dir = move_dir * (1.0f / len);
+    }
+    result.wish_dir = move_dir;
+
+    // =========================================================================
+    // Horizontal Movement (with air control)
+    // =========================================================================
+    if (s->grounded) {
+        apply_ground_friction(&s->velocity, dt);
+        accelerate(&s->velocity, move_dir, speed, GROUND_ACCEL, dt);
+    } else {
+        // In air: limited control
+        f32 air_accel = AIR_ACCEL * params->air_control;
+        accelerate(&s->velocity, move_dir, speed, air_accel, dt);
+    }
+
+    // =========================================================================
+    // Jumping (with coyote time and jump buffering)
+    // =========================================================================
+    const f32 timer_dt = std::min(dt, MAX_TIMER_DT);
+    if (s->grounded) {
+        s->coyote_time = COYOTE_TIME_MAX;
+    } else {
+        s->coyote_time -= timer_dt;
+        if (s->coyote_time < 0) s->coyote_time = 0;
+    }
+
+    if (s->jump_buffer_time > 0) {
+        s->jump_buffer_time -= timer_dt;
+        if (s->jump_buffer_time < 0) s->jump_buffer_time = 0.0f;
+    }
+
+    bool can_jump = s->grounded || s->coyote_time > 0.0f;
+    bool want_jump = s->jump_buffer_time > 0;
+    if (can_jump && want_jump) {
+        s->velocity.y = params->jump_velocity;
+        s->coyote_time = 0;           // Consume coyote time
+        s->jump_buffer_time = 0;      // Consume jump buffer
+        s->grounded = false;          // We're airborne now
+        result.jumped = true;
+    }
+
+    // =========================================================================
+    // Gravity
+    // =========================================================================
+    if (!s->grounded) {
+        s->velocity.y -= params->gravity * dt;
+
+        // Clamp to terminal velocity
+        if (s->velocity.y < -params->terminal_velocity) {
+            s->velocity.y = -params->terminal_velocity;
+        }
+    }
+
+    // =========================================================================
+    // Apply Movement with Collision
+    // =========================================================================
+    Vec3 movement = s->velocity * dt;
+
+    if (col && col->box_count > 0) {
+        AABB bounds = character_bounds(s, params);
+        MoveResult move = cache
+            ? collision_move_and_slide_cached(cache, col, bounds, movement)
+            : collision_move_and_slide(col, bounds, movement);
+
+        Vec3 delta = move.position - aabb_center(bounds);
+        s->eye_position = s->eye_position + delta;
+
+        bool grounded_hit = move.hit_floor && s->velocity.y <= 0.0f;
+        s->grounded = grounded_hit;
+
+        // If we just landed, zero out vertical velocity
+        if (grounded_hit && s->velocity.y < 0) {
+            s->velocity.y = 0;
+        }
+
+        // If we hit ceiling, stop upward velocity
+        if (move.hit_ceiling && s->velocity.y > 0) {
+            s->velocity.y = 0;
+        }
+        result.collided = true;
+        result.boxes_tested = move.boxes_tested;
+    } else {
+        // No collision world - just move freely
+        s->eye_position = s->eye_position + movement;
+        s->grounded = false;
+    }
+    return result;
+}
+
+// =============================================================================
+// Batch
+// =============================================================================
+bool character_batch_create(CharacterBatch* b, MemoryArena* arena, u32 capacity) {
+    *b = {};
+    b->eye_x = arena_alloc_array<f32>(arena, capacity);
+    b->eye_y = arena_alloc_array<f32>(arena, capacity);
+    b->eye_z = arena_alloc_array<f32>(arena, capacity);
+    b->vel_x = arena_alloc_array<f32>(arena, capacity);
+    b->vel_y = arena_alloc_array<f32>(arena, capacity);
+    b->vel_z = arena_alloc_array<f32>(arena, capacity);
+    b->current_height = arena_alloc_array<f32>(arena, capacity);
+    b->coyote_time = arena_alloc_array<f32>(arena, capacity);
+    b->jump_buffer_time = arena_alloc_array<f32>(arena, capacity);
+    b->move_state = arena_alloc_array<u8>(arena, capacity);
+    b->flags = arena_alloc_array<u8>(arena, capacity);
+    b->yaw = arena_alloc_array<f32>(arena, capacity);
+    b->forward = arena_alloc_array<f32>(arena, capacity);
+    b->right = arena_alloc_array<f32>(arena, capacity);
+    b->buttons = arena_alloc_array<u8>(arena, capacity);
+    if (!b->eye_x || !b->eye_y || !b->eye_z || !b->vel_x || !b->vel_y || !b->vel_z ||
+        !b->current_height || !b->coyote_time || !b->jump_buffer_time || !b->move_state ||
+        !b->flags || !b->yaw || !b->forward || !b->right || !b->buttons) {
+        return false;
+    }
+    b->count = 0;
+    b->capacity = capacity;
+    return true;
+}
+
+void character_batch_clear(CharacterBatch* b) { b->count = 0; }
+
+void character_batch_get(const CharacterBatch* b, u32 i, CharacterState* out) {
+    out->eye_position = Vec3(b->eye_x[i], b->eye_y[i], b->eye_z[i]);
+    out->velocity = Vec3(b->vel_x[i], b->vel_y[i], b->vel_z[i]);
+    out->current_height = b->current_height[i];
+    out->coyote_time = b->coyote_time[i];
+    out->jump_buffer_time = b->jump_buffer_time[i];
+    out->move_state = static_cast<MoveState>(b->move_state[i]);
+    out->grounded = (b->flags[i] & CHARACTER_GROUNDED) != 0;
+    out->is_crouched = (b->flags[i] & CHARACTER_CROUCHED) != 0;
+}
+
+void character_batch_set(CharacterBatch* b, u32 i, const CharacterState* s) {
+    b->eye_x[i] = s->eye_position.x;
+    b->eye_y[i] = s->eye_position.y;
+    b->eye_z[i] = s->eye_position.z;
+    b->vel_x[i] = s->velocity.x;
+    b->vel_y[i] = s->velocity.y;
+    b->vel_z[i] = s->velocity.z;
+    b->current_height[i] = s->current_height;
+    b->coyote_time[i] = s->coyote_time;
+    b->jump_buffer_time[i] = s->jump_buffer_time;
+    b->move_state[i] = static_cast<u8>(s->move_state);
+    b->flags[i] = (s->grounded ? CHARACTER_GROUNDED : 0) | (s->is_crouched ? CHARACTER_CROUCHED : 0);
+}
+
+u32 character_batch_add(CharacterBatch* b, const CharacterParams* params, const Vec3& eye_position, f32 yaw) {
+    if (b->count >= b->capacity) return b->capacity;
+    u32 i = b->count++;
+    CharacterState s;
+    character_state_init(&s, params, eye_position);
+    character_batch_set(b, i, &s);
+    b->yaw[i] = yaw;
+    b->forward[i] = 0.0f;
+    b->right[i] = 0.0f;
+    b->buttons[i] = 0;
+    return i;
+}
+
+struct CharacterBatchJob {
+    CharacterBatch* batch;
+    const CharacterParams* params;
+    const CollisionWorld* col;
+    f32 dt;
+};
+
+static void character_batch_range(void* user, u32 begin, u32 end) {
+    const CharacterBatchJob* job = static_cast<const CharacterBatchJob*>(user);
+    CharacterBatch* b = job->batch;
+    for (u32 i = begin; i < end; i++) {
+        CharacterState s;
+        character_batch_get(b, i, &s);
+
+        u8 buttons = b->buttons[i];
+        if (buttons & CHARACTER_INPUT_JUMP) character_request_jump(&s);
+
+        CharacterInput input;
+        input.yaw = b->yaw[i];
+        input.pitch = 0.0f;
+        input.forward = b->forward[i];
+        input.right = b->right[i];
+        input.sprint = (buttons & CHARACTER_INPUT_SPRINT) != 0;
+        input.crouch = (buttons & CHARACTER_INPUT_CROUCH) != 0;
+
+        character_step(&s, job->params, &input, job->col, job->dt);
+
+        character_batch_set(b, i, &s);
+        b->buttons[i] = buttons & ~CHARACTER_INPUT_JUMP;
+    }
+}
+
+void character_batch_update(CharacterBatch* b, const CharacterParams* params, const CollisionWorld* col, f32 dt) {
+    if (!b || !params || b->count == 0) return;
+    CharacterBatchJob job = { b, params, col, dt };
+    parallel_for(b->count, BATCH_JOB_SIZE, character_batch_range, &job);
+}
+
+}
@@ -1,22 +1,246 @@
 #include "brutal/world/collision.h"
 #include "brutal/core/memory.h"
 #include "brutal/core/logging.h"
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 namespace brutal {
 
 bool collision_world_create(CollisionWorld* w, MemoryArena* arena, u32 cap) {
     w->boxes = arena_alloc_array<AABB>(arena, cap);
-    if (!w->boxes) return false;
+    w->source_id = arena_alloc_array<u32>(arena, cap);
+    w->source_box = arena_alloc_array<u32>(arena, cap);
+    if (!w->boxes || !w->source_id || !w->source_box) return false;
     w->box_count = 0;
     w->box_capacity = cap;
+    w->source_count = 0;
+    w->revision = 0;
     return true;
 }
 
-void collision_world_clear(CollisionWorld* w) { w->box_count = 0; }
+void collision_world_clear(CollisionWorld* w) {
+    w->box_count = 0;
+    w->source_count = 0;
+    w->revision++;
+}
+
+void collision_world_add_box(CollisionWorld* w, const AABB& box, u32 source) {
+    if (w->box_count >= w->box_capacity) return;
+    w->source_id[w->source_count] = source;
+    w->source_box[w->source_count] = w->box_count;
+    w->source_count++;
+    w->boxes[w->box_count++] = box;
+    w->revision++;
+}
+
+// =============================================================================
+// Box merging
+// =============================================================================
+// Runs in rounds until one merges nothing. A round drops boxes inside another
+// with a sweep along the axis the boxes overlap least on, then for each axis
+// sorts the live boxes by their extents on the other two and sweeps every run
+// of equal extents along it, joining boxes that touch or overlap. Each round
+// is a few sorts, and a merged box forwards to the box that took it so the
+// sources are retargeted once at the end. Indices are local to the merged
+// range.
+
+static f32 axis_of(const Vec3& v, u32 axis) { return axis == 0 ? v.x : (axis == 1 ? v.y : v.z); }
+
+static void set_axis(Vec3* v, u32 axis, f32 value) {
+    if (axis == 0) v->x = value;
+    else if (axis == 1) v->y = value;
+    else v->z = value;
+}
+
+// The live box a merged one ended up in
+static u32 merge_target(u32* into, u32 b) {
+    while (into[b] != b) {
+        into[b] = into[into[b]];
+        b = into[b];
+    }
+    return b;
+}
+
+// The axis along which a box overlaps the fewest others, roughly: the least
+// total extent relative to the span of all boxes
+static u32 sparsest_axis(const AABB* boxes, const u32* live, u32 count) {
+    u32 best = 0;
+    f64 best_fill = 0.0;
+    for (u32 a = 0; a < 3; a++) {
+        f64 extent = 0.0;
+        f32 lo = axis_of(boxes[live[0]].min, a), hi = axis_of(boxes[live[0]].max, a);
+        for (u32 i = 0; i < count; i++) {
+            const AABB& b = boxes[live[i]];
+            extent += axis_of(b.max, a) - axis_of(b.min, a);
+            lo = fminf(lo, axis_of(b.min, a));
+            hi = fmaxf(hi, axis_of(b.max, a));
+        }
+        f64 fill = hi > lo ? extent / (hi - lo) : (f64)count;
+        if (a == 0 || fill < best_fill) {
+            best = a;
+            best_fill = fill;
+        }
+    }
+    return best;
+}
+
+// Boxes inside another. Sorted by min along the axis (the wider box first on
+// ties), a box's container has started before it and not yet ended.
+static u32 drop_contained(const AABB* boxes, u32* live, u32 count, u32* into, std::vector<u32>* active) {
+    u32 a = sparsest_axis(boxes, live, count);
+    std::sort(live, live + count, [&](u32 x, u32 y) {
+        f32 x0 = axis_of(boxes[x].min, a), y0 = axis_of(boxes[y].min, a);
+        if (x0 != y0) return x0 < y0;
+        f32 x1 = axis_of(boxes[x].max, a), y1 = axis_of(boxes[y].max, a);
+        if (x1 != y1) return x1 > y1;
+        return x < y;
+    });
+    active->clear();
+    u32 kept = 0;
+    for (u32 i = 0; i < count; i++) {
+        u32 b = live[i];
+        f32 b0 = axis_of(boxes[b].min, a);
+        u32 container = COLLISION_NO_BOX;
+        for (u32 k = 0; k < active->size();) {
+            u32 c = (*active)[k];
+            if (axis_of(boxes[c].max, a) < b0) {
+                (*active)[k] = active->back();
+                active->pop_back();
+                continue;
+            }
+            if (container == COLLISION_NO_BOX && aabb_contains(boxes[c], boxes[b])) container = c;
+            k++;
+        }
+        if (container != COLLISION_NO_BOX) {
+            into[b] = container;
+            continue;
+        }
+        active->push_back(b);
+        live[kept++] = b;
+    }
+    return kept;
+}
+
+// Joins boxes with the same extents on the two other axes that touch or
+// overlap along `axis`
+static u32 sweep_axis(AABB* boxes, u32* live, u32 count, u32* into, u32 axis) {
+    u32 u = (axis + 1) % 3, v = (axis + 2) % 3;
+    auto same_face = [&](const AABB& x, const AABB& y) {
+        return axis_of(x.min, u) == axis_of(y.min, u) && axis_of(x.max, u) == axis_of(y.max, u) &&
+            axis_of(x.min, v) == axis_of(y.min, v) && axis_of(x.max, v) == axis_of(y.max, v);
+    };
+    std::sort(live, live + count, [&](u32 x, u32 y) {
+        const AABB& bx = boxes[x];
+        const AABB& by = boxes[y];
+        const f32 kx[5] = { axis_of(bx.min, u), axis_of(bx.max, u), axis_of(bx.min, v), axis_of(bx.max, v),
+            axis_of(bx.min, axis) };
+        const f32 ky[5] = { axis_of(by.min, u), axis_of(by.max, u), axis_of(by.min, v), axis_of(by.max, v),
+            axis_of(by.min, axis) };
+        for (u32 k = 0; k < 5; k++) {
+            if (kx[k] != ky[k]) return kx[k] < ky[k];
+        }
+        return x < y;
+    });
+    u32 kept = 0;
+    for (u32 i = 0; i < count; i++) {
+        u32 b = live[i];
+        if (kept) {
+            u32 cur = live[kept - 1];
+            AABB& c = boxes[cur];
+            if (same_face(c, boxes[b]) && axis_of(boxes[b].min, axis) <= axis_of(c.max, axis)) {
+                set_axis(&c.max, axis, fmaxf(axis_of(c.max, axis), axis_of(boxes[b].max, axis)));
+                into[b] = cur;
+                continue;
+            }
+        }
+        live[kept++] = b;
+    }
+    return kept;
+}
+
+u32 collision_world_merge_boxes(CollisionWorld* w, u32 first) {
+    u32 before = w->box_count;
+    if (first >= before || before - first < 2) return 0;
+    // Only sources of boxes from first on can be retargeted. Those are the
+    // tail of the source list when boxes were appended for a partial merge.
+    u32 source_first = w->source_count;
+    for (u32 s = 0; s < w->source_count; s++) {
+        if (w->source_box[s] >= first) { source_first = s; break; }
+    }
 
-void collision_world_add_box(CollisionWorld* w, const AABB& box) {
-    if (w->box_count < w->box_capacity) w->boxes[w->box_count++] = box;
+    AABB* boxes = w->boxes + first;
+    u32 count = before - first;
+    std::vector<u32> into(count), live(count), active;
+    for (u32 i = 0; i < count; i++) into[i] = live[i] = i;
+    u32 alive = count;
+    for (;;) {
+        u32 start = alive;
+        alive = drop_contained(boxes, live.data(), alive, into.data(), &active);
+        for (u32 a = 0; a < 3; a++) alive = sweep_axis(boxes, live.data(), alive, into.data(), a);
+        if (alive == start) break;
+    }
+    if (alive == count) return 0;
+
+    // Compact in the original order and point every source at its new box
+    std::vector<u32> slot(count, COLLISION_NO_BOX);
+    for (u32 i = 0; i < alive; i++) slot[live[i]] = 0;
+    u32 kept = 0;
+    for (u32 b = 0; b < count; b++) {
+        if (slot[b] == COLLISION_NO_BOX) continue;
+        boxes[kept] = boxes[b];
+        slot[b] = kept++;
+    }
+    for (u32 s = source_first; s < w->source_count; s++) {
+        if (w->source_box[s] < first) continue;
+        w->source_box[s] = first + slot[merge_target(into.data(), w->source_box[s] - first)];
+    }
+    w->box_count = first + kept;
+    w->revision++;
+    return before - w->box_count;
+}
+
+u32 collision_world_remove_sources(CollisionWorld* w, const u8* source_mask, u32 mask_size,
+    u32* orphans, MemoryArena* temp) {
+    u32* box_remap = arena_alloc_array<u32>(temp, w->box_count ? w->box_count : 1);
+    if (!box_remap) return COLLISION_NO_BOX;
+    for (u32 b = 0; b < w->box_count; b++) box_remap[b] = 0;
+    auto masked = [&](u32 id) { return id < mask_size && source_mask[id]; };
+    for (u32 s = 0; s < w->source_count; s++) {
+        if (masked(w->source_id[s])) box_remap[w->source_box[s]] = COLLISION_NO_BOX;
+    }
+
+    u32 kept = 0;
+    for (u32 b = 0; b < w->box_count; b++) {
+        if (box_remap[b] == COLLISION_NO_BOX) continue;
+        w->boxes[kept] = w->boxes[b];
+        box_remap[b] = kept++;
+    }
+    u32 orphan_count = 0, source_kept = 0;
+    for (u32 s = 0; s < w->source_count; s++) {
+        u32 box = box_remap[w->source_box[s]];
+        if (box == COLLISION_NO_BOX) {
+            if (!masked(w->source_id[s])) orphans[orphan_count++] = w->source_id[s];
+            continue;
+        }
+        w->source_id[source_kept] = w->source_id[s];
+        w->source_box[source_kept] = box;
+        source_kept++;
+    }
+    w->box_count = kept;
+    w->source_count = source_kept;
+    w->revision++;
+    return orphan_count;
+}
+
+u32 collision_world_box_sources(const CollisionWorld* w, u32 box, u32* out, u32 max) {
+    u32 n = 0;
+    for (u32 s = 0; s < w->source_count; s++) {
+        if (w->source_box[s] != box) continue;
+        if (out && n < max) out[n] = w->source_id[s];
+        n++;
+    }
+    return n;
 }
 
 // Resolve penetration if player is already overlapping a box
@@ -45,15 +269,26 @@ static Vec3 resolve_penetration(const Vec3& pos, const Vec3& half, const AABB& b
     return push;
 }
 
-MoveResult collision_move_and_slide(const CollisionWorld* w, const AABB& player, const Vec3& vel) {
+static void extent_add(AABB* extent, const Vec3& pos, const Vec3& half) {
+    if (!extent) return;
+    *extent = aabb_merge(*extent, {pos - half, pos + half});
+}
+
+// Boxes come from candidates when given, otherwise the whole world. extent,
+// when given, grows to cover every box the mover occupied or swept through.
+static MoveResult move_and_slide_impl(const CollisionWorld* w, const u32* candidates, u32 candidate_count,
+    const AABB& player, const Vec3& vel, AABB* extent) {
     const f32 SKIN = 0.005f;      // Separation distance from walls
     const int MAX_ITER = 5;       // Maximum slide iterations
     const f32 MIN_MOVE = 0.0001f; // Minimum movement threshold
     
     MoveResult r = {};
+    r.hit_box = COLLISION_NO_BOX;
     Vec3 pos = aabb_center(player);
     Vec3 half = aabb_half_size(player);
     Vec3 rem = vel;
+    const u32 n = candidates ? candidate_count : w->box_count;
+    if (extent) *extent = player;
     
     // Phase 1: Resolve any existing penetrations
     // This handles cases where the player somehow got inside geometry
@@ -61,7 +296,8 @@ MoveResult collision_move_and_slide(const CollisionWorld* w, const AABB& player,
         Vec3 total_push(0, 0, 0);
         bool any_penetration = false;
         
-        for (u32 i = 0; i < w->box_count; i++) {
+        for (u32 k = 0; k < n; k++) {
+            u32 i = candidates ? candidates[k] : k;
             Vec3 push = resolve_penetration(pos, half, w->boxes[i]);
             if (fabsf(push.x) > MIN_MOVE || fabsf(push.y) > MIN_MOVE || fabsf(push.z) > MIN_MOVE) {
                 // Add a small skin distance to the push
@@ -82,8 +318,10 @@ MoveResult collision_move_and_slide(const CollisionWorld* w, const AABB& player,
             }
         }
         
+        r.boxes_tested += n;
         if (!any_penetration) break;
         pos = pos + total_push;
+        extent_add(extent, pos, half);
     }
     
     // Phase 2: Move and slide with collision response
@@ -94,19 +332,25 @@ MoveResult collision_move_and_slide(const CollisionWorld* w, const AABB& player,
         AABB moving = {pos - half, pos + half};
         f32 closest_t = 1.0f;
         Vec3 closest_n(0, 0, 0);
+        u32 closest_box = COLLISION_NO_BOX;
+        extent_add(extent, pos + rem, half);
+        r.boxes_tested += n;
         
-        for (u32 i = 0; i < w->box_count; i++) {
-            Vec3 n;
-            f32 t = aabb_sweep(moving, rem, w->boxes[i], &n);
+        for (u32 k = 0; k < n; k++) {
+            u32 i = candidates ? candidates[k] : k;
+            Vec3 normal;
+            f32 t = aabb_sweep(moving, rem, w->boxes[i], &normal);
             if (t < closest_t) {
                 closest_t = t;
-                closest_n = n;
+                closest_n = normal;
+                closest_box = i;
             }
         }
         
         if (closest_t < 1.0f) {
             // We hit something
             r.hit_normal = closest_n;
+            r.hit_box = closest_box;
             if (closest_n.y > 0.5f) r.hit_floor = true;
             else if (closest_n.y < -0.5f) r.hit_ceiling = true;
             else r.hit_wall = true;
@@ -138,13 +382,16 @@ MoveResult collision_move_and_slide(const CollisionWorld* w, const AABB& player,
     // This catches edge cases where sliding puts us into another wall
     for (int resolve_iter = 0; resolve_iter < 2; resolve_iter++) {
         bool any_penetration = false;
-        for (u32 i = 0; i < w->box_count; i++) {
+        r.boxes_tested += n;
+        for (u32 k = 0; k < n; k++) {
+            u32 i = candidates ? candidates[k] : k;
             Vec3 push = resolve_penetration(pos, half, w->boxes[i]);
             if (fabsf(push.x) > MIN_MOVE || fabsf(push.y) > MIN_MOVE || fabsf(push.z) > MIN_MOVE) {
                 if (push.x > 0) push.x += SKIN; else if (push.x < 0) push.x -= SKIN;
                 if (push.y > 0) push.y += SKIN; else if (push.y < 0) push.y -= SKIN;
                 if (push.z > 0) push.z += SKIN; else if (push.z < 0) push.z -= SKIN;
                 pos = pos + push;
+                extent_add(extent, pos, half);
                 any_penetration = true;
             }
         }
@@ -155,4 +402,102 @@ MoveResult collision_move_and_slide(const CollisionWorld* w, const AABB& player,
     return r;
 }
 
+MoveResult collision_move_and_slide(const CollisionWorld* w, const AABB& player, const Vec3& vel) {
+    return move_and_slide_impl(w, nullptr, 0, player, vel, nullptr);
+}
+
+bool collision_overlaps_any(const CollisionWorld* w, const AABB& box) {
+    for (u32 i = 0; i < w->box_count; i++) {
+        if (aabb_intersects(box, w->boxes[i])) return true;
+    }
+    return false;
+}
+
+// =============================================================================
+// Contact cache
+// =============================================================================
+// Slack kept between a query and the region edge so float noise in the
+// sweep never reaches a box that was left out.
+static constexpr f32 CACHE_EDGE_EPSILON = 0.01f;
+
+void collision_cache_init(CollisionCache* c, f32 margin) {
+    *c = {};
+    c->margin = margin;
+}
+
+void collision_cache_invalidate(CollisionCache* c) {
+    c->valid = false;
+}
+
+f32 collision_cache_hit_rate(const CollisionCache* c) {
+    return c->queries ? (f32)((f64)c->hits / (f64)c->queries) : 0.0f;
+}
+
+static bool cache_covers(const CollisionCache* c, const CollisionWorld* w, const AABB& query) {
+    return c->valid && c->world == w && c->world_revision == w->revision &&
+           aabb_contains(c->region, aabb_expand(query, CACHE_EDGE_EPSILON));
+}
+
+// Full scan around query. Leaves the cache invalid if the area is too dense.
+static void cache_refill(CollisionCache* c, const CollisionWorld* w, const AABB& query) {
+    c->refills++;
+    c->world = w;
+    c->world_revision = w->revision;
+    c->region = aabb_expand(query, c->margin + CACHE_EDGE_EPSILON);
+    c->count = 0;
+    c->valid = true;
+    for (u32 i = 0; i < w->box_count; i++) {
+        if (!aabb_intersects(c->region, w->boxes[i])) continue;
+        if (c->count == COLLISION_CACHE_MAX) {
+            c->valid = false;
+            return;
+        }
+        c->indices[c->count++] = i;
+    }
+}
+
+// Makes the cache cover query. Returns true on a hit.
+static bool cache_prepare(CollisionCache* c, const CollisionWorld* w, const AABB& query) {
+    c->queries++;
+    if (cache_covers(c, w, query)) {
+        c->hits++;
+        return true;
+    }
+    cache_refill(c, w, query);
+    return false;
+}
+
+MoveResult collision_move_and_slide_cached(CollisionCache* c, const CollisionWorld* w, const AABB& player, const Vec3& vel) {
+    AABB swept = aabb_merge(player, {player.min + vel, player.max + vel});
+    cache_prepare(c, w, swept);
+    if (!c->valid) {
+        c->fallbacks++;
+        return collision_move_and_slide(w, player, vel);
+    }
+
+    AABB extent;
+    MoveResult r = move_and_slide_impl(w, c->indices, c->count, player, vel, &extent);
+    if (!aabb_contains(c->region, aabb_expand(extent, CACHE_EDGE_EPSILON))) {
+        // Pushed or slid past the region: redo against everything.
+        c->fallbacks++;
+        c->valid = false;
+        u32 wasted = r.boxes_tested;
+        r = collision_move_and_slide(w, player, vel);
+        r.boxes_tested += wasted;
+    }
+    return r;
+}
+
+bool collision_overlaps_any_cached(CollisionCache* c, const CollisionWorld* w, const AABB& box) {
+    cache_prepare(c, w, box);
+    if (!c->valid) {
+        c->fallbacks++;
+        return collision_overlaps_any(w, box);
+    }
+    for (u32 k = 0; k < c->count; k++) {
+        if (aabb_intersects(box, w->boxes[c->indices[k]])) return true;
+    }
+    return false;
+}
+
 }
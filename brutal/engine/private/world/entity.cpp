@@ -1,20 +1,9 @@
 #include "brutal/world/entity.h"
+#include "brutal/core/memory.h"
+#include <cstring>
 
 namespace brutal {
 
-void entity_init(PropEntity* e, const Vec3& pos, const Vec3& scale, u32 mesh_id, const Vec3& color) {
-    e->transform.position = pos;
-    e->transform.rotation = quat_identity();
-    e->transform.scale = scale;
-    e->mesh_id = mesh_id;
-    e->color = color;
-    e->active = true;
-}
-
-Mat4 entity_get_transform_matrix(const PropEntity* e) {
-    return transform_to_matrix(&e->transform);
-}
-
 Mat4 transform_to_matrix(const Transform* t) {
     Mat4 trans = mat4_translation(t->position);
     const Quat r = quat_normalize(t->rotation);
@@ -41,4 +30,118 @@ Mat4 transform_to_matrix(const Transform* t) {
     return mat4_multiply(trans, mat4_multiply(rot, scale));
 }
 
+// =============================================================================
+// Prop storage
+// =============================================================================
+template<typename T>
+static bool grow_column(T** column, MemoryArena* arena, u32 count, u32 capacity) {
+    T* grown = arena_alloc_array<T>(arena, capacity);
+    if (!grown) return false;
+    if (count) memcpy(grown, *column, sizeof(T) * count);
+    *column = grown;
+    return true;
+}
+
+bool prop_storage_reserve(PropStorage* p, MemoryArena* arena, u32 capacity) {
+    if (capacity <= p->capacity) return true;
+    if (!grow_column(&p->positions, arena, p->count, capacity) ||
+        !grow_column(&p->rotations, arena, p->count, capacity) ||
+        !grow_column(&p->scales, arena, p->count, capacity) ||
+        !grow_column(&p->colors, arena, p->count, capacity) ||
+        !grow_column(&p->mesh_ids, arena, p->count, capacity) ||
+        !handle_table_reserve(&p->handles, arena, capacity)) {
+        return false;
+    }
+    p->capacity = capacity;
+    return true;
+}
+
+void prop_storage_clear(PropStorage* p) {
+    p->count = 0;
+    p->active_count = 0;
+    handle_table_clear(&p->handles);
+}
+
+static void swap_props(PropStorage* p, u32 a, u32 b) {
+    if (a == b) return;
+    Vec3 position = p->positions[a]; p->positions[a] = p->positions[b]; p->positions[b] = position;
+    Quat rotation = p->rotations[a]; p->rotations[a] = p->rotations[b]; p->rotations[b] = rotation;
+    Vec3 scale = p->scales[a]; p->scales[a] = p->scales[b]; p->scales[b] = scale;
+    Vec3 color = p->colors[a]; p->colors[a] = p->colors[b]; p->colors[b] = color;
+    u32 mesh_id = p->mesh_ids[a]; p->mesh_ids[a] = p->mesh_ids[b]; p->mesh_ids[b] = mesh_id;
+    handle_table_swap(&p->handles, a, b);
+}
+
+u32 prop_storage_add(PropStorage* p, const Transform& t, u32 mesh_id, const Vec3& color, bool active) {
+    if (p->count >= p->capacity) return HANDLE_NONE;
+    u32 index = p->count++;
+    handle_table_add<Prop>(&p->handles, index);
+    prop_set_transform(p, index, t);
+    p->mesh_ids[index] = mesh_id;
+    p->colors[index] = color;
+    return active ? prop_storage_set_active(p, index, true) : index;
+}
+
+u32 prop_storage_set_active(PropStorage* p, u32 index, bool active) {
+    if (prop_is_active(p, index) == active) return index;
+    // The prop trades places with the entry at the split, which moves it
+    // to the other side
+    u32 split = active ? p->active_count++ : --p->active_count;
+    swap_props(p, index, split);
+    return split;
+}
+
+void prop_storage_remove(PropStorage* p, u32 index) {
+    index = prop_storage_set_active(p, index, false);
+    u32 last = p->count - 1;
+    handle_table_remove(&p->handles, index, p->count);
+    p->positions[index] = p->positions[last];
+    p->rotations[index] = p->rotations[last];
+    p->scales[index] = p->scales[last];
+    p->colors[index] = p->colors[last];
+    p->mesh_ids[index] = p->mesh_ids[last];
+    p->count--;
+}
+
+PropView prop_storage_query(const PropStorage* p, u32 columns) {
+    PropView v = {};
+    v.count = p->active_count;
+    if (columns & PROP_COLUMN_POSITION) v.positions = p->positions;
+    if (columns & PROP_COLUMN_ROTATION) v.rotations = p->rotations;
+    if (columns & PROP_COLUMN_SCALE) v.scales = p->scales;
+    if (columns & PROP_COLUMN_COLOR) v.colors = p->colors;
+    if (columns & PROP_COLUMN_MESH) v.mesh_ids = p->mesh_ids;
+    return v;
+}
+
+void prop_storage_world_matrices(const PropStorage* p, u32 first, u32 count, Mat4* out) {
+    const Vec3* positions = p->positions + first;
+    const Quat* rotations = p->rotations + first;
+    const Vec3* scales = p->scales + first;
+    for (u32 i = 0; i < count; i++) {
+        const Quat r = quat_normalize(rotations[i]);
+        f32 xx = r.x * r.x, yy = r.y * r.y, zz = r.z * r.z;
+        f32 xy = r.x * r.y, xz = r.x * r.z, yz = r.y * r.z;
+        f32 wx = r.w * r.x, wy = r.w * r.y, wz = r.w * r.z;
+        f32 sx = scales[i].x, sy = scales[i].y, sz = scales[i].z;
+        f32* m = out[i].m;
+        m[0] = (1.0f - 2.0f * (yy + zz)) * sx;
+        m[1] = 2.0f * (xy + wz) * sx;
+        m[2] = 2.0f * (xz - wy) * sx;
+        m[3] = 0.0f;
+        m[4] = 2.0f * (xy - wz) * sy;
+        m[5] = (1.0f - 2.0f * (xx + zz)) * sy;
+        m[6] = 2.0f * (yz + wx) * sy;
+        m[7] = 0.0f;
+        m[8] = 2.0f * (xz + wy) * sz;
+        m[9] = 2.0f * (yz - wx) * sz;
+        m[10] = (1.0f - 2.0f * (xx + yy)) * sz;
+        m[11] = 0.0f;
+        m[12] = positions[i].x;
+        m[13] = positions[i].y;
+        m[14] = positions[i].z;
+        m[15] = 1.0f;
+    }
+}
+
 }
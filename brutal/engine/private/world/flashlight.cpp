@@ -31,8 +31,7 @@ namespace brutal {
         flashlight->battery_level = 1.0f;
         flashlight->flicker_phase = 0.0f;
         flashlight->intensity_scale = 1.0f;
-        flashlight->spot_light_index = 0;
-        flashlight->spot_light_registered = false;
+        flashlight->spot_light = SpotLightHandle{};
     }
 
     void flashlight_enable(PlayerFlashlight* flashlight) {
@@ -99,7 +98,8 @@ namespace brutal {
             intensity = 0.0f;
         }
 
-        if (!flashlight->spot_light_registered) {
+        SpotLight* registered = light_environment_get_spot(env, flashlight->spot_light);
+        if (!registered) {
             SpotLight* spot = light_environment_add_spot(
                 env,
                 pos,
@@ -111,14 +111,12 @@ namespace brutal {
                 intensity,
                 flashlight->config.falloff);
             if (spot) {
-                flashlight->spot_light_index = env->spot_light_count - 1;
-                flashlight->spot_light_registered = true;
+                flashlight->spot_light = light_environment_spot_handle(env, env->spot_light_count - 1);
             }
             return;
         }
 
-        if (flashlight->spot_light_index >= env->spot_light_count) return;
-        SpotLight& spot = env->spot_lights[flashlight->spot_light_index];
+        SpotLight& spot = *registered;
         spot.position = pos;
         spot.direction = forward;
         spot.color = flashlight->config.color;
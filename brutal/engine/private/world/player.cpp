@@ -1,5 +1,6 @@
 #include "brutal/world/player.h"
 #include "brutal/world/collision.h"
+#include "brutal/world/character.h"
 #include "brutal/core/platform.h"
 #include "brutal/core/profiler.h"
 #include "brutal/core/logging.h"
@@ -9,21 +10,8 @@
 
 namespace brutal {
 
-// =============================================================================
-// Physics Constants - tuned for realistic FPS feel
-// =============================================================================
-static const f32 GRAVITY = 20.0f;              // Gravity acceleration (m/s^2)
-static const f32 JUMP_VELOCITY = 6.5f;         // Initial upward velocity when jumping
-static const f32 TERMINAL_VELOCITY = 50.0f;    // Max fall speed
-static const f32 AIR_CONTROL = 0.3f;           // Air control multiplier (0-1)
-static const f32 CROUCH_TRANSITION_SPEED = 8.0f; // Height units per second
-static const f32 COYOTE_TIME_MAX = 0.1f;       // Grace period for jumping after leaving ground
-static const f32 JUMP_BUFFER_MAX = 0.1f;       // Buffer jump input before landing
-static const f32 GROUND_ACCEL = 35.0f;         // Ground acceleration (m/s^2)
-static const f32 AIR_ACCEL = 12.0f;            // Air acceleration (m/s^2)
-static const f32 GROUND_FRICTION = 8.0f;       // Ground friction (1/s)
-static const f32 MAX_TIMER_DT = 0.05f;         // Clamp timer dt to avoid spikes
 static const f32 JUMP_REQUEST_DUMP_THRESHOLD = 0.2f; // 200ms
+static const f32 MAX_STEP_DT = 0.1f;           // Matches the clamp inside character_step
 static const f32 TWO_PI = 6.283185f;
 
 static f32 clampf(f32 value, f32 min_val, f32 max_val) {
@@ -84,33 +72,44 @@ static void player_dump_jump_ring(const Player* p, const char* reason) {
     LOG_WARN("==== End Jump Debug Dump ====");
 }
 
-static void apply_ground_friction(Player* p, f32 dt) {
-    f32 speed = sqrtf(p->velocity.x * p->velocity.x + p->velocity.z * p->velocity.z);
-    if (speed < 0.0001f) {
-        p->velocity.x = 0.0f;
-        p->velocity.z = 0.0f;
-        return;
-    }
-
-    f32 drop = speed * GROUND_FRICTION * dt;
-    f32 new_speed = speed - drop;
-    if (new_speed < 0.0f) new_speed = 0.0f;
-    f32 scale = new_speed / speed;
-    p->velocity.x *= scale;
-    p->velocity.z *= scale;
+static CharacterParams player_character_params(const Player* p) {
+    CharacterParams params;
+    params.walk_speed = p->walk_speed;
+    params.sprint_speed = p->sprint_speed;
+    params.crouch_speed = p->crouch_speed;
+    params.gravity = p->gravity;
+    params.jump_velocity = p->jump_velocity;
+    params.terminal_velocity = p->terminal_velocity;
+    params.air_control = p->air_control;
+    params.stand_height = p->stand_height;
+    params.crouch_height = p->crouch_height;
+    params.eye_offset = p->eye_offset;
+    params.radius = p->radius;
+    return params;
 }
 
-static void accelerate(Player* p, const Vec3& wish_dir, f32 wish_speed, f32 accel, f32 dt) {
-    if (wish_speed <= 0.0f) return;
-
-    f32 current_speed = vec3_dot(p->velocity, wish_dir);
-    f32 add_speed = wish_speed - current_speed;
-    if (add_speed <= 0.0f) return;
-
-    f32 accel_speed = accel * dt * wish_speed;
-    if (accel_speed > add_speed) accel_speed = add_speed;
+static CharacterState player_character_state(const Player* p) {
+    CharacterState s;
+    s.eye_position = p->camera.position;
+    s.velocity = p->velocity;
+    s.current_height = p->current_height;
+    s.coyote_time = p->coyote_time;
+    s.jump_buffer_time = p->jump_buffer_time;
+    s.move_state = p->move_state;
+    s.grounded = p->grounded;
+    s.is_crouched = p->is_crouched;
+    return s;
+}
 
-    p->velocity = p->velocity + wish_dir * accel_speed;
+static void player_store_character_state(Player* p, const CharacterState& s) {
+    p->camera.position = s.eye_position;
+    p->velocity = s.velocity;
+    p->current_height = s.current_height;
+    p->coyote_time = s.coyote_time;
+    p->jump_buffer_time = s.jump_buffer_time;
+    p->move_state = s.move_state;
+    p->grounded = s.grounded;
+    p->is_crouched = s.is_crouched;
 }
 
 // =============================================================================
@@ -122,11 +121,15 @@ void player_init(Player* p) {
     p->velocity = Vec3(0, 0, 0);
     p->wish_dir = Vec3(0, 0, 0);
     flashlight_init(&p->flashlight);
+    collision_cache_init(&p->collision_cache);
+
+    CharacterParams defaults;
+    character_params_default(&defaults);
     
     // Movement speeds (meters per second)
-    p->walk_speed = 4.5f;
-    p->sprint_speed = 7.5f;
-    p->crouch_speed = 2.5f;
+    p->walk_speed = defaults.walk_speed;
+    p->sprint_speed = defaults.sprint_speed;
+    p->crouch_speed = defaults.crouch_speed;
     p->sensitivity = 0.002f;
     p->invert_look_y = false;
     p->enable_look_smoothing = false;
@@ -136,17 +139,17 @@ void player_init(Player* p) {
     p->look_smoothed = Vec2(0, 0);
     
     // Physics parameters
-    p->gravity = GRAVITY;
-    p->jump_velocity = JUMP_VELOCITY;
-    p->terminal_velocity = TERMINAL_VELOCITY;
-    p->air_control = AIR_CONTROL;
+    p->gravity = defaults.gravity;
+    p->jump_velocity = defaults.jump_velocity;
+    p->terminal_velocity = defaults.terminal_velocity;
+    p->air_control = defaults.air_control;
     
     // Physical dimensions
-    p->stand_height = 1.8f;
-    p->crouch_height = 1.0f;
+    p->stand_height = defaults.stand_height;
+    p->crouch_height = defaults.crouch_height;
     p->current_height = p->stand_height;
-    p->eye_offset = 0.1f;  // Eyes 10cm below top of head
-    p->radius = 0.3f;
+    p->eye_offset = defaults.eye_offset;
+    p->radius = defaults.radius;
     
     // State
     p->move_state = MoveState::STANDING;
@@ -166,6 +169,7 @@ void player_init(Player* p) {
     p->jump_request_dumped = false;
     p->grounded_reason = "init";
     p->last_fixed_dt = 0.0f;
+    p->last_boxes_tested = 0;
     p->last_frame_dt = 0.0f;
     p->last_fixed_step_count = 0;
     p->fixed_step_index = 0;
@@ -178,41 +182,21 @@ void player_init(Player* p) {
 // Bounds and Position Helpers
 // =============================================================================
 f32 player_get_feet_y(const Player* p) {
-    // Eye is at camera position
-    // Eye offset from top = eye_offset
-    // So feet = camera.y - (current_height - eye_offset)
-    return p->camera.position.y - (p->current_height - p->eye_offset);
+    CharacterParams params = player_character_params(p);
+    CharacterState state = player_character_state(p);
+    return character_feet_y(&state, &params);
 }
 
 AABB player_get_bounds(const Player* p) {
-    Vec3 eye_pos = p->camera.position;
-    f32 feet_y = player_get_feet_y(p);
-    Vec3 center(eye_pos.x, feet_y + p->current_height * 0.5f, eye_pos.z);
-    Vec3 half(p->radius, p->current_height * 0.5f, p->radius);
-    return {center - half, center + half};
-}
-
-// Get bounds at a specific height (for collision checking when standing up)
-static AABB player_get_bounds_at_height(const Player* p, f32 height) {
-    Vec3 eye_pos = p->camera.position;
-    f32 feet_y = player_get_feet_y(p);
-    Vec3 center(eye_pos.x, feet_y + height * 0.5f, eye_pos.z);
-    Vec3 half(p->radius, height * 0.5f, p->radius);
-    return {center - half, center + half};
+    CharacterParams params = player_character_params(p);
+    CharacterState state = player_character_state(p);
+    return character_bounds(&state, &params);
 }
 
 bool player_can_stand(const Player* p, const CollisionWorld* col) {
-    if (!col || col->box_count == 0) return true;
-    
-    // Check if standing height would collide with anything
-    AABB stand_bounds = player_get_bounds_at_height(p, p->stand_height);
-    
-    for (u32 i = 0; i < col->box_count; i++) {
-        if (aabb_intersects(stand_bounds, col->boxes[i])) {
-            return false;
-        }
-    }
-    return true;
+    CharacterParams params = player_character_params(p);
+    CharacterState state = player_character_state(p);
+    return character_can_stand(&state, &params, col);
 }
 
 void player_capture_input(Player* p, const InputState* input, bool ui_keyboard_capture) {
@@ -230,7 +214,7 @@ void player_capture_input(Player* p, const InputState* input, bool ui_keyboard_c
     p->jump_released_edge = platform_key_released(input, KEY_SPACE);
 
     if (!ui_keyboard_capture && p->jump_pressed_edge) {
-        p->jump_buffer_time = JUMP_BUFFER_MAX;
+        p->jump_buffer_time = CHARACTER_JUMP_BUFFER_MAX;
         p->jump_requested = true;
         p->jump_request_age = 0.0f;
         p->jump_request_dumped = false;
@@ -278,146 +262,51 @@ PlayerLookResult player_apply_mouse_look(Player* p, const InputState* input, boo
 // Main Update
 // =============================================================================
 void player_update(Player* p, const InputState* input, const CollisionWorld* col, f32 dt) {
-    (void)input;
     // Clamp dt to prevent physics explosion on lag spikes
-    if (dt > 0.1f) dt = 0.1f;
+    if (dt > MAX_STEP_DT) dt = MAX_STEP_DT;
     p->last_fixed_dt = dt;
-    
-    
-    
-    
-    
+
     // =========================================================================
-    // Crouch State (hold to crouch)
+    // Input -> Character Intent
     // =========================================================================
     p->wants_crouch = platform_key_down(input, KEY_LCONTROL) || 
                       platform_key_down(input, KEY_CONTROL);
-    
-    // Determine target height
-    f32 old_height = p->current_height;
-    f32 target_height;
-    if (p->wants_crouch) {
-        target_height = p->crouch_height;
-        p->is_crouched = true;
-    } else {
-        // Only stand up if there's room
-        if (p->is_crouched && !player_can_stand(p, col)) {
-            target_height = p->crouch_height;
-            // Stay crouched - can't stand up yet
-        } else {
-            target_height = p->stand_height;
-            p->is_crouched = false;
-        }
-    }
-    
-    // Smoothly interpolate height
-    f32 height_diff = target_height - p->current_height;
-    f32 max_change = CROUCH_TRANSITION_SPEED * dt;
-    if (fabsf(height_diff) > max_change) {
-        p->current_height += (height_diff > 0) ? max_change : -max_change;
-    } else {
-        p->current_height = target_height;
-    }
-    
-    // Adjust camera position to maintain feet position during crouch
-    // When crouching: feet stay on ground, eye comes down
-    if (fabsf(p->current_height - old_height) > 0.0001f) {
-        p->camera.position.y += (p->current_height - old_height);
-    }
-    
-    // =========================================================================
-    // Movement Input
-    // =========================================================================
-    f32 fwd = 0, right = 0;
-    if (platform_key_down(input, KEY_W)) fwd += 1;
-    if (platform_key_down(input, KEY_S)) fwd -= 1;
-    if (platform_key_down(input, KEY_A)) right -= 1;
-    if (platform_key_down(input, KEY_D)) right += 1;
-    
-    bool wants_sprint = platform_key_down(input, KEY_SHIFT);
-    bool is_moving = (fabsf(fwd) > 0.001f || fabsf(right) > 0.001f);
-    
-    // =========================================================================
-    // Determine Move State
-    // =========================================================================
-    if (!is_moving) {
-        p->move_state = p->is_crouched ? MoveState::CROUCHING : MoveState::STANDING;
-    } else if (p->is_crouched) {
-        p->move_state = MoveState::CROUCHING;
-    } else if (wants_sprint && fwd > 0 && p->grounded) {
-        // Can only sprint forward while grounded
-        p->move_state = MoveState::SPRINTING;
-    } else {
-        p->move_state = MoveState::WALKING;
-    }
-    
-    // =========================================================================
-    // Calculate Speed
-    // =========================================================================
-    f32 speed;
-    switch (p->move_state) {
-        case MoveState::SPRINTING: speed = p->sprint_speed; break;
-        case MoveState::CROUCHING: speed = p->crouch_speed; break;
-        case MoveState::WALKING:   speed = p->walk_speed; break;
-        default:                   speed = 0; break;
-    }
-    
+
+    CharacterInput intent = {};
+    intent.yaw = p->camera.yaw;
+    intent.pitch = p->camera.pitch;
+    if (platform_key_down(input, KEY_W)) intent.forward += 1;
+    if (platform_key_down(input, KEY_S)) intent.forward -= 1;
+    if (platform_key_down(input, KEY_A)) intent.right -= 1;
+    if (platform_key_down(input, KEY_D)) intent.right += 1;
+    intent.sprint = platform_key_down(input, KEY_SHIFT);
+    intent.crouch = p->wants_crouch;
+
     // =========================================================================
-    // Calculate Movement Direction (horizontal only)
+    // Shared controller step (crouch, accel, jump, gravity, move-and-slide)
     // =========================================================================
-    Vec3 f = camera_forward(&p->camera);
-    Vec3 r = camera_right(&p->camera);
-    f.y = 0; 
-    f = vec3_normalize(f);
-    
-    Vec3 move_dir = f * fwd + r * right;
-    f32 len = vec3_length(move_dir);
-    if (len > 0.001f) {
-        move_dir = move_dir * (1.0f / len);
+    CharacterParams params = player_character_params(p);
+    CharacterState state = player_character_state(p);
+    CharacterStepResult step;
+    {
+        PROFILE_SCOPE("Physics");
+        step = character_step(&state, &params, &intent, col, dt, &p->collision_cache);
     }
-    p->wish_dir = move_dir;
-    
-    // =========================================================================
-    // Horizontal Movement (with air control)
-    // =========================================================================
-    
-    if (p->grounded) {
-        apply_ground_friction(p, dt);
-        accelerate(p, move_dir, speed, GROUND_ACCEL, dt);
+    player_store_character_state(p, state);
+    p->wish_dir = step.wish_dir;
+    p->last_boxes_tested = step.boxes_tested;
+
+    if (step.collided) {
+        p->grounded_reason = p->grounded ? "sweep_hit_floor" : "air";
     } else {
-        // In air: limited control
-        f32 air_accel = AIR_ACCEL * p->air_control;
-        accelerate(p, move_dir, speed, air_accel, dt);
+        p->grounded_reason = "no_collision";
     }
-    
+
     // =========================================================================
-    // Jumping (with coyote time and jump buffering)
+    // Jump Request Telemetry
     // =========================================================================
-    p->jump_consumed_this_frame = false;
-    const f32 timer_dt = std::min(dt, MAX_TIMER_DT);
-    // Update coyote time
-    if (p->grounded) {
-        p->coyote_time = COYOTE_TIME_MAX;
-    } else {
-        p->coyote_time -= timer_dt;
-        if (p->coyote_time < 0) p->coyote_time = 0;
-    }
-    
-    // Update jump buffer
-    if (p->jump_buffer_time > 0) {
-        p->jump_buffer_time -= timer_dt;
-        if (p->jump_buffer_time < 0) p->jump_buffer_time = 0.0f;
-    }
-    
-    // Execute jump if conditions are met
-    bool can_jump = (p->grounded || p->coyote_time > 0.0f) && !p->jump_consumed_this_frame;    bool want_jump = p->jump_buffer_time > 0;
-    
-    if (can_jump && want_jump) {
-        p->velocity.y = p->jump_velocity;
-        p->coyote_time = 0;           // Consume coyote time
-        p->jump_buffer_time = 0;      // Consume jump buffer
-        p->grounded = false;          // We're airborne now
-        p->jump_consumed_this_frame = true;
+    p->jump_consumed_this_frame = step.jumped;
+    if (step.jumped) {
         p->jump_requested = false;
         p->jump_request_age = 0.0f;
     }
@@ -432,55 +321,6 @@ void player_update(Player* p, const InputState* input, const CollisionWorld* col
             p->jump_requested = false;
         }
     }
-    
-    // =========================================================================
-    // Gravity
-    // =========================================================================
-    if (!p->grounded) {
-        p->velocity.y -= p->gravity * dt;
-        
-        // Clamp to terminal velocity
-        if (p->velocity.y < -p->terminal_velocity) {
-            p->velocity.y = -p->terminal_velocity;
-        }
-    }
-    
-    // =========================================================================
-    // Apply Movement with Collision
-    // =========================================================================
-    Vec3 movement = p->velocity * dt;
-    
-    if (col && col->box_count > 0) {
-        PROFILE_SCOPE("Physics");
-        
-        AABB bounds = player_get_bounds(p);
-        MoveResult result = collision_move_and_slide(col, bounds, movement);
-        
-        // Calculate actual delta
-        Vec3 old_center = aabb_center(bounds);
-        Vec3 delta = result.position - old_center;
-        p->camera.position = p->camera.position + delta;
-        
-        // Update grounded state based on collision
-        bool grounded_hit = result.hit_floor && p->velocity.y <= 0.0f;
-        p->grounded = grounded_hit;
-        p->grounded_reason = grounded_hit ? "sweep_hit_floor" : "air";
-        
-        // If we just landed, zero out vertical velocity
-        if (grounded_hit && p->velocity.y < 0) {
-            p->velocity.y = 0;
-        }
-        
-        // If we hit ceiling, stop upward velocity
-        if (result.hit_ceiling && p->velocity.y > 0) {
-            p->velocity.y = 0;
-        }
-    } else {
-        // No collision world - just move freely
-        p->camera.position = p->camera.position + movement;
-        p->grounded = false;
-        p->grounded_reason = "no_collision";
-    }
     player_log_jump_frame(p, dt);
 }
 
@@ -1,18 +1,36 @@
 #include "brutal/world/scene.h"
 #include "brutal/core/memory.h"
 #include "brutal/core/logging.h"
+#include "brutal/core/jobs.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 namespace brutal {
 
+// Extra slots allocated on a full rebuild so brushes turning visible can be
+// appended without reallocating the GPU buffers.
+static u32 slot_headroom(u32 slots) { return slots / 4 > 64 ? slots / 4 : 64; }
+
 bool scene_create(Scene* s, MemoryArena* arena) {
+    s->arena = arena;
     s->brushes = arena_alloc_array<Brush>(arena, MAX_BRUSHES);
-    s->props = arena_alloc_array<PropEntity>(arena, MAX_PROPS);
-    if (!s->brushes || !s->props) return false;
+    if (!s->brushes) return false;
     s->brush_count = 0; s->brush_capacity = MAX_BRUSHES;
-    s->prop_count = 0; s->prop_capacity = MAX_PROPS;
+    s->brush_handles = {};
+    s->props = {};
+    if (!handle_table_reserve(&s->brush_handles, arena, MAX_BRUSHES) ||
+        !prop_storage_reserve(&s->props, arena, MAX_PROPS)) {
+        return false;
+    }
     s->world_mesh = {}; s->world_mesh_dirty = true;
-    light_environment_init(&s->lights);
+    s->world_slots = {};
+    if (!scene_reserve_world_slots(s, arena, MAX_BRUSHES)) return false;
+    if (!light_environment_init(&s->lights, arena)) return false;
     collision_world_create(&s->collision, arena, MAX_BRUSHES);
+    s->merge_collision = false;
+    s->cull_hidden_faces = false;
+    s->pack_world_vertices = false;
     return true;
 }
 
@@ -21,62 +39,488 @@ void scene_destroy(Scene* s) {
 }
 
 void scene_clear(Scene* s) {
-    s->brush_count = 0; s->prop_count = 0;
+    s->brush_count = 0;
     s->world_mesh_dirty = true;
+    s->world_slots.dirty_count = 0;
+    s->world_slots.retired_count = 0;
+    handle_table_clear(&s->brush_handles);
+    prop_storage_clear(&s->props);
     light_environment_clear(&s->lights);
     collision_world_clear(&s->collision);
 }
 
 Brush* scene_add_brush(Scene* s, const Vec3& min, const Vec3& max, u32 flags, const Vec3& color) {
-    if (s->brush_count >= s->brush_capacity) return nullptr;
-    Brush* b = &s->brushes[s->brush_count++];
+    if (s->brush_count >= s->brush_capacity &&
+        !scene_reserve(s, s->arena, s->brush_capacity ? s->brush_capacity * 2 : MAX_BRUSHES, 0)) {
+        return nullptr;
+    }
+    u32 index = s->brush_count++;
+    handle_table_add<Brush>(&s->brush_handles, index);
+    Brush* b = &s->brushes[index];
     b->min = min; b->max = max; b->flags = flags;
     for (int i = 0; i < 6; i++) b->faces[i].color = color;
-    s->world_mesh_dirty = true;
+    // The entry may still name the slot of a brush removed from this index
+    s->world_slots.brush_slot[index] = WORLD_SLOT_NONE;
+    scene_mark_brush_dirty(s, index);
     return b;
 }
 
-PropEntity* scene_add_prop(Scene* s, const Vec3& pos, const Vec3& scale, u32 mesh_id, const Vec3& color) {
-    if (s->prop_count >= s->prop_capacity) return nullptr;
-    PropEntity* p = &s->props[s->prop_count++];
-    p->transform.position = pos;
-    p->transform.rotation = quat_identity();
-    p->transform.scale = scale;
-    p->mesh_id = mesh_id;
-    p->color = color;
-    p->active = true;
-    return p;
+u32 scene_add_prop(Scene* s, const Transform& t, u32 mesh_id, const Vec3& color, bool active) {
+    PropStorage* p = &s->props;
+    if (p->count >= p->capacity && !scene_reserve(s, s->arena, 0, p->capacity ? p->capacity * 2 : MAX_PROPS)) {
+        return HANDLE_NONE;
+    }
+    return prop_storage_add(p, t, mesh_id, color, active);
 }
 
-void scene_rebuild_world_mesh(Scene* s, MemoryArena* temp) {
-    if (!s->world_mesh_dirty && s->world_mesh.vao) return;
-    u32 vis = 0;
-    for (u32 i = 0; i < s->brush_count; i++)
-        if (!(s->brushes[i].flags & BRUSH_INVISIBLE)) vis++;
-    if (!vis) { s->world_mesh_dirty = false; return; }
-    
-    Vertex* verts = arena_alloc_array<Vertex>(temp, vis * 24);
-    u32* indices = arena_alloc_array<u32>(temp, vis * 36);
-    u32 vc = 0, ic = 0;
-    for (u32 i = 0; i < s->brush_count; i++) {
-        if (s->brushes[i].flags & BRUSH_INVISIBLE) continue;
-        vc += brush_generate_vertices(&s->brushes[i], verts + vc);
-        brush_generate_indices(vc - 24, indices + ic);
-        ic += 36;
+bool scene_reserve(Scene* s, MemoryArena* arena, u32 brush_capacity, u32 prop_capacity) {
+    if (brush_capacity > s->brush_capacity) {
+        Brush* brushes = arena_alloc_array<Brush>(arena, brush_capacity);
+        CollisionWorld collision = {};
+        if (!brushes || !collision_world_create(&collision, arena, brush_capacity)) return false;
+        if (s->brush_count) memcpy(brushes, s->brushes, sizeof(Brush) * s->brush_count);
+        if (!scene_reserve_world_slots(s, arena, brush_capacity) ||
+            !handle_table_reserve(&s->brush_handles, arena, brush_capacity)) {
+            return false;
+        }
+        s->brushes = brushes;
+        s->brush_capacity = brush_capacity;
+        // Carry the boxes over so incremental collision updates keep working
+        const CollisionWorld& old = s->collision;
+        if (old.box_count) memcpy(collision.boxes, old.boxes, sizeof(AABB) * old.box_count);
+        if (old.source_count) {
+            memcpy(collision.source_id, old.source_id, sizeof(u32) * old.source_count);
+            memcpy(collision.source_box, old.source_box, sizeof(u32) * old.source_count);
+        }
+        collision.box_count = old.box_count;
+        collision.source_count = old.source_count;
+        collision.revision = old.revision + 1;
+        s->collision = collision;
     }
-    if (s->world_mesh.vao) mesh_destroy(&s->world_mesh);
-    mesh_create(&s->world_mesh, verts, vc, indices, ic);
+    return prop_storage_reserve(&s->props, arena, prop_capacity);
+}
+
+bool scene_reserve_world_slots(Scene* s, MemoryArena* arena, u32 brush_capacity) {
+    WorldMeshSlots* ws = &s->world_slots;
+    if (brush_capacity <= ws->table_capacity) return true;
+    u32* brush_slot = arena_alloc_array<u32>(arena, brush_capacity);
+    u32* dirty = arena_alloc_array<u32>(arena, brush_capacity);
+    u32* retired = arena_alloc_array<u32>(arena, brush_capacity);
+    if (!brush_slot || !dirty || !retired) return false;
+    if (ws->table_capacity) {
+        memcpy(brush_slot, ws->brush_slot, sizeof(u32) * ws->table_capacity);
+        memcpy(dirty, ws->dirty, sizeof(u32) * ws->dirty_count);
+        memcpy(retired, ws->retired, sizeof(u32) * ws->retired_count);
+    }
+    for (u32 i = ws->table_capacity; i < brush_capacity; i++) brush_slot[i] = WORLD_SLOT_NONE;
+    ws->brush_slot = brush_slot;
+    ws->dirty = dirty;
+    ws->retired = retired;
+    ws->table_capacity = brush_capacity;
+    return true;
+}
+
+BrushHandle scene_brush_handle(const Scene* s, u32 index) {
+    if (index >= s->brush_count) return BrushHandle{};
+    return handle_table_handle<Brush>(&s->brush_handles, index);
+}
+
+PropHandle scene_prop_handle(const Scene* s, u32 index) {
+    if (index >= s->props.count) return PropHandle{};
+    return handle_table_handle<Prop>(&s->props.handles, index);
+}
+
+u32 scene_brush_index(const Scene* s, BrushHandle h) { return handle_table_find(&s->brush_handles, h); }
+u32 scene_prop_index(const Scene* s, PropHandle h) { return handle_table_find(&s->props.handles, h); }
+
+Brush* scene_get_brush(Scene* s, BrushHandle h) {
+    u32 index = handle_table_find(&s->brush_handles, h);
+    return index == HANDLE_NONE ? nullptr : &s->brushes[index];
+}
+
+bool scene_remove_brush(Scene* s, BrushHandle h) {
+    u32 index = handle_table_find(&s->brush_handles, h);
+    if (index == HANDLE_NONE) return false;
+    handle_table_remove(&s->brush_handles, index, s->brush_count);
+    u32 last = --s->brush_count;
+    s->brushes[index] = s->brushes[last];
+
+    // The moved brush takes its slot and queue entries along; the removed
+    // brush's slot is blanked on the next update
+    WorldMeshSlots* ws = &s->world_slots;
+    u32 slot = ws->brush_slot[index];
+    ws->brush_slot[index] = ws->brush_slot[last];
+    ws->brush_slot[last] = WORLD_SLOT_NONE;
+    u32 kept = 0;
+    for (u32 i = 0; i < ws->dirty_count; i++) {
+        u32 b = ws->dirty[i];
+        if (b != index) ws->dirty[kept++] = b == last ? index : b;
+    }
+    ws->dirty_count = kept;
+    if (s->cull_hidden_faces) {
+        s->world_mesh_dirty = true;
+    } else if (slot != WORLD_SLOT_NONE && !s->world_mesh_dirty) {
+        if (ws->retired_count < ws->table_capacity) ws->retired[ws->retired_count++] = slot;
+        else s->world_mesh_dirty = true;
+    }
+    return true;
+}
+
+bool scene_remove_prop(Scene* s, PropHandle h) {
+    u32 index = handle_table_find(&s->props.handles, h);
+    if (index == HANDLE_NONE) return false;
+    prop_storage_remove(&s->props, index);
+    return true;
+}
+
+void scene_mark_brush_dirty(Scene* s, u32 brush) {
+    WorldMeshSlots* ws = &s->world_slots;
+    if (brush >= s->brush_count || s->world_mesh_dirty) return;
+    if (s->cull_hidden_faces || ws->dirty_count >= ws->table_capacity) {
+        s->world_mesh_dirty = true;
+        return;
+    }
+    ws->dirty[ws->dirty_count++] = brush;
+}
+
+// =============================================================================
+// World geometry
+// =============================================================================
+// Brushes are processed in fixed blocks. Pass one counts the faces each block
+// emits, an exclusive prefix sum over the blocks turns the counts into output
+// offsets, and pass two writes every block straight to its offset. Both
+// passes run under parallel_for and the output matches a serial build.
+constexpr u32 GEOMETRY_BLOCK = 1024;
+
+struct GeometryJob {
+    const Brush* brushes;
+    u32 brush_count;
+    const BrushFaceRect* rects;   // Null when every face of a visible brush is kept
+    u32* block_faces;             // Face count per block, then its first face
+    Vertex* verts;
+    u32* indices;
+};
+
+static void count_geometry_blocks(void* user, u32 begin, u32 end) {
+    GeometryJob* job = static_cast<GeometryJob*>(user);
+    for (u32 block = begin; block < end; block++) {
+        u32 first = block * GEOMETRY_BLOCK;
+        u32 last = first + GEOMETRY_BLOCK < job->brush_count ? first + GEOMETRY_BLOCK : job->brush_count;
+        u32 faces = 0;
+        for (u32 i = first; i < last; i++) {
+            if (job->brushes[i].flags & BRUSH_INVISIBLE) continue;
+            if (!job->rects) { faces += BRUSH_FACE_COUNT; continue; }
+            for (u32 f = 0; f < BRUSH_FACE_COUNT; f++)
+                if (!brush_face_rect_empty(job->rects[i * BRUSH_FACE_COUNT + f])) faces++;
+        }
+        job->block_faces[block] = faces;
+    }
+}
+
+static void emit_geometry_blocks(void* user, u32 begin, u32 end) {
+    GeometryJob* job = static_cast<GeometryJob*>(user);
+    for (u32 block = begin; block < end; block++) {
+        u32 first = block * GEOMETRY_BLOCK;
+        u32 last = first + GEOMETRY_BLOCK < job->brush_count ? first + GEOMETRY_BLOCK : job->brush_count;
+        u32 vc = job->block_faces[block] * 4;
+        u32 ic = job->block_faces[block] * 6;
+        for (u32 i = first; i < last; i++) {
+            const Brush* b = &job->brushes[i];
+            if (b->flags & BRUSH_INVISIBLE) continue;
+            if (job->rects) {
+                u32 written;
+                vc += brush_generate_clipped(b, &job->rects[i * BRUSH_FACE_COUNT], vc, job->verts + vc,
+                    job->indices + ic, &written);
+                ic += written;
+            } else {
+                brush_generate_vertices(b, job->verts + vc);
+                brush_generate_indices(vc, job->indices + ic);
+                vc += WORLD_SLOT_VERTICES;
+                ic += WORLD_SLOT_INDICES;
+            }
+        }
+    }
+}
+
+bool scene_build_world_geometry(const Scene* s, MemoryArena* temp,
+    Vertex** verts, u32* vertex_count, u32** indices, u32* index_count) {
+    *verts = nullptr; *indices = nullptr;
+    *vertex_count = 0; *index_count = 0;
+    if (!s->brush_count) return true;
+
+    GeometryJob job = {};
+    job.brushes = s->brushes;
+    job.brush_count = s->brush_count;
+    if (s->cull_hidden_faces) {
+        BrushFaceRect* rects = arena_alloc_array<BrushFaceRect>(temp, s->brush_count * BRUSH_FACE_COUNT);
+        if (!rects) return false;
+        brush_cull_hidden_faces(s->brushes, s->brush_count, rects, temp);
+        job.rects = rects;
+    }
+
+    u32 blocks = (s->brush_count + GEOMETRY_BLOCK - 1) / GEOMETRY_BLOCK;
+    job.block_faces = arena_alloc_array<u32>(temp, blocks);
+    if (!job.block_faces) return false;
+    parallel_for(blocks, 1, count_geometry_blocks, &job);
+
+    u32 faces = 0;
+    for (u32 block = 0; block < blocks; block++) {
+        u32 n = job.block_faces[block];
+        job.block_faces[block] = faces;
+        faces += n;
+    }
+    if (!faces) return true;
+
+    job.verts = arena_alloc_array<Vertex>(temp, faces * 4);
+    job.indices = arena_alloc_array<u32>(temp, faces * 6);
+    if (!job.verts || !job.indices) return false;
+    parallel_for(blocks, 1, emit_geometry_blocks, &job);
+
+    *verts = job.verts; *indices = job.indices;
+    *vertex_count = faces * 4; *index_count = faces * 6;
+    return true;
+}
+
+// Room around the level a packed world mesh's grid leaves for brush edits
+// before one forces a rebuild on a new grid
+constexpr f32 WORLD_PACK_MARGIN = 16.0f;
+
+static AABB world_bounds(const Vertex* verts, u32 count) {
+    AABB b = { verts[0].position, verts[0].position };
+    for (u32 i = 1; i < count; i++) {
+        const Vec3& p = verts[i].position;
+        b.min = Vec3(fminf(b.min.x, p.x), fminf(b.min.y, p.y), fminf(b.min.z, p.z));
+        b.max = Vec3(fmaxf(b.max.x, p.x), fmaxf(b.max.y, p.y), fmaxf(b.max.z, p.z));
+    }
+    return b;
+}
+
+void scene_upload_world_mesh(Scene* s, const Vertex* verts, u32 vertex_count, const u32* indices, u32 index_count) {
+    WorldMeshSlots* ws = &s->world_slots;
+    // Culled geometry is packed; size the buffers by slot-equivalents of it
+    u32 slots = (index_count + WORLD_SLOT_INDICES - 1) / WORLD_SLOT_INDICES;
+    bool pack = false;
+    AABB bounds = vertex_count ? world_bounds(verts, vertex_count) : AABB{};
+    AABB range = aabb_expand(bounds, WORLD_PACK_MARGIN);
+    if (s->pack_world_vertices && vertex_count) {
+        Vec3 origin;
+        f32 step;
+        pack = vertex_pack_grid(range, &origin, &step);
+    }
+    bool packed = s->world_mesh.format == VERTEX_FORMAT_PACKED;
+    if (!s->world_mesh.vao || ws->slot_capacity < slots || packed != pack ||
+        (pack && !mesh_contains(&s->world_mesh, range))) {
+        if (s->world_mesh.vao) mesh_destroy(&s->world_mesh);
+        if (ws->slot_capacity < slots) ws->slot_capacity = slots + slot_headroom(slots);
+        if (pack) {
+            mesh_create_dynamic_packed(&s->world_mesh, ws->slot_capacity * WORLD_SLOT_VERTICES,
+                ws->slot_capacity * WORLD_SLOT_INDICES, range);
+        } else {
+            mesh_create_dynamic(&s->world_mesh, ws->slot_capacity * WORLD_SLOT_VERTICES,
+                ws->slot_capacity * WORLD_SLOT_INDICES);
+        }
+    }
+    mesh_update_vertices(&s->world_mesh, 0, verts, vertex_count);
+    mesh_update_indices(&s->world_mesh, 0, indices, index_count);
+    s->world_mesh.vertex_count = vertex_count;
+    s->world_mesh.index_count = index_count;
+    // Lets the renderer cull the whole mesh, streamed sector chunks mostly
+    s->world_mesh.bounds = bounds;
+    s->world_mesh.has_bounds = vertex_count > 0;
+
+    u32 slot = 0;
+    for (u32 i = 0; i < s->brush_count && i < ws->table_capacity; i++) {
+        bool slotted = !s->cull_hidden_faces && !(s->brushes[i].flags & BRUSH_INVISIBLE);
+        ws->brush_slot[i] = slotted ? slot++ : WORLD_SLOT_NONE;
+    }
+    ws->slot_count = slots;
+    ws->dead_slots = 0;
+    ws->dirty_count = 0;
+    ws->retired_count = 0;
     s->world_mesh_dirty = false;
+}
+
+// Turns a slot into degenerate triangles until the next compaction.
+static void retire_slot(Scene* s, u32 slot) {
+    u32 indices[WORLD_SLOT_INDICES] = {};
+    mesh_update_indices(&s->world_mesh, slot * WORLD_SLOT_INDICES, indices, WORLD_SLOT_INDICES);
+    s->world_slots.dead_slots++;
+}
+
+// Re-emits one brush into its slot, handing out or retiring the slot when
+// visibility changed. Returns false when a full rebuild is needed instead.
+static bool update_brush_slot(Scene* s, u32 brush) {
+    WorldMeshSlots* ws = &s->world_slots;
+    const Brush* b = &s->brushes[brush];
+    u32 slot = ws->brush_slot[brush];
+    u32 indices[WORLD_SLOT_INDICES];
+
+    if (b->flags & BRUSH_INVISIBLE) {
+        if (slot == WORLD_SLOT_NONE) return true;
+        retire_slot(s, slot);
+        ws->brush_slot[brush] = WORLD_SLOT_NONE;
+        return true;
+    }
+
+    // A brush moved off a packed mesh's grid needs a rebuild on a new grid
+    if (!mesh_contains(&s->world_mesh, brush_to_aabb(b))) return false;
+    if (slot == WORLD_SLOT_NONE) {
+        if (ws->slot_count >= ws->slot_capacity) return false;
+        slot = ws->slot_count++;
+        ws->brush_slot[brush] = slot;
+    }
+    Vertex verts[WORLD_SLOT_VERTICES];
+    brush_generate_vertices(b, verts);
+    brush_generate_indices(slot * WORLD_SLOT_VERTICES, indices);
+    mesh_update_vertices(&s->world_mesh, slot * WORLD_SLOT_VERTICES, verts, WORLD_SLOT_VERTICES);
+    mesh_update_indices(&s->world_mesh, slot * WORLD_SLOT_INDICES, indices, WORLD_SLOT_INDICES);
+    s->world_mesh.bounds = aabb_merge(s->world_mesh.bounds, brush_to_aabb(b));
+    return true;
+}
+
+void scene_rebuild_world_mesh(Scene* s, MemoryArena* temp) {
+    WorldMeshSlots* ws = &s->world_slots;
+    if (!s->world_mesh_dirty && s->world_mesh.vao) {
+        if (!ws->dirty_count && !ws->retired_count) return;
+        for (u32 i = 0; i < ws->retired_count; i++) retire_slot(s, ws->retired[i]);
+        ws->retired_count = 0;
+        bool ok = true;
+        for (u32 i = 0; ok && i < ws->dirty_count; i++) ok = update_brush_slot(s, ws->dirty[i]);
+        ws->dirty_count = 0;
+        s->world_mesh.vertex_count = ws->slot_count * WORLD_SLOT_VERTICES;
+        s->world_mesh.index_count = ws->slot_count * WORLD_SLOT_INDICES;
+        if (ok && ws->dead_slots * 4 <= ws->slot_count) return;
+    } else if (!s->world_mesh_dirty && !ws->dirty_count) {
+        return;
+    }
+
+    Vertex* verts; u32* indices;
+    u32 vc, ic;
+    if (!scene_build_world_geometry(s, temp, &verts, &vc, &indices, &ic)) {
+        LOG_ERROR("World mesh: out of temp memory for %u brushes", s->brush_count);
+        return;
+    }
+    if (!ic) {
+        if (s->world_mesh.vao) mesh_destroy(&s->world_mesh);
+        ws->slot_count = ws->slot_capacity = ws->dead_slots = ws->dirty_count = 0;
+        s->world_mesh_dirty = false;
+        return;
+    }
+    scene_upload_world_mesh(s, verts, vc, indices, ic);
     LOG_INFO("World mesh: %u verts, %u indices", vc, ic);
 }
 
-void scene_rebuild_collision(Scene* s) {
-    collision_world_clear(&s->collision);
+void scene_build_collision(const Scene* s, CollisionWorld* w) {
+    collision_world_clear(w);
     for (u32 i = 0; i < s->brush_count; i++) {
         if (s->brushes[i].flags & BRUSH_SOLID)
-            collision_world_add_box(&s->collision, brush_to_aabb(&s->brushes[i]));
+            collision_world_add_box(w, brush_to_aabb(&s->brushes[i]), i);
+    }
+    if (s->merge_collision) collision_world_merge_boxes(w);
+}
+
+static void add_brush_collision(Scene* s, u32 brush) {
+    if (brush < s->brush_count && (s->brushes[brush].flags & BRUSH_SOLID))
+        collision_world_add_box(&s->collision, brush_to_aabb(&s->brushes[brush]), brush);
+}
+
+bool scene_update_collision(Scene* s, const u32* brushes, u32 count, MemoryArena* temp) {
+    CollisionWorld* w = &s->collision;
+    u32 mask_size = s->brush_count;
+    for (u32 i = 0; i < count; i++) if (brushes[i] >= mask_size) mask_size = brushes[i] + 1;
+    u8* mask = arena_alloc_array<u8>(temp, mask_size ? mask_size : 1);
+    u32* orphans = arena_alloc_array<u32>(temp, w->source_count ? w->source_count : 1);
+    if (!mask || !orphans) return false;
+    memset(mask, 0, mask_size);
+    for (u32 i = 0; i < count; i++) mask[brushes[i]] = 1;
+
+    u32 orphan_count = collision_world_remove_sources(w, mask, mask_size, orphans, temp);
+    if (orphan_count == COLLISION_NO_BOX) return false;
+    u32 first = w->box_count;
+    for (u32 i = 0; i < count; i++) {
+        if (!mask[brushes[i]]) continue;
+        mask[brushes[i]] = 0;
+        add_brush_collision(s, brushes[i]);
+    }
+    for (u32 i = 0; i < orphan_count; i++) add_brush_collision(s, orphans[i]);
+    if (s->merge_collision) collision_world_merge_boxes(w, first);
+    return true;
+}
+
+void scene_rebuild_collision(Scene* s) {
+    scene_build_collision(s, &s->collision);
+    if (s->merge_collision) {
+        LOG_INFO("Collision: %u boxes (merged from %u brushes)", s->collision.box_count, s->collision.source_count);
+        return;
     }
     LOG_INFO("Collision: %u boxes", s->collision.box_count);
 }
 
+// =============================================================================
+// Occluders
+// =============================================================================
+// Smallest score worth a place in the occlusion buffer: about a square metre
+// seen from fourteen metres
+constexpr f32 OCCLUDER_MIN_SCORE = 0.005f;
+
+struct OccluderScore {
+    f32 score;
+    u32 brush;
+};
+
+// Clip-space planes of a column-major view-projection, inside where
+// a * x + b * y + c * z + d >= 0
+static void frustum_planes(const Mat4& m, f32 planes[6][4]) {
+    for (u32 p = 0; p < 6; p++) {
+        u32 axis = p / 2;
+        f32 sign = (p & 1) ? -1.0f : 1.0f;
+        for (u32 c = 0; c < 4; c++) planes[p][c] = m.m[c * 4 + 3] + sign * m.m[c * 4 + axis];
+    }
+}
+
+// False when the box is entirely behind one plane
+static bool box_in_frustum(const f32 planes[6][4], const Vec3& min, const Vec3& max) {
+    for (u32 p = 0; p < 6; p++) {
+        const f32* pl = planes[p];
+        f32 d = pl[0] * (pl[0] > 0.0f ? max.x : min.x) + pl[1] * (pl[1] > 0.0f ? max.y : min.y) +
+            pl[2] * (pl[2] > 0.0f ? max.z : min.z) + pl[3];
+        if (d < 0.0f) return false;
+    }
+    return true;
+}
+
+u32 scene_select_occluders(const Scene* s, const Vec3& eye, const Mat4& view_projection, AABB* out, u32 max,
+    MemoryArena* temp) {
+    if (!max || !s->brush_count) return 0;
+    OccluderScore* scores = arena_alloc_array<OccluderScore>(temp, s->brush_count);
+    if (!scores) return 0;
+    f32 planes[6][4];
+    frustum_planes(view_projection, planes);
+
+    // Half the surface over the squared distance: the solid angle of a box
+    // seen from afar, without the cost of projecting it
+    u32 n = 0;
+    for (u32 i = 0; i < s->brush_count; i++) {
+        const Brush* b = &s->brushes[i];
+        if (b->flags & BRUSH_INVISIBLE) continue;
+        if (!box_in_frustum(planes, b->min, b->max)) continue;
+        Vec3 size = b->max - b->min;
+        f32 area = size.x * size.y + size.y * size.z + size.z * size.x;
+        f32 dx = fmaxf(fmaxf(b->min.x - eye.x, eye.x - b->max.x), 0.0f);
+        f32 dy = fmaxf(fmaxf(b->min.y - eye.y, eye.y - b->max.y), 0.0f);
+        f32 dz = fmaxf(fmaxf(b->min.z - eye.z, eye.z - b->max.z), 0.0f);
+        f32 score = area / fmaxf(dx * dx + dy * dy + dz * dz, 1.0f);
+        if (score >= OCCLUDER_MIN_SCORE) scores[n++] = { score, i };
+    }
+
+    auto larger = [](const OccluderScore& a, const OccluderScore& b) { return a.score > b.score; };
+    if (n > max) {
+        std::nth_element(scores, scores + max, scores + n, larger);
+        n = max;
+    }
+    std::sort(scores, scores + n, larger);
+    for (u32 i = 0; i < n; i++) out[i] = brush_to_aabb(&s->brushes[scores[i].brush]);
+    return n;
+}
+
 }
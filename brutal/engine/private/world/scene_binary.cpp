@@ -0,0 +1,353 @@
+#include "brutal/world/scene_binary.h"
+#include "brutal/core/memory.h"
+#include "brutal/core/logging.h"
+#include "brutal/core/time.h"
+#include <cstdio>
+#include <cstring>
+
+namespace brutal {
+
+// =============================================================================
+// File layout
+// =============================================================================
+// [BSceneHeader][section][section]... with every section 16-byte aligned.
+// Sections are raw arrays of the in-memory structs; capacity >= count lets
+// the collision world be rebuilt in place after editing.
+constexpr u32 BSCENE_ALIGN = 16;
+constexpr u32 BSCENE_MERGED_COLLISION = 1u << 0;
+constexpr u32 BSCENE_CULLED_FACES = 1u << 1;
+
+struct BSceneSection {
+    u64 offset;
+    u32 count;
+    u32 capacity;
+};
+
+enum BSceneSectionId : u32 {
+    SECTION_BRUSHES,
+    SECTION_PROP_POSITIONS,
+    SECTION_PROP_ROTATIONS,
+    SECTION_PROP_SCALES,
+    SECTION_PROP_COLORS,
+    SECTION_PROP_MESH_IDS,
+    SECTION_VERTICES,
+    SECTION_INDICES,
+    SECTION_BOXES,
+    SECTION_SOURCE_ID,
+    SECTION_SOURCE_BOX,
+    SECTION_POINT_LIGHTS,
+    SECTION_SPOT_LIGHTS,
+    SECTION_COUNT
+};
+
+struct BSceneHeader {
+    u32 magic;
+    u32 version;
+    u32 header_size;
+    u32 flags;
+    u64 file_size;
+    // Layout fingerprint of the baking build
+    u32 brush_size, vertex_size, point_light_size, spot_light_size;
+    u32 prop_active_count;
+    u32 pad0;               // Explicit so value-initialization zeroes every byte
+    BSceneSection sections[SECTION_COUNT];
+    SceneSpawn spawn;
+    Vec3 ambient_color;
+    f32 ambient_intensity;
+    u32 pad1;
+};
+
+static const u32 SECTION_STRIDE[SECTION_COUNT] = {
+    sizeof(Brush), sizeof(Vec3), sizeof(Quat), sizeof(Vec3), sizeof(Vec3), sizeof(u32), sizeof(Vertex), sizeof(u32),
+    sizeof(AABB), sizeof(u32), sizeof(u32), sizeof(PointLight), sizeof(SpotLight)
+};
+
+static u64 align_up(u64 v) { return (v + BSCENE_ALIGN - 1) & ~static_cast<u64>(BSCENE_ALIGN - 1); }
+
+// =============================================================================
+// Baking
+// =============================================================================
+// Lights are copied field by field into the arena's zeroed storage so
+// padding bytes are deterministic and identical scenes bake to identical files. Prop columns
+// have no padding and are written as they are.
+static void copy_point_light(PointLight* d, const PointLight* s) {
+    *d = PointLight{};
+    d->position = s->position; d->rotation = s->rotation; d->scale = s->scale;
+    d->radius = s->radius; d->color = s->color; d->intensity = s->intensity; d->active = s->active;
+}
+
+static void copy_spot_light(SpotLight* d, const SpotLight* s) {
+    *d = SpotLight{};
+    d->position = s->position; d->range = s->range; d->direction = s->direction; d->inner_cos = s->inner_cos;
+    d->color = s->color; d->intensity = s->intensity; d->outer_cos = s->outer_cos; d->falloff = s->falloff;
+    d->active = s->active;
+}
+
+static bool write_section(FILE* f, const BSceneSection& sec, u32 stride, const void* data) {
+    static const u8 zeros[256] = {};
+    long pos = ftell(f);
+    if (pos < 0) return false;
+    for (u64 pad = sec.offset - static_cast<u64>(pos); pad > 0;) {
+        size_t n = pad < sizeof(zeros) ? static_cast<size_t>(pad) : sizeof(zeros);
+        if (fwrite(zeros, 1, n, f) != n) return false;
+        pad -= n;
+    }
+    size_t bytes = static_cast<size_t>(sec.count) * stride;
+    if (bytes && fwrite(data, 1, bytes, f) != bytes) return false;
+    for (u64 rest = static_cast<u64>(sec.capacity - sec.count) * stride; rest > 0;) {
+        size_t n = rest < sizeof(zeros) ? static_cast<size_t>(rest) : sizeof(zeros);
+        if (fwrite(zeros, 1, n, f) != n) return false;
+        rest -= n;
+    }
+    return true;
+}
+
+bool scene_bake_binary(const Scene* scene, const SceneSpawn* spawn, const char* path, MemoryArena* temp) {
+    if (!scene || !spawn || !path) {
+        LOG_ERROR("Scene bake failed: no scene or path");
+        return false;
+    }
+    f64 start = time_now();
+
+    Vertex* verts; u32* indices;
+    u32 vc, ic;
+    const LightEnvironment* lights = &scene->lights;
+    PointLight* point_lights = arena_alloc_array<PointLight>(temp, lights->point_light_count ? lights->point_light_count : 1);
+    SpotLight* spot_lights = arena_alloc_array<SpotLight>(temp, lights->spot_light_count ? lights->spot_light_count : 1);
+    CollisionWorld collision = {};
+    u32 collision_capacity = scene->brush_count ? scene->brush_count : 1;
+    if (!point_lights || !spot_lights || !scene_build_world_geometry(scene, temp, &verts, &vc, &indices, &ic) ||
+        !collision_world_create(&collision, temp, collision_capacity)) {
+        LOG_ERROR("Scene bake failed: out of temp memory for %s", path);
+        return false;
+    }
+    for (u32 i = 0; i < lights->point_light_count; i++) copy_point_light(&point_lights[i], &lights->point_lights[i]);
+    for (u32 i = 0; i < lights->spot_light_count; i++) copy_spot_light(&spot_lights[i], &lights->spot_lights[i]);
+    scene_build_collision(scene, &collision);
+
+    BSceneHeader header{};
+    header.magic = BSCENE_MAGIC;
+    header.version = BSCENE_VERSION;
+    header.header_size = sizeof(BSceneHeader);
+    header.flags = (scene->merge_collision ? BSCENE_MERGED_COLLISION : 0) |
+                   (scene->cull_hidden_faces ? BSCENE_CULLED_FACES : 0);
+    header.brush_size = sizeof(Brush);
+    header.prop_active_count = scene->props.active_count;
+    header.vertex_size = sizeof(Vertex);
+    header.point_light_size = sizeof(PointLight);
+    header.spot_light_size = sizeof(SpotLight);
+    header.spawn = *spawn;
+    header.ambient_color = lights->ambient_color;
+    header.ambient_intensity = lights->ambient_intensity;
+
+    const u32 counts[SECTION_COUNT] = {
+        scene->brush_count, scene->props.count, scene->props.count, scene->props.count, scene->props.count,
+        scene->props.count, vc, ic,
+        collision.box_count, collision.source_count, collision.source_count,
+        lights->point_light_count, lights->spot_light_count
+    };
+    const void* data[SECTION_COUNT] = {
+        scene->brushes, scene->props.positions, scene->props.rotations, scene->props.scales, scene->props.colors,
+        scene->props.mesh_ids, verts, indices,
+        collision.boxes, collision.source_id, collision.source_box,
+        point_lights, spot_lights
+    };
+    u64 offset = align_up(sizeof(BSceneHeader));
+    for (u32 i = 0; i < SECTION_COUNT; i++) {
+        BSceneSection& sec = header.sections[i];
+        sec.offset = offset;
+        sec.count = counts[i];
+        bool collision_section = i == SECTION_BOXES || i == SECTION_SOURCE_ID || i == SECTION_SOURCE_BOX;
+        sec.capacity = collision_section ? collision_capacity : counts[i];
+        offset = align_up(offset + static_cast<u64>(sec.capacity) * SECTION_STRIDE[i]);
+    }
+    header.file_size = offset;
+
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        LOG_ERROR("Scene bake failed: cannot open %s", path);
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    for (u32 i = 0; ok && i < SECTION_COUNT; i++) {
+        ok = write_section(f, header.sections[i], SECTION_STRIDE[i], data[i]);
+    }
+    // Trailing pad so the file is exactly file_size
+    ok = ok && write_section(f, BSceneSection{ header.file_size, 0, 0 }, 1, nullptr);
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        LOG_ERROR("Scene bake failed: write error on %s", path);
+        remove(path);
+        return false;
+    }
+    LOG_INFO("Scene baked: %s (%.1f KB, %u verts, %u collision boxes) in %.2f ms", path,
+        static_cast<f64>(header.file_size) / 1024.0, vc, collision.box_count, (time_now() - start) * 1000.0);
+    return true;
+}
+
+// =============================================================================
+// Loading
+// =============================================================================
+// Turns a section offset into a pointer after checking it lies inside the
+// mapping and is aligned for T.
+template<typename T>
+static T* section_ptr(u8* base, size_t size, const BSceneSection& sec) {
+    if (sec.count > sec.capacity || sec.offset % BSCENE_ALIGN != 0) return nullptr;
+    u64 bytes = static_cast<u64>(sec.capacity) * sizeof(T);
+    if (sec.offset > size || bytes > size - sec.offset) return nullptr;
+    return reinterpret_cast<T*>(base + sec.offset);
+}
+
+static const char* validate_header(const BSceneHeader* h, size_t size) {
+    if (size < sizeof(BSceneHeader)) return "file too small";
+    if (h->magic != BSCENE_MAGIC) return "not a baked scene";
+    if (h->version != BSCENE_VERSION) return "version mismatch";
+    if (h->header_size != sizeof(BSceneHeader) || h->brush_size != sizeof(Brush) ||
+        h->vertex_size != sizeof(Vertex) ||
+        h->point_light_size != sizeof(PointLight) || h->spot_light_size != sizeof(SpotLight)) {
+        return "struct layout mismatch";
+    }
+    if (h->file_size != size) return "truncated file";
+    const BSceneSection* s = h->sections;
+    for (u32 i = SECTION_PROP_ROTATIONS; i <= SECTION_PROP_MESH_IDS; i++) {
+        if (s[i].count != s[SECTION_PROP_POSITIONS].count) return "inconsistent sections";
+    }
+    if (h->prop_active_count > s[SECTION_PROP_POSITIONS].count) return "inconsistent sections";
+    if (s[SECTION_BOXES].capacity != s[SECTION_SOURCE_ID].capacity ||
+        s[SECTION_BOXES].capacity != s[SECTION_SOURCE_BOX].capacity ||
+        s[SECTION_SOURCE_ID].count != s[SECTION_SOURCE_BOX].count) {
+        return "inconsistent sections";
+    }
+    return nullptr;
+}
+
+bool scene_load_binary(Scene* scene, SceneSpawn* spawn, const char* path, MemoryArena* arena, SceneBinary* out) {
+    *out = {};
+    if (!scene || !path) {
+        LOG_ERROR("Scene load failed: no scene or path");
+        return false;
+    }
+    f64 start = time_now();
+    FileMapping m;
+    if (!file_map_private(path, &m)) {
+        LOG_WARN("Baked scene not found: %s", path);
+        return false;
+    }
+
+    u8* base = const_cast<u8*>(m.data);
+    const BSceneHeader* h = reinterpret_cast<const BSceneHeader*>(base);
+    const char* error = validate_header(h, m.size);
+
+    const BSceneSection* s = error ? nullptr : h->sections;
+    Brush* brushes = nullptr;
+    PropStorage props = {};
+    const Vertex* verts = nullptr;
+    const u32* indices = nullptr;
+    AABB* boxes = nullptr;
+    u32* source_id = nullptr;
+    u32* source_box = nullptr;
+    const PointLight* point_lights = nullptr;
+    const SpotLight* spot_lights = nullptr;
+    if (!error) {
+        brushes = section_ptr<Brush>(base, m.size, s[SECTION_BRUSHES]);
+        props.positions = section_ptr<Vec3>(base, m.size, s[SECTION_PROP_POSITIONS]);
+        props.rotations = section_ptr<Quat>(base, m.size, s[SECTION_PROP_ROTATIONS]);
+        props.scales = section_ptr<Vec3>(base, m.size, s[SECTION_PROP_SCALES]);
+        props.colors = section_ptr<Vec3>(base, m.size, s[SECTION_PROP_COLORS]);
+        props.mesh_ids = section_ptr<u32>(base, m.size, s[SECTION_PROP_MESH_IDS]);
+        verts = section_ptr<Vertex>(base, m.size, s[SECTION_VERTICES]);
+        indices = section_ptr<u32>(base, m.size, s[SECTION_INDICES]);
+        boxes = section_ptr<AABB>(base, m.size, s[SECTION_BOXES]);
+        source_id = section_ptr<u32>(base, m.size, s[SECTION_SOURCE_ID]);
+        source_box = section_ptr<u32>(base, m.size, s[SECTION_SOURCE_BOX]);
+        point_lights = section_ptr<PointLight>(base, m.size, s[SECTION_POINT_LIGHTS]);
+        spot_lights = section_ptr<SpotLight>(base, m.size, s[SECTION_SPOT_LIGHTS]);
+        if (!brushes || !props.positions || !props.rotations || !props.scales || !props.colors ||
+            !props.mesh_ids || !verts || !indices || !boxes || !source_id || !source_box ||
+            !point_lights || !spot_lights) {
+            error = "section out of bounds";
+        }
+    }
+    // Everything that can fail is reserved up front so the scene stays intact
+    u32 brush_count = error ? 0 : s[SECTION_BRUSHES].count;
+    u32 prop_count = error ? 0 : s[SECTION_PROP_POSITIONS].count;
+    if (!error && (!scene_reserve_world_slots(scene, arena, brush_count) ||
+        !handle_table_reserve(&scene->brush_handles, arena, brush_count) ||
+        !handle_table_reserve(&scene->props.handles, arena, prop_count) ||
+        !light_environment_reserve(&scene->lights, s[SECTION_POINT_LIGHTS].count, s[SECTION_SPOT_LIGHTS].count))) {
+        error = "out of memory for scene tables";
+    }
+    if (error) {
+        LOG_ERROR("Baked scene %s rejected: %s", path, error);
+        file_unmap(&m);
+        return false;
+    }
+
+    // Old handles go stale; after a clear the tables hand out slot i to index i
+    handle_table_clear(&scene->brush_handles);
+    handle_table_clear(&scene->props.handles);
+    for (u32 i = 0; i < brush_count; i++) handle_table_add<Brush>(&scene->brush_handles, i);
+    for (u32 i = 0; i < prop_count; i++) handle_table_add<Prop>(&scene->props.handles, i);
+    scene->brushes = brushes;
+    scene->brush_count = scene->brush_capacity = brush_count;
+    props.count = props.capacity = prop_count;
+    props.active_count = h->prop_active_count;
+    props.handles = scene->props.handles;
+    scene->props = props;
+
+    // Lights are few and grow with editing, so they are copied into the arena
+    LightEnvironment* lights = &scene->lights;
+    light_environment_clear(lights);
+    lights->ambient_color = h->ambient_color;
+    lights->ambient_intensity = h->ambient_intensity;
+    for (u32 i = 0; i < s[SECTION_POINT_LIGHTS].count; i++) {
+        const PointLight& p = point_lights[i];
+        *light_environment_add_point(lights, p.position, p.color, p.radius, p.intensity) = p;
+    }
+    for (u32 i = 0; i < s[SECTION_SPOT_LIGHTS].count; i++) {
+        const SpotLight& p = spot_lights[i];
+        *light_environment_add_spot(lights, p.position, p.direction, p.color, p.range,
+            p.inner_cos, p.outer_cos, p.intensity, p.falloff) = p;
+    }
+    scene->merge_collision = (h->flags & BSCENE_MERGED_COLLISION) != 0;
+    scene->cull_hidden_faces = (h->flags & BSCENE_CULLED_FACES) != 0;
+    scene->world_mesh_dirty = true;
+    scene->world_slots.dirty_count = 0;
+    scene->world_slots.retired_count = 0;
+
+    CollisionWorld& c = scene->collision;
+    u32 revision = c.revision + 1;
+    c.boxes = boxes;
+    c.box_count = s[SECTION_BOXES].count;
+    c.box_capacity = s[SECTION_BOXES].capacity;
+    c.source_id = source_id;
+    c.source_box = source_box;
+    c.source_count = s[SECTION_SOURCE_ID].count;
+    c.revision = revision;
+
+    if (spawn) *spawn = h->spawn;
+
+    out->mapping = m;
+    out->vertices = verts;
+    out->vertex_count = s[SECTION_VERTICES].count;
+    out->indices = indices;
+    out->index_count = s[SECTION_INDICES].count;
+    LOG_INFO("Scene loaded: %s (%u brushes, %u props, %u collision boxes, baked) in %.3f ms", path,
+        scene->brush_count, scene->props.count, c.box_count, (time_now() - start) * 1000.0);
+    return true;
+}
+
+void scene_binary_upload(Scene* scene, const SceneBinary* bin) {
+    if (!bin->index_count) {
+        scene->world_mesh_dirty = false;
+        return;
+    }
+    scene_upload_world_mesh(scene, bin->vertices, bin->vertex_count, bin->indices, bin->index_count);
+}
+
+void scene_binary_close(SceneBinary* bin) {
+    file_unmap(&bin->mapping);
+    *bin = {};
+}
+
+}
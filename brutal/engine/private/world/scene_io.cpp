@@ -1,14 +1,335 @@
 #include "brutal/world/scene_io.h"
+#include "brutal/core/file.h"
+#include "brutal/core/json.h"
 #include "brutal/core/logging.h"
+#include "brutal/core/time.h"
 
 #include <cstdio>
 
 namespace brutal {
 
-    bool scene_load_from_json(Scene* scene, SceneSpawn* spawn, const char* path, MemoryArena* arena) {
-        (void)spawn;
-        (void)arena;
+    // =========================================================================
+    // Format
+    // =========================================================================
+    // {
+    //   "format": "brutal.scene", "version": 1,
+    //   "brush_count": N, "prop_count": N,          (optional capacity hints)
+    //   "spawn": {"position": [x, y, z], "yaw": f, "pitch": f},
+    //   "ambient": {"color": [r, g, b], "intensity": f},
+    //   "brushes": [{"min": [..], "max": [..], "solid": b, "invisible": b,
+    //                "color": [..] | "faces": [[..] x6]}],
+    //   "props": [{"position": [..], "rotation": [x, y, z, w], "scale": [..],
+    //              "mesh": u, "color": [..], "active": b}],
+    //   "point_lights": [{"position", "color", "radius", "intensity",
+    //                     "rotation", "scale", "active"}],
+    //   "spot_lights": [{"position", "direction", "color", "range", "inner_cos",
+    //                    "outer_cos", "intensity", "falloff", "active"}]
+    // }
+    // Unknown keys are skipped so newer files still load.
+    static constexpr u32 SCENE_JSON_VERSION = 1;
+    static constexpr u32 MAX_CAPACITY_HINT = 1u << 24;
+
+    // =========================================================================
+    // Reader
+    // =========================================================================
+    struct SceneReader {
+        JsonReader json;
+        Scene* scene;
+        SceneSpawn spawn;      // Committed to the caller only on success
+        bool has_spawn;
+        MemoryArena* arena;
+    };
+
+    static bool reader_fail(SceneReader* r, const char* message) {
+        if (!r->json.error) r->json.error = message;
+        return false;
+    }
+
+    static bool key_is(const SceneReader* r, const char* key) {
+        return json_text_equals(&r->json, key);
+    }
+
+    static bool expect(SceneReader* r, JsonToken want, const char* message) {
+        JsonToken t = json_next(&r->json);
+        return t == want || reader_fail(r, message);
+    }
+
+    // Next key of the current object; false at '}' or on error.
+    static bool next_key(SceneReader* r) {
+        return json_next(&r->json) == JsonToken::KEY;
+    }
+
+    static bool object_done(const SceneReader* r) {
+        return !r->json.error;
+    }
+
+    static bool skip_value(SceneReader* r) {
+        return json_skip_value(&r->json, json_next(&r->json)) || reader_fail(r, "malformed value");
+    }
+
+    static bool read_f32(SceneReader* r, f32* out) {
+        if (!expect(r, JsonToken::NUMBER, "expected number")) return false;
+        *out = static_cast<f32>(r->json.number);
+        return true;
+    }
+
+    static bool read_u32(SceneReader* r, u32* out) {
+        if (!expect(r, JsonToken::NUMBER, "expected number")) return false;
+        f64 n = r->json.number;
+        if (n < 0.0 || n > 4294967295.0) return reader_fail(r, "integer out of range");
+        *out = static_cast<u32>(n);
+        return true;
+    }
+
+    static bool read_bool(SceneReader* r, bool* out) {
+        JsonToken t = json_next(&r->json);
+        if (t == JsonToken::TRUE_VALUE) { *out = true; return true; }
+        if (t == JsonToken::FALSE_VALUE) { *out = false; return true; }
+        return reader_fail(r, "expected true or false");
+    }
+
+    static bool read_floats(SceneReader* r, f32* out, u32 count) {
+        if (!expect(r, JsonToken::ARRAY_BEGIN, "expected array")) return false;
+        for (u32 i = 0; i < count; i++) {
+            if (!read_f32(r, &out[i])) return false;
+        }
+        return expect(r, JsonToken::ARRAY_END, "too many array elements");
+    }
+
+    static bool read_vec3(SceneReader* r, Vec3* out) {
+        f32 v[3];
+        if (!read_floats(r, v, 3)) return false;
+        *out = Vec3(v[0], v[1], v[2]);
+        return true;
+    }
+
+    static bool read_quat(SceneReader* r, Quat* out) {
+        f32 v[4];
+        if (!read_floats(r, v, 4)) return false;
+        *out = {v[0], v[1], v[2], v[3]};
+        return true;
+    }
+
+    // Calls element once per object in an array; element starts after '{'.
+    static bool read_object_array(SceneReader* r, bool (*element)(SceneReader*)) {
+        if (!expect(r, JsonToken::ARRAY_BEGIN, "expected array")) return false;
+        for (;;) {
+            JsonToken t = json_next(&r->json);
+            if (t == JsonToken::ARRAY_END) return true;
+            if (t != JsonToken::OBJECT_BEGIN) return reader_fail(r, "expected object");
+            if (!element(r)) return false;
+        }
+    }
+
+    static bool read_spawn(SceneReader* r) {
+        if (!expect(r, JsonToken::OBJECT_BEGIN, "expected spawn object")) return false;
+        while (next_key(r)) {
+            bool ok;
+            if (key_is(r, "position")) ok = read_vec3(r, &r->spawn.position);
+            else if (key_is(r, "yaw")) ok = read_f32(r, &r->spawn.yaw);
+            else if (key_is(r, "pitch")) ok = read_f32(r, &r->spawn.pitch);
+            else ok = skip_value(r);
+            if (!ok) return false;
+        }
+        r->has_spawn = true;
+        return object_done(r);
+    }
+
+    static bool read_ambient(SceneReader* r) {
+        if (!expect(r, JsonToken::OBJECT_BEGIN, "expected ambient object")) return false;
+        LightEnvironment* env = &r->scene->lights;
+        while (next_key(r)) {
+            bool ok;
+            if (key_is(r, "color")) ok = read_vec3(r, &env->ambient_color);
+            else if (key_is(r, "intensity")) ok = read_f32(r, &env->ambient_intensity);
+            else ok = skip_value(r);
+            if (!ok) return false;
+        }
+        return object_done(r);
+    }
+
+    static bool read_brush(SceneReader* r) {
+        Vec3 min(0, 0, 0), max(1, 1, 1), color(1, 1, 1);
+        Vec3 faces[6];
+        bool has_faces = false;
+        bool solid = true, invisible = false;
+        while (next_key(r)) {
+            bool ok;
+            if (key_is(r, "min")) ok = read_vec3(r, &min);
+            else if (key_is(r, "max")) ok = read_vec3(r, &max);
+            else if (key_is(r, "color")) ok = read_vec3(r, &color);
+            else if (key_is(r, "solid")) ok = read_bool(r, &solid);
+            else if (key_is(r, "invisible")) ok = read_bool(r, &invisible);
+            else if (key_is(r, "faces")) {
+                ok = expect(r, JsonToken::ARRAY_BEGIN, "expected faces array");
+                for (u32 i = 0; ok && i < 6; i++) ok = read_vec3(r, &faces[i]);
+                ok = ok && expect(r, JsonToken::ARRAY_END, "brush needs exactly 6 faces");
+                has_faces = true;
+            }
+            else ok = skip_value(r);
+            if (!ok) return false;
+        }
+        if (!object_done(r)) return false;
+
+        u32 flags = (solid ? BRUSH_SOLID : 0) | (invisible ? BRUSH_INVISIBLE : 0);
+        Brush* b = scene_add_brush(r->scene, min, max, flags, color);
+        if (!b) return reader_fail(r, "out of memory for brushes");
+        if (has_faces) {
+            for (int i = 0; i < 6; i++) b->faces[i].color = faces[i];
+        }
+        return true;
+    }
+
+    static bool read_prop(SceneReader* r) {
+        Vec3 position(0, 0, 0), scale(1, 1, 1), color(1, 1, 1);
+        Quat rotation = quat_identity();
+        u32 mesh_id = MESH_CUBE;
+        bool active = true;
+        while (next_key(r)) {
+            bool ok;
+            if (key_is(r, "position")) ok = read_vec3(r, &position);
+            else if (key_is(r, "rotation")) ok = read_quat(r, &rotation);
+            else if (key_is(r, "scale")) ok = read_vec3(r, &scale);
+            else if (key_is(r, "mesh")) ok = read_u32(r, &mesh_id);
+            else if (key_is(r, "color")) ok = read_vec3(r, &color);
+            else if (key_is(r, "active")) ok = read_bool(r, &active);
+            else ok = skip_value(r);
+            if (!ok) return false;
+        }
+        if (!object_done(r)) return false;
+
+        Transform transform = { position, rotation, scale };
+        if (scene_add_prop(r->scene, transform, mesh_id, color, active) == HANDLE_NONE) {
+            return reader_fail(r, "out of memory for props");
+        }
+        return true;
+    }
+
+    static bool read_point_light(SceneReader* r) {
+        PointLight light = {};
+        light.scale = Vec3(1, 1, 1);
+        light.color = Vec3(1, 1, 1);
+        light.radius = 10.0f;
+        light.intensity = 1.0f;
+        light.active = true;
+        while (next_key(r)) {
+            bool ok;
+            if (key_is(r, "position")) ok = read_vec3(r, &light.position);
+            else if (key_is(r, "color")) ok = read_vec3(r, &light.color);
+            else if (key_is(r, "radius")) ok = read_f32(r, &light.radius);
+            else if (key_is(r, "intensity")) ok = read_f32(r, &light.intensity);
+            else if (key_is(r, "rotation")) ok = read_vec3(r, &light.rotation);
+            else if (key_is(r, "scale")) ok = read_vec3(r, &light.scale);
+            else if (key_is(r, "active")) ok = read_bool(r, &light.active);
+            else ok = skip_value(r);
+            if (!ok) return false;
+        }
+        if (!object_done(r)) return false;
+
+        PointLight* l = light_environment_add_point(&r->scene->lights,
+            light.position, light.color, light.radius, light.intensity);
+        if (!l) return reader_fail(r, "out of memory for point lights");
+        l->rotation = light.rotation;
+        l->scale = light.scale;
+        l->active = light.active;
+        return true;
+    }
 
+    static bool read_spot_light(SceneReader* r) {
+        SpotLight light = {};
+        light.direction = Vec3(0, -1, 0);
+        light.color = Vec3(1, 1, 1);
+        light.range = 10.0f;
+        light.inner_cos = 0.9f;
+        light.outer_cos = 0.8f;
+        light.intensity = 1.0f;
+        light.falloff = 1.0f;
+        light.active = true;
+        while (next_key(r)) {
+            bool ok;
+            if (key_is(r, "position")) ok = read_vec3(r, &light.position);
+            else if (key_is(r, "direction")) ok = read_vec3(r, &light.direction);
+            else if (key_is(r, "color")) ok = read_vec3(r, &light.color);
+            else if (key_is(r, "range")) ok = read_f32(r, &light.range);
+            else if (key_is(r, "inner_cos")) ok = read_f32(r, &light.inner_cos);
+            else if (key_is(r, "outer_cos")) ok = read_f32(r, &light.outer_cos);
+            else if (key_is(r, "intensity")) ok = read_f32(r, &light.intensity);
+            else if (key_is(r, "falloff")) ok = read_f32(r, &light.falloff);
+            else if (key_is(r, "active")) ok = read_bool(r, &light.active);
+            else ok = skip_value(r);
+            if (!ok) return false;
+        }
+        if (!object_done(r)) return false;
+
+        SpotLight* l = light_environment_add_spot(&r->scene->lights, light.position, light.direction,
+            light.color, light.range, light.inner_cos, light.outer_cos, light.intensity, light.falloff);
+        if (!l) return reader_fail(r, "out of memory for spot lights");
+        l->active = light.active;
+        return true;
+    }
+
+    static bool read_scene(SceneReader* r) {
+        if (!expect(r, JsonToken::OBJECT_BEGIN, "expected scene object")) return false;
+        while (next_key(r)) {
+            bool ok;
+            if (key_is(r, "brushes")) ok = read_object_array(r, read_brush);
+            else if (key_is(r, "props")) ok = read_object_array(r, read_prop);
+            else if (key_is(r, "point_lights")) ok = read_object_array(r, read_point_light);
+            else if (key_is(r, "spot_lights")) ok = read_object_array(r, read_spot_light);
+            else if (key_is(r, "spawn")) ok = read_spawn(r);
+            else if (key_is(r, "ambient")) ok = read_ambient(r);
+            else if (key_is(r, "brush_count") || key_is(r, "prop_count")) {
+                bool brushes = key_is(r, "brush_count");
+                u32 hint = 0;
+                ok = read_u32(r, &hint);
+                if (ok && hint <= MAX_CAPACITY_HINT) {
+                    ok = brushes ? scene_reserve(r->scene, r->arena, hint, 0)
+                                 : scene_reserve(r->scene, r->arena, 0, hint);
+                    if (!ok) reader_fail(r, "out of memory for capacity hint");
+                }
+            }
+            else if (key_is(r, "version")) {
+                u32 version = 0;
+                ok = read_u32(r, &version);
+                if (ok && version > SCENE_JSON_VERSION) {
+                    LOG_WARN("Scene JSON version %u is newer than %u, unknown fields are ignored",
+                        version, SCENE_JSON_VERSION);
+                }
+            }
+            else ok = skip_value(r);
+            if (!ok) return false;
+        }
+        if (!object_done(r)) return false;
+        return expect(r, JsonToken::END, "trailing data after scene");
+    }
+
+    bool scene_load_from_json_buffer(Scene* scene, SceneSpawn* spawn, const char* data, size_t size,
+        const char* name, MemoryArena* arena) {
+        if (!scene) {
+            LOG_ERROR("Scene load failed: scene is null");
+            return false;
+        }
+        scene_clear(scene);
+
+        SceneReader r = {};
+        json_reader_init(&r.json, data, size);
+        r.scene = scene;
+        if (spawn) r.spawn = *spawn;
+        r.arena = arena;
+
+        if (!read_scene(&r)) {
+            u32 line = 0, column = 0;
+            json_error_location(&r.json, &line, &column);
+            LOG_ERROR("Scene JSON %s:%u:%u: %s", name, line, column,
+                r.json.error ? r.json.error : "malformed scene");
+            scene_clear(scene);
+            return false;
+        }
+        if (spawn && r.has_spawn) *spawn = r.spawn;
+        return true;
+    }
+
+    bool scene_load_from_json(Scene* scene, SceneSpawn* spawn, const char* path, MemoryArena* arena) {
         if (!scene) {
             LOG_ERROR("Scene load failed: scene is null");
             return false;
@@ -21,14 +342,186 @@ namespace brutal {
             return true;
         }
 
-        FILE* file = std::fopen(path, "rb");
-        if (!file) {
+        f64 start = time_now();
+        FileMapping file = {};
+        if (!file_map_read(path, &file)) {
             LOG_WARN("Scene JSON not found: %s (loading skipped)", path);
             return true;
         }
 
-        std::fclose(file);
-        LOG_WARN("Scene JSON loading not implemented yet: %s", path);
+        bool ok = scene_load_from_json_buffer(scene, spawn,
+            reinterpret_cast<const char*>(file.data), file.size, path, arena);
+        file_unmap(&file);
+        if (ok) {
+            LOG_INFO("Scene loaded: %s (%u brushes, %u props, %u point, %u spot lights) in %.2f ms",
+                path, scene->brush_count, scene->props.count,
+                scene->lights.point_light_count, scene->lights.spot_light_count,
+                (time_now() - start) * 1000.0);
+        }
+        return ok;
+    }
+
+    // =========================================================================
+    // Writer
+    // =========================================================================
+    static void write_vec3(JsonWriter* w, const char* key, const Vec3& v) {
+        json_key(w, key);
+        json_begin_array(w, true);
+        json_write_float(w, v.x);
+        json_write_float(w, v.y);
+        json_write_float(w, v.z);
+        json_end_array(w);
+    }
+
+    static void write_f32(JsonWriter* w, const char* key, f32 v) {
+        json_key(w, key);
+        json_write_float(w, v);
+    }
+
+    static void write_bool(JsonWriter* w, const char* key, bool v) {
+        json_key(w, key);
+        json_write_bool(w, v);
+    }
+
+    static bool same_color(const Vec3& a, const Vec3& b) {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+
+    static void write_brush(JsonWriter* w, const Brush* b) {
+        json_begin_object(w, true);
+        write_vec3(w, "min", b->min);
+        write_vec3(w, "max", b->max);
+        write_bool(w, "solid", (b->flags & BRUSH_SOLID) != 0);
+        if (b->flags & BRUSH_INVISIBLE) write_bool(w, "invisible", true);
+
+        bool uniform = true;
+        for (int i = 1; i < 6; i++) uniform = uniform && same_color(b->faces[i].color, b->faces[0].color);
+        if (uniform) {
+            write_vec3(w, "color", b->faces[0].color);
+        } else {
+            json_key(w, "faces");
+            json_begin_array(w);
+            for (int i = 0; i < 6; i++) {
+                json_begin_array(w);
+                json_write_float(w, b->faces[i].color.x);
+                json_write_float(w, b->faces[i].color.y);
+                json_write_float(w, b->faces[i].color.z);
+                json_end_array(w);
+            }
+            json_end_array(w);
+        }
+        json_end_object(w);
+    }
+
+    static void write_prop(JsonWriter* w, const PropStorage* p, u32 i) {
+        json_begin_object(w, true);
+        write_vec3(w, "position", p->positions[i]);
+        json_key(w, "rotation");
+        json_begin_array(w);
+        json_write_float(w, p->rotations[i].x);
+        json_write_float(w, p->rotations[i].y);
+        json_write_float(w, p->rotations[i].z);
+        json_write_float(w, p->rotations[i].w);
+        json_end_array(w);
+        write_vec3(w, "scale", p->scales[i]);
+        json_key(w, "mesh");
+        json_write_uint(w, p->mesh_ids[i]);
+        write_vec3(w, "color", p->colors[i]);
+        write_bool(w, "active", prop_is_active(p, i));
+        json_end_object(w);
+    }
+
+    bool scene_save_to_json(const Scene* scene, const SceneSpawn* spawn, const char* path) {
+        if (!scene || !path || path[0] == '\0') {
+            LOG_ERROR("Scene save failed: no scene or path");
+            return false;
+        }
+        FILE* file = std::fopen(path, "wb");
+        if (!file) {
+            LOG_ERROR("Scene save failed: cannot open %s", path);
+            return false;
+        }
+        std::setvbuf(file, nullptr, _IOFBF, 1 << 16);
+
+        JsonWriter w;
+        json_writer_init(&w, file);
+        json_begin_object(&w);
+        json_key(&w, "format");
+        json_write_string(&w, "brutal.scene");
+        json_key(&w, "version");
+        json_write_uint(&w, SCENE_JSON_VERSION);
+        json_key(&w, "brush_count");
+        json_write_uint(&w, scene->brush_count);
+        json_key(&w, "prop_count");
+        json_write_uint(&w, scene->props.count);
+
+        if (spawn) {
+            json_key(&w, "spawn");
+            json_begin_object(&w, true);
+            write_vec3(&w, "position", spawn->position);
+            write_f32(&w, "yaw", spawn->yaw);
+            write_f32(&w, "pitch", spawn->pitch);
+            json_end_object(&w);
+        }
+
+        json_key(&w, "ambient");
+        json_begin_object(&w, true);
+        write_vec3(&w, "color", scene->lights.ambient_color);
+        write_f32(&w, "intensity", scene->lights.ambient_intensity);
+        json_end_object(&w);
+
+        json_key(&w, "brushes");
+        json_begin_array(&w);
+        for (u32 i = 0; i < scene->brush_count; i++) write_brush(&w, &scene->brushes[i]);
+        json_end_array(&w);
+
+        json_key(&w, "props");
+        json_begin_array(&w);
+        for (u32 i = 0; i < scene->props.count; i++) write_prop(&w, &scene->props, i);
+        json_end_array(&w);
+
+        json_key(&w, "point_lights");
+        json_begin_array(&w);
+        for (u32 i = 0; i < scene->lights.point_light_count; i++) {
+            const PointLight& l = scene->lights.point_lights[i];
+            json_begin_object(&w, true);
+            write_vec3(&w, "position", l.position);
+            write_vec3(&w, "color", l.color);
+            write_f32(&w, "radius", l.radius);
+            write_f32(&w, "intensity", l.intensity);
+            write_vec3(&w, "rotation", l.rotation);
+            write_vec3(&w, "scale", l.scale);
+            write_bool(&w, "active", l.active);
+            json_end_object(&w);
+        }
+        json_end_array(&w);
+
+        json_key(&w, "spot_lights");
+        json_begin_array(&w);
+        for (u32 i = 0; i < scene->lights.spot_light_count; i++) {
+            const SpotLight& l = scene->lights.spot_lights[i];
+            json_begin_object(&w, true);
+            write_vec3(&w, "position", l.position);
+            write_vec3(&w, "direction", l.direction);
+            write_vec3(&w, "color", l.color);
+            write_f32(&w, "range", l.range);
+            write_f32(&w, "inner_cos", l.inner_cos);
+            write_f32(&w, "outer_cos", l.outer_cos);
+            write_f32(&w, "intensity", l.intensity);
+            write_f32(&w, "falloff", l.falloff);
+            write_bool(&w, "active", l.active);
+            json_end_object(&w);
+        }
+        json_end_array(&w);
+        json_end_object(&w);
+
+        bool ok = !std::ferror(file);
+        ok = (std::fclose(file) == 0) && ok;
+        if (!ok) {
+            LOG_ERROR("Scene save failed: write error on %s", path);
+            return false;
+        }
+        LOG_INFO("Scene saved: %s (%u brushes, %u props)", path, scene->brush_count, scene->props.count);
         return true;
     }
 
@@ -0,0 +1,218 @@
+#include "brutal/world/scene_reload.h"
+#include "brutal/core/logging.h"
+#include "brutal/core/memory.h"
+#include "brutal/core/time.h"
+
+namespace brutal {
+
+static bool vec3_equal(const Vec3& a, const Vec3& b) { return a.x == b.x && a.y == b.y && a.z == b.z; }
+
+static bool brush_equal(const Brush& a, const Brush& b) {
+    if (!vec3_equal(a.min, b.min) || !vec3_equal(a.max, b.max) || a.flags != b.flags) return false;
+    for (u32 f = 0; f < BRUSH_FACE_COUNT; f++) {
+        if (!vec3_equal(a.faces[f].color, b.faces[f].color)) return false;
+    }
+    return true;
+}
+
+static bool point_light_equal(const PointLight& a, const PointLight& b) {
+    return vec3_equal(a.position, b.position) && vec3_equal(a.rotation, b.rotation) &&
+        vec3_equal(a.scale, b.scale) && vec3_equal(a.color, b.color) && a.radius == b.radius &&
+        a.intensity == b.intensity && a.active == b.active;
+}
+
+static bool spot_light_equal(const SpotLight& a, const SpotLight& b) {
+    return vec3_equal(a.position, b.position) && vec3_equal(a.direction, b.direction) &&
+        vec3_equal(a.color, b.color) && a.range == b.range && a.inner_cos == b.inner_cos &&
+        a.outer_cos == b.outer_cos && a.intensity == b.intensity && a.falloff == b.falloff &&
+        a.active == b.active;
+}
+
+static bool prop_equal(const PropStorage* a, u32 a_active, const PropStorage* b, u32 i) {
+    const Quat& qa = a->rotations[i];
+    const Quat& qb = b->rotations[i];
+    return vec3_equal(a->positions[i], b->positions[i]) && qa.x == qb.x && qa.y == qb.y && qa.z == qb.z &&
+        qa.w == qb.w && vec3_equal(a->scales[i], b->scales[i]) && vec3_equal(a->colors[i], b->colors[i]) &&
+        a->mesh_ids[i] == b->mesh_ids[i] && (i < a_active) == prop_is_active(b, i);
+}
+
+// =============================================================================
+// Diff
+// =============================================================================
+static void apply_brushes(Scene* live, const Scene* src, u32* changed, u32* changed_count, SceneDiffStats* st) {
+    u32 old_count = live->brush_count;
+    u32 common = old_count < src->brush_count ? old_count : src->brush_count;
+    for (u32 i = 0; i < common; i++) {
+        if (brush_equal(live->brushes[i], src->brushes[i])) continue;
+        live->brushes[i] = src->brushes[i];
+        scene_mark_brush_dirty(live, i);
+        changed[(*changed_count)++] = i;
+        st->brushes_changed++;
+    }
+    // From the end, so removal never renumbers a brush
+    while (live->brush_count > src->brush_count) {
+        u32 i = live->brush_count - 1;
+        scene_remove_brush(live, scene_brush_handle(live, i));
+        changed[(*changed_count)++] = i;
+        st->brushes_removed++;
+    }
+    for (u32 i = old_count; i < src->brush_count; i++) {
+        const Brush& b = src->brushes[i];
+        // Storage was reserved up front, so this cannot fail
+        *scene_add_brush(live, b.min, b.max, b.flags, b.faces[0].color) = b;
+        changed[(*changed_count)++] = i;
+        st->brushes_added++;
+    }
+}
+
+static void apply_props(PropStorage* live, const PropStorage* src, SceneDiffStats* st) {
+    u32 old_active = live->active_count;
+    u32 common = live->count < src->count ? live->count : src->count;
+    for (u32 i = 0; i < common; i++) {
+        if (!prop_equal(live, old_active, src, i)) st->props_changed++;
+    }
+    // Overwriting by index only keeps the active split if the tail is
+    // inactive while it grows or shrinks; the final split is set at the end
+    if (live->active_count > common) live->active_count = common;
+    while (live->count > src->count) {
+        prop_storage_remove(live, live->count - 1);
+        st->props_removed++;
+    }
+    while (live->count < src->count) {
+        prop_storage_add(live, transform_default(), 0, Vec3(0, 0, 0), false);
+        st->props_added++;
+    }
+    for (u32 i = 0; i < src->count; i++) {
+        prop_set_transform(live, i, prop_transform(src, i));
+        live->colors[i] = src->colors[i];
+        live->mesh_ids[i] = src->mesh_ids[i];
+    }
+    live->active_count = src->active_count;
+}
+
+static void apply_lights(LightEnvironment* live, const LightEnvironment* src, SceneDiffStats* st) {
+    u32 common = live->point_light_count < src->point_light_count ? live->point_light_count : src->point_light_count;
+    for (u32 i = 0; i < common; i++) {
+        if (point_light_equal(live->point_lights[i], src->point_lights[i])) continue;
+        live->point_lights[i] = src->point_lights[i];
+        st->lights_changed++;
+    }
+    while (live->point_light_count > src->point_light_count) {
+        light_environment_remove_point(live, light_environment_point_handle(live, live->point_light_count - 1));
+        st->lights_removed++;
+    }
+    for (u32 i = live->point_light_count; i < src->point_light_count; i++) {
+        const PointLight& l = src->point_lights[i];
+        *light_environment_add_point(live, l.position, l.color, l.radius, l.intensity) = l;
+        st->lights_added++;
+    }
+
+    common = live->spot_light_count < src->spot_light_count ? live->spot_light_count : src->spot_light_count;
+    for (u32 i = 0; i < common; i++) {
+        if (spot_light_equal(live->spot_lights[i], src->spot_lights[i])) continue;
+        live->spot_lights[i] = src->spot_lights[i];
+        st->lights_changed++;
+    }
+    while (live->spot_light_count > src->spot_light_count) {
+        light_environment_remove_spot(live, light_environment_spot_handle(live, live->spot_light_count - 1));
+        st->lights_removed++;
+    }
+    for (u32 i = live->spot_light_count; i < src->spot_light_count; i++) {
+        const SpotLight& l = src->spot_lights[i];
+        *light_environment_add_spot(live, l.position, l.direction, l.color, l.range, l.inner_cos, l.outer_cos,
+            l.intensity, l.falloff) = l;
+        st->lights_added++;
+    }
+    live->ambient_color = src->ambient_color;
+    live->ambient_intensity = src->ambient_intensity;
+}
+
+bool scene_apply_diff(Scene* live, const Scene* src, u32 point_base, u32 spot_base, MemoryArena* temp,
+    SceneDiffStats* out) {
+    SceneDiffStats st = {};
+    LightEnvironment* env = &live->lights;
+    u32 max_brushes = live->brush_count > src->brush_count ? live->brush_count : src->brush_count;
+    u32* changed = arena_alloc_array<u32>(temp, max_brushes ? max_brushes : 1);
+    if (!changed || !scene_reserve(live, live->arena, src->brush_count, src->props.count) ||
+        !light_environment_reserve(env, src->lights.point_light_count, src->lights.spot_light_count)) {
+        return false;
+    }
+
+    while (env->point_light_count > point_base)
+        light_environment_remove_point(env, light_environment_point_handle(env, env->point_light_count - 1));
+    while (env->spot_light_count > spot_base)
+        light_environment_remove_spot(env, light_environment_spot_handle(env, env->spot_light_count - 1));
+
+    u32 changed_count = 0;
+    apply_brushes(live, src, changed, &changed_count, &st);
+    apply_props(&live->props, &src->props, &st);
+    apply_lights(env, &src->lights, &st);
+    if (changed_count && !scene_update_collision(live, changed, changed_count, temp)) {
+        scene_rebuild_collision(live);
+        st.collision_rebuilt = true;
+    }
+    if (out) *out = st;
+    return true;
+}
+
+// =============================================================================
+// Hot reload
+// =============================================================================
+bool scene_reloader_open(SceneReloader* r, const char* path, const Scene* scene) {
+    *r = {};
+    if (!path || !file_watch_open(&r->watch, path)) {
+        LOG_WARN("Scene reload: cannot watch %s", path ? path : "(null)");
+        return false;
+    }
+    r->point_lights = scene->lights.point_light_count;
+    r->spot_lights = scene->lights.spot_light_count;
+    return true;
+}
+
+void scene_reloader_close(SceneReloader* r) {
+    file_watch_close(&r->watch);
+}
+
+bool scene_reloader_poll(SceneReloader* r) {
+    return file_watch_poll(&r->watch);
+}
+
+bool scene_reload(SceneReloader* r, Scene* scene, SceneSpawn* spawn, MemoryArena* temp, SceneDiffStats* out) {
+    const char* path = r->watch.path;
+    f64 start = time_now();
+    FileMapping file = {};
+    if (!file_map_read(path, &file)) {
+        LOG_WARN("Scene reload skipped: %s not found", path);
+        return false;
+    }
+
+    Scene staged = {};
+    SceneSpawn staged_spawn = spawn ? *spawn : SceneSpawn{};
+    bool ok = scene_create(&staged, temp) &&
+        scene_load_from_json_buffer(&staged, &staged_spawn, reinterpret_cast<const char*>(file.data), file.size,
+            path, temp);
+    file_unmap(&file);
+    f64 parsed = time_now();
+    if (!ok) {
+        LOG_WARN("Scene reload skipped: %s did not load, keeping the current scene", path);
+        return false;
+    }
+
+    SceneDiffStats st = {};
+    if (!scene_apply_diff(scene, &staged, r->point_lights, r->spot_lights, temp, &st)) {
+        LOG_ERROR("Scene reload failed: out of memory applying %s", path);
+        return false;
+    }
+    r->point_lights = scene->lights.point_light_count;
+    r->spot_lights = scene->lights.spot_light_count;
+    if (spawn) *spawn = staged_spawn;
+    if (out) *out = st;
+
+    LOG_INFO("Scene reloaded: %s, brushes %u changed %u added %u removed, props %u/%u/%u, lights %u/%u/%u "
+        "(parse %.2f ms, apply %.2f ms)", path, st.brushes_changed, st.brushes_added, st.brushes_removed,
+        st.props_changed, st.props_added, st.props_removed, st.lights_changed, st.lights_added, st.lights_removed,
+        (parsed - start) * 1000.0, (time_now() - parsed) * 1000.0);
+    return true;
+}
+
+}
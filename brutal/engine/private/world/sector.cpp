@@ -0,0 +1,557 @@
+#include "brutal/world/sector.h"
+#include "brutal/world/scene_binary.h"
+#include "brutal/core/file.h"
+#include "brutal/core/logging.h"
+#include "brutal/core/memory.h"
+#include "brutal/core/time.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace brutal {
+
+// =============================================================================
+// Manifest layout
+// =============================================================================
+// [BSectorsHeader][SectorInfo x sector_count]
+constexpr u32 BSECTORS_MERGED_COLLISION = 1u << 0;
+constexpr u32 BSECTORS_CULLED_FACES = 1u << 1;
+constexpr u32 MAX_SECTOR_CELLS = 1u << 22;
+
+struct BSectorsHeader {
+    u32 magic;
+    u32 version;
+    u32 header_size;
+    u32 info_size;
+    u32 sector_count;
+    u32 flags;
+    f32 sector_size;
+    f32 ambient_intensity;
+    Vec3 ambient_color;
+    SceneSpawn spawn;
+};
+
+static void sector_file_path(const char* manifest_path, u32 index, char* out, size_t size) {
+    snprintf(out, size, "%s.%u", manifest_path, index);
+}
+
+static u64 file_size_of(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return 0;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    return size > 0 ? static_cast<u64>(size) : 0;
+}
+
+// =============================================================================
+// Baking
+// =============================================================================
+// Counting sort of items by cell: order lists items cell by cell and cell c
+// owns order[first[c], first[c + 1]).
+static bool bucket_by_cell(const u32* cell_of, u32 count, u32 cells, MemoryArena* temp, u32** first, u32** order) {
+    *first = arena_alloc_array<u32>(temp, cells + 1);
+    *order = arena_alloc_array<u32>(temp, count ? count : 1);
+    if (!*first || !*order) return false;
+    u32* f = *first;
+    memset(f, 0, sizeof(u32) * (cells + 1));
+    for (u32 i = 0; i < count; i++) f[cell_of[i] + 1]++;
+    for (u32 c = 0; c < cells; c++) f[c + 1] += f[c];
+    for (u32 i = 0; i < count; i++) (*order)[f[cell_of[i]]++] = i;
+    // The scatter advanced every start to the next cell's; shift back
+    for (u32 c = cells; c > 0; c--) f[c] = f[c - 1];
+    f[0] = 0;
+    return true;
+}
+
+bool scene_bake_sectors(const Scene* scene, const SceneSpawn* spawn, const char* manifest_path,
+    f32 sector_size, MemoryArena* temp) {
+    if (!scene || !spawn || !manifest_path || !(sector_size > 0.0f)) {
+        LOG_ERROR("Sector bake failed: bad arguments");
+        return false;
+    }
+    f64 start = time_now();
+    const LightEnvironment* lights = &scene->lights;
+    const PropStorage* props = &scene->props;
+
+    // Grid origin and extent from everything that gets placed
+    f32 min_x = INFINITY, min_z = INFINITY, max_x = -INFINITY, max_z = -INFINITY;
+    auto extend = [&](const Vec3& p) {
+        min_x = std::min(min_x, p.x); max_x = std::max(max_x, p.x);
+        min_z = std::min(min_z, p.z); max_z = std::max(max_z, p.z);
+    };
+    for (u32 i = 0; i < scene->brush_count; i++) extend(aabb_center(brush_to_aabb(&scene->brushes[i])));
+    for (u32 i = 0; i < props->count; i++) extend(props->positions[i]);
+    for (u32 i = 0; i < lights->point_light_count; i++) extend(lights->point_lights[i].position);
+    for (u32 i = 0; i < lights->spot_light_count; i++) extend(lights->spot_lights[i].position);
+    if (min_x > max_x) min_x = max_x = min_z = max_z = 0.0f;
+
+    u32 grid_w = static_cast<u32>((max_x - min_x) / sector_size) + 1;
+    u32 grid_h = static_cast<u32>((max_z - min_z) / sector_size) + 1;
+    if (static_cast<u64>(grid_w) * grid_h > MAX_SECTOR_CELLS) {
+        LOG_ERROR("Sector bake failed: %ux%u sectors, use a larger sector size", grid_w, grid_h);
+        return false;
+    }
+    u32 cells = grid_w * grid_h;
+    auto cell_of = [&](const Vec3& p) {
+        u32 x = std::min(static_cast<u32>((p.x - min_x) / sector_size), grid_w - 1);
+        u32 z = std::min(static_cast<u32>((p.z - min_z) / sector_size), grid_h - 1);
+        return z * grid_w + x;
+    };
+
+    u32 counts[4] = { scene->brush_count, props->count, lights->point_light_count, lights->spot_light_count };
+    u32* cell_ids[4];
+    u32* first[4];
+    u32* order[4];
+    for (u32 k = 0; k < 4; k++) {
+        cell_ids[k] = arena_alloc_array<u32>(temp, counts[k] ? counts[k] : 1);
+        if (!cell_ids[k]) {
+            LOG_ERROR("Sector bake failed: out of temp memory");
+            return false;
+        }
+    }
+    for (u32 i = 0; i < scene->brush_count; i++) cell_ids[0][i] = cell_of(aabb_center(brush_to_aabb(&scene->brushes[i])));
+    for (u32 i = 0; i < props->count; i++) cell_ids[1][i] = cell_of(props->positions[i]);
+    for (u32 i = 0; i < lights->point_light_count; i++) cell_ids[2][i] = cell_of(lights->point_lights[i].position);
+    for (u32 i = 0; i < lights->spot_light_count; i++) cell_ids[3][i] = cell_of(lights->spot_lights[i].position);
+    for (u32 k = 0; k < 4; k++) {
+        if (!bucket_by_cell(cell_ids[k], counts[k], cells, temp, &first[k], &order[k])) {
+            LOG_ERROR("Sector bake failed: out of temp memory");
+            return false;
+        }
+    }
+
+    // One scratch arena sized for the largest sector, reset between sectors
+    u32 max_brushes = 0, max_other = 0;
+    for (u32 c = 0; c < cells; c++) {
+        max_brushes = std::max(max_brushes, first[0][c + 1] - first[0][c]);
+        u32 other = 0;
+        for (u32 k = 1; k < 4; k++) other += first[k][c + 1] - first[k][c];
+        max_other = std::max(max_other, other);
+    }
+    MemoryArena scratch = {};
+    if (!arena_init(&scratch, static_cast<size_t>(max_brushes) * 4096 + static_cast<size_t>(max_other) * 512 +
+        4 * 1024 * 1024)) {
+        LOG_ERROR("Sector bake failed: out of memory for the scratch arena");
+        return false;
+    }
+
+    std::vector<SectorInfo> infos;
+    bool ok = true;
+    char path[1024];
+    for (u32 c = 0; ok && c < cells; c++) {
+        u32 nb = first[0][c + 1] - first[0][c];
+        u32 np = first[1][c + 1] - first[1][c];
+        u32 npl = first[2][c + 1] - first[2][c];
+        u32 nsl = first[3][c + 1] - first[3][c];
+        if (!nb && !np && !npl && !nsl) continue;
+
+        arena_reset(&scratch);
+        Scene sub = {};
+        if (!scene_create(&sub, &scratch) || !scene_reserve(&sub, &scratch, nb, np)) {
+            ok = false;
+            break;
+        }
+        sub.merge_collision = scene->merge_collision;
+        sub.cull_hidden_faces = scene->cull_hidden_faces;
+        sub.lights.ambient_color = lights->ambient_color;
+        sub.lights.ambient_intensity = lights->ambient_intensity;
+
+        SectorInfo info = {};
+        info.cell_x = static_cast<i32>(c % grid_w);
+        info.cell_z = static_cast<i32>(c / grid_w);
+        info.bounds.min = Vec3(INFINITY, INFINITY, INFINITY);
+        info.bounds.max = Vec3(-INFINITY, -INFINITY, -INFINITY);
+        for (u32 j = first[0][c]; j < first[0][c + 1]; j++) {
+            const Brush& src = scene->brushes[order[0][j]];
+            Brush* b = scene_add_brush(&sub, src.min, src.max, src.flags, src.faces[0].color);
+            for (u32 f = 0; f < BRUSH_FACE_COUNT; f++) b->faces[f].color = src.faces[f].color;
+            info.bounds = aabb_merge(info.bounds, brush_to_aabb(&src));
+        }
+        for (u32 j = first[1][c]; j < first[1][c + 1]; j++) {
+            u32 i = order[1][j];
+            Transform t = prop_transform(props, i);
+            scene_add_prop(&sub, t, props->mesh_ids[i], props->colors[i], prop_is_active(props, i));
+            // Rotated unit cube reaches at most sqrt(3) half extents out
+            info.bounds = aabb_merge(info.bounds, aabb_from_center_size(t.position, t.scale * 1.7320508f));
+        }
+        for (u32 j = first[2][c]; j < first[2][c + 1]; j++) {
+            const PointLight& src = lights->point_lights[order[2][j]];
+            *light_environment_add_point(&sub.lights, src.position, src.color, src.radius, src.intensity) = src;
+            info.bounds = aabb_merge(info.bounds, AABB{ src.position, src.position });
+        }
+        for (u32 j = first[3][c]; j < first[3][c + 1]; j++) {
+            const SpotLight& src = lights->spot_lights[order[3][j]];
+            *light_environment_add_spot(&sub.lights, src.position, src.direction, src.color, src.range,
+                src.inner_cos, src.outer_cos, src.intensity, src.falloff) = src;
+            info.bounds = aabb_merge(info.bounds, AABB{ src.position, src.position });
+        }
+
+        u32 index = static_cast<u32>(infos.size());
+        sector_file_path(manifest_path, index, path, sizeof(path));
+        ok = scene_bake_binary(&sub, spawn, path, &scratch);
+        info.file_size = file_size_of(path);
+        info.brush_count = nb;
+        info.prop_count = np;
+        info.point_light_count = npl;
+        info.spot_light_count = nsl;
+        infos.push_back(info);
+    }
+    arena_shutdown(&scratch);
+    if (!ok) {
+        LOG_ERROR("Sector bake failed: could not bake sector %u of %s", static_cast<u32>(infos.size()), manifest_path);
+        return false;
+    }
+
+    BSectorsHeader header{};
+    header.magic = BSECTORS_MAGIC;
+    header.version = BSECTORS_VERSION;
+    header.header_size = sizeof(BSectorsHeader);
+    header.info_size = sizeof(SectorInfo);
+    header.sector_count = static_cast<u32>(infos.size());
+    header.flags = (scene->merge_collision ? BSECTORS_MERGED_COLLISION : 0) |
+                   (scene->cull_hidden_faces ? BSECTORS_CULLED_FACES : 0);
+    header.sector_size = sector_size;
+    header.ambient_color = lights->ambient_color;
+    header.ambient_intensity = lights->ambient_intensity;
+    header.spawn = *spawn;
+
+    FILE* f = fopen(manifest_path, "wb");
+    if (!f) {
+        LOG_ERROR("Sector bake failed: cannot open %s", manifest_path);
+        return false;
+    }
+    ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+         (infos.empty() || fwrite(infos.data(), sizeof(SectorInfo), infos.size(), f) == infos.size());
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        LOG_ERROR("Sector bake failed: write error on %s", manifest_path);
+        remove(manifest_path);
+        return false;
+    }
+    LOG_INFO("Sectors baked: %s (%u sectors of %.0f units, %ux%u grid) in %.2f ms", manifest_path,
+        header.sector_count, sector_size, grid_w, grid_h, (time_now() - start) * 1000.0);
+    return true;
+}
+
+// =============================================================================
+// Streaming
+// =============================================================================
+enum SectorState : u32 {
+    SECTOR_UNLOADED,
+    SECTOR_QUEUED,
+    SECTOR_LOADING,
+    SECTOR_READY,      // Loaded by the loader thread, waiting for the main thread
+    SECTOR_RESIDENT,
+    SECTOR_FAILED      // Never retried
+};
+
+// Arena for scene_create's initial storage plus the tables scene_load_binary
+// builds. Sized from the manifest counts so it can be charged up front.
+static size_t sector_arena_size(const SectorInfo& info) {
+    return 256 * 1024 + static_cast<size_t>(info.brush_count) * 32 + static_cast<size_t>(info.prop_count) * 16 +
+        static_cast<size_t>(info.point_light_count + info.spot_light_count) * 256;
+}
+
+static size_t sector_cost(const SectorInfo& info) {
+    return static_cast<size_t>(info.file_size) + sector_arena_size(info);
+}
+
+struct StreamedSector {
+    SectorInfo info;
+    u32 state;             // Changed under the state mutex only
+    f32 distance;
+    bool wanted;
+    MemoryArena arena;
+    Scene scene;
+    SceneBinary binary;
+};
+
+struct SectorStreamerState {
+    std::string manifest_path;
+    std::vector<StreamedSector> sectors;
+    std::vector<u32> queue;         // Sectors to load, nearest at the back
+    std::vector<u32> order;         // Scratch for update
+    std::vector<u32> uploads, unloads;
+    std::vector<Scene*> resident;
+    std::vector<AABB> boxes;
+    std::thread loader;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    u32 in_flight;
+    bool quit;
+};
+
+static bool load_sector(SectorStreamerState* state, StreamedSector* sector, u32 index) {
+    char path[1024];
+    sector_file_path(state->manifest_path.c_str(), index, path, sizeof(path));
+    if (!arena_init(&sector->arena, sector_arena_size(sector->info))) return false;
+    sector->scene = {};
+    if (scene_create(&sector->scene, &sector->arena) &&
+        scene_load_binary(&sector->scene, nullptr, path, &sector->arena, &sector->binary)) {
+        return true;
+    }
+    arena_shutdown(&sector->arena);
+    return false;
+}
+
+static void loader_main(SectorStreamerState* state) {
+    for (;;) {
+        u32 index;
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->wake.wait(lock, [&] { return state->quit || !state->queue.empty(); });
+            if (state->quit) return;
+            index = state->queue.back();
+            state->queue.pop_back();
+            state->sectors[index].state = SECTOR_LOADING;
+            state->in_flight++;
+        }
+        bool ok = load_sector(state, &state->sectors[index], index);
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->sectors[index].state = ok ? SECTOR_READY : SECTOR_FAILED;
+            state->in_flight--;
+        }
+        state->idle.notify_all();
+    }
+}
+
+SectorStreamConfig sector_stream_config_default() {
+    SectorStreamConfig c;
+    c.load_radius = 64.0f;
+    c.unload_radius = 80.0f;
+    c.memory_budget = 0;
+    c.upload_meshes = true;
+    return c;
+}
+
+bool sector_streamer_open(SectorStreamer* st, const char* manifest_path, const SectorStreamConfig& config,
+    MemoryArena* arena) {
+    *st = {};
+    FileMapping m;
+    if (!manifest_path || !file_map_read(manifest_path, &m)) {
+        LOG_ERROR("Sector manifest not found: %s", manifest_path ? manifest_path : "(null)");
+        return false;
+    }
+    const BSectorsHeader* h = reinterpret_cast<const BSectorsHeader*>(m.data);
+    const char* error = nullptr;
+    if (m.size < sizeof(BSectorsHeader)) error = "file too small";
+    else if (h->magic != BSECTORS_MAGIC) error = "not a sector manifest";
+    else if (h->version != BSECTORS_VERSION) error = "version mismatch";
+    else if (h->header_size != sizeof(BSectorsHeader) || h->info_size != sizeof(SectorInfo)) error = "struct layout mismatch";
+    else if (m.size != sizeof(BSectorsHeader) + static_cast<size_t>(h->sector_count) * sizeof(SectorInfo)) error = "truncated file";
+    if (!error && !light_environment_init(&st->lights, arena)) error = "out of memory for lights";
+    if (error) {
+        LOG_ERROR("Sector manifest %s rejected: %s", manifest_path, error);
+        file_unmap(&m);
+        return false;
+    }
+
+    SectorStreamerState* state = new SectorStreamerState();
+    state->manifest_path = manifest_path;
+    state->sectors.resize(h->sector_count);
+    const SectorInfo* infos = reinterpret_cast<const SectorInfo*>(m.data + sizeof(BSectorsHeader));
+    for (u32 i = 0; i < h->sector_count; i++) {
+        state->sectors[i] = {};
+        state->sectors[i].info = infos[i];
+    }
+    state->in_flight = 0;
+    state->quit = false;
+
+    st->config = config;
+    st->spawn = h->spawn;
+    st->lights.ambient_color = h->ambient_color;
+    st->lights.ambient_intensity = h->ambient_intensity;
+    st->stats.sector_count = h->sector_count;
+    st->state = state;
+    file_unmap(&m);
+
+    state->loader = std::thread(loader_main, state);
+    LOG_INFO("Sector streaming: %s (%u sectors)", manifest_path, st->stats.sector_count);
+    return true;
+}
+
+static void unload_sector(StreamedSector* sector) {
+    scene_destroy(&sector->scene);
+    scene_binary_close(&sector->binary);
+    arena_shutdown(&sector->arena);
+    sector->scene = {};
+}
+
+void sector_streamer_close(SectorStreamer* st) {
+    SectorStreamerState* state = st->state;
+    if (!state) return;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->quit = true;
+    }
+    state->wake.notify_all();
+    state->loader.join();
+    for (StreamedSector& sector : state->sectors) {
+        if (sector.state == SECTOR_READY || sector.state == SECTOR_RESIDENT) unload_sector(&sector);
+    }
+    delete state;
+    *st = {};
+}
+
+static f32 distance_to_bounds(const AABB& b, const Vec3& p) {
+    f32 dx = std::max(std::max(b.min.x - p.x, p.x - b.max.x), 0.0f);
+    f32 dy = std::max(std::max(b.min.y - p.y, p.y - b.max.y), 0.0f);
+    f32 dz = std::max(std::max(b.min.z - p.z, p.z - b.max.z), 0.0f);
+    return sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+// Gathers collision boxes and lights of the resident sectors.
+static void rebuild_combined(SectorStreamer* st) {
+    SectorStreamerState* state = st->state;
+    state->resident.clear();
+    state->boxes.clear();
+    light_environment_clear(&st->lights);
+    bool lights_ok = true;
+    for (StreamedSector& sector : state->sectors) {
+        if (sector.state != SECTOR_RESIDENT) continue;
+        Scene* s = &sector.scene;
+        state->resident.push_back(s);
+        state->boxes.insert(state->boxes.end(), s->collision.boxes, s->collision.boxes + s->collision.box_count);
+        for (u32 i = 0; lights_ok && i < s->lights.point_light_count; i++) {
+            const PointLight& l = s->lights.point_lights[i];
+            PointLight* dst = light_environment_add_point(&st->lights, l.position, l.color, l.radius, l.intensity);
+            if (dst) *dst = l;
+            lights_ok = dst != nullptr;
+        }
+        for (u32 i = 0; lights_ok && i < s->lights.spot_light_count; i++) {
+            const SpotLight& l = s->lights.spot_lights[i];
+            SpotLight* dst = light_environment_add_spot(&st->lights, l.position, l.direction, l.color, l.range,
+                l.inner_cos, l.outer_cos, l.intensity, l.falloff);
+            if (dst) *dst = l;
+            lights_ok = dst != nullptr;
+        }
+    }
+    if (!lights_ok) LOG_WARN("Sector streaming: out of memory for lights, some are missing");
+
+    CollisionWorld& c = st->collision;
+    u32 revision = c.revision + 1;
+    c = {};
+    c.boxes = state->boxes.data();
+    c.box_count = c.box_capacity = static_cast<u32>(state->boxes.size());
+    c.revision = revision;
+    st->resident = state->resident.data();
+    st->resident_count = static_cast<u32>(state->resident.size());
+}
+
+bool sector_streamer_update(SectorStreamer* st, const Vec3& viewer) {
+    SectorStreamerState* state = st->state;
+    if (!state) return false;
+    const SectorStreamConfig& cfg = st->config;
+    SectorStreamStats& stats = st->stats;
+    state->uploads.clear();
+    state->unloads.clear();
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+
+        // Candidates nearest first; held sectors get the larger unload radius
+        std::vector<StreamedSector>& sectors = state->sectors;
+        state->order.clear();
+        size_t used = 0;
+        for (u32 i = 0; i < sectors.size(); i++) {
+            StreamedSector& s = sectors[i];
+            s.distance = distance_to_bounds(s.info.bounds, viewer);
+            s.wanted = false;
+            if (s.state == SECTOR_FAILED) continue;
+            bool held = s.state != SECTOR_UNLOADED;
+            // A load in progress cannot be cancelled, so its memory is spent
+            if (s.state == SECTOR_LOADING) used += sector_cost(s.info);
+            if (s.distance <= cfg.load_radius || (held && s.distance <= cfg.unload_radius)) state->order.push_back(i);
+        }
+        std::sort(state->order.begin(), state->order.end(), [&](u32 a, u32 b) {
+            return sectors[a].distance < sectors[b].distance || (sectors[a].distance == sectors[b].distance && a < b);
+        });
+        stats.over_budget = 0;
+        for (u32 i : state->order) {
+            StreamedSector& s = sectors[i];
+            if (s.state != SECTOR_LOADING) {
+                size_t cost = sector_cost(s.info);
+                if (cfg.memory_budget && used + cost > cfg.memory_budget) {
+                    stats.over_budget++;
+                    continue;
+                }
+                used += cost;
+            }
+            s.wanted = true;
+        }
+
+        state->queue.clear();
+        for (auto it = state->order.rbegin(); it != state->order.rend(); ++it) {
+            StreamedSector& s = sectors[*it];
+            if (s.wanted && (s.state == SECTOR_UNLOADED || s.state == SECTOR_QUEUED)) {
+                s.state = SECTOR_QUEUED;
+                state->queue.push_back(*it);
+            }
+        }
+        stats.pending = state->in_flight + static_cast<u32>(state->queue.size());
+        for (u32 i = 0; i < sectors.size(); i++) {
+            StreamedSector& s = sectors[i];
+            if (!s.wanted && s.state == SECTOR_QUEUED) s.state = SECTOR_UNLOADED;
+            else if (s.state == SECTOR_READY) {
+                if (s.wanted) state->uploads.push_back(i);
+                else state->unloads.push_back(i);
+            } else if (s.state == SECTOR_RESIDENT && !s.wanted) {
+                state->unloads.push_back(i);
+            }
+        }
+        // The loader does not touch ready or resident sectors, so the GL
+        // work below can run unlocked once the states are claimed
+        for (u32 i : state->uploads) sectors[i].state = SECTOR_RESIDENT;
+    }
+    if (!state->queue.empty()) state->wake.notify_one();
+
+    bool changed = !state->uploads.empty();
+    for (u32 i : state->unloads) {
+        StreamedSector& s = state->sectors[i];
+        bool was_resident = s.state == SECTOR_RESIDENT;
+        unload_sector(&s);
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            s.state = SECTOR_UNLOADED;
+        }
+        if (was_resident) {
+            stats.unloads++;
+            changed = true;
+        }
+    }
+    for (u32 i : state->uploads) {
+        StreamedSector& s = state->sectors[i];
+        if (cfg.upload_meshes) scene_binary_upload(&s.scene, &s.binary);
+        stats.loads++;
+    }
+
+    if (changed) rebuild_combined(st);
+
+    stats.resident = st->resident_count;
+    stats.resident_bytes = 0;
+    for (const StreamedSector& s : state->sectors) {
+        if (s.state == SECTOR_RESIDENT) stats.resident_bytes += sector_cost(s.info);
+    }
+    return changed;
+}
+
+bool sector_streamer_flush(SectorStreamer* st, const Vec3& viewer) {
+    SectorStreamerState* state = st->state;
+    if (!state) return false;
+    bool changed = sector_streamer_update(st, viewer);
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->idle.wait(lock, [&] { return state->queue.empty() && state->in_flight == 0; });
+    }
+    return sector_streamer_update(st, viewer) || changed;
+}
+
+}
@@ -0,0 +1,405 @@
+#include "brutal/world/snapshot.h"
+#include "brutal/core/file.h"
+#include "brutal/core/logging.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace brutal {
+
+// =============================================================================
+// Layout
+// =============================================================================
+// [SnapshotHeader][brushes][brush handles][5 prop columns][prop handles]
+// [point lights][point handles][spot lights][spot handles][boxes]
+// [source ids][source boxes][Player], each section 16-byte aligned. A handle
+// table is slot_dense and slot_generation per slot, then dense_slot per item.
+constexpr u32 SNAPSHOT_MERGE_COLLISION = 1u << 0;
+constexpr u32 SNAPSHOT_CULL_HIDDEN_FACES = 1u << 1;
+
+struct SnapshotTable {
+    u32 slot_count;
+    u32 free_head;
+};
+
+struct SnapshotHeader {
+    u32 magic;
+    u32 version;
+    u32 header_size;
+    u32 flags;
+    u64 size;
+    // Layout check
+    u32 brush_size, point_light_size, spot_light_size, player_size;
+    u32 brush_count;
+    u32 prop_count, prop_active_count;
+    u32 point_light_count, spot_light_count;
+    u32 box_count, source_count;
+    u32 collision_revision;
+    SnapshotTable brush_handles, prop_handles, point_handles, spot_handles;
+    Vec3 ambient_color;
+    f32 ambient_intensity;
+};
+
+static size_t align16(size_t n) { return (n + 15) & ~static_cast<size_t>(15); }
+
+static size_t table_bytes(u32 slot_count, u32 count) {
+    return align16(sizeof(u32) * slot_count) * 2 + align16(sizeof(u32) * count);
+}
+
+static size_t layout_size(const SnapshotHeader& h) {
+    size_t size = align16(sizeof(SnapshotHeader));
+    size += align16(sizeof(Brush) * h.brush_count) + table_bytes(h.brush_handles.slot_count, h.brush_count);
+    size += (align16(sizeof(Vec3) * h.prop_count) * 3 + align16(sizeof(Quat) * h.prop_count) +
+        align16(sizeof(u32) * h.prop_count)) + table_bytes(h.prop_handles.slot_count, h.prop_count);
+    size += align16(sizeof(PointLight) * h.point_light_count) +
+        table_bytes(h.point_handles.slot_count, h.point_light_count);
+    size += align16(sizeof(SpotLight) * h.spot_light_count) +
+        table_bytes(h.spot_handles.slot_count, h.spot_light_count);
+    size += align16(sizeof(AABB) * h.box_count) + align16(sizeof(u32) * h.source_count) * 2;
+    size += align16(sizeof(Player));
+    return size;
+}
+
+static SnapshotHeader make_header(const Scene* scene) {
+    SnapshotHeader h{};
+    h.magic = SNAPSHOT_MAGIC;
+    h.version = SNAPSHOT_VERSION;
+    h.header_size = sizeof(SnapshotHeader);
+    h.flags = (scene->merge_collision ? SNAPSHOT_MERGE_COLLISION : 0) |
+              (scene->cull_hidden_faces ? SNAPSHOT_CULL_HIDDEN_FACES : 0);
+    h.brush_size = sizeof(Brush);
+    h.point_light_size = sizeof(PointLight);
+    h.spot_light_size = sizeof(SpotLight);
+    h.player_size = sizeof(Player);
+    h.brush_count = scene->brush_count;
+    h.prop_count = scene->props.count;
+    h.prop_active_count = scene->props.active_count;
+    h.point_light_count = scene->lights.point_light_count;
+    h.spot_light_count = scene->lights.spot_light_count;
+    h.box_count = scene->collision.box_count;
+    h.source_count = scene->collision.source_count;
+    h.collision_revision = scene->collision.revision;
+    h.brush_handles = { scene->brush_handles.slot_count, scene->brush_handles.free_head };
+    h.prop_handles = { scene->props.handles.slot_count, scene->props.handles.free_head };
+    h.point_handles = { scene->lights.point_handles.slot_count, scene->lights.point_handles.free_head };
+    h.spot_handles = { scene->lights.spot_handles.slot_count, scene->lights.spot_handles.free_head };
+    h.ambient_color = scene->lights.ambient_color;
+    h.ambient_intensity = scene->lights.ambient_intensity;
+    h.size = layout_size(h);
+    return h;
+}
+
+static u8* put(u8* at, const void* src, size_t bytes) {
+    if (bytes) memcpy(at, src, bytes);
+    size_t padded = align16(bytes);
+    if (padded > bytes) memset(at + bytes, 0, padded - bytes);
+    return at + padded;
+}
+
+static const u8* get(const u8* at, void* dst, size_t bytes) {
+    if (bytes) memcpy(dst, at, bytes);
+    return at + align16(bytes);
+}
+
+static u8* put_table(u8* at, const HandleTable* t, u32 count) {
+    at = put(at, t->slot_dense, sizeof(u32) * t->slot_count);
+    at = put(at, t->slot_generation, sizeof(u32) * t->slot_count);
+    return put(at, t->dense_slot, sizeof(u32) * count);
+}
+
+static const u8* get_table(const u8* at, HandleTable* t, const SnapshotTable& st, u32 count) {
+    at = get(at, t->slot_dense, sizeof(u32) * st.slot_count);
+    at = get(at, t->slot_generation, sizeof(u32) * st.slot_count);
+    at = get(at, t->dense_slot, sizeof(u32) * count);
+    t->slot_count = st.slot_count;
+    t->free_head = st.free_head;
+    return at;
+}
+
+// =============================================================================
+// Capture / restore
+// =============================================================================
+size_t snapshot_size(const Scene* scene, const Player*) {
+    return static_cast<size_t>(make_header(scene).size);
+}
+
+bool snapshot_capture(Snapshot* snap, const Scene* scene, const Player* player) {
+    SnapshotHeader h = make_header(scene);
+    if (h.size > snap->capacity) {
+        u8* data = static_cast<u8*>(realloc(snap->data, h.size));
+        if (!data) {
+            LOG_ERROR("Snapshot capture failed: out of memory for %llu bytes", static_cast<unsigned long long>(h.size));
+            return false;
+        }
+        snap->data = data;
+        snap->capacity = h.size;
+    }
+
+    const PropStorage* p = &scene->props;
+    const LightEnvironment* env = &scene->lights;
+    const CollisionWorld* c = &scene->collision;
+    u8* at = put(snap->data, &h, sizeof(h));
+    at = put(at, scene->brushes, sizeof(Brush) * h.brush_count);
+    at = put_table(at, &scene->brush_handles, h.brush_count);
+    at = put(at, p->positions, sizeof(Vec3) * h.prop_count);
+    at = put(at, p->rotations, sizeof(Quat) * h.prop_count);
+    at = put(at, p->scales, sizeof(Vec3) * h.prop_count);
+    at = put(at, p->colors, sizeof(Vec3) * h.prop_count);
+    at = put(at, p->mesh_ids, sizeof(u32) * h.prop_count);
+    at = put_table(at, &p->handles, h.prop_count);
+    at = put(at, env->point_lights, sizeof(PointLight) * h.point_light_count);
+    at = put_table(at, &env->point_handles, h.point_light_count);
+    at = put(at, env->spot_lights, sizeof(SpotLight) * h.spot_light_count);
+    at = put_table(at, &env->spot_handles, h.spot_light_count);
+    at = put(at, c->boxes, sizeof(AABB) * h.box_count);
+    at = put(at, c->source_id, sizeof(u32) * h.source_count);
+    at = put(at, c->source_box, sizeof(u32) * h.source_count);
+    at = put(at, player, sizeof(Player));
+    snap->size = static_cast<size_t>(at - snap->data);
+    return true;
+}
+
+static bool validate(const Snapshot* snap, SnapshotHeader* h) {
+    const char* error = nullptr;
+    if (!snap->data || snap->size < sizeof(SnapshotHeader)) error = "too small";
+    else {
+        memcpy(h, snap->data, sizeof(SnapshotHeader));
+        if (h->magic != SNAPSHOT_MAGIC) error = "not a snapshot";
+        else if (h->version != SNAPSHOT_VERSION) error = "version mismatch";
+        else if (h->header_size != sizeof(SnapshotHeader) || h->brush_size != sizeof(Brush) ||
+            h->point_light_size != sizeof(PointLight) || h->spot_light_size != sizeof(SpotLight) ||
+            h->player_size != sizeof(Player)) error = "struct layout mismatch";
+        else if (h->size != snap->size || layout_size(*h) != snap->size) error = "size mismatch";
+        else if (h->prop_active_count > h->prop_count) error = "bad prop split";
+    }
+    if (error) LOG_ERROR("Snapshot restore rejected: %s", error);
+    return !error;
+}
+
+static u32 max_u32(u32 a, u32 b) { return a > b ? a : b; }
+
+bool snapshot_restore(const Snapshot* snap, Scene* scene, Player* player) {
+    SnapshotHeader h;
+    if (!validate(snap, &h)) return false;
+
+    // Grow everything first so a failure leaves the state as it was
+    MemoryArena* arena = scene->arena;
+    LightEnvironment* env = &scene->lights;
+    CollisionWorld* c = &scene->collision;
+    u32 collision_capacity = max_u32(h.box_count, h.source_count);
+    CollisionWorld grown = {};
+    if (!scene_reserve(scene, arena, h.brush_count, h.prop_count) ||
+        !handle_table_reserve(&scene->brush_handles, arena, h.brush_handles.slot_count) ||
+        !handle_table_reserve(&scene->props.handles, arena, h.prop_handles.slot_count) ||
+        !light_environment_reserve(env, h.point_light_count, h.spot_light_count) ||
+        !handle_table_reserve(&env->point_handles, arena, h.point_handles.slot_count) ||
+        !handle_table_reserve(&env->spot_handles, arena, h.spot_handles.slot_count) ||
+        (c->box_capacity < collision_capacity && !collision_world_create(&grown, arena, collision_capacity))) {
+        LOG_ERROR("Snapshot restore failed: out of memory");
+        return false;
+    }
+    // The boxes are replaced below, only the revision carries over
+    if (grown.boxes) {
+        grown.revision = c->revision;
+        *c = grown;
+    }
+
+    const u8* at = snap->data + align16(sizeof(SnapshotHeader));
+    const Brush* brushes = reinterpret_cast<const Brush*>(at);
+    WorldMeshSlots* ws = &scene->world_slots;
+    if (scene->brush_count == h.brush_count && !scene->world_mesh_dirty &&
+        !(h.flags & SNAPSHOT_CULL_HIDDEN_FACES) == !scene->cull_hidden_faces) {
+        // Same brush set: only brushes that moved since the capture get re-emitted
+        if (memcmp(scene->brushes, brushes, sizeof(Brush) * h.brush_count)) {
+            for (u32 i = 0; i < h.brush_count; i++) {
+                if (!memcmp(&scene->brushes[i], &brushes[i], sizeof(Brush))) continue;
+                scene->brushes[i] = brushes[i];
+                scene_mark_brush_dirty(scene, i);
+            }
+        }
+    } else {
+        memcpy(scene->brushes, brushes, sizeof(Brush) * h.brush_count);
+        scene->world_mesh_dirty = true;
+        ws->dirty_count = 0;
+        ws->retired_count = 0;
+    }
+    scene->brush_count = h.brush_count;
+    at += align16(sizeof(Brush) * h.brush_count);
+    at = get_table(at, &scene->brush_handles, h.brush_handles, h.brush_count);
+
+    PropStorage* p = &scene->props;
+    at = get(at, p->positions, sizeof(Vec3) * h.prop_count);
+    at = get(at, p->rotations, sizeof(Quat) * h.prop_count);
+    at = get(at, p->scales, sizeof(Vec3) * h.prop_count);
+    at = get(at, p->colors, sizeof(Vec3) * h.prop_count);
+    at = get(at, p->mesh_ids, sizeof(u32) * h.prop_count);
+    at = get_table(at, &p->handles, h.prop_handles, h.prop_count);
+    p->count = h.prop_count;
+    p->active_count = h.prop_active_count;
+
+    at = get(at, env->point_lights, sizeof(PointLight) * h.point_light_count);
+    at = get_table(at, &env->point_handles, h.point_handles, h.point_light_count);
+    at = get(at, env->spot_lights, sizeof(SpotLight) * h.spot_light_count);
+    at = get_table(at, &env->spot_handles, h.spot_handles, h.spot_light_count);
+    env->point_light_count = h.point_light_count;
+    env->spot_light_count = h.spot_light_count;
+    env->ambient_color = h.ambient_color;
+    env->ambient_intensity = h.ambient_intensity;
+
+    at = get(at, c->boxes, sizeof(AABB) * h.box_count);
+    at = get(at, c->source_id, sizeof(u32) * h.source_count);
+    at = get(at, c->source_box, sizeof(u32) * h.source_count);
+    c->box_count = h.box_count;
+    c->source_count = h.source_count;
+    // Caches keyed on the old revision must not match the restored boxes
+    c->revision = max_u32(c->revision, h.collision_revision) + 1;
+
+    scene->merge_collision = (h.flags & SNAPSHOT_MERGE_COLLISION) != 0;
+    scene->cull_hidden_faces = (h.flags & SNAPSHOT_CULL_HIDDEN_FACES) != 0;
+
+    if (player) {
+        get(at, player, sizeof(Player));
+        // Debug strings point into the capturing process
+        player->grounded_reason = "snapshot";
+        for (u32 i = 0; i < Player::kJumpDebugRingSize; i++) player->jump_debug_ring[i].grounded_reason = nullptr;
+        player->collision_cache.world = nullptr;
+        collision_cache_invalidate(&player->collision_cache);
+    }
+    return true;
+}
+
+void snapshot_free(Snapshot* snap) {
+    free(snap->data);
+    *snap = {};
+}
+
+// =============================================================================
+// Compression
+// =============================================================================
+// Tokens of [zero words][literal words][literals...]. A literal run only
+// ends at two zero words in a row, so tokens never cost more than they save
+// and the output is at most one token header larger than the input.
+size_t snapshot_compress_bound(size_t size) {
+    return size + 2 * sizeof(u32);
+}
+
+size_t snapshot_compress(const u8* data, size_t size, const u8* base, u8* out) {
+    const u32* src = reinterpret_cast<const u32*>(data);
+    const u32* ref = reinterpret_cast<const u32*>(base);
+    u32* o = reinterpret_cast<u32*>(out);
+    size_t words = size / sizeof(u32);
+    auto word = [&](size_t i) { return ref ? src[i] ^ ref[i] : src[i]; };
+
+    size_t n = 0, i = 0;
+    while (i < words) {
+        size_t zeros_start = i;
+        while (i < words && word(i) == 0) i++;
+        size_t zeros = i - zeros_start;
+        size_t literal_start = i;
+        while (i < words && !(word(i) == 0 && i + 1 < words && word(i + 1) == 0)) i++;
+        o[n++] = static_cast<u32>(zeros);
+        o[n++] = static_cast<u32>(i - literal_start);
+        for (size_t k = literal_start; k < i; k++) o[n++] = word(k);
+    }
+    return n * sizeof(u32);
+}
+
+bool snapshot_decompress(const u8* in, size_t in_size, const u8* base, u8* out, size_t size) {
+    const u32* src = reinterpret_cast<const u32*>(in);
+    const u32* ref = reinterpret_cast<const u32*>(base);
+    u32* o = reinterpret_cast<u32*>(out);
+    size_t in_words = in_size / sizeof(u32), words = size / sizeof(u32);
+    size_t at = 0, w = 0;
+    while (at < in_words) {
+        if (at + 2 > in_words) return false;
+        size_t zeros = src[at], literals = src[at + 1];
+        at += 2;
+        if (zeros > words - w || literals > words - w - zeros || literals > in_words - at) return false;
+        for (size_t k = 0; k < zeros; k++, w++) o[w] = ref ? ref[w] : 0;
+        for (size_t k = 0; k < literals; k++, w++) o[w] = ref ? src[at + k] ^ ref[w] : src[at + k];
+        at += literals;
+    }
+    return w == words;
+}
+
+// =============================================================================
+// Files
+// =============================================================================
+constexpr u32 SNAPSHOT_FILE_COMPRESSED = 1u << 0;
+
+struct SnapshotFileHeader {
+    u32 magic;
+    u32 flags;
+    u64 size;              // Snapshot bytes
+    u64 stored_size;       // Bytes that follow
+};
+
+bool snapshot_save(const Snapshot* snap, const char* path, bool compress) {
+    SnapshotFileHeader fh = { SNAPSHOT_MAGIC, compress ? SNAPSHOT_FILE_COMPRESSED : 0, snap->size, snap->size };
+    u8* packed = nullptr;
+    const u8* payload = snap->data;
+    if (compress) {
+        packed = static_cast<u8*>(malloc(snapshot_compress_bound(snap->size)));
+        if (!packed) {
+            LOG_ERROR("Snapshot save failed: out of memory");
+            return false;
+        }
+        fh.stored_size = snapshot_compress(snap->data, snap->size, nullptr, packed);
+        payload = packed;
+    }
+
+    FILE* f = fopen(path, "wb");
+    bool ok = f && fwrite(&fh, sizeof(fh), 1, f) == 1 &&
+        (!fh.stored_size || fwrite(payload, static_cast<size_t>(fh.stored_size), 1, f) == 1);
+    if (f) ok = (fclose(f) == 0) && ok;
+    free(packed);
+    if (!ok) {
+        LOG_ERROR("Snapshot save failed: cannot write %s", path);
+        return false;
+    }
+    LOG_INFO("Snapshot saved: %s (%.1f KB, %.1f KB stored)", path, snap->size / 1024.0, fh.stored_size / 1024.0);
+    return true;
+}
+
+bool snapshot_load(Snapshot* snap, const char* path) {
+    FileMapping m;
+    if (!file_map_read(path, &m)) {
+        LOG_WARN("Snapshot not found: %s", path);
+        return false;
+    }
+    SnapshotFileHeader fh;
+    bool ok = m.size >= sizeof(fh);
+    if (ok) {
+        memcpy(&fh, m.data, sizeof(fh));
+        ok = fh.magic == SNAPSHOT_MAGIC && fh.size % sizeof(u32) == 0 &&
+            fh.stored_size == m.size - sizeof(fh) &&
+            ((fh.flags & SNAPSHOT_FILE_COMPRESSED) || fh.stored_size == fh.size);
+    }
+    if (ok && fh.size > snap->capacity) {
+        u8* data = static_cast<u8*>(realloc(snap->data, static_cast<size_t>(fh.size)));
+        ok = data != nullptr;
+        if (data) {
+            snap->data = data;
+            snap->capacity = static_cast<size_t>(fh.size);
+        }
+    }
+    if (ok) {
+        const u8* payload = m.data + sizeof(fh);
+        if (fh.flags & SNAPSHOT_FILE_COMPRESSED) {
+            ok = snapshot_decompress(payload, static_cast<size_t>(fh.stored_size), nullptr, snap->data,
+                static_cast<size_t>(fh.size));
+        } else if (fh.size) {
+            memcpy(snap->data, payload, static_cast<size_t>(fh.size));
+        }
+    }
+    file_unmap(&m);
+    if (!ok) {
+        LOG_ERROR("Snapshot load failed: %s is not a valid snapshot file", path);
+        snap->size = 0;
+        return false;
+    }
+    snap->size = static_cast<size_t>(fh.size);
+    return true;
+}
+
+}
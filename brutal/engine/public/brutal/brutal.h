@@ -6,6 +6,10 @@
 #include "brutal/core/memory.h"
 #include "brutal/core/time.h"
 #include "brutal/core/profiler.h"
+#include "brutal/core/jobs.h"
+#include "brutal/core/file.h"
+#include "brutal/core/json.h"
+#include "brutal/core/handle.h"
 #include "brutal/core/platform.h"
 #include "brutal/math/vec.h"
 #include "brutal/math/mat.h"
@@ -15,12 +19,25 @@
 #include "brutal/renderer/mesh.h"
 #include "brutal/renderer/camera.h"
 #include "brutal/renderer/light.h"
+#include "brutal/renderer/light_clusters.h"
+#include "brutal/renderer/object_lights.h"
+#include "brutal/renderer/render_queue.h"
 #include "brutal/renderer/renderer.h"
 #include "brutal/renderer/debug_draw.h"
+#include "brutal/renderer/stream_buffer.h"
+#include "brutal/renderer/occlusion.h"
+#include "brutal/renderer/render_backend.h"
+#include "brutal/renderer/software_raster.h"
 #include "brutal/world/brush.h"
 #include "brutal/world/entity.h"
 #include "brutal/world/collision.h"
+#include "brutal/world/character.h"
 #include "brutal/world/scene.h"
+#include "brutal/world/scene_io.h"
+#include "brutal/world/scene_binary.h"
+#include "brutal/world/sector.h"
+#include "brutal/world/scene_reload.h"
+#include "brutal/world/snapshot.h"
 #include "brutal/world/player.h"
 
 namespace brutal {
@@ -0,0 +1,43 @@
+#ifndef BRUTAL_CORE_FILE_H
+#define BRUTAL_CORE_FILE_H
+
+#include "brutal/core/types.h"
+#include <cstddef>
+
+namespace brutal {
+
+// Read-only view of a whole file mapped into memory. data is null for an
+// empty file. The view stays valid until file_unmap.
+struct FileMapping {
+    const u8* data;
+    size_t size;
+    void* handle;          // Platform mapping handle (Win32 only)
+};
+
+bool file_map_read(const char* path, FileMapping* out);
+// Copy-on-write view: pages may be written through a const_cast, changes stay
+// private to the process and never reach the file.
+bool file_map_private(const char* path, FileMapping* out);
+void file_unmap(FileMapping* m);
+
+// Last write time in platform ticks, only meaningful for comparing files.
+bool file_modified_time(const char* path, u64* out);
+
+// Change notifications for one file. On Linux inotify watches the parent
+// directory, which also catches editors that save by renaming a new file
+// over the old one; elsewhere the modified time is polled.
+struct FileWatch {
+    char path[512];
+    u32 name_offset;       // Start of the file name in path
+    u64 modified;
+    i32 fd, wd;            // inotify descriptors, -1 when polling
+};
+
+bool file_watch_open(FileWatch* w, const char* path);
+void file_watch_close(FileWatch* w);
+// Non-blocking. True once for any number of writes since the last poll.
+bool file_watch_poll(FileWatch* w);
+
+}
+
+#endif
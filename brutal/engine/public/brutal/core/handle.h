@@ -0,0 +1,86 @@
+#ifndef BRUTAL_CORE_HANDLE_H
+#define BRUTAL_CORE_HANDLE_H
+
+#include "brutal/core/types.h"
+
+namespace brutal {
+
+struct MemoryArena;
+
+// =============================================================================
+// Generational handles
+// =============================================================================
+// Objects live in dense arrays that stay contiguous by swap-removing: the last
+// element moves into the hole. A handle names a slot in a HandleTable instead,
+// and the slot maps to the object's current dense index. Every removal bumps
+// the slot's generation, so a handle to a removed object fails its lookup
+// rather than aliasing whatever reuses the slot. Generation 0 is never issued;
+// a zeroed handle is always invalid.
+constexpr u32 HANDLE_NONE = 0xFFFFFFFFu;
+
+template<typename Tag>
+struct Handle {
+    u32 slot;
+    u32 generation;
+};
+
+template<typename Tag>
+inline bool operator==(Handle<Tag> a, Handle<Tag> b) { return a.slot == b.slot && a.generation == b.generation; }
+template<typename Tag>
+inline bool operator!=(Handle<Tag> a, Handle<Tag> b) { return !(a == b); }
+
+// Handles are typed per storage; casts are for code that stores several kinds
+// side by side, like an editor selection tagged with its type.
+template<typename To, typename From>
+inline Handle<To> handle_cast(Handle<From> h) { return Handle<To>{ h.slot, h.generation }; }
+
+struct HandleTable {
+    u32* slot_dense;       // Per slot: dense index, or the next free slot while free
+    u32* slot_generation;  // Per slot: generation of the live or last issued handle
+    u32* dense_slot;       // Per dense index: owning slot
+    u32 slot_count;        // Slots handed out so far, free ones included
+    u32 capacity;
+    u32 free_head;         // HANDLE_NONE when no slot is free
+};
+
+// Grows the table to at least capacity entries, keeping contents. Outgrown
+// arrays stay in the arena. Tables track dense storage one to one, so grow
+// both together.
+bool handle_table_reserve(HandleTable* t, MemoryArena* arena, u32 capacity);
+// Invalidates every handle and frees all slots. Slots come back in order, so
+// refilling after a clear hands out slot i to dense index i.
+void handle_table_clear(HandleTable* t);
+// Issues a slot for the object just appended at dense index dense. Returns
+// the slot and writes its generation; HANDLE_NONE when the table is full.
+u32 handle_table_insert(HandleTable* t, u32 dense, u32* generation);
+// Dense index of a live handle, HANDLE_NONE when stale or out of range.
+u32 handle_table_lookup(const HandleTable* t, u32 slot, u32 generation);
+// Frees the slot of dense index dense and moves the entry of the last element
+// (count - 1) into its place, mirroring a swap-remove of the dense array.
+void handle_table_remove(HandleTable* t, u32 dense, u32 count);
+// Mirrors swapping two dense elements; their handles follow them.
+void handle_table_swap(HandleTable* t, u32 a, u32 b);
+
+template<typename Tag>
+inline Handle<Tag> handle_table_add(HandleTable* t, u32 dense) {
+    Handle<Tag> h;
+    h.slot = handle_table_insert(t, dense, &h.generation);
+    if (h.slot == HANDLE_NONE) h.generation = 0;
+    return h;
+}
+
+template<typename Tag>
+inline u32 handle_table_find(const HandleTable* t, Handle<Tag> h) {
+    return handle_table_lookup(t, h.slot, h.generation);
+}
+
+// Current handle of the object at dense index dense; the caller checks range.
+template<typename Tag>
+inline Handle<Tag> handle_table_handle(const HandleTable* t, u32 dense) {
+    u32 slot = t->dense_slot[dense];
+    return Handle<Tag>{ slot, t->slot_generation[slot] };
+}
+
+}
+
+#endif
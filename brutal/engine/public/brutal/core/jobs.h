@@ -0,0 +1,23 @@
+#ifndef BRUTAL_CORE_JOBS_H
+#define BRUTAL_CORE_JOBS_H
+
+#include "brutal/core/types.h"
+
+namespace brutal {
+
+// Processes items [begin, end) of a parallel_for range.
+using ParallelForFn = void (*)(void* user, u32 begin, u32 end);
+
+// worker_count = 0 picks hardware threads - 1. The calling thread always
+// participates, so a pool of N workers runs N + 1 ranges at once.
+bool jobs_init(u32 worker_count = 0);
+void jobs_shutdown();
+u32 jobs_worker_count();
+
+// Splits [0, count) into batches of batch_size and blocks until all are done.
+// Runs inline when the pool is not initialized or the range fits one batch.
+void parallel_for(u32 count, u32 batch_size, ParallelForFn fn, void* user);
+
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef BRUTAL_CORE_JSON_H
+#define BRUTAL_CORE_JSON_H
+
+#include "brutal/core/types.h"
+#include <cstddef>
+#include <cstdio>
+
+namespace brutal {
+
+constexpr u32 JSON_MAX_DEPTH = 32;
+
+// =============================================================================
+// Reader
+// =============================================================================
+// Pull-style tokenizer over a buffer that is already in memory (typically a
+// mapped file). Strings are returned as views into the buffer with escapes
+// left in place, so reading never allocates.
+enum class JsonToken : u8 {
+    END,
+    ERROR,
+    OBJECT_BEGIN,
+    OBJECT_END,
+    ARRAY_BEGIN,
+    ARRAY_END,
+    KEY,
+    STRING,
+    NUMBER,
+    TRUE_VALUE,
+    FALSE_VALUE,
+    NULL_VALUE
+};
+
+struct JsonReader {
+    const char* begin;
+    const char* cur;
+    const char* end;
+
+    // Payload of the last KEY/STRING or NUMBER token
+    const char* text;
+    u32 text_length;
+    f64 number;
+
+    u32 depth;
+    bool in_object[JSON_MAX_DEPTH];
+    bool need_comma;
+    bool after_key;
+    bool root_done;
+    const char* error;
+};
+
+void json_reader_init(JsonReader* r, const char* data, size_t size);
+JsonToken json_next(JsonReader* r);
+
+// Skips the rest of a value whose first token was just read.
+bool json_skip_value(JsonReader* r, JsonToken first);
+
+bool json_text_equals(const JsonReader* r, const char* s);
+void json_error_location(const JsonReader* r, u32* line, u32* column);
+
+// =============================================================================
+// Writer
+// =============================================================================
+// Streams pretty-printed JSON to a FILE. Containers opened as single_line
+// keep themselves and their children on one line.
+struct JsonWriter {
+    FILE* file;
+    u32 depth;
+    u32 single_line_depth;  // Depth at which single-line mode began, 0 = off
+    bool need_comma;
+    bool after_key;
+};
+
+void json_writer_init(JsonWriter* w, FILE* file);
+void json_begin_object(JsonWriter* w, bool single_line = false);
+void json_end_object(JsonWriter* w);
+void json_begin_array(JsonWriter* w, bool single_line = false);
+void json_end_array(JsonWriter* w);
+void json_key(JsonWriter* w, const char* key);
+void json_write_number(JsonWriter* w, f64 value);
+void json_write_float(JsonWriter* w, f32 value);
+void json_write_uint(JsonWriter* w, u64 value);
+void json_write_bool(JsonWriter* w, bool value);
+void json_write_string(JsonWriter* w, const char* value);
+
+}
+
+#endif
@@ -28,6 +28,22 @@ inline bool aabb_intersects(const AABB& a, const AABB& b) {
            (a.min.z <= b.max.z && a.max.z >= b.min.z);
 }
 
+inline bool aabb_contains(const AABB& outer, const AABB& inner) {
+    return (outer.min.x <= inner.min.x && outer.max.x >= inner.max.x) &&
+           (outer.min.y <= inner.min.y && outer.max.y >= inner.max.y) &&
+           (outer.min.z <= inner.min.z && outer.max.z >= inner.max.z);
+}
+
+inline AABB aabb_merge(const AABB& a, const AABB& b) {
+    return {Vec3(fminf(a.min.x, b.min.x), fminf(a.min.y, b.min.y), fminf(a.min.z, b.min.z)),
+            Vec3(fmaxf(a.max.x, b.max.x), fmaxf(a.max.y, b.max.y), fmaxf(a.max.z, b.max.z))};
+}
+
+inline AABB aabb_expand(const AABB& b, f32 amount) {
+    Vec3 e(amount, amount, amount);
+    return {b.min - e, b.max + e};
+}
+
 f32 aabb_sweep(const AABB& moving, const Vec3& vel, const AABB& stationary, Vec3* normal);
 
 }
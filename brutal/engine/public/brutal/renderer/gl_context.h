@@ -3,6 +3,8 @@
 
 namespace brutal {
     bool gl_init();
+    // GL 4.4 or ARB_buffer_storage: buffers can stay mapped while drawn from
+    bool gl_has_buffer_storage();
 }
 
 #endif
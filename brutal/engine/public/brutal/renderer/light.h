@@ -3,11 +3,11 @@
 
 #include "brutal/math/vec.h"
 #include "brutal/core/types.h"
+#include "brutal/core/handle.h"
 
 namespace brutal {
 
-constexpr u32 MAX_POINT_LIGHTS = 16;
-constexpr u32 MAX_SPOT_LIGHTS = 8;
+struct MemoryArena;
 
 struct PointLight {
     Vec3 position;
@@ -31,17 +31,30 @@ struct SpotLight {
     bool active;
 };
 
+using PointLightHandle = Handle<PointLight>;
+using SpotLightHandle = Handle<SpotLight>;
+
+// Dense light arrays that double in the arena when full. The renderer
+// clusters them per view, so the count is bounded by the froxel budget in
+// light_clusters.h rather than by the shader. Removal swaps the
+// last light into the hole, so keep handles rather than indices or pointers.
 struct LightEnvironment {
     Vec3 ambient_color;
     f32 ambient_intensity;
-    PointLight point_lights[MAX_POINT_LIGHTS];
-    u32 point_light_count;
-    SpotLight spot_lights[MAX_SPOT_LIGHTS];
-    u32 spot_light_count;
+    PointLight* point_lights;
+    u32 point_light_count, point_light_capacity;
+    SpotLight* spot_lights;
+    u32 spot_light_count, spot_light_capacity;
+    HandleTable point_handles;
+    HandleTable spot_handles;
+    MemoryArena* arena;
 };
 
-void light_environment_init(LightEnvironment* env);
+bool light_environment_init(LightEnvironment* env, MemoryArena* arena);
+// Removes all lights; handles to them go stale.
 void light_environment_clear(LightEnvironment* env);
+bool light_environment_reserve(LightEnvironment* env, u32 point_capacity, u32 spot_capacity);
+// Both add functions return nullptr only when the arena is out of memory.
 PointLight* light_environment_add_point(LightEnvironment* env, const Vec3& pos, const Vec3& color, f32 radius, f32 intensity);
 SpotLight* light_environment_add_spot(LightEnvironment* env,
     const Vec3& pos,
@@ -52,6 +65,17 @@ SpotLight* light_environment_add_spot(LightEnvironment* env,
     f32 outer_cos,
     f32 intensity,
     f32 falloff);
+
+PointLightHandle light_environment_point_handle(const LightEnvironment* env, u32 index);
+SpotLightHandle light_environment_spot_handle(const LightEnvironment* env, u32 index);
+// Dense index of a light, HANDLE_NONE when the handle is stale.
+u32 light_environment_point_index(const LightEnvironment* env, PointLightHandle h);
+u32 light_environment_spot_index(const LightEnvironment* env, SpotLightHandle h);
+PointLight* light_environment_get_point(LightEnvironment* env, PointLightHandle h);
+SpotLight* light_environment_get_spot(LightEnvironment* env, SpotLightHandle h);
+bool light_environment_remove_point(LightEnvironment* env, PointLightHandle h);
+bool light_environment_remove_spot(LightEnvironment* env, SpotLightHandle h);
+
 }
 
 #endif
@@ -0,0 +1,83 @@
+#ifndef BRUTAL_RENDERER_LIGHT_CLUSTERS_H
+#define BRUTAL_RENDERER_LIGHT_CLUSTERS_H
+
+#include "brutal/core/types.h"
+#include "brutal/math/mat.h"
+
+namespace brutal {
+
+struct MemoryArena;
+struct LightEnvironment;
+
+// =============================================================================
+// Clustered lights
+// =============================================================================
+// The view frustum is split into a grid of froxels: screen tiles in x and y,
+// slices in view depth growing exponentially from near to far. Every light is
+// assigned to the froxels its range sphere touches, so a fragment shades only
+// with the lights of its own froxel and the cost per fragment no longer grows
+// with the light count.
+constexpr u32 CLUSTER_GRID_X = 16;
+constexpr u32 CLUSTER_GRID_Y = 9;
+constexpr u32 CLUSTER_GRID_Z = 24;
+constexpr u32 CLUSTER_COUNT = CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z;
+// Lights one froxel holds; further lights touching it are dropped
+constexpr u32 CLUSTER_MAX_LIGHTS = 64;
+// Active lights one build takes, points first, then spots
+constexpr u32 CLUSTER_LIGHT_CAPACITY = 4096;
+// Floats per light in light_data, four RGBA texels:
+//   xyz position, range | rgb color, intensity | xyz direction, inner cos |
+//   outer cos, falloff, 1 for spots, 0
+constexpr u32 CLUSTER_LIGHT_FLOATS = 16;
+
+struct LightClusters {
+    // Perspective the grid was built for, read back from the projection
+    f32 near_plane, far_plane;
+    f32 tan_half_x, tan_half_y;
+    // log(depth) * depth_scale + depth_bias is the slice of a view depth
+    f32 depth_scale, depth_bias;
+
+    // Packed lights, indexed by the cluster lists, in ascending order of their
+    // bounding sphere's world x so a box query can search for the slab of
+    // lights that may reach it
+    f32* light_data;
+    u32 light_count;
+    f32 max_radius;   // Largest bounding sphere radius
+
+    // Bounding spheres in world space and in view space (depth positive),
+    // one array per component so the culling loops run over contiguous floats
+    f32* sphere_x;
+    f32* sphere_y;
+    f32* sphere_z;
+    f32* sphere_r;
+    f32* bound_x;
+    f32* bound_y;
+    f32* bound_z;
+    f32* bound_r;
+
+    // Per froxel: first index << 8 | count, and the compacted lists
+    u32* grid;
+    u16* indices;
+    u32 index_count;
+
+    // Lights in environment order and the permutation that sorts them
+    f32* staging;
+    u16* order;
+
+    // Fixed-stride lists the build writes before compaction
+    u16* scratch;
+    u8* scratch_counts;
+    u32 full_clusters;   // Froxels at CLUSTER_MAX_LIGHTS, which may have dropped lights
+};
+
+bool light_clusters_create(LightClusters* c, MemoryArena* arena);
+// Packs the environment's active lights and assigns them to froxels of the
+// given perspective. Runs the froxel slices in parallel once there are enough
+// lights to pay for it.
+void light_clusters_build(LightClusters* c, const LightEnvironment* lights, const Mat4& view, const Mat4& projection);
+// Froxel of a view-space point with depth = -z, for tests and debugging.
+u32 light_clusters_index(const LightClusters* c, const Vec3& view_pos);
+
+}
+
+#endif
@@ -3,6 +3,8 @@
 
 #include "brutal/core/types.h"
 #include "brutal/math/vec.h"
+#include "brutal/math/geometry.h"
+#include "brutal/math/mat.h"
 
 namespace brutal {
 
@@ -12,14 +14,67 @@ struct Vertex {
     Vec3 color;
 };
 
+// GPU layout of packed meshes, 16 bytes against Vertex's 36: position in
+// steps of a power-of-two grid from the mesh origin, so coordinates snapped
+// to that grid come back exactly; signed 2:10:10:10 normal; RGBA8 color.
+struct PackedVertex {
+    u16 position[3];
+    u16 pad;
+    u32 normal;
+    u32 color;
+};
+
+enum VertexFormat : u8 {
+    VERTEX_FORMAT_FLOAT,
+    VERTEX_FORMAT_PACKED,
+};
+
+// Coarsest grid a packed mesh may use; wider meshes keep the float layout
+constexpr f32 PACKED_MAX_STEP = 1.0f / 64.0f;
+
 struct Mesh {
     u32 vao, vbo, ibo;
     u32 vertex_count;
     u32 index_count;
+    // Local bounds of the vertices; dynamic meshes have none until their owner
+    // sets them
+    AABB bounds;
+    bool has_bounds;
+    // Packed meshes store grid positions: local = origin + position * step
+    VertexFormat format;
+    Vec3 origin;
+    f32 step;
+    // Software backend: geometry stays in memory, always as floats, and vao
+    // is only an id for sorting. Null backend: the id, counts, bounds and
+    // format only. Neither has a vbo.
+    Vertex* cpu_vertices;
+    u32* cpu_indices;
+    u32 vertex_capacity, index_capacity;
 };
 
+// Meshes follow the render backend selected when they are created.
 bool mesh_create(Mesh* m, const Vertex* verts, u32 vc, const u32* idx, u32 ic);
+// As mesh_create, stored as PackedVertex when the vertices' extent allows a
+// grid of at most PACKED_MAX_STEP, otherwise as floats
+bool mesh_create_packed(Mesh* m, const Vertex* verts, u32 vc, const u32* idx, u32 ic);
+// Buffers sized for the given capacities and left for range updates; the
+// counts start at 0 and are set by the caller to what should be drawn.
+bool mesh_create_dynamic(Mesh* m, u32 vertex_capacity, u32 index_capacity);
+// Dynamic mesh packed on a grid covering `range`; updates must stay inside
+// it (see mesh_contains). Floats when the range is too wide to pack.
+bool mesh_create_dynamic_packed(Mesh* m, u32 vertex_capacity, u32 index_capacity, const AABB& range);
+void mesh_update_vertices(Mesh* m, u32 first, const Vertex* verts, u32 count);
+void mesh_update_indices(Mesh* m, u32 first, const u32* idx, u32 count);
 void mesh_destroy(Mesh* m);
+// Whether the mesh can store vertices inside the box; always for floats
+bool mesh_contains(const Mesh* m, const AABB& box);
+// The model matrix to draw with: model with a packed mesh's grid folded in
+Mat4 mesh_draw_matrix(const Mesh* m, const Mat4& model);
+u32 mesh_vertex_size(const Mesh* m);
+// Finest power-of-two grid whose 16-bit positions span the range; false when
+// it would be coarser than PACKED_MAX_STEP
+bool vertex_pack_grid(const AABB& range, Vec3* origin, f32* step);
+void vertex_pack(const Vertex* in, u32 count, const Vec3& origin, f32 step, PackedVertex* out);
 void mesh_draw(const Mesh* m);
 Mesh mesh_create_cube();
 Mesh mesh_create_grid(f32 size, i32 divs);
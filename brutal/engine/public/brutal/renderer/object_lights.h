@@ -0,0 +1,36 @@
+#ifndef BRUTAL_RENDERER_OBJECT_LIGHTS_H
+#define BRUTAL_RENDERER_OBJECT_LIGHTS_H
+
+#include "brutal/core/types.h"
+#include "brutal/math/geometry.h"
+#include "brutal/math/mat.h"
+
+namespace brutal {
+
+struct LightClusters;
+
+// =============================================================================
+// Per-object lights
+// =============================================================================
+// Small objects shade with a short list of the lights that reach their world
+// bounds instead of their froxels' lists, which caps the lights a fragment
+// of a prop can pay for. Large or boundless geometry keeps the froxels.
+constexpr u32 OBJECT_MAX_LIGHTS = 8;
+
+// Two light indices per element, low half first
+struct ObjectLights {
+    u32 packed[OBJECT_MAX_LIGHTS / 2];
+    u32 count;
+};
+
+// World bounds of a local box under an affine transform
+AABB aabb_transform(const AABB& b, const Mat4& m);
+
+// The lights of the clustered set whose sphere (points) or cone (spots)
+// touches the box, strongest first by their estimated contribution at the
+// box. Indices are those of the clusters' light_data.
+void object_lights_select(const LightClusters* c, const AABB& bounds, ObjectLights* out);
+
+}
+
+#endif
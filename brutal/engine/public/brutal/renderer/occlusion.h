@@ -0,0 +1,80 @@
+#ifndef BRUTAL_RENDERER_OCCLUSION_H
+#define BRUTAL_RENDERER_OCCLUSION_H
+
+#include "brutal/core/types.h"
+#include "brutal/math/geometry.h"
+#include "brutal/math/mat.h"
+
+namespace brutal {
+
+struct MemoryArena;
+
+// =============================================================================
+// Software occlusion
+// =============================================================================
+// A low-resolution depth buffer rasterized on the CPU from a few large boxes
+// (the biggest brushes in view), tested against the bounds of everything else
+// before it is queued. Depth is 1/w, larger is nearer, 0 where nothing was
+// drawn. The screen is cut into tiles rasterized in parallel on the job pool;
+// a pyramid of the farthest depth under each texel then answers box tests
+// with a handful of reads. No GL: the whole path runs headless.
+constexpr u32 OCCLUSION_WIDTH = 256;
+constexpr u32 OCCLUSION_HEIGHT = 144;
+constexpr u32 OCCLUSION_TILE_WIDTH = 32;
+constexpr u32 OCCLUSION_TILE_HEIGHT = 16;
+constexpr u32 OCCLUSION_TILES_X = OCCLUSION_WIDTH / OCCLUSION_TILE_WIDTH;
+constexpr u32 OCCLUSION_TILES_Y = OCCLUSION_HEIGHT / OCCLUSION_TILE_HEIGHT;
+constexpr u32 OCCLUSION_TILE_COUNT = OCCLUSION_TILES_X * OCCLUSION_TILES_Y;
+constexpr u32 OCCLUSION_MAX_OCCLUDERS = 256;
+// Three faces per box, each up to a 9-gon after clipping
+constexpr u32 OCCLUSION_MAX_TRIANGLES = OCCLUSION_MAX_OCCLUDERS * 3 * 7;
+constexpr u32 OCCLUSION_MAX_LEVELS = 9;
+
+// Edge functions (interior >= 0) and the 1/w plane over pixel coordinates,
+// clamped pixel bounds inclusive
+struct OccluderTriangle {
+    f32 edge[3][3];
+    f32 depth[3];
+    i32 min_x, min_y, max_x, max_y;
+};
+
+struct OcclusionStats {
+    u32 occluders;   // Boxes that reached the rasterizer
+    u32 triangles;
+    u32 tested;
+    u32 culled;
+    f32 raster_ms;   // Setup, tiles and pyramid
+};
+
+struct OcclusionBuffer {
+    Mat4 view_projection;
+    f32 near_plane;
+    bool ready;       // Built for the current camera; tests pass until then
+    f32* levels[OCCLUSION_MAX_LEVELS];   // 0 is the depth buffer
+    u32 level_width[OCCLUSION_MAX_LEVELS];
+    u32 level_height[OCCLUSION_MAX_LEVELS];
+    u32 level_count;
+    OccluderTriangle* triangles;
+    u32 triangle_count;
+    // Triangles overlapping each tile: tile_triangles[tile_first[t]..tile_first[t + 1])
+    u32* tile_first;
+    u16* tile_triangles;
+    u32 tile_capacity;
+    OcclusionStats stats;
+};
+
+bool occlusion_create(OcclusionBuffer* o, MemoryArena* arena);
+// Rasterizes the faces of the boxes that face the eye and rebuilds the
+// pyramid. Boxes past OCCLUSION_MAX_OCCLUDERS are ignored; the caller picks
+// the ones worth drawing (scene_select_occluders). Resets the test counters.
+void occlusion_build(OcclusionBuffer* o, const Mat4& view, const Mat4& projection, const Vec3& eye,
+    const AABB* boxes, u32 count);
+inline void occlusion_reset(OcclusionBuffer* o) { o->ready = false; }
+// False only when the box is behind drawn occluders everywhere it covers.
+// Boxes crossing the near plane or off screen pass. Counts into stats, so
+// call from one thread.
+bool occlusion_test_box(OcclusionBuffer* o, const AABB& box);
+
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef BRUTAL_RENDERER_RENDER_BACKEND_H
+#define BRUTAL_RENDERER_RENDER_BACKEND_H
+
+#include "brutal/core/types.h"
+
+namespace brutal {
+
+// =============================================================================
+// Render backend
+// =============================================================================
+// What sits behind renderer.h and mesh.h for the whole process. GL needs a
+// current context (gl_init). The software backend needs no GPU: meshes keep
+// their geometry in memory and frames are rasterized on the CPU into a
+// framebuffer (software_raster.h). The null backend does the renderer's CPU
+// work (culling, sorting, light selection, instance data) and counts what it
+// would submit, with no GPU and no pixels: meshes keep only their counts and
+// bounds. Select before creating any mesh or the renderer; GL is the default.
+enum RenderBackend : u8 {
+    RENDER_BACKEND_GL,
+    RENDER_BACKEND_SOFTWARE,
+    RENDER_BACKEND_NULL,
+};
+
+void render_backend_select(RenderBackend backend);
+RenderBackend render_backend();
+inline bool render_backend_uses_gl() { return render_backend() == RENDER_BACKEND_GL; }
+const char* render_backend_name(RenderBackend backend);
+
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef BRUTAL_RENDERER_RENDER_QUEUE_H
+#define BRUTAL_RENDERER_RENDER_QUEUE_H
+
+#include "brutal/core/types.h"
+#include "brutal/math/mat.h"
+
+namespace brutal {
+
+struct MemoryArena;
+struct Mesh;
+
+// =============================================================================
+// Render queue
+// =============================================================================
+// Draws are recorded as commands with a 64-bit sort key and executed in key
+// order, so draws sharing a pass, program and mesh run back to back and the
+// state between them only changes where a key field does. Key layout, high
+// bits first:
+//   [63..60] pass   [59..56] program   [55..40] mesh   [39..16] depth
+// Depth is the top of the float bits of the camera distance, which orders
+// like the float itself for non-negative values: opaque draws of one mesh go
+// front to back for early-z.
+enum RenderPass : u8 {
+    RENDER_PASS_OPAQUE = 0,
+    RENDER_PASS_OUTLINE = 1,    // Front faces culled, drawn over the opaque pass
+    RENDER_PASS_LINES = 2
+};
+
+enum RenderProgram : u8 {
+    RENDER_PROGRAM_LIT = 0,
+    RENDER_PROGRAM_FLAT = 1
+};
+
+struct RenderCommand {
+    Mat4 model;
+    Vec3 color;
+    const Mesh* mesh;
+};
+
+struct RenderSortItem {
+    u64 key;
+    u32 command;
+};
+
+struct RenderQueue {
+    RenderCommand* commands;
+    RenderSortItem* items;     // Sorted by render_queue_sort
+    RenderSortItem* scratch;
+    u32 count, capacity;
+};
+
+bool render_queue_create(RenderQueue* q, MemoryArena* arena, u32 capacity);
+inline void render_queue_clear(RenderQueue* q) { q->count = 0; }
+// nullptr when full; the caller flushes and pushes again.
+RenderCommand* render_queue_push(RenderQueue* q, u64 key);
+// Radix sort on the keys, skipping digits every key shares. Stable, so equal
+// keys keep submission order.
+void render_queue_sort(RenderQueue* q);
+
+u64 render_sort_key(RenderPass pass, RenderProgram program, u32 mesh_id, f32 depth);
+inline RenderPass render_key_pass(u64 key) { return static_cast<RenderPass>(key >> 60); }
+inline RenderProgram render_key_program(u64 key) { return static_cast<RenderProgram>((key >> 56) & 0xF); }
+
+}
+
+#endif
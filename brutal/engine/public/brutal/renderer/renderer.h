@@ -6,6 +6,11 @@
 #include "brutal/renderer/shader.h"
 #include "brutal/renderer/mesh.h"
 #include "brutal/renderer/light.h"
+#include "brutal/renderer/render_queue.h"
+#include "brutal/renderer/light_clusters.h"
+#include "brutal/renderer/stream_buffer.h"
+#include "brutal/renderer/occlusion.h"
+#include "brutal/renderer/software_raster.h"
 
 namespace brutal {
 
@@ -13,30 +18,76 @@ struct MemoryArena;
 struct Camera;
 struct LightEnvironment;
 
+// std140 layout of the lit shader's Lights block. The lights themselves are
+// in buffer textures indexed through the froxel grid (light_clusters.h).
+struct ShaderLightBlock {
+    f32 camera_pos[4];
+    f32 ambient[4];         // rgb, intensity
+    f32 cluster_depth[4];   // slice = log(depth) * x + y
+    i32 cluster_dims[4];    // grid x, y, z, lights per froxel
+};
+
+// Per-instance attributes of the instanced lit shader: model matrix in
+// locations 3..6, color in 7 with the light count in w (-1: froxel lists),
+// packed light indices in 8.
+struct RenderInstance {
+    f32 model[16];
+    f32 color[4];
+    u32 lights[4];
+};
+
 struct RendererState {
     Shader lit_shader;
     Shader flat_shader;
+    Shader lit_instanced_shader;
+    i32 loc_instanced_view_proj;
+    i32 loc_object_lights;
+    i32 loc_object_light_count;
     Mesh cube_mesh;
     Mesh grid_mesh;
     i32 viewport_width, viewport_height;
     Vec3 camera_pos;
     Mat4 view, projection, view_projection;
     const LightEnvironment* lights;
-    i32 loc_camera_pos;
-    i32 loc_ambient;
-    i32 loc_light_count;
-    i32 loc_light_pos[MAX_POINT_LIGHTS];
-    i32 loc_light_color[MAX_POINT_LIGHTS];
-    i32 loc_spot_light_count;
-    i32 loc_spot_light_pos[MAX_SPOT_LIGHTS];
-    i32 loc_spot_light_dir[MAX_SPOT_LIGHTS];
-    i32 loc_spot_light_color[MAX_SPOT_LIGHTS];
-    i32 loc_spot_light_params[MAX_SPOT_LIGHTS];
+    // Lights are clustered again when the camera or lights are set. The
+    // Lights uniform buffer is uploaded only when its bytes change; the
+    // light data and froxel lists go to buffer textures.
+    u32 light_buffer;
+    ShaderLightBlock light_block;
+    bool light_block_valid;
+    bool lights_dirty;
+    LightClusters clusters;
+    u32 light_data_buffer, light_data_texture;
+    u32 cluster_grid_buffer, cluster_grid_texture;
+    u32 cluster_lights_buffer, cluster_lights_texture;
+    // Runs of one lit mesh in the opaque pass are written into the stream
+    // and drawn with one instanced call; instances stages them when the
+    // stream cannot stay mapped
+    StreamBuffer instance_stream;
+    RenderInstance* instances;
+    u32 instance_capacity;
+    RenderQueue queue;
     u32 draw_calls;
     u32 triangles;
     u32 vertices;
+    u64 vertex_bytes;   // Vertex data the draws fetch, at each mesh's format
+    u64 upload_bytes;   // Instance and light data streamed to the GPU
+    // Bound-state changes the queue could not elide
+    u32 program_binds;
+    u32 vao_binds;
+    u32 uniform_uploads;
+    u32 light_uploads;
+    // Draws shaded with their own light list, and the lights they were given
+    u32 object_light_draws;
+    u32 object_light_refs;
+    // Built per camera by renderer_build_occlusion; until then nothing is culled
+    OcclusionBuffer occlusion;
+    // Software backend: flushes rasterize into its framebuffer
+    SoftwareRaster software;
 };
 
+// Runs on the render backend selected at init (render_backend.h); the
+// software and null backends need no GL context
 bool renderer_init(RendererState* s, MemoryArena* arena);
 void renderer_shutdown(RendererState* s);
 void renderer_begin_frame(RendererState* s, i32 w, i32 h);
@@ -44,15 +95,39 @@ void renderer_end_frame();
 void renderer_set_camera(RendererState* s, const Camera* c);
 void renderer_set_camera_matrices(RendererState* s, const Mat4& view, const Mat4& projection, const Vec3& camera_pos);
 void renderer_set_lights(RendererState* s, const LightEnvironment* l);
+// Draws are queued and run sorted by renderer_flush. Changing the camera or
+// lights flushes what was queued under the old ones; flush before switching
+// render targets or drawing outside the renderer. Opaque draws sharing an
+// indexed mesh run as one instanced draw, so many props on one mesh cost a
+// single draw call.
+void renderer_flush(RendererState* s);
+// Rasterizes the occluders for the current camera. Draws queued afterwards
+// whose mesh has bounds are dropped when those bounds are hidden behind them,
+// until the camera changes or the frame ends.
+void renderer_build_occlusion(RendererState* s, const AABB* occluders, u32 count);
 void renderer_draw_mesh(RendererState* s, const Mesh* m, const Mat4& model, const Vec3& color);
 void renderer_draw_mesh_outline(RendererState* s, const Mesh* m, const Mat4& model, const Vec3& color, f32 scale);
 void renderer_draw_cube(RendererState* s, const Vec3& pos, const Vec3& scale, const Vec3& color);
 void renderer_draw_grid(RendererState* s);
 Mat4 renderer_get_view_projection(const RendererState* s);
 const Mesh* renderer_get_cube_mesh(const RendererState* s);
+// Software backend: the frame drawn by the flushes so far
+inline const SoftwareFramebuffer* renderer_framebuffer(const RendererState* s) { return &s->software.framebuffer; }
 inline u32 renderer_draw_calls(const RendererState* s) { return s->draw_calls; }
 inline u32 renderer_triangles(const RendererState* s) { return s->triangles; }
 inline u32 renderer_vertices(const RendererState* s) { return s->vertices; }
+inline u64 renderer_vertex_bytes(const RendererState* s) { return s->vertex_bytes; }
+inline u64 renderer_upload_bytes(const RendererState* s) { return s->upload_bytes; }
+inline u32 renderer_program_binds(const RendererState* s) { return s->program_binds; }
+inline u32 renderer_vao_binds(const RendererState* s) { return s->vao_binds; }
+inline u32 renderer_uniform_uploads(const RendererState* s) { return s->uniform_uploads; }
+inline u32 renderer_light_uploads(const RendererState* s) { return s->light_uploads; }
+inline const LightClusters* renderer_light_clusters(const RendererState* s) { return &s->clusters; }
+inline const OcclusionStats* renderer_occlusion_stats(const RendererState* s) { return &s->occlusion.stats; }
+inline u32 renderer_object_light_draws(const RendererState* s) { return s->object_light_draws; }
+inline f32 renderer_average_object_lights(const RendererState* s) {
+    return s->object_light_draws ? (f32)s->object_light_refs / (f32)s->object_light_draws : 0.0f;
+}
 
 }
 
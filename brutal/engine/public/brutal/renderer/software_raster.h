@@ -0,0 +1,125 @@
+#ifndef BRUTAL_RENDERER_SOFTWARE_RASTER_H
+#define BRUTAL_RENDERER_SOFTWARE_RASTER_H
+
+#include "brutal/core/types.h"
+#include "brutal/math/mat.h"
+#include "brutal/renderer/object_lights.h"
+
+namespace brutal {
+
+struct Mesh;
+struct LightClusters;
+
+// =============================================================================
+// Software rasterizer
+// =============================================================================
+// The CPU half of the software render backend. Draws are transformed,
+// clipped and set up as they are recorded; a resolve bins the triangles into
+// screen tiles and rasterizes the tiles in parallel on the job pool. Within
+// a tile, edge functions and depth are evaluated over each row's span in a
+// branch-free loop, then every pixel is shaded once by its nearest triangle,
+// with attributes interpolated perspective-correct and the lit shader's
+// model against the same light clusters. Vertices are snapped to 1/16 pixel
+// and edges shared by two triangles fill each pixel once.
+constexpr u32 SOFTWARE_TILE_SIZE = 64;
+
+// RGBA8 (0xAABBGGRR), first row at the top; depth is NDC z, 1 when clear
+struct SoftwareFramebuffer {
+    u32 width, height;
+    u32* color;
+    f32* depth;
+};
+
+enum SoftwareCull : u8 {
+    SOFTWARE_CULL_NONE,
+    SOFTWARE_CULL_BACK,
+    SOFTWARE_CULL_FRONT,
+};
+
+// What the tiles shade one draw's pixels with
+struct SoftwareDraw {
+    Vec3 color;
+    ObjectLights lights;
+    i32 light_count;   // -1: the froxel lists
+    bool lit;          // Otherwise flat color
+};
+
+// Pixel position (x, y, sub-pixel snapped), NDC depth and 1/w, then the
+// attributes the lit shader interpolates
+struct SoftwareVertex {
+    f32 x, y, z, inv_w;
+    Vec3 world, normal, color;
+};
+
+// Counter-clockwise on screen after setup; edge e runs from v[e] to
+// v[(e + 1) % 3] with E = a * (x - x0) + b * (y - y0), inside where E >= 0.
+// Depth changes by z_dx, z_dy per pixel from v[0]'s.
+struct SoftwareTriangle {
+    u32 v[3];
+    u32 draw;
+    f32 a[3], b[3];
+    f32 inv_area;
+    f32 z_dx, z_dy;
+    i32 min_x, min_y, max_x, max_y;
+};
+
+struct SoftwareLine {
+    u32 v[2];
+    u32 draw;
+};
+
+// Lighting shared by the draws of one resolve
+struct SoftwareShading {
+    const LightClusters* clusters;
+    Vec3 camera_pos;
+    Vec3 ambient;
+};
+
+struct SoftwareRaster {
+    SoftwareFramebuffer framebuffer;
+    u32 framebuffer_capacity;   // Pixels
+    u32 clear_color;
+    // Recorded since the last resolve, grown as needed
+    SoftwareVertex* vertices;
+    u32 vertex_count, vertex_capacity;
+    Vec4* clip;                 // Clip-space position per vertex, for clipping
+    u32 clip_capacity;
+    SoftwareTriangle* triangles;
+    u32 triangle_count, triangle_capacity;
+    SoftwareLine* lines;
+    u32 line_count, line_capacity;
+    SoftwareDraw* draws;
+    u32 draw_count, draw_capacity;
+    // Triangles per tile: tile_triangles[tile_first[t]..tile_first[t + 1])
+    u32 tiles_x, tiles_y;
+    u32* tile_first;
+    u32* tile_pixels;           // Pixels each tile shaded in the last resolve
+    u32 tile_capacity;
+    u32* tile_triangles;
+    u32 tile_ref_capacity;
+    SoftwareShading shading;
+    // This frame
+    u32 triangles_binned;
+    u32 pixels_shaded;
+};
+
+bool software_raster_create(SoftwareRaster* r);
+void software_raster_destroy(SoftwareRaster* r);
+// Sizes the framebuffer and clears it; drops anything recorded
+bool software_raster_begin_frame(SoftwareRaster* r, u32 width, u32 height, const Vec3& clear_color);
+u32 software_raster_add_draw(SoftwareRaster* r, const SoftwareDraw& draw);
+// Records an indexed (or plain) triangle mesh of a software-backend mesh
+void software_raster_draw_triangles(SoftwareRaster* r, const Mesh* m, const Mat4& model, const Mat4& view_projection,
+    u32 draw, SoftwareCull cull);
+// Records consecutive vertex pairs as lines, drawn after the triangles
+void software_raster_draw_lines(SoftwareRaster* r, const Mesh* m, const Mat4& model, const Mat4& view_projection,
+    u32 draw);
+// Rasterizes everything recorded into the framebuffer in recording order
+void software_raster_resolve(SoftwareRaster* r, const SoftwareShading& shading);
+
+// Uncompressed 32-bit TGA, top-left origin
+bool software_framebuffer_save_tga(const SoftwareFramebuffer* fb, const char* path);
+
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef BRUTAL_RENDERER_STREAM_BUFFER_H
+#define BRUTAL_RENDERER_STREAM_BUFFER_H
+
+#include "brutal/core/types.h"
+
+namespace brutal {
+
+// =============================================================================
+// Stream buffers
+// =============================================================================
+// A GL buffer for data rewritten every frame, split into segments the CPU
+// fills in turn. A fence follows the draws of each segment and the CPU waits
+// on it only when it comes back around, so writes never stall on a draw the
+// GPU has yet to run.
+//
+// Where buffer storage is available the buffer stays mapped and callers write
+// straight into it. Otherwise they write to a staging block that is copied in
+// with an unsynchronized map on commit, or, without sync objects, by
+// orphaning the storage.
+constexpr u32 STREAM_SEGMENTS = 3;
+
+enum StreamMode : u8 {
+    STREAM_PERSISTENT,
+    STREAM_FENCED,
+    STREAM_ORPHAN,
+};
+
+struct StreamBuffer {
+    u32 buffer;
+    u32 target;
+    StreamMode mode;
+    u32 segment_size;
+    u32 segment;            // Segment being written
+    u32 head;               // Byte offset of the next write in the buffer
+    u32 frame;              // Stream frame the segment was last written in
+    u8* mapped;             // Whole buffer, persistent mode only
+    u8* staging;
+    u32 staging_size;
+    void* fences[STREAM_SEGMENTS];
+    u32 write_stride;       // Element size of the open write, 0 when none
+};
+
+// Bytes written and waits on a segment still in use, over one frame
+struct StreamStats {
+    u32 bytes;
+    u32 stalls;
+};
+
+// staging backs the writes when the buffer cannot stay mapped; it bounds
+// the elements one write can take in those modes
+bool stream_buffer_create(StreamBuffer* sb, u32 target, u32 segment_size, void* staging, u32 staging_size);
+void stream_buffer_destroy(StreamBuffer* sb);
+// Opens a write of up to `count` elements of `stride` bytes and returns where
+// to put them, with room for *capacity of them. Moves to the next segment
+// when the current one cannot take all `count`.
+void* stream_buffer_begin(StreamBuffer* sb, u32 stride, u32 count, u32* capacity);
+// Closes the open write with `count` elements and returns their byte offset
+// in the buffer, a multiple of the stride. The buffer is left bound.
+u32 stream_buffer_commit(StreamBuffer* sb, u32 count);
+// Marks the end of a frame: each stream fences its segment at its next write
+void stream_buffers_end_frame();
+StreamStats stream_buffers_last_frame();
+
+}
+
+#endif
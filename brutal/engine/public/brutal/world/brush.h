@@ -7,9 +7,11 @@
 namespace brutal {
 
 struct Vertex;
+struct MemoryArena;
 
 constexpr u32 BRUSH_SOLID = 1;
 constexpr u32 BRUSH_INVISIBLE = 2;
+constexpr u32 BRUSH_FACE_COUNT = 6;   // -X, +X, -Y, +Y, -Z, +Z
 
 struct BrushFace { Vec3 color; };
 
@@ -23,6 +25,24 @@ inline AABB brush_to_aabb(const Brush* b) { return {b->min, b->max}; }
 u32 brush_generate_vertices(const Brush* b, Vertex* out);
 u32 brush_generate_indices(u32 base, u32* out);
 
+// Extent of a face on its two tangent axes, in axis order: (y, z) for X
+// faces, (x, z) for Y faces, (x, y) for Z faces. Empty when min >= max.
+struct BrushFaceRect { f32 min_u, min_v, max_u, max_v; };
+
+BrushFaceRect brush_face_rect(const Brush* b, u32 face);
+inline bool brush_face_rect_empty(const BrushFaceRect& r) { return r.min_u >= r.max_u || r.min_v >= r.max_v; }
+
+// Emits only the faces whose rect is non-empty, each clipped to its rect.
+// Indices start at base. Returns vertices written, *index_count gets indices.
+u32 brush_generate_clipped(const Brush* b, const BrushFaceRect* rects, u32 base, Vertex* verts, u32* idx, u32* index_count);
+
+// Shrinks rects[brush * 6 + face] of visible brushes to the part not hidden
+// by other visible brushes. A face is hidden where another brush lies against
+// it or it is buried inside one; covered regions are cut away when they span
+// the remaining rect on one axis, so partial cover is clipped where it is a
+// simple trim and kept otherwise. Returns faces removed entirely.
+u32 brush_cull_hidden_faces(const Brush* brushes, u32 count, BrushFaceRect* rects, MemoryArena* temp);
+
 }
 
 #endif
@@ -0,0 +1,132 @@
+#ifndef BRUTAL_WORLD_CHARACTER_H
+#define BRUTAL_WORLD_CHARACTER_H
+
+#include "brutal/math/geometry.h"
+#include "brutal/math/vec.h"
+#include "brutal/core/types.h"
+
+namespace brutal {
+
+struct MemoryArena;
+struct CollisionWorld;
+struct CollisionCache;
+
+// Movement state for deterministic behavior
+enum class MoveState {
+    STANDING,
+    WALKING,
+    SPRINTING,
+    CROUCHING
+};
+
+constexpr f32 CHARACTER_JUMP_BUFFER_MAX = 0.1f;  // Buffer jump input before landing
+
+// Tuning shared by every character driven by the same controller.
+struct CharacterParams {
+    f32 walk_speed;
+    f32 sprint_speed;
+    f32 crouch_speed;
+    f32 gravity;
+    f32 jump_velocity;
+    f32 terminal_velocity;
+    f32 air_control;
+    f32 stand_height;
+    f32 crouch_height;
+    f32 eye_offset;        // Eye position below top of the box
+    f32 radius;
+};
+
+// Per-character simulation state touched by one fixed step.
+struct CharacterState {
+    Vec3 eye_position;
+    Vec3 velocity;
+    f32 current_height;
+    f32 coyote_time;
+    f32 jump_buffer_time;
+    MoveState move_state;
+    bool grounded;
+    bool is_crouched;
+};
+
+// Intent for one fixed step. forward/right are in [-1, 1].
+struct CharacterInput {
+    f32 yaw;
+    f32 pitch;
+    f32 forward;
+    f32 right;
+    bool sprint;
+    bool crouch;
+};
+
+struct CharacterStepResult {
+    Vec3 wish_dir;
+    bool jumped;
+    bool collided;         // A collision world was present and swept against
+    u32 boxes_tested;      // By move-and-slide this step
+};
+
+void character_params_default(CharacterParams* params);
+void character_state_init(CharacterState* s, const CharacterParams* params, const Vec3& eye_position);
+
+// Arms the jump buffer; the jump fires on the next step that can take it.
+inline void character_request_jump(CharacterState* s) { s->jump_buffer_time = CHARACTER_JUMP_BUFFER_MAX; }
+
+f32 character_feet_y(const CharacterState* s, const CharacterParams* params);
+AABB character_bounds(const CharacterState* s, const CharacterParams* params);
+AABB character_bounds_at_height(const CharacterState* s, const CharacterParams* params, f32 height);
+bool character_can_stand(const CharacterState* s, const CharacterParams* params, const CollisionWorld* col,
+    CollisionCache* cache = nullptr);
+
+// One fixed step of the FPS controller: crouch, acceleration/friction,
+// coyote time + jump buffer, gravity and move-and-slide. Player and batch
+// paths both go through here so they produce identical results. A contact
+// cache, when given, narrows collision queries without changing results.
+CharacterStepResult character_step(CharacterState* s,
+    const CharacterParams* params,
+    const CharacterInput* input,
+    const CollisionWorld* col,
+    f32 dt,
+    CollisionCache* cache = nullptr);
+
+// =============================================================================
+// Batch (SoA) movement for many AI characters
+// =============================================================================
+constexpr u8 CHARACTER_GROUNDED = 1;
+constexpr u8 CHARACTER_CROUCHED = 2;
+
+constexpr u8 CHARACTER_INPUT_JUMP = 1;
+constexpr u8 CHARACTER_INPUT_SPRINT = 2;
+constexpr u8 CHARACTER_INPUT_CROUCH = 4;
+
+struct CharacterBatch {
+    u32 count, capacity;
+
+    // State
+    f32* eye_x; f32* eye_y; f32* eye_z;
+    f32* vel_x; f32* vel_y; f32* vel_z;
+    f32* current_height;
+    f32* coyote_time;
+    f32* jump_buffer_time;
+    u8* move_state;
+    u8* flags;             // CHARACTER_GROUNDED | CHARACTER_CROUCHED
+
+    // Input, written by AI before each update
+    f32* yaw;
+    f32* forward;
+    f32* right;
+    u8* buttons;           // CHARACTER_INPUT_*, JUMP is consumed by the update
+};
+
+bool character_batch_create(CharacterBatch* b, MemoryArena* arena, u32 capacity);
+void character_batch_clear(CharacterBatch* b);
+// Returns the new agent index, or capacity when full.
+u32 character_batch_add(CharacterBatch* b, const CharacterParams* params, const Vec3& eye_position, f32 yaw);
+void character_batch_get(const CharacterBatch* b, u32 i, CharacterState* out);
+void character_batch_set(CharacterBatch* b, u32 i, const CharacterState* s);
+
+// Steps every agent once, split across the job system.
+void character_batch_update(CharacterBatch* b, const CharacterParams* params, const CollisionWorld* col, f32 dt);
+
+}
+
+#endif
@@ -7,22 +7,86 @@ namespace brutal {
 
 struct MemoryArena;
 
+constexpr u32 COLLISION_NO_SOURCE = 0xFFFFFFFFu;
+constexpr u32 COLLISION_NO_BOX = 0xFFFFFFFFu;
+
 struct CollisionWorld {
     AABB* boxes;
     u32 box_count, box_capacity;
+    // One entry per added box, kept across merging so a box can be traced
+    // back to what produced it (e.g. a brush index).
+    u32* source_id;
+    u32* source_box;
+    u32 source_count;
+    u32 revision;          // Bumped on every change; invalidates CollisionCache
 };
 
 bool collision_world_create(CollisionWorld* w, MemoryArena* arena, u32 cap);
 void collision_world_clear(CollisionWorld* w);
-void collision_world_add_box(CollisionWorld* w, const AABB& box);
+void collision_world_add_box(CollisionWorld* w, const AABB& box, u32 source = COLLISION_NO_SOURCE);
+
+// Greedily merges boxes whose union is exactly a box (same extent on two
+// axes and touching/overlapping on the third, or one containing the other).
+// The merged set covers exactly the same space. Only boxes from first on take
+// part, so boxes appended after an update merge among themselves without
+// rescanning the rest. Returns boxes removed.
+u32 collision_world_merge_boxes(CollisionWorld* w, u32 first = 0);
+
+// Drops every box that covers a source marked in source_mask, for patching
+// the world after some sources changed. Unmarked sources that shared a
+// dropped box lose their coverage; their ids go to orphans (room for
+// source_count entries) to be added back. Returns the orphan count, or
+// COLLISION_NO_BOX when temp is out of memory.
+u32 collision_world_remove_sources(CollisionWorld* w, const u8* source_mask, u32 mask_size,
+    u32* orphans, MemoryArena* temp);
+
+// Writes up to max source ids covered by box into out, returns the total.
+u32 collision_world_box_sources(const CollisionWorld* w, u32 box, u32* out, u32 max);
 
 struct MoveResult {
     Vec3 position;
     bool hit_wall, hit_floor, hit_ceiling;
     Vec3 hit_normal;
+    u32 hit_box;           // Last box swept into, or COLLISION_NO_BOX
+    u32 boxes_tested;      // Penetration and sweep tests run, for profiling
 };
 
 MoveResult collision_move_and_slide(const CollisionWorld* w, const AABB& box, const Vec3& vel);
+bool collision_overlaps_any(const CollisionWorld* w, const AABB& box);
+
+// =============================================================================
+// Contact cache (temporal coherence for one mover)
+// =============================================================================
+// Boxes inside an inflated region around the mover are gathered once and
+// reused across fixed steps until a query leaves the region, so per-step cost
+// follows local density rather than level size. Results match the uncached
+// queries exactly: anything that would leave the region falls back to a
+// full scan.
+constexpr u32 COLLISION_CACHE_MAX = 128;
+constexpr f32 COLLISION_CACHE_DEFAULT_MARGIN = 1.0f;
+
+struct CollisionCache {
+    u32 indices[COLLISION_CACHE_MAX];
+    u32 count;
+    AABB region;
+    const CollisionWorld* world;
+    u32 world_revision;
+    bool valid;
+    f32 margin;
+
+    // Counters
+    u64 queries;
+    u64 hits;              // Answered from the cached candidates
+    u64 refills;           // Region rebuilt from a full scan
+    u64 fallbacks;         // Query escaped the region or overflowed the cache
+};
+
+void collision_cache_init(CollisionCache* c, f32 margin = COLLISION_CACHE_DEFAULT_MARGIN);
+void collision_cache_invalidate(CollisionCache* c);
+f32 collision_cache_hit_rate(const CollisionCache* c);
+
+MoveResult collision_move_and_slide_cached(CollisionCache* c, const CollisionWorld* w, const AABB& box, const Vec3& vel);
+bool collision_overlaps_any_cached(CollisionCache* c, const CollisionWorld* w, const AABB& box);
 
 }
 
@@ -4,9 +4,12 @@
 #include "brutal/math/vec.h"
 #include "brutal/math/quat.h"
 #include "brutal/math/mat.h"
+#include "brutal/core/handle.h"
 
 namespace brutal {
 
+struct MemoryArena;
+
 struct Transform {
     Vec3 position;
     Quat rotation;
@@ -19,13 +22,75 @@ inline Transform transform_default() {
 
 Mat4 transform_to_matrix(const Transform* t);
 
-struct PropEntity {
-    Transform transform;
-    u32 mesh_id;
-    Vec3 color;
-    bool active;
+// =============================================================================
+// Prop storage
+// =============================================================================
+// Props are stored as component columns: entry i of every array belongs to
+// prop i. Active props are kept packed at the front, [0, active_count), so
+// per-frame passes walk contiguous column prefixes with no active checks.
+// Toggling or removing a prop swaps entries to keep the split, which moves
+// indices around; refer to props across frames by handle.
+struct Prop;
+using PropHandle = Handle<Prop>;
+
+struct PropStorage {
+    Vec3* positions;
+    Quat* rotations;
+    Vec3* scales;
+    Vec3* colors;
+    u32* mesh_ids;
+    u32 count, capacity;
+    u32 active_count;
+    HandleTable handles;
+};
+
+enum PropColumn : u32 {
+    PROP_COLUMN_POSITION = 1u << 0,
+    PROP_COLUMN_ROTATION = 1u << 1,
+    PROP_COLUMN_SCALE    = 1u << 2,
+    PROP_COLUMN_COLOR    = 1u << 3,
+    PROP_COLUMN_MESH     = 1u << 4
 };
 
+// Read-only columns over the active props. Arrays not asked for are null, so
+// a system states up front which components it streams.
+struct PropView {
+    u32 count;
+    const Vec3* positions;
+    const Quat* rotations;
+    const Vec3* scales;
+    const Vec3* colors;
+    const u32* mesh_ids;
+};
+
+// Grows every column (and the handle table) to capacity, keeping contents.
+// Outgrown columns stay in the arena.
+bool prop_storage_reserve(PropStorage* p, MemoryArena* arena, u32 capacity);
+// Removes all props; their handles go stale.
+void prop_storage_clear(PropStorage* p);
+// Appends a prop and returns its index, HANDLE_NONE when full.
+u32 prop_storage_add(PropStorage* p, const Transform& t, u32 mesh_id, const Vec3& color, bool active);
+// Moves the prop across the active split if needed; returns its new index.
+u32 prop_storage_set_active(PropStorage* p, u32 index, bool active);
+void prop_storage_remove(PropStorage* p, u32 index);
+PropView prop_storage_query(const PropStorage* p, u32 columns);
+
+inline bool prop_is_active(const PropStorage* p, u32 index) { return index < p->active_count; }
+
+inline Transform prop_transform(const PropStorage* p, u32 index) {
+    return { p->positions[index], p->rotations[index], p->scales[index] };
+}
+
+inline void prop_set_transform(PropStorage* p, u32 index, const Transform& t) {
+    p->positions[index] = t.position;
+    p->rotations[index] = t.rotation;
+    p->scales[index] = t.scale;
+}
+
+// World matrices of props [first, first + count), same as
+// transform_to_matrix, computed in one pass over the transform columns.
+void prop_storage_world_matrices(const PropStorage* p, u32 first, u32 count, Mat4* out);
+
 constexpr u32 MESH_CUBE = 0;
 
 }
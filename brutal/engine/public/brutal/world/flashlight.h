@@ -3,11 +3,11 @@
 
 #include "brutal/core/types.h"
 #include "brutal/math/vec.h"
+#include "brutal/renderer/light.h"
 
 namespace brutal {
 
     struct Camera;
-    struct LightEnvironment;
 
     struct FlashlightConfig {
         f32 range;
@@ -29,8 +29,7 @@ namespace brutal {
         f32 battery_level;
         f32 flicker_phase;
         f32 intensity_scale;
-        u32 spot_light_index;
-        bool spot_light_registered;
+        SpotLightHandle spot_light;  // Re-registered when the scene drops it
     };
 
     void flashlight_init(PlayerFlashlight* flashlight);
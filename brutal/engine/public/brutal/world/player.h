@@ -6,19 +6,12 @@
 #include "brutal/math/vec.h"
 #include "brutal/core/types.h"
 #include "brutal/world/flashlight.h"
+#include "brutal/world/character.h"
+#include "brutal/world/collision.h"
 
 namespace brutal {
 
 struct InputState;
-struct CollisionWorld;
-
-// Movement state for deterministic behavior
-enum class MoveState {
-    STANDING,
-    WALKING,
-    SPRINTING,
-    CROUCHING
-};
 
 struct Player {
     Camera camera;
@@ -56,6 +49,7 @@ struct Player {
     bool grounded;
     bool wants_crouch;     // Player holding crouch key
     bool is_crouched;      // Actually crouched (may differ if can't stand up)
+    CollisionCache collision_cache;  // Nearby boxes reused across fixed steps
     
     // Jump state (NEW - for edge-triggered jump with coyote time)
     bool jump_requested;   // Jump was requested this frame
@@ -75,6 +69,7 @@ struct Player {
     bool jump_request_dumped;
     const char* grounded_reason;
     f32 last_fixed_dt;
+    u32 last_boxes_tested;
     f32 last_frame_dt;
     i32 last_fixed_step_count;
     i32 fixed_step_index;
@@ -1,6 +1,7 @@
 #ifndef BRUTAL_WORLD_SCENE_H
 #define BRUTAL_WORLD_SCENE_H
 
+#include "brutal/core/handle.h"
 #include "brutal/world/brush.h"
 #include "brutal/world/entity.h"
 #include "brutal/world/collision.h"
@@ -11,27 +12,111 @@ namespace brutal {
 
 struct MemoryArena;
 
+// Initial storage; adding past it doubles the arrays in the scene arena.
 constexpr u32 MAX_BRUSHES = 256;
 constexpr u32 MAX_PROPS = 128;
+constexpr u32 WORLD_SLOT_NONE = 0xFFFFFFFFu;
+constexpr u32 WORLD_SLOT_VERTICES = 24;
+constexpr u32 WORLD_SLOT_INDICES = 36;
 
+// The brush world mesh lives in persistent GPU buffers where every visible
+// brush owns a fixed slot of 24 vertices and 36 indices. Editing a brush
+// re-emits and uploads only its slot. Slots of brushes that turned invisible
+// or were removed stay behind as degenerate triangles until a full rebuild
+// compacts them.
+struct WorldMeshSlots {
+    u32* brush_slot;       // Per brush, WORLD_SLOT_NONE when not in the mesh
+    u32* dirty;            // Brushes queued by scene_mark_brush_dirty
+    u32 dirty_count;
+    u32* retired;          // Slots of removed brushes, blanked on the next update
+    u32 retired_count;
+    u32 slot_count;        // Slots handed out, dead ones included
+    u32 slot_capacity;     // Slots the GPU buffers have room for
+    u32 dead_slots;
+    u32 table_capacity;    // Entries in brush_slot and dirty
+};
+
+using BrushHandle = Handle<Brush>;
+
+// Brushes and props are dense arrays kept contiguous by swap-remove, so an
+// index is only good until the next removal. Hold handles across frames.
 struct Scene {
+    MemoryArena* arena;  // Backs storage growth
     Brush* brushes;
     u32 brush_count, brush_capacity;
+    HandleTable brush_handles;
     Mesh world_mesh;
-    bool world_mesh_dirty;
-    PropEntity* props;
-    u32 prop_count, prop_capacity;
+    bool world_mesh_dirty;  // Forces a full rebuild
+    WorldMeshSlots world_slots;
+    PropStorage props;
     LightEnvironment lights;
     CollisionWorld collision;
+    bool merge_collision;  // Merge touching solid brushes in scene_rebuild_collision
+    // Bake option: leave out brush faces hidden by other brushes. The packed
+    // mesh has no per-brush slots, so brush edits fall back to full rebuilds.
+    bool cull_hidden_faces;
+    // Upload the world mesh as PackedVertex when the level is small enough
+    // to pack exactly on its grid (see mesh_create_dynamic_packed)
+    bool pack_world_vertices;
 };
 
 bool scene_create(Scene* s, MemoryArena* arena);
 void scene_destroy(Scene* s);
+// Removes everything; all handles into the scene go stale.
 void scene_clear(Scene* s);
+// Both add functions grow storage when full. The brush is nullptr and the
+// prop index HANDLE_NONE only when the arena is out of memory. A new brush is
+// queued for an incremental world mesh update; collision is the caller's.
 Brush* scene_add_brush(Scene* s, const Vec3& min, const Vec3& max, u32 flags, const Vec3& color);
-PropEntity* scene_add_prop(Scene* s, const Vec3& pos, const Vec3& scale, u32 mesh_id, const Vec3& color);
+u32 scene_add_prop(Scene* s, const Transform& t, u32 mesh_id, const Vec3& color, bool active = true);
+// Grows brush/prop storage (and collision capacity with it) to at least the
+// given capacities, keeping contents. Outgrown storage stays in the arena.
+bool scene_reserve(Scene* s, MemoryArena* arena, u32 brush_capacity, u32 prop_capacity);
+
+// Handle of the object currently at index; a null handle when out of range.
+BrushHandle scene_brush_handle(const Scene* s, u32 index);
+PropHandle scene_prop_handle(const Scene* s, u32 index);
+// Current index of a handle, HANDLE_NONE when the object was removed.
+u32 scene_brush_index(const Scene* s, BrushHandle h);
+u32 scene_prop_index(const Scene* s, PropHandle h);
+Brush* scene_get_brush(Scene* s, BrushHandle h);
+// Swap-remove: the last object takes the removed one's index (for props, after
+// the active split was kept; see PropStorage). A removed brush's world mesh
+// slot is retired on the next update; collision is the caller's to rebuild.
+bool scene_remove_brush(Scene* s, BrushHandle h);
+bool scene_remove_prop(Scene* s, PropHandle h);
+// Grows only the per-brush world mesh tables, for brush storage owned elsewhere.
+bool scene_reserve_world_slots(Scene* s, MemoryArena* arena, u32 brush_capacity);
+
+// Queues one brush for an incremental world mesh update after its bounds,
+// colors or flags changed. Falls back to a full rebuild when the queue is full.
+void scene_mark_brush_dirty(Scene* s, u32 brush);
+
+// Full rebuild when world_mesh_dirty is set, otherwise uploads the queued
+// brushes with range updates. Compacts once a quarter of the slots are dead.
 void scene_rebuild_world_mesh(Scene* s, MemoryArena* temp);
+// Uploads prebuilt geometry (scene_build_world_geometry layout) as the world
+// mesh and hands out slots to visible brushes in order.
+void scene_upload_world_mesh(Scene* s, const Vertex* verts, u32 vertex_count, const u32* indices, u32 index_count);
 void scene_rebuild_collision(Scene* s);
+// Patches collision for the listed brushes only: their boxes (merged boxes
+// included) are dropped and rebuilt from the current brushes. Indices at or
+// past brush_count name brushes removed from the end. A swap-remove renumbers
+// a brush, so after one rebuild instead. False when temp ran out.
+bool scene_update_collision(Scene* s, const u32* brushes, u32 count, MemoryArena* temp);
+
+// CPU halves of the two rebuilds above, shared with the scene baker.
+// Geometry arrays come from temp; both counts are 0 when nothing is visible.
+bool scene_build_world_geometry(const Scene* s, MemoryArena* temp,
+    Vertex** verts, u32* vertex_count, u32** indices, u32* index_count);
+void scene_build_collision(const Scene* s, CollisionWorld* w);
+
+// Up to max visible brushes worth rasterizing as occluders from eye, largest
+// rough solid angle first. Brushes outside the view_projection frustum, or
+// too small or far to hide much, are left out. Scores come from temp;
+// returns the boxes written.
+u32 scene_select_occluders(const Scene* s, const Vec3& eye, const Mat4& view_projection, AABB* out, u32 max,
+    MemoryArena* temp);
 
 }
 
@@ -0,0 +1,49 @@
+#ifndef BRUTAL_WORLD_SCENE_BINARY_H
+#define BRUTAL_WORLD_SCENE_BINARY_H
+
+#include "brutal/core/file.h"
+#include "brutal/world/scene.h"
+#include "brutal/world/scene_io.h"
+
+namespace brutal {
+
+// =============================================================================
+// Baked binary scene (.bscene)
+// =============================================================================
+// A snapshot of everything startup would otherwise derive from brushes:
+// brushes, prop columns and lights as plain arrays, the world mesh vertex/index
+// buffers and the (merged) collision boxes. Loading maps the file
+// copy-on-write and points the scene straight into it, so there is no parsing
+// and no copying; only the GL upload is left.
+//
+// Files are tied to the struct layout of the build that baked them. A version
+// or layout mismatch is rejected and the caller falls back to the JSON source.
+constexpr u32 BSCENE_MAGIC = 0x4E435342u;  // "BSCN"
+constexpr u32 BSCENE_VERSION = 3;
+
+struct SceneBinary {
+    FileMapping mapping;
+    const Vertex* vertices;
+    u32 vertex_count;
+    const u32* indices;
+    u32 index_count;
+};
+
+// Writes the scene with freshly built geometry and collision. temp is used
+// for the geometry and is not reset.
+bool scene_bake_binary(const Scene* scene, const SceneSpawn* spawn, const char* path, MemoryArena* temp);
+
+// Replaces the scene contents with the baked file. Brush, prop and collision
+// storage then lives in out->mapping, which must stay open while the scene
+// uses it; edits are fine and adding moves the arrays into the scene arena.
+// arena supplies the handle and per-brush world mesh tables. On failure the
+// scene and spawn are untouched.
+bool scene_load_binary(Scene* scene, SceneSpawn* spawn, const char* path, MemoryArena* arena, SceneBinary* out);
+
+// Creates the world mesh from the baked buffers.
+void scene_binary_upload(Scene* scene, const SceneBinary* bin);
+void scene_binary_close(SceneBinary* bin);
+
+}
+
+#endif
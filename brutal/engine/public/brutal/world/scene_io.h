@@ -3,6 +3,7 @@
 
 #include "brutal/core/types.h"
 #include "brutal/world/scene.h"
+#include <cstddef>
 
 namespace brutal {
 
@@ -12,8 +13,17 @@ namespace brutal {
         f32 pitch;
     };
 
+    // Replaces the scene contents with the file. Brush and prop storage grows
+    // from arena as needed; spawn is only written when the file has one.
+    // A missing file leaves the scene empty and still succeeds.
     bool scene_load_from_json(Scene* scene, SceneSpawn* spawn, const char* path, MemoryArena* arena);
 
+    // Same, from a buffer already in memory. name is used in log messages.
+    bool scene_load_from_json_buffer(Scene* scene, SceneSpawn* spawn, const char* data, size_t size,
+        const char* name, MemoryArena* arena);
+
+    bool scene_save_to_json(const Scene* scene, const SceneSpawn* spawn, const char* path);
+
 }
 
 #endif
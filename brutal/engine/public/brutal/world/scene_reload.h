@@ -0,0 +1,57 @@
+#ifndef BRUTAL_WORLD_SCENE_RELOAD_H
+#define BRUTAL_WORLD_SCENE_RELOAD_H
+
+#include "brutal/core/file.h"
+#include "brutal/world/scene.h"
+#include "brutal/world/scene_io.h"
+
+namespace brutal {
+
+// =============================================================================
+// Scene diff
+// =============================================================================
+// Objects are matched by index: a file lists brushes, props and lights in
+// storage order, so an edit shows up as a changed entry and additions or
+// deletions as a longer or shorter tail. Changed entries are overwritten in
+// place and keep their handles.
+struct SceneDiffStats {
+    u32 brushes_changed, brushes_added, brushes_removed;
+    u32 props_changed, props_added, props_removed;
+    u32 lights_changed, lights_added, lights_removed;
+    bool collision_rebuilt;    // Incremental patch ran out of temp memory
+};
+
+inline u32 scene_diff_total(const SceneDiffStats& d) {
+    return d.brushes_changed + d.brushes_added + d.brushes_removed + d.props_changed + d.props_added +
+        d.props_removed + d.lights_changed + d.lights_added + d.lights_removed;
+}
+
+// Makes live equal to src. Only the brushes that differ are queued for the
+// world mesh and patched in collision. Live lights at or past point_base and
+// spot_base were added at runtime (the flashlight) and are dropped; their
+// owners re-register them. Storage is reserved before anything changes, so a
+// false return (out of memory) leaves live untouched.
+bool scene_apply_diff(Scene* live, const Scene* src, u32 point_base, u32 spot_base, MemoryArena* temp,
+    SceneDiffStats* out);
+
+// =============================================================================
+// Hot reload
+// =============================================================================
+struct SceneReloader {
+    FileWatch watch;
+    u32 point_lights, spot_lights;   // Lights that came from the file
+};
+
+// scene must hold what was just loaded from path.
+bool scene_reloader_open(SceneReloader* r, const char* path, const Scene* scene);
+void scene_reloader_close(SceneReloader* r);
+// True when the file was written since the last poll.
+bool scene_reloader_poll(SceneReloader* r);
+// Parses the file into a staging scene in temp and applies the diff. A
+// missing or malformed file leaves the scene as it is. spawn is updated when
+// the file has one; moving the player is up to the caller.
+bool scene_reload(SceneReloader* r, Scene* scene, SceneSpawn* spawn, MemoryArena* temp, SceneDiffStats* out);
+
+}
+
+#endif
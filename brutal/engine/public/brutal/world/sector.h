@@ -0,0 +1,87 @@
+#ifndef BRUTAL_WORLD_SECTOR_H
+#define BRUTAL_WORLD_SECTOR_H
+
+#include "brutal/world/scene.h"
+#include "brutal/world/scene_io.h"
+#include <cstddef>
+
+namespace brutal {
+
+// =============================================================================
+// Sectors
+// =============================================================================
+// A level baked for streaming is cut into square sectors on a uniform XZ grid.
+// Brushes (by bounds center), props and lights go to the sector containing
+// them, and every non-empty sector is baked as its own .bscene: its own
+// brush/prop/light arrays, world mesh chunk and collision boxes. Faces are
+// only culled and boxes only merged within a sector. A manifest (.bsectors)
+// lists the sectors with their bounds and memory cost; sector files sit next
+// to it as <manifest>.<index>.
+constexpr u32 BSECTORS_MAGIC = 0x43455342u;  // "BSEC"
+constexpr u32 BSECTORS_VERSION = 1;
+
+struct SectorInfo {
+    i32 cell_x, cell_z;
+    AABB bounds;            // Everything in the sector, for distance checks
+    u64 file_size;
+    u32 brush_count, prop_count, point_light_count, spot_light_count;
+};
+
+// Bakes scene into a manifest plus one file per sector. temp holds the
+// per-sector lists; each sector is built in a scratch arena of its own.
+bool scene_bake_sectors(const Scene* scene, const SceneSpawn* spawn, const char* manifest_path,
+    f32 sector_size, MemoryArena* temp);
+
+// =============================================================================
+// Streaming
+// =============================================================================
+// Keeps the sectors around a viewer resident. Loading (map, validate, build
+// tables) runs on a background thread; the main thread only uploads finished
+// world mesh chunks and frees sectors that fell out of range. Resident
+// sectors are combined into one collision world and one light environment,
+// rebuilt whenever the resident set changes.
+struct SectorStreamConfig {
+    f32 load_radius;        // Sectors whose bounds come this close are wanted
+    f32 unload_radius;      // Wanted sectors stay until farther than this
+    size_t memory_budget;   // Mapped files plus sector arenas; 0 = unlimited
+    bool upload_meshes;     // False for headless tools without a GL context
+};
+
+struct SectorStreamStats {
+    u32 sector_count;
+    u32 resident, pending;  // pending = queued or loading
+    size_t resident_bytes;
+    u32 loads, unloads;
+    u32 over_budget;        // Wanted sectors left out by the budget last update
+};
+
+struct SectorStreamerState;
+
+struct SectorStreamer {
+    SectorStreamConfig config;
+    SceneSpawn spawn;
+    CollisionWorld collision;   // Boxes of resident sectors; no source ids
+    LightEnvironment lights;    // Lights of resident sectors, manifest ambient
+    Scene* const* resident;     // Resident sector scenes, for drawing
+    u32 resident_count;
+    SectorStreamStats stats;
+    SectorStreamerState* state;
+};
+
+SectorStreamConfig sector_stream_config_default();
+
+// Reads the manifest and starts the loader thread; nothing is loaded yet.
+// arena backs the combined light environment.
+bool sector_streamer_open(SectorStreamer* st, const char* manifest_path, const SectorStreamConfig& config,
+    MemoryArena* arena);
+void sector_streamer_close(SectorStreamer* st);
+// Main thread, once per frame. Queues loads nearest first, uploads sectors
+// the loader finished and unloads the rest. Returns true when the resident
+// set, and with it collision and lights, changed.
+bool sector_streamer_update(SectorStreamer* st, const Vec3& viewer);
+// Blocks until the loader is idle, then applies its results like an update.
+bool sector_streamer_flush(SectorStreamer* st, const Vec3& viewer);
+
+}
+
+#endif
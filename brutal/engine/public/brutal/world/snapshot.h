@@ -0,0 +1,55 @@
+#ifndef BRUTAL_WORLD_SNAPSHOT_H
+#define BRUTAL_WORLD_SNAPSHOT_H
+
+#include "brutal/world/scene.h"
+#include "brutal/world/player.h"
+#include <cstddef>
+
+namespace brutal {
+
+// =============================================================================
+// Simulation snapshots
+// =============================================================================
+// The complete simulation state in one contiguous buffer: scene brushes, prop
+// columns, lights, collision boxes and the handle tables behind them, plus
+// the player with its movement state. Every section is a straight memcpy of
+// the live arrays, so capture and restore cost little more than copying the
+// bytes. Restoring keeps handles valid and queues only the brushes that
+// differ for the world mesh.
+//
+// Layouts are those of the running build. Saved files are rejected by
+// another build rather than converted.
+constexpr u32 SNAPSHOT_MAGIC = 0x50414E53u;  // "SNAP"
+constexpr u32 SNAPSHOT_VERSION = 1;
+
+struct Snapshot {
+    u8* data;              // Heap buffer, reused by later captures
+    size_t size, capacity;
+};
+
+// Bytes a capture of this state takes.
+size_t snapshot_size(const Scene* scene, const Player* player);
+bool snapshot_capture(Snapshot* snap, const Scene* scene, const Player* player);
+// Scene storage grows from its arena when the snapshot holds more than fits.
+// False (with the state untouched) for a malformed or foreign snapshot.
+bool snapshot_restore(const Snapshot* snap, Scene* scene, Player* player);
+void snapshot_free(Snapshot* snap);
+
+// Quick-save files. Compressed files store the snapshot as zero-word runs,
+// which suits the sparse handle tables and flag fields well.
+bool snapshot_save(const Snapshot* snap, const char* path, bool compress);
+bool snapshot_load(Snapshot* snap, const char* path);
+
+// =============================================================================
+// Compression
+// =============================================================================
+// Word-level run-length coding of zeros. With a base of the same size, words
+// are XORed with it first, so a snapshot taken shortly after another one
+// shrinks to little more than what changed. Sizes are multiples of 4.
+size_t snapshot_compress_bound(size_t size);
+size_t snapshot_compress(const u8* data, size_t size, const u8* base, u8* out);
+bool snapshot_decompress(const u8* in, size_t in_size, const u8* base, u8* out, size_t size);
+
+}
+
+#endif
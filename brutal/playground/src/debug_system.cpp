@@ -105,6 +105,8 @@ namespace brutal {
         system->show_player_bounds = false;
         system->show_console = false;
         system->reload_requested = false;
+        system->quicksave_requested = false;
+        system->quickload_requested = false;
     }
 
     void debug_system_update(DebugSystem* system, const InputState* input) {
@@ -115,6 +117,8 @@ namespace brutal {
         if (platform_key_pressed(input, KEY_F5)) system->show_lights = !system->show_lights;
         if (platform_key_pressed(input, KEY_F6)) system->show_player_bounds = !system->show_player_bounds;
         if (platform_key_pressed(input, KEY_F7)) system->reload_requested = true;
+        if (platform_key_pressed(input, KEY_F8)) system->quicksave_requested = true;
+        if (platform_key_pressed(input, KEY_F11)) system->quickload_requested = true;
         if (platform_key_pressed(input, KEY_GRAVE)) system->show_console = !system->show_console;
     }
 
@@ -133,6 +137,18 @@ namespace brutal {
         return requested;
     }
 
+    bool debug_system_consume_quicksave(DebugSystem* system) {
+        bool requested = system->quicksave_requested;
+        system->quicksave_requested = false;
+        return requested;
+    }
+
+    bool debug_system_consume_quickload(DebugSystem* system) {
+        bool requested = system->quickload_requested;
+        system->quickload_requested = false;
+        return requested;
+    }
+
     void debug_system_draw(const DebugSystem* system,
         const DebugFrameInfo& frame,
         const InputState* input,
@@ -182,6 +198,10 @@ namespace brutal {
                 player->fixed_step_index);
             draw_line(y, white, "WishDir: (%.2f, %.2f, %.2f)",
                 player->wish_dir.x, player->wish_dir.y, player->wish_dir.z);
+            const CollisionCache& cache = player->collision_cache;
+            draw_line(y, white, "Contact Cache: %.1f%% hit, %u boxes, %llu refills, %llu fallbacks",
+                collision_cache_hit_rate(&cache) * 100.0f, cache.valid ? cache.count : 0u,
+                (unsigned long long)cache.refills, (unsigned long long)cache.fallbacks);
             if (input) {
                 const bool w = platform_key_down(input, KEY_W);
                 const bool a = platform_key_down(input, KEY_A);
@@ -232,8 +252,22 @@ namespace brutal {
         if (system->show_render) {
             draw_header(y, green, "Render Stats");
             draw_line(y, white, "Draw Calls: %u", renderer_draw_calls(renderer));
+            draw_line(y, white, "State Changes: programs %u, VAOs %u, uniforms %u, light uploads %u",
+                renderer_program_binds(renderer), renderer_vao_binds(renderer), renderer_uniform_uploads(renderer),
+                renderer_light_uploads(renderer));
+            const LightClusters* clusters = renderer_light_clusters(renderer);
+            draw_line(y, white, "Light Clusters: %u lights, %u froxel refs, %u full",
+                clusters->light_count, clusters->index_count, clusters->full_clusters);
+            draw_line(y, white, "Object Lights: %u draws, %.2f lights each", renderer_object_light_draws(renderer),
+                renderer_average_object_lights(renderer));
+            StreamStats stream = stream_buffers_last_frame();
+            const OcclusionStats* occlusion = renderer_occlusion_stats(renderer);
+            draw_line(y, white, "Occlusion: %u occluders, %u/%u culled, %.2f ms", occlusion->occluders,
+                occlusion->culled, occlusion->tested, occlusion->raster_ms);
+            draw_line(y, white, "Streamed: %.1f KB, %u stalls", (f32)stream.bytes / 1024.0f, stream.stalls);
             draw_line(y, white, "Triangles: %u", renderer_triangles(renderer));
-            draw_line(y, white, "Vertices: %u", renderer_vertices(renderer));
+            draw_line(y, white, "Vertices: %u (%.2f MB)", renderer_vertices(renderer),
+                (f64)renderer_vertex_bytes(renderer) / (1024.0 * 1024.0));
             if (collision) {
                 draw_line(y, white, "Collision Boxes: %u", collision->box_count);
             }
@@ -270,7 +304,7 @@ namespace brutal {
         }
 
         debug_text_printf(10, screen_h - 40, yellow,
-            "F1 Debug  F2 Perf  F3 Render  F4 Collision  F5 Lights  F6 Bounds  F7 Reload  ` Console");
+            "F1 Debug  F2 Perf  F3 Render  F4 Collision  F5 Lights  F6 Bounds  F7 Reload  F8/F11 Quick save/load  ` Console");
     }
 
 }
\ No newline at end of file
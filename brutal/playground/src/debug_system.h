@@ -27,6 +27,8 @@ namespace brutal {
         bool show_player_bounds;
         bool show_console;
         bool reload_requested;
+        bool quicksave_requested;
+        bool quickload_requested;
     };
 
     void debug_system_init(DebugSystem* system);
@@ -44,6 +46,8 @@ namespace brutal {
     bool debug_system_show_collision(const DebugSystem* system);
     bool debug_system_has_world_lines(const DebugSystem* system);
     bool debug_system_consume_reload(DebugSystem* system);
+    bool debug_system_consume_quicksave(DebugSystem* system);
+    bool debug_system_consume_quickload(DebugSystem* system);
 
 }
 
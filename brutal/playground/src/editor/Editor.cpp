@@ -11,12 +11,18 @@
 #include "editor/Panels/Panel_hierarchy.h"
 #include "editor/Panels/Panel_inspector.h"
 
+#include "brutal/math/quat.h"
+#include "brutal/world/entity.h"
+
 #include <ImGuizmo.h>
 #include <glad/glad.h>
 #include <imgui.h>
 #include <imgui_impl_opengl3.h>
 #include <imgui_impl_win32.h>
 
+#include <algorithm>
+#include <cstring>
+
 #ifdef _WIN32
 #include <windows.h>
 #endif
@@ -27,10 +33,13 @@ namespace brutal {
         return ImGui_ImplWin32_WndProcHandler(static_cast<HWND>(hwnd), msg, wparam, lparam);
     }
 
-    void editor_init(EditorContext* ctx, PlatformState* platform) {
+    void editor_init(EditorContext* ctx, PlatformState* platform, MemoryArena* arena) {
         if (!ctx || !platform) return;
         *ctx = {};
 
+        // About 2.8 MB: a drag is one delta per field per selected object
+        editor_history_init(&ctx->history, arena, 4096, 65536);
+
         IMGUI_CHECKVERSION();
         ImGui::CreateContext();
         ImGuiIO& io = ImGui::GetIO();
@@ -95,12 +104,128 @@ namespace brutal {
         ImGuizmo::BeginFrame();
     }
 
+    namespace {
+
+        void editor_delete_selection(EditorContext* ctx, Scene* scene) {
+            for (const EditorSelectionItem& item : ctx->selection) {
+                switch (item.type) {
+                case EditorSelectionType::Brush:
+                    if (scene_remove_brush(scene, handle_cast<Brush>(item.handle))) {
+                        ctx->rebuild_world = true;
+                        ctx->rebuild_collision = true;
+                    }
+                    break;
+                case EditorSelectionType::Prop:
+                    scene_remove_prop(scene, handle_cast<Prop>(item.handle));
+                    break;
+                case EditorSelectionType::Light:
+                    light_environment_remove_point(&scene->lights, handle_cast<PointLight>(item.handle));
+                    break;
+                default:
+                    break;
+                }
+            }
+            ctx->selection.clear();
+            ctx->selection_type = EditorSelectionType::None;
+            ctx->selection_handle = EditorHandle{};
+        }
+
+        bool editor_transform_valid(const Scene* scene, EditorSelectionType type, u32 index) {
+            switch (type) {
+            case EditorSelectionType::Brush:
+                return index < scene->brush_count;
+            case EditorSelectionType::Prop:
+                return index < scene->props.count;
+            case EditorSelectionType::Light:
+                return index < scene->lights.point_light_count;
+            default:
+                return false;
+            }
+        }
+
+        EditorSelectionType editor_field_type(EditorField field) {
+            switch (field) {
+            case EditorField::BrushMin:
+            case EditorField::BrushMax:
+                return EditorSelectionType::Brush;
+            case EditorField::PropPosition:
+            case EditorField::PropRotation:
+            case EditorField::PropScale:
+                return EditorSelectionType::Prop;
+            default:
+                return EditorSelectionType::Light;
+            }
+        }
+
+        // Address and float count of a field of the object at index
+        f32* editor_field_data(Scene* scene, EditorField field, u32 index, u32* count) {
+            *count = 3;
+            switch (field) {
+            case EditorField::BrushMin: return &scene->brushes[index].min.x;
+            case EditorField::BrushMax: return &scene->brushes[index].max.x;
+            case EditorField::PropPosition: return &scene->props.positions[index].x;
+            case EditorField::PropRotation: *count = 4; return &scene->props.rotations[index].x;
+            case EditorField::PropScale: return &scene->props.scales[index].x;
+            case EditorField::LightPosition: return &scene->lights.point_lights[index].position.x;
+            case EditorField::LightRotation: return &scene->lights.point_lights[index].rotation.x;
+            case EditorField::LightScale: return &scene->lights.point_lights[index].scale.x;
+            }
+            return nullptr;
+        }
+
+        void editor_write_field(EditorContext* ctx, Scene* scene, EditorField field, u32 index, const f32* values) {
+            u32 count = 0;
+            f32* data = editor_field_data(scene, field, index, &count);
+            memcpy(data, values, sizeof(f32) * count);
+            if (editor_field_type(field) == EditorSelectionType::Brush) {
+                scene_mark_brush_dirty(scene, index);
+                ctx->rebuild_world = true;
+                ctx->rebuild_collision = true;
+            }
+        }
+
+        // Writes the field and records it if the value changes
+        void editor_edit_field(EditorContext* ctx, Scene* scene, EditorField field, u32 index, const f32* values) {
+            u32 count = 0;
+            const f32* data = editor_field_data(scene, field, index, &count);
+            if (!memcmp(data, values, sizeof(f32) * count)) return;
+            f32 before[4];
+            memcpy(before, data, sizeof(f32) * count);
+            editor_history_record(&ctx->history, field, editor_selection_handle(scene, editor_field_type(field), index),
+                before, values, count);
+            editor_write_field(ctx, scene, field, index, values);
+        }
+
+        void editor_apply_entry(EditorContext* ctx, Scene* scene, const EditorHistoryEntry* entry, bool undo) {
+            for (u32 i = 0; i < entry->delta_count; ++i) {
+                u64 position = entry->first_delta + (undo ? entry->delta_count - 1 - i : i);
+                const EditorDelta* delta = editor_history_delta(&ctx->history, position);
+                // Objects deleted since are skipped
+                u32 index = editor_selection_index(scene, editor_field_type(delta->field), delta->handle);
+                if (index == HANDLE_NONE) continue;
+                editor_write_field(ctx, scene, delta->field, index, undo ? delta->before : delta->after);
+            }
+        }
+
+    }
+
     void editor_update(EditorContext* ctx, Scene* scene, PlatformState* platform, f32 dt) {
         if (!ctx || !scene || !platform || !ctx->active) return;
         editor_input_update(ctx, platform);
         editor_camera_update(ctx, platform, dt);
         editor_gizmo_handle_input(ctx, platform);
-        (void)scene;
+        if (ctx->delete_requested) {
+            ctx->delete_requested = false;
+            editor_delete_selection(ctx, scene);
+        }
+        if (ctx->undo_requested) {
+            ctx->undo_requested = false;
+            editor_undo(ctx, scene);
+        }
+        if (ctx->redo_requested) {
+            ctx->redo_requested = false;
+            editor_redo(ctx, scene);
+        }
     }
 
     void editor_build_ui(EditorContext* ctx, Scene* scene, PlatformState* platform) {
@@ -153,6 +278,135 @@ namespace brutal {
         }
     }
 
+    u32 editor_selection_index(const Scene* scene, EditorSelectionType type, EditorHandle handle) {
+        switch (type) {
+        case EditorSelectionType::Brush:
+            return scene_brush_index(scene, handle_cast<Brush>(handle));
+        case EditorSelectionType::Prop:
+            return scene_prop_index(scene, handle_cast<Prop>(handle));
+        case EditorSelectionType::Light:
+            return light_environment_point_index(&scene->lights, handle_cast<PointLight>(handle));
+        default:
+            return HANDLE_NONE;
+        }
+    }
+
+    EditorHandle editor_selection_handle(const Scene* scene, EditorSelectionType type, u32 index) {
+        switch (type) {
+        case EditorSelectionType::Brush:
+            return handle_cast<void>(scene_brush_handle(scene, index));
+        case EditorSelectionType::Prop:
+            return handle_cast<void>(scene_prop_handle(scene, index));
+        case EditorSelectionType::Light:
+            return handle_cast<void>(light_environment_point_handle(&scene->lights, index));
+        default:
+            return EditorHandle{};
+        }
+    }
+
+    bool editor_get_transform(const Scene* scene, EditorSelectionType type, u32 index, Transform* out) {
+        if (!editor_transform_valid(scene, type, index)) return false;
+        if (type == EditorSelectionType::Prop) {
+            if (out) *out = prop_transform(&scene->props, index);
+            return true;
+        }
+        if (type == EditorSelectionType::Brush) {
+            const Brush& brush = scene->brushes[index];
+            AABB bounds = brush_to_aabb(&brush);
+            if (out) {
+                out->position = aabb_center(bounds);
+                out->rotation = quat_identity();
+                out->scale = aabb_half_size(bounds) * 2.0f;
+            }
+            return true;
+        }
+        if (type == EditorSelectionType::Light) {
+            const PointLight& light = scene->lights.point_lights[index];
+            if (out) {
+                out->position = light.position;
+                out->rotation = quat_from_euler_radians(light.rotation);
+                out->scale = light.scale;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void editor_set_transform(EditorContext* ctx, Scene* scene, EditorSelectionType type, u32 index, const Transform& transform) {
+        if (!ctx || !editor_transform_valid(scene, type, index)) return;
+        if (type == EditorSelectionType::Prop) {
+            Vec3 scale = transform.scale;
+            scale.x = std::max(scale.x, 0.05f);
+            scale.y = std::max(scale.y, 0.05f);
+            scale.z = std::max(scale.z, 0.05f);
+            editor_edit_field(ctx, scene, EditorField::PropPosition, index, &transform.position.x);
+            editor_edit_field(ctx, scene, EditorField::PropRotation, index, &transform.rotation.x);
+            editor_edit_field(ctx, scene, EditorField::PropScale, index, &scale.x);
+            return;
+        }
+        if (type == EditorSelectionType::Brush) {
+            Vec3 size = transform.scale;
+            size.x = std::max(size.x, 0.1f);
+            size.y = std::max(size.y, 0.1f);
+            size.z = std::max(size.z, 0.1f);
+            Vec3 half = size * 0.5f;
+            Vec3 min = transform.position - half;
+            Vec3 max = transform.position + half;
+            editor_edit_field(ctx, scene, EditorField::BrushMin, index, &min.x);
+            editor_edit_field(ctx, scene, EditorField::BrushMax, index, &max.x);
+            return;
+        }
+        if (type == EditorSelectionType::Light) {
+            Vec3 rotation = quat_to_euler_radians(transform.rotation);
+            editor_edit_field(ctx, scene, EditorField::LightPosition, index, &transform.position.x);
+            editor_edit_field(ctx, scene, EditorField::LightRotation, index, &rotation.x);
+            editor_edit_field(ctx, scene, EditorField::LightScale, index, &transform.scale.x);
+            return;
+        }
+    }
+
+    void editor_transform_selection(EditorContext* ctx, Scene* scene, const Transform& before, const Transform& after) {
+        if (!ctx || !scene) return;
+        u32 primary = editor_selection_index(scene, ctx->selection_type, ctx->selection_handle);
+        editor_set_transform(ctx, scene, ctx->selection_type, primary, after);
+
+        Vec3 offset = after.position - before.position;
+        bool rotated = memcmp(&before.rotation, &after.rotation, sizeof(Quat)) != 0;
+        bool scaled = memcmp(&before.scale, &after.scale, sizeof(Vec3)) != 0;
+        Quat spin = quat_multiply(after.rotation,
+            Quat{ -before.rotation.x, -before.rotation.y, -before.rotation.z, before.rotation.w });
+        for (const EditorSelectionItem& item : ctx->selection) {
+            if (item.type == ctx->selection_type && item.handle == ctx->selection_handle) continue;
+            u32 index = editor_selection_index(scene, item.type, item.handle);
+            Transform t;
+            if (!editor_get_transform(scene, item.type, index, &t)) continue;
+            t.position = t.position + offset;
+            if (rotated) t.rotation = quat_normalize(quat_multiply(spin, t.rotation));
+            if (scaled) {
+                if (before.scale.x != 0.0f) t.scale.x *= after.scale.x / before.scale.x;
+                if (before.scale.y != 0.0f) t.scale.y *= after.scale.y / before.scale.y;
+                if (before.scale.z != 0.0f) t.scale.z *= after.scale.z / before.scale.z;
+            }
+            editor_set_transform(ctx, scene, item.type, index, t);
+        }
+    }
+
+    bool editor_undo(EditorContext* ctx, Scene* scene) {
+        if (!ctx || !scene) return false;
+        const EditorHistoryEntry* entry = editor_history_undo(&ctx->history);
+        if (!entry) return false;
+        editor_apply_entry(ctx, scene, entry, true);
+        return true;
+    }
+
+    bool editor_redo(EditorContext* ctx, Scene* scene) {
+        if (!ctx || !scene) return false;
+        const EditorHistoryEntry* entry = editor_history_redo(&ctx->history);
+        if (!entry) return false;
+        editor_apply_entry(ctx, scene, entry, false);
+        return true;
+    }
+
     bool editor_scene_needs_rebuild(const EditorContext* ctx) {
         return ctx && (ctx->rebuild_world || ctx->rebuild_collision);
     }
@@ -163,4 +417,10 @@ namespace brutal {
         ctx->rebuild_collision = false;
     }
 
+    bool editor_consume_save_request(EditorContext* ctx) {
+        if (!ctx || !ctx->save_requested) return false;
+        ctx->save_requested = false;
+        return true;
+    }
+
 }
@@ -2,11 +2,13 @@
 #define PLAYGROUND_EDITOR_EDITOR_H
 
 #include "brutal/core/types.h"
+#include "brutal/core/handle.h"
 #include "brutal/core/platform.h"
 #include "brutal/renderer/camera.h"
 #include "brutal/renderer/renderer.h"
 #include "brutal/world/scene.h"
 #include "brutal/world/player.h"
+#include "editor/Editor_history.h"
 
 #include <vector>
 
@@ -27,9 +29,13 @@ namespace brutal {
         Light
     };
 
+    // Selections hold handles, not indices, so they survive removals that
+    // reorder the scene arrays. The handle is cast back by type.
+    using EditorHandle = Handle<void>;
+
     struct EditorSelectionItem {
         EditorSelectionType type;
-        u32 index;
+        EditorHandle handle;
     };
 
     struct EditorGizmoState {
@@ -64,12 +70,19 @@ namespace brutal {
         f32 look_sensitivity;
 
         EditorSelectionType selection_type;
-        u32 selection_index;
+        EditorHandle selection_handle;
         std::vector<EditorSelectionItem> selection;
 
         bool show_grid;
         bool rebuild_world;
         bool rebuild_collision;
+        bool save_requested;
+        bool delete_requested;
+        bool undo_requested;
+        bool redo_requested;
+
+        EditorHistory history;
+        bool inspector_editing;
 
         EditorGizmoState gizmo;
 
@@ -81,7 +94,7 @@ namespace brutal {
         f32 snap_scale_value;
     };
 
-    void editor_init(EditorContext* ctx, PlatformState* platform);
+    void editor_init(EditorContext* ctx, PlatformState* platform, MemoryArena* arena);
     void editor_shutdown(EditorContext* ctx);
     void editor_set_active(EditorContext* ctx, bool active, PlatformState* platform, Player* player);
 
@@ -91,8 +104,24 @@ namespace brutal {
     void editor_render_scene(EditorContext* ctx, Scene* scene, RendererState* renderer);
     void editor_end_frame(EditorContext* ctx, const PlatformState* platform);
 
+    // Current index of a selected object, HANDLE_NONE once it was removed.
+    u32 editor_selection_index(const Scene* scene, EditorSelectionType type, EditorHandle handle);
+    EditorHandle editor_selection_handle(const Scene* scene, EditorSelectionType type, u32 index);
+
+    // Transforms as the gizmo and inspector see them. Setting one records
+    // the fields it changes in the history.
+    bool editor_get_transform(const Scene* scene, EditorSelectionType type, u32 index, Transform* out);
+    void editor_set_transform(EditorContext* ctx, Scene* scene, EditorSelectionType type, u32 index, const Transform& transform);
+    // Moves the whole selection by the change from before to after of the
+    // primary selection, which is set to after.
+    void editor_transform_selection(EditorContext* ctx, Scene* scene, const Transform& before, const Transform& after);
+
+    bool editor_undo(EditorContext* ctx, Scene* scene);
+    bool editor_redo(EditorContext* ctx, Scene* scene);
+
     bool editor_scene_needs_rebuild(const EditorContext* ctx);
     void editor_clear_rebuild_flag(EditorContext* ctx);
+    bool editor_consume_save_request(EditorContext* ctx);
 
 }
 
@@ -0,0 +1,130 @@
+#include "editor/Editor_history.h"
+
+#include "brutal/core/logging.h"
+#include "brutal/core/memory.h"
+
+#include <cstring>
+
+namespace brutal {
+
+    namespace {
+
+        EditorHistoryEntry* editor_history_entry(EditorHistory* h, u64 position) {
+            return &h->entries[position % h->entry_capacity];
+        }
+
+        void editor_history_drop_oldest(EditorHistory* h) {
+            h->entry_begin++;
+            if (h->entry_cursor < h->entry_begin) h->entry_cursor = h->entry_begin;
+        }
+
+        // Starts an entry at the cursor, dropping anything that could be redone
+        void editor_history_start_entry(EditorHistory* h) {
+            u64 first = h->delta_end;
+            if (h->entry_cursor > h->entry_begin) {
+                const EditorHistoryEntry* last = editor_history_entry(h, h->entry_cursor - 1);
+                first = last->first_delta + last->delta_count;
+            }
+            h->entry_end = h->entry_cursor;
+            if (h->entry_end - h->entry_begin == h->entry_capacity) editor_history_drop_oldest(h);
+            EditorHistoryEntry* entry = editor_history_entry(h, h->entry_end);
+            entry->first_delta = first;
+            entry->delta_count = 0;
+            h->delta_end = first;
+            h->entry_end++;
+            h->entry_cursor = h->entry_end;
+        }
+
+    }
+
+    bool editor_history_init(EditorHistory* h, MemoryArena* arena, u32 entry_capacity, u32 delta_capacity) {
+        *h = {};
+        if (!arena || entry_capacity == 0 || delta_capacity == 0) return false;
+        h->entries = arena_alloc_array<EditorHistoryEntry>(arena, entry_capacity);
+        h->deltas = arena_alloc_array<EditorDelta>(arena, delta_capacity);
+        if (!h->entries || !h->deltas) {
+            LOG_ERROR("Editor history: out of memory");
+            *h = {};
+            return false;
+        }
+        h->entry_capacity = entry_capacity;
+        h->delta_capacity = delta_capacity;
+        return true;
+    }
+
+    void editor_history_clear(EditorHistory* h) {
+        h->entry_begin = h->entry_cursor = h->entry_end;
+        h->open_entry = false;
+    }
+
+    void editor_history_begin(EditorHistory* h) {
+        h->open = true;
+        h->open_entry = false;
+    }
+
+    void editor_history_end(EditorHistory* h) {
+        h->open = false;
+        h->open_entry = false;
+    }
+
+    void editor_history_record(EditorHistory* h, EditorField field, Handle<void> handle, const f32* before,
+        const f32* after, u32 count) {
+        if (!h->deltas || count > 4) return;
+
+        if (h->open && h->open_entry && h->entry_cursor > h->entry_begin) {
+            const EditorHistoryEntry* entry = editor_history_entry(h, h->entry_cursor - 1);
+            for (u32 i = 0; i < entry->delta_count; ++i) {
+                EditorDelta* delta = &h->deltas[(entry->first_delta + i) % h->delta_capacity];
+                if (delta->field == field && delta->handle == handle) {
+                    memcpy(delta->after, after, sizeof(f32) * count);
+                    return;
+                }
+            }
+        }
+        else {
+            editor_history_start_entry(h);
+            h->open_entry = h->open;
+        }
+
+        EditorHistoryEntry* entry = editor_history_entry(h, h->entry_cursor - 1);
+        if (entry->delta_count == h->delta_capacity) {
+            // An edit larger than the whole journal cannot be undone in part
+            LOG_WARN("Editor history: edit of more than %u fields, history cleared", h->delta_capacity);
+            editor_history_clear(h);
+            h->open_entry = false;
+            return;
+        }
+        // Make room by forgetting the oldest entries
+        while (h->entry_begin + 1 < h->entry_end &&
+            h->delta_end - editor_history_entry(h, h->entry_begin)->first_delta >= h->delta_capacity) {
+            editor_history_drop_oldest(h);
+        }
+
+        EditorDelta* delta = &h->deltas[h->delta_end % h->delta_capacity];
+        *delta = {};
+        delta->handle = handle;
+        delta->field = field;
+        memcpy(delta->before, before, sizeof(f32) * count);
+        memcpy(delta->after, after, sizeof(f32) * count);
+        h->delta_end++;
+        entry->delta_count++;
+    }
+
+    const EditorHistoryEntry* editor_history_undo(EditorHistory* h) {
+        editor_history_end(h);
+        if (h->entry_cursor == h->entry_begin) return nullptr;
+        h->entry_cursor--;
+        return editor_history_entry(h, h->entry_cursor);
+    }
+
+    const EditorHistoryEntry* editor_history_redo(EditorHistory* h) {
+        editor_history_end(h);
+        if (h->entry_cursor == h->entry_end) return nullptr;
+        return editor_history_entry(h, h->entry_cursor++);
+    }
+
+    const EditorDelta* editor_history_delta(const EditorHistory* h, u64 position) {
+        return &h->deltas[position % h->delta_capacity];
+    }
+
+}
@@ -0,0 +1,73 @@
+#ifndef PLAYGROUND_EDITOR_HISTORY_H
+#define PLAYGROUND_EDITOR_HISTORY_H
+
+#include "brutal/core/types.h"
+#include "brutal/core/handle.h"
+
+namespace brutal {
+
+    struct MemoryArena;
+
+    // Editable fields. The field implies the object type its handle names.
+    enum class EditorField : u8 {
+        BrushMin,
+        BrushMax,
+        PropPosition,
+        PropRotation,
+        PropScale,
+        LightPosition,
+        LightRotation,
+        LightScale
+    };
+
+    // One field of one object before and after an edit. Vec3 fields leave
+    // the fourth value at zero.
+    struct EditorDelta {
+        Handle<void> handle;
+        EditorField field;
+        f32 before[4];
+        f32 after[4];
+    };
+
+    struct EditorHistoryEntry {
+        u64 first_delta;
+        u32 delta_count;
+    };
+
+    // Undo journal: entries of field deltas in two fixed rings, addressed by
+    // ever-growing positions. Memory follows the number of fields edited,
+    // and once a ring is full the oldest entries are forgotten. Entries
+    // [entry_begin, entry_cursor) can be undone, [entry_cursor, entry_end)
+    // redone; a new edit drops the redo tail.
+    struct EditorHistory {
+        EditorDelta* deltas;
+        EditorHistoryEntry* entries;
+        u32 delta_capacity;
+        u32 entry_capacity;
+        u64 entry_begin, entry_cursor, entry_end;
+        u64 delta_end;
+        bool open;         // Inside begin/end: records join one entry
+        bool open_entry;   // The open group already has its entry
+    };
+
+    bool editor_history_init(EditorHistory* h, MemoryArena* arena, u32 entry_capacity, u32 delta_capacity);
+    void editor_history_clear(EditorHistory* h);
+
+    // Everything recorded between begin and end is one entry, undone in one
+    // step; a field recorded twice keeps its first before and last after, so
+    // a gizmo drag costs one delta per field however many frames it lasts.
+    // A record outside begin/end is an entry of its own.
+    void editor_history_begin(EditorHistory* h);
+    void editor_history_end(EditorHistory* h);
+    void editor_history_record(EditorHistory* h, EditorField field, Handle<void> handle, const f32* before,
+        const f32* after, u32 count);
+
+    // The entry to revert or reapply, nullptr when there is none. The cursor
+    // has already moved past it.
+    const EditorHistoryEntry* editor_history_undo(EditorHistory* h);
+    const EditorHistoryEntry* editor_history_redo(EditorHistory* h);
+    const EditorDelta* editor_history_delta(const EditorHistory* h, u64 position);
+
+}
+
+#endif
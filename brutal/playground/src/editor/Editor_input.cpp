@@ -13,6 +13,24 @@ namespace brutal {
 
         if (ctx->wants_capture_keyboard) return;
 
+        const bool ctrl = platform_key_down(&platform->input, KEY_CONTROL);
+        if (ctrl && platform_key_pressed(&platform->input, KEY_S)) {
+            ctx->save_requested = true;
+            return;
+        }
+        const bool shift = platform_key_down(&platform->input, KEY_SHIFT);
+        if (ctrl && (platform_key_pressed(&platform->input, KEY_Y) ||
+            (shift && platform_key_pressed(&platform->input, KEY_Z)))) {
+            ctx->redo_requested = true;
+            return;
+        }
+        if (ctrl && platform_key_pressed(&platform->input, KEY_Z)) {
+            ctx->undo_requested = true;
+            return;
+        }
+        if (platform_key_pressed(&platform->input, KEY_DELETE)) {
+            ctx->delete_requested = true;
+        }
         if (platform_key_pressed(&platform->input, KEY_W)) {
             ctx->gizmo.operation = ImGuizmo::OPERATION::TRANSLATE;
         }
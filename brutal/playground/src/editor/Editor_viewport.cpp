@@ -6,6 +6,8 @@
 #include <glad/glad.h>
 #include <imgui.h>
 
+#include <algorithm>
+
 namespace brutal {
 
     namespace {
@@ -130,26 +132,29 @@ namespace brutal {
             renderer_draw_mesh(renderer, &scene->world_mesh, Mat4::identity(), Vec3(1, 1, 1));
         }
 
-        for (u32 p = 0; p < scene->prop_count; ++p) {
-            const PropEntity& prop = scene->props[p];
-            if (!prop.active) continue;
-            Mat4 model = transform_to_matrix(&prop.transform);
-            renderer_draw_mesh(renderer, renderer_get_cube_mesh(renderer), model, prop.color);
+        PropView props = prop_storage_query(&scene->props, PROP_COLUMN_COLOR);
+        Mat4 models[64];
+        for (u32 first = 0; first < props.count; first += 64) {
+            u32 batch = std::min(props.count - first, 64u);
+            prop_storage_world_matrices(&scene->props, first, batch, models);
+            for (u32 p = 0; p < batch; ++p) {
+                renderer_draw_mesh(renderer, renderer_get_cube_mesh(renderer), models[p], props.colors[first + p]);
+            }
         }
 
         if (!ctx->selection.empty()) {
             const f32 outline_scale = 1.02f;
             for (const auto& item : ctx->selection) {
+                u32 index = editor_selection_index(scene, item.type, item.handle);
+                if (index == HANDLE_NONE) continue;
                 if (item.type == EditorSelectionType::Prop) {
-                    if (item.index >= scene->prop_count) continue;
-                    const PropEntity& prop = scene->props[item.index];
-                    if (!prop.active) continue;
-                    Mat4 model = transform_to_matrix(&prop.transform);
+                    if (!prop_is_active(&scene->props, index)) continue;
+                    Transform transform = prop_transform(&scene->props, index);
+                    Mat4 model = transform_to_matrix(&transform);
                     renderer_draw_mesh_outline(renderer, renderer_get_cube_mesh(renderer), model, Vec3(1.0f, 0.85f, 0.2f), outline_scale);
                 }
                 else if (item.type == EditorSelectionType::Brush) {
-                    if (item.index >= scene->brush_count) continue;
-                    const Brush& brush = scene->brushes[item.index];
+                    const Brush& brush = scene->brushes[index];
                     AABB brush_aabb = brush_to_aabb(&brush);
                     Vec3 center = aabb_center(brush_aabb);
                     Vec3 size = aabb_half_size(brush_aabb) * 2.0f;
@@ -157,8 +162,7 @@ namespace brutal {
                     renderer_draw_mesh_outline(renderer, renderer_get_cube_mesh(renderer), model, Vec3(1.0f, 0.85f, 0.2f), outline_scale);
                 }
                 else if (item.type == EditorSelectionType::Light) {
-                    if (item.index >= scene->lights.point_light_count) continue;
-                    const PointLight& light = scene->lights.point_lights[item.index];
+                    const PointLight& light = scene->lights.point_lights[index];
                     Mat4 model = mat4_multiply(mat4_translation(light.position), mat4_scale(Vec3(0.2f, 0.2f, 0.2f)));
                     renderer_draw_mesh_outline(renderer, renderer_get_cube_mesh(renderer), model, Vec3(1.0f, 0.85f, 0.2f), outline_scale);
                 }
@@ -169,6 +173,7 @@ namespace brutal {
             renderer_draw_grid(renderer);
         }
 
+        renderer_flush(renderer);
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 
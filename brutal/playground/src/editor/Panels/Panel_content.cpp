@@ -9,7 +9,7 @@ namespace brutal {
         ImGui::Begin("Content Browser");
         ImGui::TextUnformatted("Assets placeholder.");
         ImGui::Text("Brushes: %u", scene->brush_count);
-        ImGui::Text("Props: %u", scene->prop_count);
+        ImGui::Text("Props: %u", scene->props.count);
         ImGui::Text("Lights: %u", scene->lights.point_light_count);
         ImGui::End();
     }
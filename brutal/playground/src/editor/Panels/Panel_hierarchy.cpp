@@ -8,16 +8,49 @@ namespace brutal {
 
     namespace {
 
-        void editor_set_selection(EditorContext* ctx, EditorSelectionType type, u32 index) {
+        void editor_set_selection(EditorContext* ctx, const Scene* scene, EditorSelectionType type, u32 index) {
             if (!ctx) return;
             ctx->selection_type = type;
-            ctx->selection_index = index;
+            ctx->selection_handle = editor_selection_handle(scene, type, index);
             ctx->selection.clear();
             if (type != EditorSelectionType::None) {
-                ctx->selection.push_back({ type, index });
+                ctx->selection.push_back({ type, ctx->selection_handle });
             }
         }
 
+        bool editor_is_selected(const EditorContext* ctx, const Scene* scene, EditorSelectionType type, u32 index) {
+            EditorHandle handle = editor_selection_handle(scene, type, index);
+            for (const EditorSelectionItem& item : ctx->selection) {
+                if (item.type == type && item.handle == handle) return true;
+            }
+            return false;
+        }
+
+        // Ctrl+click adds to the selection or takes an object out of it; the
+        // last one added is the primary the gizmo and inspector act on
+        void editor_click_selection(EditorContext* ctx, const Scene* scene, EditorSelectionType type, u32 index) {
+            if (!ImGui::GetIO().KeyCtrl || ctx->selection_type == EditorSelectionType::None) {
+                editor_set_selection(ctx, scene, type, index);
+                return;
+            }
+            EditorHandle handle = editor_selection_handle(scene, type, index);
+            for (size_t i = 0; i < ctx->selection.size(); ++i) {
+                if (ctx->selection[i].type != type || ctx->selection[i].handle != handle) continue;
+                ctx->selection.erase(ctx->selection.begin() + i);
+                if (ctx->selection.empty()) {
+                    editor_set_selection(ctx, scene, EditorSelectionType::None, 0);
+                }
+                else if (ctx->selection_type == type && ctx->selection_handle == handle) {
+                    ctx->selection_type = ctx->selection.back().type;
+                    ctx->selection_handle = ctx->selection.back().handle;
+                }
+                return;
+            }
+            ctx->selection.push_back({ type, handle });
+            ctx->selection_type = type;
+            ctx->selection_handle = handle;
+        }
+
     }
 
     void editor_draw_hierarchy(EditorContext* ctx, Scene* scene) {
@@ -28,22 +61,20 @@ namespace brutal {
             for (u32 i = 0; i < scene->brush_count; ++i) {
                 char label[64];
                 snprintf(label, sizeof(label), "Brush %u", i);
-                bool selected = ctx->selection_type == EditorSelectionType::Brush && ctx->selection_index == i;
+                bool selected = editor_is_selected(ctx, scene, EditorSelectionType::Brush, i);
                 if (ImGui::Selectable(label, selected)) {
-                    editor_set_selection(ctx, EditorSelectionType::Brush, i);
+                    editor_click_selection(ctx, scene, EditorSelectionType::Brush, i);
                 }
             }
         }
 
         if (ImGui::CollapsingHeader("Props", ImGuiTreeNodeFlags_DefaultOpen)) {
-            for (u32 i = 0; i < scene->prop_count; ++i) {
-                const PropEntity& prop = scene->props[i];
-                if (!prop.active) continue;
+            for (u32 i = 0; i < scene->props.active_count; ++i) {
                 char label[64];
                 snprintf(label, sizeof(label), "Prop %u", i);
-                bool selected = ctx->selection_type == EditorSelectionType::Prop && ctx->selection_index == i;
+                bool selected = editor_is_selected(ctx, scene, EditorSelectionType::Prop, i);
                 if (ImGui::Selectable(label, selected)) {
-                    editor_set_selection(ctx, EditorSelectionType::Prop, i);
+                    editor_click_selection(ctx, scene, EditorSelectionType::Prop, i);
                 }
             }
         }
@@ -54,15 +85,15 @@ namespace brutal {
                 if (!light.active) continue;
                 char label[64];
                 snprintf(label, sizeof(label), "Light %u", i);
-                bool selected = ctx->selection_type == EditorSelectionType::Light && ctx->selection_index == i;
+                bool selected = editor_is_selected(ctx, scene, EditorSelectionType::Light, i);
                 if (ImGui::Selectable(label, selected)) {
-                    editor_set_selection(ctx, EditorSelectionType::Light, i);
+                    editor_click_selection(ctx, scene, EditorSelectionType::Light, i);
                 }
             }
         }
 
         if (ImGui::Button("Clear Selection")) {
-            editor_set_selection(ctx, EditorSelectionType::None, 0);
+            editor_set_selection(ctx, scene, EditorSelectionType::None, 0);
         }
 
         ImGui::End();
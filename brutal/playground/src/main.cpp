@@ -13,6 +13,9 @@
 #include "brutal/renderer/debug_draw.h"
 #include "brutal/world/scene.h"
 #include "brutal/world/scene_io.h"
+#include "brutal/world/scene_binary.h"
+#include "brutal/world/scene_reload.h"
+#include "brutal/world/snapshot.h"
 #include "brutal/world/player.h"
 #include "debug_system.h"
 #include "debug_camera.h"
@@ -23,7 +26,16 @@
 
 using namespace brutal;
 
-
+// Faces hidden between brushes are culled outside the editor only: with every
+// face kept, a brush edit rewrites just its own slots of the world mesh
+// instead of re-culling the whole level.
+static void apply_face_culling(Scene* scene, EngineMode mode, MemoryArena* temp) {
+    bool cull = mode != EngineMode::Editor;
+    if (scene->cull_hidden_faces == cull) return;
+    scene->cull_hidden_faces = cull;
+    scene->world_mesh_dirty = true;
+    scene_rebuild_world_mesh(scene, temp);
+}
 
 // =============================================================================
 // Main Entry Point
@@ -32,8 +44,8 @@ using namespace brutal;
 int main() {
     LOG_INFO("Brutal Engine - Gothic House Demo");
     LOG_INFO("Controls: WASD move, SPACE jump, CTRL crouch, SHIFT sprint, ESC quit");
-    LOG_INFO("Modes: F9 toggle Editor/Play, F10 toggle Debug FreeCam");
-    LOG_INFO("Debug: F1 main, F2 perf, F3 render, F4 collision, F5 lights, F6 player bounds, F7 reload");
+    LOG_INFO("Modes: F9 toggle Editor/Play, F10 toggle Debug FreeCam, Ctrl+S save scene, Ctrl+Z/Ctrl+Y undo/redo (editor)");
+    LOG_INFO("Debug: F1 main, F2 perf, F3 render, F4 collision, F5 lights, F6 player bounds, F7 reload, F8/F11 quick save/load");
     
     // Initialize platform
     PlatformState platform = {};
@@ -71,6 +83,7 @@ int main() {
     }
 
     profiler_init();
+    jobs_init();
     
     // Create scene
     Scene scene = {};
@@ -78,18 +91,43 @@ int main() {
         LOG_ERROR("Failed to create scene");
         return 1;
     }
+    scene.merge_collision = true;
+    // Baked for play; the editor turns it off below
+    scene.cull_hidden_faces = true;
+    scene.pack_world_vertices = true;
     
-    // Load scene data (data-driven, no hardcoded level)
+    // Load scene data (data-driven, no hardcoded level). The baked .bscene is
+    // used while it is newer than the JSON source, otherwise it is rebaked.
     const char* scene_path = "playground/data/gothic_house.scene.json";
+    const char* baked_path = "playground/data/gothic_house.bscene";
     SceneSpawn spawn = { Vec3(0.0f, 1.7f, 8.0f), 3.14159f, 0.0f };
-    if (!scene_load_from_json(&scene, &spawn, scene_path, &arena)) {
-        LOG_ERROR("Failed to load scene: %s", scene_path);
-        return 1;
+    SceneBinary baked = {};
+    u64 source_time = 0, baked_time = 0;
+    bool baked_current = file_modified_time(baked_path, &baked_time) &&
+        (!file_modified_time(scene_path, &source_time) || baked_time > source_time);
+    if (baked_current && scene_load_binary(&scene, &spawn, baked_path, &arena, &baked)) {
+        scene_binary_upload(&scene, &baked);
+    } else {
+        if (!scene_load_from_json(&scene, &spawn, scene_path, &arena)) {
+            LOG_ERROR("Failed to load scene: %s", scene_path);
+            return 1;
+        }
+
+        // Rebuild world mesh and collision
+        scene_rebuild_world_mesh(&scene, &temp_arena);
+        scene_rebuild_collision(&scene);
+        scene_bake_binary(&scene, &spawn, baked_path, &temp_arena);
+        arena_reset(&temp_arena);
     }
     
-    // Rebuild world mesh and collision
-    scene_rebuild_world_mesh(&scene, &temp_arena);
-    scene_rebuild_collision(&scene);
+    // Edits to the JSON source are picked up while running; F7 forces a reload
+    SceneReloader reloader = {};
+    scene_reloader_open(&reloader, scene_path, &scene);
+
+    // F8 captures the scene and player in memory and on disk, F11 restores
+    // the last capture (or the file from an earlier run)
+    const char* quicksave_path = "playground/data/quicksave.bsnap";
+    Snapshot quicksave = {};
     
     // Initialize player
     Player player = {};
@@ -107,10 +145,12 @@ int main() {
     debug_system_init(&debug_system);
 
     EditorContext editor = {};
-    editor_init(&editor, &platform);
+    editor_init(&editor, &platform, &arena);
 
     EngineModeState engine_mode = {};
     engine_mode_init(&engine_mode, EngineMode::Editor);
+    apply_face_culling(&scene, engine_mode.mode, &temp_arena);
+    arena_reset(&temp_arena);
     editor_set_active(&editor, true, &platform, &player);
 
     DebugFreeCamera debug_camera = {};
@@ -141,14 +181,16 @@ int main() {
                 editor_set_active(&editor, false, &platform, &player);
                 platform_disable_mouse_look(&platform);
             }
+            apply_face_culling(&scene, engine_mode.mode, &temp_arena);
         }
 
         
         
         debug_system_update(&debug_system, &platform.input);
-        if (debug_system_consume_reload(&debug_system)) {
-            LOG_INFO("Reload requested (not implemented)");
-        }
+        bool reload_scene = debug_system_consume_reload(&debug_system);
+        bool quicksave_scene = debug_system_consume_quicksave(&debug_system);
+        bool quickload_scene = debug_system_consume_quickload(&debug_system);
+        if (scene_reloader_poll(&reloader)) reload_scene = true;
         
         if (engine_mode.mode == EngineMode::Play) {
             // Capture mouse on click (play mode)
@@ -229,6 +271,29 @@ int main() {
         
         // Clear temp arena each frame
         arena_reset(&temp_arena);
+        if (reload_scene && scene_reload(&reloader, &scene, &spawn, &temp_arena, nullptr)) {
+            apply_face_culling(&scene, engine_mode.mode, &temp_arena);
+            scene_rebuild_world_mesh(&scene, &temp_arena);
+            arena_reset(&temp_arena);
+        }
+        if (quicksave_scene) {
+            f64 start = time_now();
+            if (snapshot_capture(&quicksave, &scene, &player)) {
+                LOG_INFO("Quick save: %.1f KB captured in %.3f ms", quicksave.size / 1024.0,
+                    (time_now() - start) * 1000.0);
+                snapshot_save(&quicksave, quicksave_path, true);
+            }
+        }
+        if (quickload_scene && (quicksave.size || snapshot_load(&quicksave, quicksave_path))) {
+            f64 start = time_now();
+            if (snapshot_restore(&quicksave, &scene, &player)) {
+                LOG_INFO("Quick load: restored in %.3f ms", (time_now() - start) * 1000.0);
+                // The snapshot brings back the culling it was captured with
+                apply_face_culling(&scene, engine_mode.mode, &temp_arena);
+                scene_rebuild_world_mesh(&scene, &temp_arena);
+                arena_reset(&temp_arena);
+            }
+        }
         if (engine_mode.mode == EngineMode::Editor && editor_scene_needs_rebuild(&editor)) {
             scene_rebuild_world_mesh(&scene, &temp_arena);
             if (editor.rebuild_collision) {
@@ -236,6 +301,11 @@ int main() {
             }
             editor_clear_rebuild_flag(&editor);
         }
+        if (editor_consume_save_request(&editor)) {
+            scene_save_to_json(&scene, &spawn, scene_path);
+            // Our own save is not an edit to pick up
+            scene_reloader_poll(&reloader);
+        }
         
         // Render
         PROFILE_SCOPE("Render");
@@ -253,18 +323,28 @@ int main() {
                 ? &debug_camera.camera
                 : &player.camera;
             renderer_set_camera(&renderer, active_camera);
+            AABB* occluders = arena_alloc_array<AABB>(&temp_arena, OCCLUSION_MAX_OCCLUDERS);
+            if (occluders) {
+                u32 occluder_count = scene_select_occluders(&scene, active_camera->position,
+                    renderer_get_view_projection(&renderer), occluders, OCCLUSION_MAX_OCCLUDERS, &temp_arena);
+                renderer_build_occlusion(&renderer, occluders, occluder_count);
+            }
             if (scene.world_mesh.vao) {
                 renderer_draw_mesh(&renderer, &scene.world_mesh, Mat4::identity(), Vec3(1, 1, 1));
             }
 
-            for (u32 i = 0; i < scene.prop_count; ++i) {
-                const PropEntity& prop = scene.props[i];
-                if (!prop.active) continue;
-                Mat4 model = transform_to_matrix(&prop.transform);
-                renderer_draw_mesh(&renderer, renderer_get_cube_mesh(&renderer), model, prop.color);
+            PropView props = prop_storage_query(&scene.props, PROP_COLUMN_COLOR);
+            Mat4* models = arena_alloc_array<Mat4>(&temp_arena, props.count);
+            if (models) {
+                prop_storage_world_matrices(&scene.props, 0, props.count, models);
+                for (u32 i = 0; i < props.count; ++i) {
+                    renderer_draw_mesh(&renderer, renderer_get_cube_mesh(&renderer), models[i], props.colors[i]);
+                }
             }
         }
         
+        renderer_flush(&renderer);
+
         DebugFrameInfo frame_info = {};
         frame_info.delta_time = (f32)frame_dt;
         frame_info.frame_ms = (f32)(frame_dt * 1000.0);
@@ -292,10 +372,14 @@ int main() {
     }
     
     // Cleanup
+    jobs_shutdown();
     profiler_shutdown();
     debug_draw_shutdown();
     editor_shutdown(&editor);
+    scene_reloader_close(&reloader);
+    snapshot_free(&quicksave);
     scene_destroy(&scene);
+    scene_binary_close(&baked);
     renderer_shutdown(&renderer);
     arena_shutdown(&arena);
     arena_shutdown(&temp_arena);
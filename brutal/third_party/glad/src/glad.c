@@ -20,6 +20,7 @@ static void* get_proc(const char* name) {
 }
 #else
 #include <dlfcn.h>
+#include <stddef.h>
 static void* opengl_lib = NULL;
 static void* get_proc(const char* name) {
     if (!opengl_lib) opengl_lib = dlopen("libGL.so.1", RTLD_LAZY);
@@ -39,6 +40,8 @@ PFNGLFRONTFACEPROC glFrontFace = NULL;
 PFNGLFLUSHPROC glFlush = NULL;
 PFNGLGETSTRINGPROC glGetString = NULL;
 PFNGLGETERRORPROC glGetError = NULL;
+PFNGLGETINTEGERVPROC glGetIntegerv = NULL;
+PFNGLGETSTRINGIPROC glGetStringi = NULL;
 PFNGLSCISSORPROC glScissor = NULL;
 PFNGLDRAWARRAYSPROC glDrawArrays = NULL;
 PFNGLDRAWELEMENTSPROC glDrawElements = NULL;
@@ -68,6 +71,7 @@ PFNGLUNIFORM1FPROC glUniform1f = NULL;
 PFNGLUNIFORM2FPROC glUniform2f = NULL;
 PFNGLUNIFORM3FPROC glUniform3f = NULL;
 PFNGLUNIFORM4FPROC glUniform4f = NULL;
+PFNGLUNIFORM4IPROC glUniform4i = NULL;
 PFNGLUNIFORMMATRIX4FVPROC glUniformMatrix4fv = NULL;
 PFNGLGENVERTEXARRAYSPROC glGenVertexArrays = NULL;
 PFNGLDELETEVERTEXARRAYSPROC glDeleteVertexArrays = NULL;
@@ -77,8 +81,21 @@ PFNGLDELETEBUFFERSPROC glDeleteBuffers = NULL;
 PFNGLBINDBUFFERPROC glBindBuffer = NULL;
 PFNGLBUFFERDATAPROC glBufferData = NULL;
 PFNGLBUFFERSUBDATAPROC glBufferSubData = NULL;
+PFNGLMAPBUFFERRANGEPROC glMapBufferRange = NULL;
+PFNGLUNMAPBUFFERPROC glUnmapBuffer = NULL;
+PFNGLBUFFERSTORAGEPROC glBufferStorage = NULL;
+PFNGLFENCESYNCPROC glFenceSync = NULL;
+PFNGLCLIENTWAITSYNCPROC glClientWaitSync = NULL;
+PFNGLDELETESYNCPROC glDeleteSync = NULL;
+PFNGLBINDBUFFERBASEPROC glBindBufferBase = NULL;
+PFNGLGETUNIFORMBLOCKINDEXPROC glGetUniformBlockIndex = NULL;
+PFNGLUNIFORMBLOCKBINDINGPROC glUniformBlockBinding = NULL;
 PFNGLENABLEVERTEXATTRIBARRAYPROC glEnableVertexAttribArray = NULL;
 PFNGLVERTEXATTRIBPOINTERPROC glVertexAttribPointer = NULL;
+PFNGLVERTEXATTRIBDIVISORPROC glVertexAttribDivisor = NULL;
+PFNGLVERTEXATTRIBIPOINTERPROC glVertexAttribIPointer = NULL;
+PFNGLTEXBUFFERPROC glTexBuffer = NULL;
+PFNGLDRAWELEMENTSINSTANCEDPROC glDrawElementsInstanced = NULL;
 PFNGLGENFRAMEBUFFERSPROC glGenFramebuffers = NULL;
 PFNGLDELETEFRAMEBUFFERSPROC glDeleteFramebuffers = NULL;
 PFNGLBINDFRAMEBUFFERPROC glBindFramebuffer = NULL;
@@ -101,6 +118,8 @@ int gladLoadGL(void) {
     glFlush = (PFNGLFLUSHPROC)get_proc("glFlush");
     glGetString = (PFNGLGETSTRINGPROC)get_proc("glGetString");
     glGetError = (PFNGLGETERRORPROC)get_proc("glGetError");
+    glGetIntegerv = (PFNGLGETINTEGERVPROC)get_proc("glGetIntegerv");
+    glGetStringi = (PFNGLGETSTRINGIPROC)get_proc("glGetStringi");
     glScissor = (PFNGLSCISSORPROC)get_proc("glScissor");
     glDrawArrays = (PFNGLDRAWARRAYSPROC)get_proc("glDrawArrays");
     glDrawElements = (PFNGLDRAWELEMENTSPROC)get_proc("glDrawElements");
@@ -130,6 +149,7 @@ int gladLoadGL(void) {
     glUniform2f = (PFNGLUNIFORM2FPROC)get_proc("glUniform2f");
     glUniform3f = (PFNGLUNIFORM3FPROC)get_proc("glUniform3f");
     glUniform4f = (PFNGLUNIFORM4FPROC)get_proc("glUniform4f");
+    glUniform4i = (PFNGLUNIFORM4IPROC)get_proc("glUniform4i");
     glUniformMatrix4fv = (PFNGLUNIFORMMATRIX4FVPROC)get_proc("glUniformMatrix4fv");
     glGenVertexArrays = (PFNGLGENVERTEXARRAYSPROC)get_proc("glGenVertexArrays");
     glDeleteVertexArrays = (PFNGLDELETEVERTEXARRAYSPROC)get_proc("glDeleteVertexArrays");
@@ -139,8 +159,21 @@ int gladLoadGL(void) {
     glBindBuffer = (PFNGLBINDBUFFERPROC)get_proc("glBindBuffer");
     glBufferData = (PFNGLBUFFERDATAPROC)get_proc("glBufferData");
     glBufferSubData = (PFNGLBUFFERSUBDATAPROC)get_proc("glBufferSubData");
+    glMapBufferRange = (PFNGLMAPBUFFERRANGEPROC)get_proc("glMapBufferRange");
+    glUnmapBuffer = (PFNGLUNMAPBUFFERPROC)get_proc("glUnmapBuffer");
+    glBufferStorage = (PFNGLBUFFERSTORAGEPROC)get_proc("glBufferStorage");
+    glFenceSync = (PFNGLFENCESYNCPROC)get_proc("glFenceSync");
+    glClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)get_proc("glClientWaitSync");
+    glDeleteSync = (PFNGLDELETESYNCPROC)get_proc("glDeleteSync");
+    glBindBufferBase = (PFNGLBINDBUFFERBASEPROC)get_proc("glBindBufferBase");
+    glGetUniformBlockIndex = (PFNGLGETUNIFORMBLOCKINDEXPROC)get_proc("glGetUniformBlockIndex");
+    glUniformBlockBinding = (PFNGLUNIFORMBLOCKBINDINGPROC)get_proc("glUniformBlockBinding");
     glEnableVertexAttribArray = (PFNGLENABLEVERTEXATTRIBARRAYPROC)get_proc("glEnableVertexAttribArray");
     glVertexAttribPointer = (PFNGLVERTEXATTRIBPOINTERPROC)get_proc("glVertexAttribPointer");
+    glVertexAttribDivisor = (PFNGLVERTEXATTRIBDIVISORPROC)get_proc("glVertexAttribDivisor");
+    glVertexAttribIPointer = (PFNGLVERTEXATTRIBIPOINTERPROC)get_proc("glVertexAttribIPointer");
+    glTexBuffer = (PFNGLTEXBUFFERPROC)get_proc("glTexBuffer");
+    glDrawElementsInstanced = (PFNGLDRAWELEMENTSINSTANCEDPROC)get_proc("glDrawElementsInstanced");
     glGenFramebuffers = (PFNGLGENFRAMEBUFFERSPROC)get_proc("glGenFramebuffers");
     glDeleteFramebuffers = (PFNGLDELETEFRAMEBUFFERSPROC)get_proc("glDeleteFramebuffers");
     glBindFramebuffer = (PFNGLBINDFRAMEBUFFERPROC)get_proc("glBindFramebuffer");
@@ -68,6 +68,7 @@ namespace ImGui {
     ImVec2 GetItemRectMin() { return g_last_min; }
     ImVec2 GetItemRectMax() { return g_last_max; }
     bool IsItemHovered() { return false; }
+    bool IsItemActive() { return false; }
     bool IsWindowFocused() { return false; }
 
     bool CollapsingHeader(const char*, int) { return true; }
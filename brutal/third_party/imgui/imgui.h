@@ -21,6 +21,7 @@ struct ImGuiIO {
     int ConfigFlags = 0;
     bool WantCaptureMouse = false;
     bool WantCaptureKeyboard = false;
+    bool KeyCtrl = false;
 };
 
 enum ImGuiConfigFlags_ {
@@ -112,6 +113,7 @@ namespace ImGui {
     ImVec2 GetItemRectMin();
     ImVec2 GetItemRectMax();
     bool IsItemHovered();
+    bool IsItemActive();
     bool IsWindowFocused();
 
     bool CollapsingHeader(const char* label, int flags = 0);